@@ -5,33 +5,118 @@
 #include <semaphore.h>
 #include <time.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include "../include/utils.h"
+#include "../include/fila_mpsc.h"
+
+// Tempo de voo em cada setor: TEMPO_VOO_MIN_MS + [0, TEMPO_VOO_VARIACAO_MS)
+#define TEMPO_VOO_MIN_MS 1000
+#define TEMPO_VOO_VARIACAO_MS 500
+
+// Ids de setor da rota em 16 bits enquanto couberem; acima disso, 32 bits
+#define SETORES_ROTA_CURTA 65536
+
+// Tempos de espera de uma aeronave agregados em tamanho fixo (no lugar de um
+// valor por trecho). Percentis saem do histograma da frota (espera.h)
+typedef struct {
+    uint32_t amostras;       // Concessões registradas
+    uint32_t amostras_media; // Das quais com espera acima de 1 ms (as que entram na média da aeronave)
+    int64_t soma_ns;
+    int64_t soma_media_ns;
+    int64_t max_ns;
+} espera_agregada_t;
+
+// Pedido ao controlador central (modo central): o nó vai direto para a fila MPSC
+typedef struct {
+    no_mpsc_t no;                 // Primeiro campo: o nó da fila é o próprio pedido
+    struct aeronave_t *aeronave;
+    int setor;
+    bool liberar;                 // false = adquirir, true = liberar
+    _Atomic bool pendente;        // Ainda na fila ou em processamento: não pode ser reenviado
+} pedido_controle_t;
+
+// Resposta do controlador central a um pedido de setor
+typedef enum {
+    RESPOSTA_PENDENTE,
+    RESPOSTA_CONCEDIDO,
+    RESPOSTA_BLOQUEADO,  // Fecharia um ciclo: o setor atual foi liberado, tente mais tarde
+    RESPOSTA_JA_NO_SETOR, // Pediu o setor em que já está: nada muda e não conta como espera
+    RESPOSTA_ERRO
+} resposta_controle_t;
+
+// Onde a thread da aeronave está, para o checkpoint saber se o estado dela
+// está parado. As transições entre trechos são escritas com ordem sequencial
+// e conferem a pausa logo depois (checkpoint.h)
+typedef enum {
+    FASE_LARGADA,       // Antes do primeiro trecho
+    FASE_PEDINDO,       // Em atc_solicitar_setor (parada só enquanto estiver numa fila)
+    FASE_VOANDO,        // Com o setor, até fim_voo_ns
+    FASE_ENTRE_TRECHOS, // Terminou o voo e avança na rota (transitória)
+    FASE_ESTACIONADA,   // Parada pelo checkpoint antes de pedir o trecho posicao_rota
+    FASE_POUSADA,       // Parada pelo checkpoint no fim do voo do trecho posicao_rota
+    FASE_CONCLUIDA
+} fase_aeronave_t;
 
 typedef struct aeronave_t {
+    // Somente leitura após a criação
     int id;
-    unsigned int prioridade;
     unsigned int prioridade_original;
-    int *rota;
+    const void *rota;  // Trechos no bloco compacto de rotas: uint16_t, ou uint32_t se rota_larga
+    bool rota_larga;
+    bool emergencia;   // Classe de emergência: corredor próprio e preempção (atc_registrar_aeronave)
     int comprimento_rota;
+    pthread_t thread;
+
+    // Estado da própria thread (escrito sob mutex_ctrl quando o controlador participa)
+    unsigned int prioridade;
+    int posicao_rota; // Índice do trecho da rota em andamento
     int setor_atual;
     int setor_destino;
-    struct timespec tempo_solicitacao;
-    time_t tempo_entrada;
-    double *tempo_espera;
-    int total_espera;
-    sem_t sem_aeronave;
-    pthread_t thread;
-    bool precisa_recuar;
+    long long instante_solicitacao_ns; // relogio_agora_ns do último pedido de setor
+    long long instante_entrada_ns;     // Criação da aeronave
+    espera_agregada_t espera;
     int contador_recuos;
+    bool recuo_recente; // Perdeu a vez num ciclo e ainda não tentou de novo (sob mutex_ctrl)
     int contador_esperas_longas;
+    unsigned int semente; // Estado do gerador aleatório próprio da thread
+    struct aeronave_t *proxima_emergencia; // Elo no corredor de emergência do setor aguardado
+    _Atomic int fase;         // fase_aeronave_t
+    long long fim_voo_ns;     // Fim do voo em andamento (relogio_agora_ns)
+    long long voo_restante_ns; // Restauração: resto do voo interrompido pelo checkpoint
+    long long espera_estimada_ns; // Estimativa na entrada da fila, conferida na concessão (-1 = nenhuma)
+
+    // Escrito por outras threads (repasse e recuo): linha de cache própria
+    _Alignas(LINHA_CACHE) sem_t sem_aeronave;
+    bool precisa_recuar;
+    long long instante_repasse_ns; // Quando o setor foi repassado a ela (0 = não houve)
+    resposta_controle_t resposta_controle; // Escrita pelo controlador central antes de acordá-la
+
+    // Pedidos ao controlador central: um para adquirir e outro para liberar,
+    // já que a liberação é assíncrona e pode ainda estar na fila no pedido seguinte
+    pedido_controle_t pedido_setor;
+    pedido_controle_t pedido_liberacao;
 } aeronave_t;
 
 
+int aeronave_inicializar(aeronave_t *a, int id, int total_setores, void *rota,
+                         int comprimento_rota, unsigned int semente);
+size_t aeronave_tamanho_trecho(int total_setores);
+int aeronave_sortear_comprimento_rota(int total_setores);
 aeronave_t *aeronave_criar(int id, int total_setores);
 void aeronave_destruir(aeronave_t *aeronave);
 void *aeronave_executa(void *arg);
 void aeronave_imprimir_status(aeronave_t *aeronave);
-void aeronave_registro_tempo_espera(aeronave_t *aeronave, struct timespec inicio);
+void aeronave_registro_tempo_espera(aeronave_t *aeronave, long long inicio_ns);
 double aeronave_calcular_media_espera(aeronave_t *aeronave);
 
+/**
+ * Setor do i-ésimo trecho da rota
+ * @param a: Aeronave
+ * @param i: Índice do trecho (0 a comprimento_rota-1)
+ * @return Id do setor
+ */
+static inline int aeronave_trecho(const aeronave_t *a, int i) {
+    return a->rota_larga ? (int)((const uint32_t *)a->rota)[i] : (int)((const uint16_t *)a->rota)[i];
+}
+
 #endif // AERONAVE_H
\ No newline at end of file
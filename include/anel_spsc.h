@@ -0,0 +1,26 @@
+#ifndef ANEL_SPSC_H
+#define ANEL_SPSC_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "../include/utils.h"
+
+// Anel lock-free de um produtor e um consumidor com mensagens de tamanho fixo
+// Pode morar em memória compartilhada entre processos: só usa índices, nunca ponteiros
+typedef struct {
+    _Alignas(LINHA_CACHE) _Atomic unsigned long cabeca; // Próxima leitura (consumidor)
+    _Alignas(LINHA_CACHE) _Atomic unsigned long cauda;  // Próxima escrita (produtor)
+    _Alignas(LINHA_CACHE) unsigned long capacidade;     // Potência de 2
+    unsigned long tamanho_mensagem;
+    _Alignas(LINHA_CACHE) unsigned char dados[];
+} anel_spsc_t;
+
+
+size_t anel_spsc_tamanho(unsigned long capacidade, size_t tamanho_mensagem);
+void anel_spsc_inicializar(anel_spsc_t *anel, unsigned long capacidade, size_t tamanho_mensagem);
+bool anel_spsc_enviar(anel_spsc_t *anel, const void *mensagem);
+bool anel_spsc_receber(anel_spsc_t *anel, void *mensagem);
+bool anel_spsc_vazio(anel_spsc_t *anel);
+
+#endif // ANEL_SPSC_H
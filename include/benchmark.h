@@ -0,0 +1,25 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include "../include/simulacao.h"
+
+#define LINHA_BASE_PADRAO "estresse.base" // Vazões de referência do teste de estresse
+
+
+int benchmark_politicas(const simulacao_config_t *base);
+int benchmark_controladores(const simulacao_config_t *base);
+int benchmark_deteccao(const simulacao_config_t *base);
+int benchmark_vitimas(const simulacao_config_t *base);
+int benchmark_reservas(const simulacao_config_t *base);
+int benchmark_memoria(const simulacao_config_t *base);
+int benchmark_numa(const simulacao_config_t *base);
+int benchmark_estresse(const simulacao_config_t *base, const char *arquivo_linha_base, bool gravar);
+int benchmark_chegadas(const simulacao_config_t *base);
+int benchmark_emergencias(const simulacao_config_t *base);
+int benchmark_medicao(const simulacao_config_t *base);
+int benchmark_temporizador(const simulacao_config_t *base);
+int benchmark_heranca(const simulacao_config_t *base);
+int benchmark_relogio();
+int benchmark_micro();
+
+#endif // BENCHMARK_H
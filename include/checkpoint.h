@@ -0,0 +1,50 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "../include/aeronave.h"
+#include "../include/frota.h"
+#include "../include/contadores.h"
+
+#define CHECKPOINT_MAGICA "ATCK"
+#define CHECKPOINT_VERSAO 5 // Muda com o formato (inclusive com CONTADORES_TOTAL)
+
+// Retrato de uma execução em andamento num arquivo binário: cabeçalho, um
+// registro fixo por aeronave e o estado do controlador (ocupação, filas na
+// ordem de atendimento e corredores de emergência). Para gravar, as aeronaves
+// são seguradas no próximo ponto seguro (antes de pedir um trecho ou no fim de
+// um voo); as que estão numa fila ou voando já estão paradas e são lidas como
+// estão. O estado do controlador é copiado sob mutex_ctrl para a memória e só
+// então escrito, fora da trava. Tempos vão em ns simulados (independem da
+// escala da execução que restaura)
+typedef struct {
+    char magica[4];
+    uint32_t versao;
+    int32_t setores;
+    int32_t aeronaves;
+    uint32_t semente;             // Recria a mesma frota e as mesmas rotas
+    int32_t escala;
+    char politica[16];
+    double fracao_emergencias;
+    int64_t instante_simulado_ns; // Tempo simulado desde a largada (somado entre retomadas)
+    uint64_t soma_rotas;          // Confere que a frota recriada é a mesma
+    int64_t contadores[CONTADORES_TOTAL];
+} checkpoint_cabecalho_t;
+
+// Medidas da última gravação
+typedef struct {
+    double pausa_ms;    // Da pausa pedida ao estado copiado (frota segurada)
+    double escrita_ms;  // Arquivo escrito e renomeado, fora da pausa
+    long bytes;
+    int tentativas;     // Varreduras até achar todas as aeronaves paradas
+} checkpoint_medidas_t;
+
+
+void checkpoint_ponto_seguro(aeronave_t *a, fase_aeronave_t fase_seguinte, fase_aeronave_t fase_parada);
+bool checkpoint_gravar(const char *caminho, frota_t *frota, const checkpoint_cabecalho_t *modelo,
+                       long long largada_ns, checkpoint_medidas_t *medidas);
+bool checkpoint_ler_cabecalho(const char *caminho, checkpoint_cabecalho_t *cabecalho);
+bool checkpoint_restaurar(const char *caminho, frota_t *frota, checkpoint_cabecalho_t *cabecalho);
+
+#endif // CHECKPOINT_H
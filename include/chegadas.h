@@ -0,0 +1,49 @@
+#ifndef CHEGADAS_H
+#define CHEGADAS_H
+
+#include <stdbool.h>
+
+#define CHEGADAS_DURACAO_PADRAO_S 600    // Segundos simulados com chegadas
+#define CHEGADAS_AQUECIMENTO_PADRAO_S 60 // Segundos simulados iniciais fora da medição
+
+// Regime aberto: em vez da frota inteira na largada, as aeronaves chegam a uma
+// taxa fixa, independente de quantas ainda estão no ar. As chegadas são
+// sorteadas antes da largada (a frota é exatamente quem chega em duracao
+// segundos) e cada thread dorme até o seu instante. Tempos em segundos
+// simulados, comprimidos pela escala como os de voo
+typedef enum {
+    CHEGADAS_POISSON,   // Intervalos exponenciais de média 1/taxa
+    CHEGADAS_CONSTANTE  // Intervalo fixo de 1/taxa
+} processo_chegadas_t;
+
+typedef struct {
+    processo_chegadas_t processo;
+    double taxa;        // Aeronaves por segundo simulado
+    double duracao;     // Chegadas em [0, duracao)
+    double aquecimento; // A medição cobre [aquecimento, duracao]
+} chegadas_config_t;
+
+// Medidas da janela [aquecimento, duracao]; vazão e percentis da espera ficam
+// no resultado da simulação (o histograma de espera.h só conta a janela)
+typedef struct {
+    int aeronaves;              // Chegadas sorteadas (tamanho da frota)
+    double taxa_efetiva;        // Chegadas por segundo simulado dentro da janela
+    double trechos_por_aeronave;
+    int em_sistema_inicio;      // Chegaram e não concluíram, no início da janela
+    int em_sistema_fim;         // ... e no fim (crescendo: acima da capacidade)
+    double drenagem;            // Segundos simulados do fim das chegadas à última conclusão
+} chegadas_estatisticas_t;
+
+
+bool chegadas_interpretar(const char *texto, chegadas_config_t *config);
+const char *chegadas_nome_processo(processo_chegadas_t processo);
+int chegadas_preparar(const chegadas_config_t *config, unsigned int semente);
+void chegadas_finalizar();
+bool chegadas_ativas();
+void chegadas_definir_origem(long long origem_ns);
+void chegadas_aguardar(int id);
+void chegadas_concluir();
+void chegadas_acompanhar_janela(chegadas_estatisticas_t *estatisticas);
+void chegadas_registrar_fim(long long conclusao_ns, chegadas_estatisticas_t *estatisticas);
+
+#endif // CHEGADAS_H
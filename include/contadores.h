@@ -0,0 +1,54 @@
+#ifndef CONTADORES_H
+#define CONTADORES_H
+
+// Contadores de eventos do controlador divididos por thread. Cada thread que
+// conta ganha um bloco próprio do tamanho de linhas de cache inteiras e só ela
+// escreve nele (load e store relaxados, sem instrução atômica de
+// leitura-modificação-escrita), então contar não disputa linha com ninguém,
+// dentro ou fora de mutex_ctrl. O total é a soma dos blocos, feita só quando
+// alguém lê: no fim da execução ou por um leitor ao vivo (o monitor)
+typedef enum {
+    CONTADOR_TRANSFERENCIAS,     // Setores concedidos
+    CONTADOR_DEADLOCKS,          // Ciclos de espera encontrados
+    CONTADOR_RECUOS,             // Recuos forçados
+    CONTADOR_BOOSTS,             // Boosts de prioridade (recuos ou esperas longas)
+    CONTADOR_SALTOS_PERDIDOS,    // Setores devolvidos por recuos
+    CONTADOR_ESPERA_PERDIDA_NS,  // Fila descartada por vítimas
+    CONTADOR_PREEMPCOES,         // Setores tomados de ocupantes comuns por emergências (desalojo ou cessão)
+    CONTADOR_ACESSOS_SETOR,      // Concessões medidas por nó NUMA
+    CONTADOR_ACESSOS_REMOTOS,    // ... feitas de um núcleo fora do nó do setor
+    CONTADOR_LOTES,              // Lotes do controlador central
+    CONTADOR_PEDIDOS_LOTE,       // Pedidos atendidos nesses lotes
+    CONTADOR_PASSADAS_DETECCAO,  // Passadas do detector periódico
+    CONTADOR_SECOES,             // Posses de mutex_ctrl
+    CONTADOR_SECAO_NS,           // Soma das posses
+    CONTADOR_ESTIMATIVAS,        // Esperas em fila com estimativa conferida
+    CONTADOR_ESPERA_ESTIMADA_NS, // Soma das estimativas
+    CONTADOR_ESPERA_MEDIDA_NS,   // Soma das esperas medidas correspondentes
+    CONTADOR_ERRO_ESTIMATIVA_NS, // Soma dos erros absolutos
+    CONTADOR_ESTIMATIVAS_NA_FAIXA, // Estimativas entre metade e o dobro da espera medida
+    CONTADOR_RETENCOES,          // Decolagens retidas pela medição (medicao.h)
+    CONTADOR_RETENCAO_NS,        // Soma do tempo retido em solo
+    CONTADOR_SONOS,              // Esperas por tempo das aeronaves (temporizador.h)
+    CONTADOR_ATRASO_SONO_NS,     // Soma dos atrasos além do prazo
+    CONTADOR_TEMPORIZADORES_ARMADOS, // Temporizadores armados no kernel
+    CONTADOR_LOTES_RODA,         // Ticks da roda que acordaram alguém
+    CONTADOR_ACORDADAS_RODA,     // Aeronaves acordadas nesses ticks
+    CONTADOR_HERANCAS,           // Ocupantes que herdaram prioridade de quem os espera
+    CONTADORES_TOTAL
+} contador_t;
+
+typedef struct {
+    long long valor[CONTADORES_TOTAL];
+    int threads; // Blocos somados (threads que contaram algo)
+} contadores_t;
+
+
+void contadores_reiniciar();
+void contadores_finalizar();
+void contadores_registrar_thread();
+void contadores_adicionar(contador_t contador, long long quantidade);
+void contadores_incrementar(contador_t contador);
+void contadores_ler(contadores_t *totais);
+
+#endif // CONTADORES_H
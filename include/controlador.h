@@ -4,6 +4,7 @@
 #include "../include/fila_prioridade.h"
 #include "aeronave.h"
 #include <stdbool.h>
+#include <stdio.h>
 #include "../include/utils.h"
 
 extern int total_setores;
@@ -15,16 +16,85 @@ extern sem_t mutex_ctrl;
 extern sem_t mutex_console;
 extern pthread_t thread_controlador;
 
+typedef enum {
+    CONTROLADOR_TRAVAS,  // Cada aeronave executa a lógica do controlador sob mutex_ctrl (original)
+    CONTROLADOR_CENTRAL  // Aeronaves enfileiram pedidos e a thread do controlador os atende em lotes
+} modo_controlador_t;
 
+typedef enum {
+    DETECCAO_POR_PEDIDO, // Cadeia de espera a partir do solicitante, a cada pedido contestado (original)
+    DETECCAO_PERIODICA   // Pedidos enfileiram sem checar; um detector acha todos os ciclos de tempos em tempos
+} modo_deteccao_t;
+
+typedef struct {
+    int deadlocks_detectados;
+    int recuos_forcados;
+    int boosts_aplicados;
+    int transferencias;
+    double tempo_total; // Segundos desde atc_init
+    long lotes;         // Modo central: lotes atendidos pela thread do controlador
+    long pedidos_em_lote;
+    long passadas_deteccao;        // Modo periódico: passadas do detector
+    double secao_critica_media_ns; // Posse média de mutex_ctrl
+    long long secao_critica_max_ns;
+    long saltos_perdidos;          // Setores devolvidos por recuos (trabalho perdido)
+    double espera_perdida;         // Segundos de fila descartados por vítimas
+    int max_recuos_seguidos;       // Pior sequência de recuos de uma mesma aeronave
+    long acessos_setor;            // Concessões medidas (só com mais de um nó NUMA)
+    long acessos_remotos;          // ... feitas de um núcleo fora do nó dono do setor
+    int preempcoes;                // Setores tomados de ocupantes comuns por emergências (desalojo ou cessão)
+    int threads_contadores;        // Threads cujos contadores entraram na soma
+    long estimativas;              // Esperas em fila com estimativa conferida na concessão
+    double estimativa_erro_medio_ns; // Erro absoluto médio da estimativa
+    double estimativa_vies_ns;     // Estimada - medida, em média (negativo = otimista)
+    double espera_estimada_media_ns;
+    double espera_medida_media_ns;
+    double estimativas_na_faixa;   // Fração com a estimativa entre metade e o dobro da medida
+    long retencoes;                // Decolagens retidas pela medição
+    double retencao_media_ns;      // Tempo em solo por retenção
+    long herancas;                 // Ocupantes que herdaram prioridade de quem os espera
+} atc_estatisticas_t;
+
+
+void atc_definir_politica(const politica_fila_t *politica);
+bool atc_definir_modo(const char *nome);
+const char *atc_nome_modo();
+bool atc_definir_deteccao(const char *nome);
+bool atc_definir_emergencias(double fracao);
+double atc_fracao_emergencias();
+void atc_definir_preempcao(bool ligada);
+void atc_definir_heranca(bool ligada);
+bool atc_heranca_ligada();
+const char *atc_nome_deteccao();
 void atc_init(int setores, int n_aeronaves);
 void atc_finalizar();
+bool atc_registrar_aeronave(aeronave_t *aeronave);
+void atc_simular_espera(aeronave_t *aeronave, int setor);
+int atc_ocupante_setor(int setor);
+int atc_setor_aguardado(int id);
+long long atc_estimar_espera(int setor, unsigned int prioridade);
+void atc_definir_prioridade(aeronave_t *aeronave, unsigned int prioridade);
+unsigned int atc_prioridade_propria(const aeronave_t *aeronave);
+void atc_congelar();
+void atc_descongelar();
+int atc_fila_da_aeronave(int id);
+bool atc_salvar_estado(FILE *f);
+bool atc_restaurar_estado(FILE *f);
+void atc_aguardar_largada();
+void atc_liberar_largada();
+void atc_obter_estatisticas(atc_estatisticas_t *estatisticas);
 int atc_solicitar_setor(aeronave_t *aeronave, int setor_destino);
+int atc_retomar_espera(aeronave_t *aeronave, int setor_desejado);
 void atc_liberar_setor(aeronave_t *aeronave, int setor_liberado);
+int atc_deixar_setor(aeronave_t *aeronave);
 void *controlador_central_executar(void *arg);
+void *controlador_detector_executar(void *arg);
 void liberar_setor_emergencia(aeronave_t *aeronave);
 // void controlador_processar_solicitacao();
 bool verificar_deadlock(aeronave_t *aeronave, int setor_desejado);
 void imprimir_estado_setores();
 void imprimir_fila_espera();
+void imprimir_estimativas();
+void imprimir_contadores();
 
 #endif // CONTROLADOR_H
\ No newline at end of file
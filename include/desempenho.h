@@ -0,0 +1,82 @@
+#ifndef DESEMPENHO_H
+#define DESEMPENHO_H
+
+#include <stdbool.h>
+
+// Contadores de hardware (perf_event_open) por fase do controlador. Cada
+// thread abre o seu grupo de eventos na primeira fase em que entra e lê o
+// grupo inteiro numa chamada a cada troca de fase; a diferença vai para a
+// fase do topo da pilha, então os números são exclusivos (um pedido não conta
+// a busca de ciclo nem o log que fez por dentro). Cada leitura é uma chamada
+// de sistema e entra na conta da fase seguinte: é uma medição para comparar
+// fases, não para medir a vazão. Eventos que o kernel ou a máquina não
+// oferecem (máquinas virtuais costumam não ter os de hardware) ficam de fora
+// e aparecem como n/d. Compilar com SEM_CONTADORES_HW (make SEM_CONTADORES_HW=1)
+// ou fora do Linux tira tudo: as chamadas viram funções vazias
+#if defined(__linux__) && !defined(SEM_CONTADORES_HW)
+#define DESEMPENHO_COMPILADO 1
+#endif
+
+#define DESEMPENHO_PROFUNDIDADE 8 // Fases aninhadas; além disso só contam entradas
+
+typedef enum {
+    DESEMPENHO_PEDIDO,     // Pedido de setor (tentativa com travas ou pedido aplicado pela thread central)
+    DESEMPENHO_TRAVA,      // Espera por mutex_ctrl
+    DESEMPENHO_ESPERA,     // Aeronave dormindo na fila ou na pausa após um bloqueio
+    DESEMPENHO_DEADLOCK,   // Busca de ciclo (por pedido ou passada periódica)
+    DESEMPENHO_ENFILEIRAR, // Entrada na fila do setor
+    DESEMPENHO_REPASSE,    // Liberação e repasse em cadeia para a fila
+    DESEMPENHO_LOG,        // Linhas de log_evento
+    DESEMPENHO_FASES
+} desempenho_fase_t;
+
+typedef enum {
+    DESEMPENHO_CICLOS,
+    DESEMPENHO_INSTRUCOES,
+    DESEMPENHO_FALHAS_L1,     // Leituras que falharam no L1 de dados
+    DESEMPENHO_FALHAS_LLC,    // Falhas no último nível de cache
+    DESEMPENHO_FALHAS_DESVIO, // Desvios mal previstos
+    DESEMPENHO_TROCAS,        // Trocas de contexto
+    DESEMPENHO_TEMPO_CPU,     // ns na CPU (task-clock)
+    DESEMPENHO_EVENTOS
+} desempenho_evento_t;
+
+
+#ifdef DESEMPENHO_COMPILADO
+extern bool desempenho_ativo; // Só muda entre execuções (desempenho_ligar)
+
+void desempenho_entrar_fase(desempenho_fase_t fase);
+void desempenho_sair_fase();
+
+bool desempenho_ligar(bool ligado);
+bool desempenho_ligado();
+void desempenho_reiniciar();
+void desempenho_finalizar();
+void desempenho_imprimir();
+
+/**
+ * Marca o início de uma fase na thread chamadora (aninha na fase atual)
+ * @param fase: Fase que começa
+ */
+static inline void desempenho_entrar(desempenho_fase_t fase) {
+    if (desempenho_ativo) desempenho_entrar_fase(fase);
+}
+
+/**
+ * Marca o fim da fase mais interna da thread chamadora
+ */
+static inline void desempenho_sair() {
+    if (desempenho_ativo) desempenho_sair_fase();
+}
+
+#else
+static inline void desempenho_entrar(desempenho_fase_t fase) { (void)fase; }
+static inline void desempenho_sair() {}
+static inline bool desempenho_ligar(bool ligado) { return !ligado; } // Pedir para ligar falha
+static inline bool desempenho_ligado() { return false; }
+static inline void desempenho_reiniciar() {}
+static inline void desempenho_finalizar() {}
+static inline void desempenho_imprimir() {}
+#endif
+
+#endif // DESEMPENHO_H
@@ -0,0 +1,48 @@
+#ifndef ESPERA_H
+#define ESPERA_H
+
+#include <semaphore.h>
+#include <stdbool.h>
+
+#define ESPERA_PRIORIDADE_ALTA 901 // Prioridade original da classe alta (os 10% do topo de 1-1000)
+
+typedef enum {
+    ESPERA_BLOQUEANTE,  // sem_wait direto (comportamento original)
+    ESPERA_ADAPTATIVA   // gira, depois cede a CPU, depois dorme no semáforo
+} modo_espera_t;
+
+typedef struct {
+    long esperas_giro;      // Resolvidas girando
+    long esperas_rendicao;  // Resolvidas com sched_yield
+    long esperas_dormindo;  // Precisaram dormir no semáforo (futex)
+    long repasses;          // Amostras de latência de repasse
+    double repasse_media;   // Latência liberação -> novo ocupante rodando, em µs
+    double repasse_p50;
+    double repasse_p99;
+    double repasse_max;
+    long concessoes;        // Amostras de espera por concessão de setor (só as da janela, se houver)
+    double concessao_p50;   // Em ms, pelo histograma (erro < 12,5%)
+    double concessao_p99;
+    double concessao_p999;
+    long emergencias;       // Concessões a aeronaves de emergência (também contadas acima)
+    double emergencia_p50;  // Em ms
+    double emergencia_p99;
+    double emergencia_p999;
+    double emergencia_max;
+    long altas;             // Concessões a aeronaves de prioridade alta (também contadas acima)
+    double alta_p50;        // Em ms
+    double alta_p99;
+    double alta_p999;
+} espera_estatisticas_t;
+
+
+bool espera_definir_modo(const char *nome);
+const char *espera_nome_modo();
+void espera_reiniciar();
+void espera_definir_janela(long long inicio_ns, long long fim_ns);
+void espera_aguardar(sem_t *sem);
+void espera_registrar_repasse(long long latencia_ns);
+void espera_registrar_concessao(long long espera_ns, bool emergencia, bool alta);
+void espera_obter_estatisticas(espera_estatisticas_t *estatisticas);
+
+#endif // ESPERA_H
@@ -0,0 +1,30 @@
+#ifndef ESTIMATIVA_H
+#define ESTIMATIVA_H
+
+#include <stdbool.h>
+
+#define ESTIMATIVA_FAIXAS 16 // Faixas de prioridade na composição de cada fila
+#define ESTIMATIVA_PESO 8    // A média móvel do serviço anda 1/8 em cada amostra
+
+// Estimador da espera por setor, mantido incrementalmente pelo controlador:
+// média móvel exponencial da posse do setor (voo e, se for o caso, a espera
+// pelo trecho seguinte segurando este) e a composição da fila por faixa de
+// prioridade. A estimativa é ocupante restante + quem fica à frente vezes o
+// serviço médio, lida em O(1) de campos atômicos sem mutex_ctrl (os campos
+// podem vir de instantes um pouco diferentes)
+bool estimativa_inicializar(int setores, unsigned int prioridade_max, long long servico_inicial_ns);
+void estimativa_finalizar();
+
+// Escrita: só sob mutex_ctrl (um escritor por vez)
+void estimativa_enfileirar(int setor, unsigned int prioridade, bool corredor);
+void estimativa_desenfileirar(int setor, unsigned int prioridade, bool corredor);
+void estimativa_ocupar(int setor, long long agora_ns);
+void estimativa_liberar(int setor, long long agora_ns);
+
+// Leitura: qualquer thread, sem travas
+long long estimativa_calcular(int setor, unsigned int prioridade, bool corredor, bool por_prioridade,
+                              long long agora_ns);
+long long estimativa_servico(int setor);
+int estimativa_tamanho_fila(int setor);
+
+#endif // ESTIMATIVA_H
@@ -0,0 +1,27 @@
+#ifndef FILA_MPSC_H
+#define FILA_MPSC_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include "../include/utils.h"
+
+// Nó intrusivo: fica dentro da estrutura enfileirada, a fila nunca aloca memória
+typedef struct no_mpsc {
+    _Atomic(struct no_mpsc *) proximo;
+} no_mpsc_t;
+
+// Fila lock-free de vários produtores e um consumidor (algoritmo de Vyukov)
+// Inserir é um único atomic_exchange; só o consumidor mexe na cauda
+typedef struct {
+    _Alignas(LINHA_CACHE) _Atomic(no_mpsc_t *) cabeca; // Último inserido (produtores)
+    _Alignas(LINHA_CACHE) no_mpsc_t *cauda;            // Próximo a remover (consumidor)
+    no_mpsc_t sentinela;
+} fila_mpsc_t;
+
+
+void fila_mpsc_inicializar(fila_mpsc_t *fila);
+void fila_mpsc_inserir(fila_mpsc_t *fila, no_mpsc_t *no);
+no_mpsc_t *fila_mpsc_remover(fila_mpsc_t *fila);
+bool fila_mpsc_vazia(fila_mpsc_t *fila);
+
+#endif // FILA_MPSC_H
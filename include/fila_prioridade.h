@@ -6,24 +6,43 @@
 
 typedef struct no_fila {
     aeronave_t *aeronave;
+    double chave; // Chave de ordenação calculada pela política na inserção
     struct no_fila *proximo;
 } no_fila_t;
 
+typedef struct fila_prioridade fila_prioridade_t;
+
+// Política de escalonamento: define a ordem de atendimento da fila
+// Menor chave é atendida primeiro; empates são resolvidos por ordem de chegada
 typedef struct {
+    const char *nome;
+    double (*calcular_chave)(fila_prioridade_t *fila, aeronave_t *aeronave);
+    // Opcional: nova chave de quem já está na fila e mudou de prioridade (sem ela, calcular_chave)
+    double (*recalcular_chave)(fila_prioridade_t *fila, aeronave_t *aeronave, double chave, unsigned int prioridade_antiga);
+    void (*ao_atender)(fila_prioridade_t *fila, double chave); // Opcional
+    bool chave_temporal; // Chave em segundos do relógio: um checkpoint a grava relativa ao instante
+} politica_fila_t;
+
+struct fila_prioridade {
     no_fila_t *inicio;
     no_fila_t *fim;
     int tamanho;
-} fila_prioridade_t;
+    const politica_fila_t *politica;
+    double tempo_virtual; // Estado da política (ex.: relógio virtual do WFQ)
+};
 
 
 aeronave_t *fila_remover(fila_prioridade_t *fila);
 aeronave_t *fila_espiar(fila_prioridade_t *fila);
 void fila_inicializar(fila_prioridade_t *fila);
-void fila_inserir(fila_prioridade_t *fila, aeronave_t *aeronave);
+void fila_definir_politica(fila_prioridade_t *fila, const politica_fila_t *politica);
+double fila_inserir(fila_prioridade_t *fila, aeronave_t *aeronave);
+bool fila_anexar(fila_prioridade_t *fila, aeronave_t *aeronave, double chave);
 bool fila_vazio(fila_prioridade_t *fila);
 void fila_destruir(fila_prioridade_t *fila);
 void fila_imprimir(fila_prioridade_t *fila);
 void fila_rotacionar(fila_prioridade_t *fila);
 bool fila_remover_aeronave(fila_prioridade_t *fila, aeronave_t *aeronave);
+bool fila_reposicionar(fila_prioridade_t *fila, aeronave_t *aeronave, unsigned int prioridade_antiga, double *chave);
 
-#endif // FILA_PRIORIDADE_H
\ No newline at end of file
+#endif // FILA_PRIORIDADE_H
@@ -0,0 +1,28 @@
+#ifndef FROTA_H
+#define FROTA_H
+
+#include <stddef.h>
+#include "../include/aeronave.h"
+
+#define PILHA_PADRAO_KB 256
+
+// Frota inteira numa única arena: aeronaves contíguas e alinhadas, a vista por
+// id e as rotas compactas concatenadas (cada aeronave aponta para o seu trecho)
+typedef struct {
+    int tamanho;
+    void *arena;              // Única alocação da frota
+    size_t tamanho_arena;     // Bytes da arena
+    aeronave_t *aeronaves;    // Início da arena, alinhado à linha de cache
+    aeronave_t **ponteiros;   // Vista id -> aeronave (NULL se não iniciou)
+    void *rotas;              // Trechos de todas as rotas, aeronave_tamanho_trecho bytes cada
+    int threads_iniciadas;
+} frota_t;
+
+
+int frota_criar(frota_t *frota, int tamanho, int total_setores);
+int frota_iniciar_threads(frota_t *frota, size_t tamanho_pilha);
+void frota_aguardar(frota_t *frota, bool verboso);
+void frota_cancelar(frota_t *frota);
+void frota_destruir(frota_t *frota);
+
+#endif // FROTA_H
@@ -0,0 +1,32 @@
+#ifndef GRAFO_ESPERA_H
+#define GRAFO_ESPERA_H
+
+#include <stdbool.h>
+#include "../include/instantaneo.h"
+
+// Grafo de espera montado a partir de um instantaneo: cada aeronave em fila
+// aponta para o ocupante do setor que aguarda. Como cada aeronave espera no
+// máximo um setor, o grau de saída é no máximo 1 e toda componente fortemente
+// conexa não trivial é exatamente um ciclo
+typedef struct {
+    int capacidade;
+    int *proximo;    // Por aeronave: id de quem ela espera, -1 se nenhum
+    int *indice;     // Tarjan: ordem de descoberta (-1 = não visitada)
+    int *baixo;      // Tarjan: menor índice alcançável ainda na pilha
+    int *pilha;      // Tarjan: pilha de vértices da busca atual
+    int *chamada;    // Pilha de recursão explícita (threads têm pilha pequena)
+    bool *na_pilha;
+    bool *explorado; // A aresta de saída do vértice já foi seguida
+    void *bloco;     // Alocação única com todos os arrays
+} grafo_espera_t;
+
+// Recebe cada ciclo em ordem de espera: ciclo[k] espera por ciclo[k+1] (e o último pelo primeiro)
+typedef void (*ao_encontrar_ciclo_t)(const int *ciclo, int tamanho, void *contexto);
+
+
+bool grafo_espera_inicializar(grafo_espera_t *grafo, int capacidade);
+void grafo_espera_destruir(grafo_espera_t *grafo);
+void grafo_espera_montar(grafo_espera_t *grafo, const instantaneo_t *instantaneo);
+int grafo_espera_ciclos(grafo_espera_t *grafo, ao_encontrar_ciclo_t ao_encontrar, void *contexto);
+
+#endif // GRAFO_ESPERA_H
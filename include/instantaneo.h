@@ -0,0 +1,38 @@
+#ifndef INSTANTANEO_H
+#define INSTANTANEO_H
+
+#include <stdbool.h>
+
+// Cópia coerente da ocupação dos setores e das filas de espera, obtida sem
+// mutex_ctrl: o controlador mantém um espelho protegido por seqlock e o leitor
+// refaz a cópia se uma escrita acontecer no meio dela
+typedef struct {
+    unsigned long versao;      // Sequência do seqlock em que a cópia foi feita
+    int total_setores;
+    int total_aeronaves;
+    int *ocupante;             // Por setor: id do ocupante ou -1
+    int *inicio_fila;          // Por setor (+1): a fila de s é fila[inicio_fila[s] .. inicio_fila[s+1])
+    int *fila;                 // Ids em espera, fila a fila, na ordem de atendimento
+    unsigned int *prioridade;  // Por aeronave: prioridade efetiva
+    int tentativas;            // Cópias descartadas por escrita concorrente
+} instantaneo_t;
+
+
+bool instantaneo_inicializar(int setores, int aeronaves);
+void instantaneo_finalizar();
+
+// Escrita: só sob mutex_ctrl (um escritor por vez). As mudanças de uma seção
+// crítica saem juntas: a primeira abre a escrita e instantaneo_publicar, em
+// atc_destravar, a fecha
+void instantaneo_ocupante(int setor, int id);
+void instantaneo_repassar(int setor, int id);
+void instantaneo_enfileirar(int id, int setor, double chave);
+void instantaneo_desenfileirar(int id);
+void instantaneo_prioridade(int id, unsigned int prioridade);
+void instantaneo_publicar();
+
+// Leitura: qualquer thread, sem travas
+bool instantaneo_capturar(instantaneo_t *instantaneo);
+void instantaneo_liberar(instantaneo_t *instantaneo);
+
+#endif // INSTANTANEO_H
@@ -0,0 +1,33 @@
+#ifndef MEDICAO_H
+#define MEDICAO_H
+
+#include <stdbool.h>
+
+#define MEDICAO_FILA_PADRAO 2        // fila: segura com N ou mais aeronaves na fila do setor alvo
+#define MEDICAO_TAXA_PADRAO 0.8      // taxa: entradas por segundo simulado em cada setor (~1/voo médio)
+#define MEDICAO_RAJADA_PADRAO 2      // taxa: entradas seguidas admitidas sem espaçamento
+#define MEDICAO_INTERVALO_MS 50      // Entre consultas de quem está retido (ms simulados)
+
+// Medição de tráfego na frente de atc_solicitar_setor: antes de decolar, a
+// aeronave olha os dois primeiros setores da rota e fica retida em solo
+// enquanto algum estiver congestionado. Só em solo: retida em voo, ela
+// seguraria o setor atual fora de qualquer fila (a espera não aparece para o
+// detector e bloqueia quem vem atrás). Critérios:
+//  fila:N       profundidade da fila do setor (estimativa.h), sem travar
+//  taxa:R[:B]   balde de fichas por setor (GCRA: um instante teórico por setor,
+//               atualizado com CAS), R entradas por segundo simulado, rajada B
+typedef enum {
+    MEDICAO_DESLIGADA,
+    MEDICAO_FILA,
+    MEDICAO_TAXA
+} modo_medicao_t;
+
+
+bool medicao_definir(const char *texto);
+const char *medicao_nome();
+bool medicao_ativa();
+bool medicao_inicializar(int setores);
+void medicao_finalizar();
+long long medicao_admitir(int setor_primeiro, int setor_seguinte, long long agora_ns);
+
+#endif // MEDICAO_H
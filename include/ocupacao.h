@@ -0,0 +1,34 @@
+#ifndef OCUPACAO_H
+#define OCUPACAO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define OCUPACAO_PROFUNDIDADE_MAX UINT16_MAX // A profundidade satura aqui (só ordena setores)
+#define OCUPACAO_K_MAX 64                    // Maior k de ocupacao_menos_carregados
+
+// Índice de ocupação ao lado de setores_ocupados, para consultas do tipo
+// "algum setor livre?" sem varrer um int por setor: um bit por setor livre em
+// palavras de 64 bits, um resumo com um bit por palavra que tem algum livre
+// (pula 4096 setores ocupados por palavra lida) e a profundidade da fila de
+// cada setor em 16 bits. O controlador escreve sob mutex_ctrl (um escritor,
+// como o estimador); as consultas leem sem travas, 64 setores por popcount ou
+// ctz, e podem misturar setores de instantes um pouco diferentes
+bool ocupacao_inicializar(int setores);
+void ocupacao_finalizar();
+
+// Escrita: só sob mutex_ctrl
+void ocupacao_ocupar(int setor);
+void ocupacao_liberar(int setor);
+void ocupacao_enfileirar(int setor);
+void ocupacao_desenfileirar(int setor);
+
+// Leitura: qualquer thread, sem travas
+bool ocupacao_livre(int setor);
+int ocupacao_carga(int setor);
+int ocupacao_livres(int inicio, int fim);
+int ocupacao_primeiro_livre(int inicio, int fim);
+int ocupacao_primeiro_livre_de(const int *candidatos, int n);
+int ocupacao_menos_carregados(const int *candidatos, int n, int k, int *saida);
+
+#endif // OCUPACAO_H
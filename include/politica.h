@@ -0,0 +1,18 @@
+#ifndef POLITICA_H
+#define POLITICA_H
+
+#include "../include/fila_prioridade.h"
+
+extern const politica_fila_t politica_prioridade;
+extern const politica_fila_t politica_fifo;
+extern const politica_fila_t politica_edf;
+extern const politica_fila_t politica_wfq;
+extern const politica_fila_t politica_srrf;
+
+extern const politica_fila_t *const politicas_disponiveis[];
+extern const int total_politicas;
+
+
+const politica_fila_t *politica_buscar(const char *nome);
+
+#endif // POLITICA_H
@@ -0,0 +1,40 @@
+#ifndef REGIAO_H
+#define REGIAO_H
+
+#include "../include/simulacao.h"
+
+#define REGIOES_MAX 16
+
+// Resultado de uma região, escrito pelo processo da região na memória compartilhada
+typedef struct {
+    int status;              // 0 = sucesso
+    int setor_inicial;
+    int setor_final;         // Exclusivo
+    int transferencias;
+    int deadlocks;           // Detectados pelo controlador local
+    int recuos;
+    int pedidos_remotos;     // Pedidos de setor enviados para outras regiões
+    int sondas_enviadas;
+    int ciclos_inter_regioes;// Ciclos de espera entre regiões detectados e desfeitos
+    int amostras_espera;
+    double soma_espera;      // ms
+    double espera_p99;       // ms
+    double espera_max;       // ms
+    long long fim_ns;
+} regiao_resultado_t;
+
+typedef struct {
+    int total_regioes;
+    double tempo_total;      // s, da largada até a última região terminar
+    int transferencias;
+    double vazao;
+    double espera_media;     // ms
+    double espera_p99;       // ms, pior p99 entre as regiões
+    double espera_max;       // ms
+    regiao_resultado_t regioes[REGIOES_MAX];
+} regioes_resultado_t;
+
+
+int regioes_executar(const simulacao_config_t *config, int total_regioes, regioes_resultado_t *resultado);
+
+#endif // REGIAO_H
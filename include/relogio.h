@@ -0,0 +1,30 @@
+#ifndef RELOGIO_H
+#define RELOGIO_H
+
+#include <stddef.h>
+#include <time.h>
+
+// Relógio dos prazos das esperas bloqueantes (sem_clockwait e condições com
+// pthread_condattr_setclock): o kernel não espera em MONOTONIC_RAW nem no
+// TSC, e o CLOCK_REALTIME pula com ajustes do relógio de parede
+#define RELOGIO_ESPERA CLOCK_MONOTONIC
+
+// Tamanho do texto "[HH:MM:SS.uuuuuu] " com o terminador
+#define RELOGIO_TAMANHO_TIMESTAMP 20
+
+typedef enum {
+    RELOGIO_MONOTONICO_RAW, // clock_gettime(CLOCK_MONOTONIC_RAW): imune a ajustes do NTP
+    RELOGIO_TSC             // Contador de ciclos invariante, calibrado contra o relógio RAW
+} fonte_relogio_t;
+
+
+void relogio_inicializar();
+const char *relogio_nome_fonte();
+long long relogio_agora_ns();
+long long relogio_monotonico_raw_ns();
+double relogio_segundos_desde(long long inicio_ns);
+long long relogio_espera_ns();
+void relogio_prazo_espera(long long instante_ns, struct timespec *prazo);
+void relogio_formatar_timestamp(char *destino, size_t tamanho);
+
+#endif // RELOGIO_H
@@ -0,0 +1,35 @@
+#ifndef RESERVA_H
+#define RESERVA_H
+
+#include <stdbool.h>
+
+// Folga após cada janela (ms simulados): absorve o atraso de acordar das threads
+#define SEPARACAO_RESERVA_MS 50
+
+// Modo de reservas (trajetória 4D): cada setor guarda um calendário de janelas
+// de ocupação e a aeronave, ao decolar, reserva a rota inteira de uma vez. As
+// janelas de um mesmo setor nunca se sobrepõem, então em voo nenhum pedido ao
+// controlador encontra o setor ocupado e não há ciclos de espera. O preço é o
+// atraso em solo: a partida é a primeira em que todas as janelas cabem
+typedef struct {
+    long agendamentos;
+    long intervalos;                // Janelas reservadas em todos os setores
+    long conflitos;                 // Partidas adiadas por choque com alguma janela
+    long reservas_no_fim;           // Rotas sem encaixe, reservadas após o fim dos calendários
+    long long tempo_agendamento_ns; // Soma do tempo gasto em reserva_agendar
+    long long atraso_solo_ms;       // Soma de (partida - instante do pedido), ms simulados
+    long long atraso_solo_max_ms;
+    long long makespan_ms;          // Fim da última janela reservada, ms simulados desde a origem
+} reserva_estatisticas_t;
+
+
+bool reserva_inicializar(int setores);
+void reserva_finalizar();
+bool reserva_ativa();
+void reserva_definir_origem(long long origem_ns);
+long long reserva_agora_ms();
+long long reserva_agendar(const int *setores, const int *duracoes_ms, int trechos, long long minimo_ms);
+void reserva_dormir_ate(long long instante_ms);
+void reserva_obter_estatisticas(reserva_estatisticas_t *estatisticas);
+
+#endif // RESERVA_H
@@ -0,0 +1,85 @@
+#ifndef SIMULACAO_H
+#define SIMULACAO_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "../include/fila_prioridade.h"
+#include "../include/espera.h"
+#include "../include/verificador.h"
+#include "../include/chegadas.h"
+#include "../include/temporizador.h"
+
+typedef struct {
+    int num_setores;
+    int num_aeronaves;
+    const politica_fila_t *politica;
+    unsigned int semente; // Mesma semente => mesma frota, rotas e tempos de voo
+    size_t tamanho_pilha; // Pilha de cada thread de aeronave em bytes (0 = padrão do sistema)
+    int intervalo_monitor_ms; // Observador que imprime setores e filas a cada N ms (0 = desligado)
+    bool reservas;            // Cada aeronave reserva a rota inteira antes de decolar (reserva.h)
+    bool verificar;           // Confere as invariantes durante a execução (verificador.h)
+    const chegadas_config_t *chegadas; // Regime aberto (chegadas.h); NULL = frota inteira na largada
+    const char *checkpoint;   // Arquivo de checkpoint (checkpoint.h); NULL = desligado
+    int intervalo_checkpoint_s; // Checkpoint a cada N segundos de relógio (0 = só ao receber um sinal)
+    const char *restaurar;    // Retoma a execução gravada neste checkpoint; NULL = execução nova
+} simulacao_config_t;
+
+typedef struct {
+    double tempo_total;     // Segundos de relógio (já comprimidos pela escala)
+    int transferencias;     // Setores concedidos
+    double vazao;           // Concessões por segundo
+    double espera_media;    // Espera por concessão, em ms
+    double espera_p50;
+    double espera_p99;
+    double espera_max;
+    int deadlocks;
+    int recuos;
+    int boosts;
+    int aeronaves_concluidas;
+    double tempo_inicializacao; // ms para criar a frota e as threads, até a largada
+    double rss_por_aeronave;    // KB residentes por aeronave (frota + threads)
+    double tamanho_medio_lote;  // Pedidos por lote do controlador central (0 no modo com travas)
+    double secao_critica_media_ns; // Posse média de mutex_ctrl
+    double secao_critica_max_us;
+    long passadas_deteccao;     // Passadas do detector periódico (0 na detecção por pedido)
+    long saltos_perdidos;       // Setores devolvidos por recuos
+    double espera_perdida;      // Segundos de fila descartados por vítimas
+    int max_recuos_seguidos;    // Pior sequência de recuos de uma mesma aeronave
+    double makespan;            // Segundos da largada à última aeronave concluída
+    double makespan_previsto;   // Modo de reservas: fim da última janela, em segundos de relógio
+    double atraso_solo_medio;   // Modo de reservas: espera em solo até a partida, em ms
+    double atraso_solo_max;
+    double agendamento_medio_us; // Modo de reservas: custo de uma reserva de rota inteira
+    long conflitos_reserva;      // Modo de reservas: partidas adiadas por choque de janelas
+    long acessos_setor;          // Concessões medidas por nó (só com mais de um nó NUMA)
+    long acessos_remotos;        // ... feitas de um núcleo fora do nó dono do setor
+    int preempcoes;              // Setores tomados de ocupantes comuns por emergências (desalojo ou cessão)
+    long herancas;               // Prioridades elevadas por herança (com --heranca)
+    long estimativas;            // Esperas em fila com estimativa conferida (atc_estimar_espera)
+    double estimativa_erro_medio; // Erro absoluto médio, em ms
+    double estimativa_vies;      // Estimada - medida, em ms (negativo = otimista)
+    double espera_estimada_media; // ms
+    double espera_medida_media;  // ms, das mesmas esperas
+    double estimativas_na_faixa; // Fração entre metade e o dobro da espera medida
+    long retencoes;              // Decolagens retidas pela medição (medicao.h)
+    double retencao_media;       // ms em solo por retenção
+    temporizador_estatisticas_t sono; // Voos e pausas dormidos (temporizador.h)
+    long trocas_contexto;        // Voluntárias e involuntárias do processo durante o voo da frota
+    double vazao_sustentada;     // Regime aberto: concessões por segundo simulado na janela de medição
+    int checkpoints;             // Checkpoints gravados
+    double checkpoint_pausa_media_ms; // Frota segurada por checkpoint
+    double checkpoint_pausa_max_ms;
+    double checkpoint_escrita_media_ms;
+    long checkpoint_bytes;       // Tamanho do último checkpoint
+    double instante_restaurado;  // Segundos simulados já feitos no checkpoint restaurado
+    chegadas_estatisticas_t chegadas; // Regime aberto: chegadas e fila nas bordas da janela
+    espera_estatisticas_t espera; // Fases da espera e latência de repasse
+    verificador_estatisticas_t verificacao; // Violações encontradas (só com config->verificar)
+} simulacao_resultado_t;
+
+
+int simulacao_executar(const simulacao_config_t *config, simulacao_resultado_t *resultado);
+void simulacao_abortar();
+bool simulacao_pedir_checkpoint();
+
+#endif // SIMULACAO_H
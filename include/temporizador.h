@@ -0,0 +1,41 @@
+#ifndef TEMPORIZADOR_H
+#define TEMPORIZADOR_H
+
+#include <stdbool.h>
+
+#define TEMPORIZADOR_TOLERANCIA_PADRAO_US 250 // roda: duração do tick (atraso máximo além do escalonador)
+#define RODA_BITS 6                           // 64 posições por nível
+#define RODA_NIVEIS 4                         // Alcance de 2^24 ticks; prazos além disso descem em cascata
+
+// Como as aeronaves dormem o voo de cada trecho, a pausa depois de um
+// bloqueio por deadlock e a retenção da medição:
+//  nanosleep   cada thread arma o próprio temporizador no kernel (original)
+//  roda[:US]   roda de tempo hierárquica numa única thread: a aeronave
+//              registra o prazo e dorme num semáforo; a thread acorda uma vez
+//              por tick com prazos vencidos e solta todas as desse tick juntas.
+//              O prazo é arredondado para cima até o tick de US µs, então
+//              ninguém acorda antes e o atraso a mais fica abaixo de US
+typedef enum {
+    TEMPORIZADOR_NANOSLEEP,
+    TEMPORIZADOR_RODA
+} modo_temporizador_t;
+
+typedef struct {
+    long sonos;              // Esperas por tempo das aeronaves
+    long armados;            // Temporizadores armados no kernel (nanosleep ou esperas da thread da roda)
+    long lotes;              // Ticks que acordaram alguém (roda)
+    double por_lote;         // Aeronaves acordadas por lote
+    double atraso_medio_us;  // Despertar menos prazo
+    double atraso_max_us;
+} temporizador_estatisticas_t;
+
+
+bool temporizador_definir(const char *texto);
+const char *temporizador_nome();
+bool temporizador_inicializar();
+void temporizador_finalizar();
+void temporizador_dormir_ns(long long duracao_ns);
+void temporizador_dormir_ms(int ms);
+void temporizador_obter_estatisticas(temporizador_estatisticas_t *estatisticas);
+
+#endif // TEMPORIZADOR_H
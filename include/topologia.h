@@ -0,0 +1,37 @@
+#ifndef TOPOLOGIA_H
+#define TOPOLOGIA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <pthread.h>
+#include "../include/aeronave.h"
+
+#define TOPOLOGIA_NOS_MAX 64
+
+// Posicionamento das threads e do estado dos setores entre os nós NUMA. No
+// modo numa os setores são divididos em faixas contíguas, uma por nó; cada nó
+// inicializa a própria faixa (a primeira escrita decide em que nó a página
+// fica) e cada aeronave roda nos núcleos do nó dono da maior parte da rota.
+// Com um nó só (ou sem /sys/devices/system/node) nada é fixado: o modo numa
+// vira o livre. "numa:N" simula N nós repartindo os núcleos, para exercitar
+// o caminho em máquinas de um soquete
+typedef enum {
+    POSICIONAMENTO_LIVRE, // O escalonador decide onde cada thread roda (original)
+    POSICIONAMENTO_NUMA   // Setores particionados por nó e aeronaves fixadas no nó da rota
+} posicionamento_t;
+
+
+bool topologia_definir_posicionamento(const char *nome);
+const char *topologia_nome_posicionamento();
+int topologia_nos();
+bool topologia_ativa();
+int topologia_no_do_setor(int setor, int total_setores);
+void topologia_faixa_do_no(int no, int total_setores, int *inicio, int *fim);
+int topologia_no_da_rota(const aeronave_t *aeronave, int total_setores);
+int topologia_no_atual();
+bool topologia_fixar_no(pthread_attr_t *atributos, int no);
+void topologia_em_cada_no(void (*funcao)(int no, void *contexto), void *contexto);
+void *topologia_alocar(size_t tamanho);
+void topologia_liberar(void *memoria, size_t tamanho);
+
+#endif // TOPOLOGIA_H
@@ -3,18 +3,27 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdbool.h>
 #include <time.h>
 #include <unistd.h>
 
 #define TEMPO_BASE 1000000
 #define PRIORIDADE_MAX 1000
+#define LINHA_CACHE 64
 
 typedef struct aeronave_t aeronave_t;
 
+extern bool modo_silencioso; // Suprime o log de eventos (benchmarks)
+extern int escala_tempo;     // Divisor aplicado aos tempos simulados (1 = tempo real)
+
 
 int* gerar_rota_aleatoria(int comprimento, int total_setores);
 double calcular_tempo_medio(aeronave_t **aeronaves, int total_aeronaves);  
 void imprimir_timestamp();
 int gerar_comprimento_rota(int total_setores);
+void log_evento(const char *formato, ...);
+void dormir_ms(int ms);
+double percentil(double *valores, int n, double p);
+long memoria_rss_kb();
 
-#endif // UTILS_H
\ No newline at end of file
+#endif // UTILS_H
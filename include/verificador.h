@@ -0,0 +1,39 @@
+#ifndef VERIFICADOR_H
+#define VERIFICADOR_H
+
+#include <stdbool.h>
+
+// Sem progresso por mais que isto (ms de relógio, não simulados) com o setor
+// livre ou já concedido, a aeronave parada perdeu o despertar
+#define VERIFICADOR_LIMITE_PERDA_MS 5000
+#define VERIFICADOR_PERIODO_MS 20 // Entre passadas do vigia de despertares
+
+// Verificador de invariantes para os testes de estresse. Mantém uma cópia
+// atômica própria do dono de cada setor, atualizada com CAS nas concessões e
+// liberações: um setor concedido com outro dono, ou devolvido por quem não o
+// ocupa, é uma violação. As aeronaves conferem em voo que ainda são donas do
+// setor, e um vigia procura aeronaves paradas no semáforo cujo setor já está
+// livre ou já é delas (despertar perdido). Desligado, cada gancho custa um
+// teste de ponteiro
+typedef struct {
+    long concessoes;              // Concessões conferidas
+    long violacoes_ocupacao;      // Setor concedido a uma aeronave com outra dentro
+    long liberacoes_invalidas;    // Setor devolvido por quem não era o dono
+    long setores_perdidos;        // Aeronave em voo que deixou de ser a dona do próprio setor
+    long estacionamentos;         // Esperas no semáforo acompanhadas pelo vigia
+    long long parada_max_ns;      // Maior espera no semáforo vista pelo vigia
+    char primeira_violacao[160];  // Descrição da primeira violação ("" se nenhuma)
+} verificador_estatisticas_t;
+
+
+bool verificador_inicializar(int setores, int aeronaves);
+void verificador_finalizar();
+bool verificador_ativo();
+void verificador_ocupar(int setor, int id);
+void verificador_desocupar(int setor, int id);
+void verificador_confirmar(int setor, int id);
+void verificador_estacionar(int id, int setor);
+void verificador_despertar(int id);
+void verificador_obter_estatisticas(verificador_estatisticas_t *estatisticas);
+
+#endif // VERIFICADOR_H
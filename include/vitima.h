@@ -0,0 +1,33 @@
+#ifndef VITIMA_H
+#define VITIMA_H
+
+#include <stdbool.h>
+#include "../include/aeronave.h"
+
+// Escolha da vítima de um deadlock: cada aeronave do ciclo recebe um custo de
+// recuo (quanto se perde ao fazê-la recuar) e recua a de menor custo
+// custo = peso_prioridade * prioridade efetiva / PRIORIDADE_MAX
+//       + peso_progresso  * fração da rota já percorrida
+//       + peso_espera     * espera do pedido atual / ESPERA_REFERENCIA_S (tempo simulado)
+//       + peso_recuos     * recuos seguidos / RECUOS_REFERENCIA
+typedef struct {
+    const char *nome;
+    double peso_prioridade;
+    double peso_progresso;
+    double peso_espera;
+    double peso_recuos;
+} politica_vitima_t;
+
+extern const politica_vitima_t vitima_prioridade;
+extern const politica_vitima_t vitima_progresso;
+extern const politica_vitima_t vitima_custo;
+
+extern const politica_vitima_t *const vitimas_disponiveis[];
+extern const int total_vitimas;
+
+
+bool vitima_definir(const char *nome);
+const char *vitima_nome();
+double vitima_calcular_custo(const aeronave_t *aeronave, unsigned int prioridade, long long agora_ns);
+
+#endif // VITIMA_H
@@ -3,46 +3,159 @@
 #include <time.h>
 #include <signal.h>
 #include <unistd.h>
+#include <string.h>
 #include "include/controlador.h"
 #include "include/aeronave.h"
 #include "include/utils.h"
+#include "include/politica.h"
+#include "include/simulacao.h"
+#include "include/benchmark.h"
+#include "include/frota.h"
+#include "include/desempenho.h"
+#include "include/espera.h"
+#include "include/regiao.h"
+#include "include/relogio.h"
+#include "include/vitima.h"
+#include "include/topologia.h"
+#include "include/chegadas.h"
+#include "include/checkpoint.h"
+#include "include/medicao.h"
+#include "include/temporizador.h"
 
 extern aeronave_t **Aeronaves;
 void trata_sinal(int sinal) {
     printf("\n\n[SISTEMA] Recebido sinal %d - Finalizando graciosamente...\n", sinal);
+
+    // Com checkpoints ligados, a thread de checkpoint grava o último e encerra
+    if (simulacao_pedir_checkpoint()) return;
     
-    // Para threads de aeronaves
-    for (int i = 0; i < total_aeronaves && aeronaves != NULL; i++) {
-        if (aeronaves[i] != NULL) {
-            pthread_cancel(aeronaves[i]->thread);
-        }
-    }
-    
-    // Finaliza sistema ATC
-    atc_finalizar();
-    
-    // Libera memória das aeronaves
-    if (aeronaves != NULL) {
-        for (int i = 0; i < total_aeronaves; i++) {
-            if (aeronaves[i] != NULL) {
-                aeronave_destruir(aeronaves[i]);
-            }
-        }
-        free(aeronaves);
-    }
+    // Para threads de aeronaves, finaliza sistema ATC e libera a frota
+    simulacao_abortar();
     
     printf("[SISTEMA] Finalizado com sucesso.\n");
     exit(0);
 }
 
+/**
+ * Executa o modo multi-processo e imprime o relatório por região
+ * @param config: Parâmetros da execução
+ * @param regioes: Número de regiões (processos)
+ * @return Código de saída do programa
+ */
+static int executar_regioes(const simulacao_config_t *config, int regioes) {
+    // Os processos das regiões herdam os tratadores; o encerramento por sinal
+    // do modo multi-processo é o padrão do sistema
+    signal(SIGINT, SIG_DFL);
+    signal(SIGTERM, SIG_DFL);
+
+    printf("[MAIN] Espaço aéreo dividido em %d regiões (%d setores, %d aeronaves, semente %u)\n",
+           regioes, config->num_setores, config->num_aeronaves, config->semente);
+
+    regioes_resultado_t resultado;
+    if (regioes_executar(config, regioes, &resultado) != 0) {
+        printf("[MAIN] Falha na execução multi-processo\n");
+        return 1;
+    }
+
+    printf("\n%-7s %-11s %10s %10s %10s %9s %9s %8s %8s\n", "regiao", "setores", "concedidos",
+           "p99(ms)", "remotos", "deadlocks", "recuos", "sondas", "ciclos");
+    for (int r = 0; r < resultado.total_regioes; r++) {
+        regiao_resultado_t *rr = &resultado.regioes[r];
+        char faixa[32];
+        snprintf(faixa, sizeof(faixa), "S%d-S%d", rr->setor_inicial, rr->setor_final - 1);
+        printf("R%-6d %-11s %10d %10.2f %10d %9d %9d %8d %8d\n", r, faixa, rr->transferencias,
+               rr->espera_p99, rr->pedidos_remotos, rr->deadlocks, rr->recuos,
+               rr->sondas_enviadas, rr->ciclos_inter_regioes);
+    }
+    printf("\nTempo total: %.2f s | Vazão: %.1f setores concedidos/s\n",
+           resultado.tempo_total, resultado.vazao);
+    printf("Espera por concessão: média %.2f ms | p99 (pior região) %.2f ms | máx %.2f ms\n",
+           resultado.espera_media, resultado.espera_p99, resultado.espera_max);
+    return 0;
+}
+
+/**
+ * Imprime a forma de uso do programa e as opções disponíveis
+ * @param programa: Nome do executável (argv[0])
+ */
+static void imprimir_uso(const char *programa) {
+    printf("Uso: %s [NUM_SETORES] [NUM_AERONAVES] [opções]\n", programa);
+    printf("Exemplo: %s 5 8\n", programa);
+    printf("Opções:\n");
+    printf("  --politica=NOME   prioridade (padrão), fifo, edf, wfq, srrf\n");
+    printf("  --semente=N       semente da carga (padrão: time(NULL))\n");
+    printf("  --escala=N        comprime o tempo simulado N vezes (padrão: 1)\n");
+    printf("  --espera=MODO     adaptativa (padrão: gira, cede a CPU, dorme) ou bloqueante\n");
+    printf("  --silencioso      não imprime os eventos da simulação\n");
+    printf("  --pilha=KB        pilha de cada thread de aeronave (padrão: %d, 0 = padrão do sistema)\n",
+           PILHA_PADRAO_KB);
+    printf("  --deteccao=M      pedido (padrão: a cada pedido contestado) ou periodica[:MS] (detector em segundo plano)\n");
+    printf("  --vitima=NOME     quem recua num deadlock: prioridade (padrão), progresso, custo ou pesos:P,R,E,C\n");
+    printf("  --reservas        cada aeronave reserva janelas na rota inteira antes de decolar (sem disputa em voo)\n");
+    printf("  --posicionamento=M livre (padrão) ou numa[:N]: setores por nó NUMA e aeronaves fixadas no nó da rota\n");
+    printf("                    (N simula N nós repartindo os núcleos; com um nó só, numa equivale a livre)\n");
+    printf("  --chegadas=P:TAXA regime aberto: aeronaves chegam por P (poisson ou constante) a TAXA por segundo\n");
+    printf("                    simulado; NUM_AERONAVES é ignorado (a frota é quem chega)\n");
+    printf("  --duracao=S       segundos simulados com chegadas (padrão: %d)\n", CHEGADAS_DURACAO_PADRAO_S);
+    printf("  --aquecimento=S   segundos simulados iniciais fora da medição (padrão: %d)\n",
+           CHEGADAS_AQUECIMENTO_PADRAO_S);
+    printf("  --emergencias=PCT PCT%% da frota em emergência: corredor próprio em cada setor e preempção\n");
+    printf("                    do ocupante comum parado em fila (em voo, ele sai no fim do trecho)\n");
+    printf("  --medicao=M       retém em solo quem decolaria para setores congestionados: fila[:N] (N ou mais na fila,\n");
+    printf("                    padrão %d) ou taxa[:R[:B]] (R entradas/s por setor, rajada B; padrão %.1f:%d)\n",
+           MEDICAO_FILA_PADRAO, MEDICAO_TAXA_PADRAO, MEDICAO_RAJADA_PADRAO);
+    printf("  --temporizador=M  nanosleep (padrão: cada aeronave no kernel) ou roda[:US] (uma thread com roda\n");
+    printf("                    de tempo, tolerância de US µs; padrão %d)\n", TEMPORIZADOR_TOLERANCIA_PADRAO_US);
+    printf("  --heranca         quem ocupa um setor herda a maior prioridade de quem o espera (transitivo\n");
+    printf("                    pela cadeia de espera); vítimas e boosts seguem a prioridade própria\n");
+    printf("  --contadores-hw   ciclos, instruções, falhas de cache e de desvio e trocas de contexto por fase\n");
+    printf("                    do controlador (perf_event_open), em tabela no fim; eventos indisponíveis\n");
+    printf("                    ficam como n/d (sem efeito se compilado com SEM_CONTADORES_HW=1)\n");
+    printf("  --checkpoint=ARQ[:S] grava a execução em ARQ a cada S segundos (e ao receber Ctrl+C ou SIGTERM)\n");
+    printf("  --restaurar=ARQ   retoma a execução gravada em ARQ (setores, frota, semente, escala e política\n");
+    printf("                    vêm do arquivo)\n");
+    printf("  --monitor=MS      imprime setores e filas a cada MS ms sem travar o controlador\n");
+    printf("  --controlador=M   travas (padrão: cada aeronave sob o mutex) ou central (thread servidora em lotes)\n");
+    printf("  --benchmark       roda a mesma carga com todas as políticas (escala padrão: 100)\n");
+    printf("  --benchmark=controlador  compara os controladores travas e central na mesma carga\n");
+    printf("  --benchmark=deteccao     compara a detecção por pedido com a periódica\n");
+    printf("  --benchmark=vitima       compara as escolhas de vítima pelo trabalho perdido nos recuos\n");
+    printf("  --benchmark=reservas     compara o makespan das reservas com o controlador reativo\n");
+    printf("  --benchmark=memoria      cria a frota sem threads e mede a memória por aeronave\n");
+    printf("  --benchmark=numa         compara threads livres com o posicionamento numa\n");
+    printf("  --benchmark=chegadas     varre taxas de chegada (fração de TAXA ou da capacidade estimada)\n");
+    printf("                           e imprime a curva vazão sustentada x latência\n");
+    printf("  --benchmark=emergencia   compara as emergências sem e com o corredor (p99.9 e preempções)\n");
+    printf("  --benchmark=medicao      compara a execução sem medição com os critérios fila e taxa\n");
+    printf("  --benchmark=temporizador compara nanosleep com a roda de tempo (temporizadores, trocas de contexto, atraso)\n");
+    printf("  --benchmark=heranca      compara a espera das prioridades altas sem e com herança de prioridade\n");
+    printf("  --benchmark=estresse     confere as invariantes em todos os controladores e compara a vazão\n");
+    printf("                           com a linha de base (falha em violação ou queda de vazão)\n");
+    printf("  --linha-base=ARQ  vazões de referência do estresse (padrão: %s; sem a base, falha)\n",
+           LINHA_BASE_PADRAO);
+    printf("  --gravar-linha-base  grava a vazão medida no estresse como a nova base em vez de comparar\n");
+    printf("Também: %s --benchmark=relogio (custo por chamada das leituras de tempo)\n", programa);
+    printf("        %s --benchmark=micro (ns por operação da fila, da detecção e do par pedir/deixar, em CSV)\n",
+           programa);
+    printf("  --regioes=R       divide os setores em R regiões, cada uma num processo (1-%d)\n",
+           REGIOES_MAX);
+}
+
 int main(int argc, char *argv[]) {
     signal(SIGINT, trata_sinal);
     signal(SIGTERM, trata_sinal);
+    relogio_inicializar();
+
+    if (argc >= 2 && strcmp(argv[1], "--benchmark=relogio") == 0) {
+        return benchmark_relogio();
+    }
+    if (argc >= 2 && strcmp(argv[1], "--benchmark=micro") == 0) {
+        return benchmark_micro() == 0 ? 0 : 1;
+    }
     
     // Verificar argumentos
-    if (argc != 3) {
-        printf("Uso: %s [NUM_SETORES] [NUM_AERONAVES]\n", argv[0]);
-        printf("Exemplo: %s 5 8\n", argv[0]);
+    if (argc < 3) {
+        imprimir_uso(argv[0]);
         return 1;
     }
     
@@ -57,68 +170,423 @@ int main(int argc, char *argv[]) {
         printf("Aviso: Mínimo de 2 setores. Ajustando para 2...\n");
         num_setores = 2;
     }
-    
-    srand(time(NULL));
+
+    simulacao_config_t config = {
+        .num_setores = num_setores,
+        .num_aeronaves = num_aeronaves,
+        .politica = &politica_prioridade,
+        .semente = (unsigned int)time(NULL),
+        .tamanho_pilha = (size_t)PILHA_PADRAO_KB * 1024,
+    };
+    bool modo_benchmark = false;
+    bool benchmark_controlador = false;
+    bool benchmark_detector = false;
+    bool benchmark_vitima = false;
+    bool benchmark_reserva = false;
+    bool benchmark_memoria_frota = false;
+    bool benchmark_estresse_verificado = false;
+    bool benchmark_medicao_trafego = false;
+    bool benchmark_sono = false;
+    bool benchmark_prioridade_herdada = false;
+    bool benchmark_posicionamento = false;
+    bool benchmark_regime_aberto = false;
+    bool benchmark_emergencia = false;
+    bool regime_aberto = false;
+    chegadas_config_t chegadas = {
+        .processo = CHEGADAS_POISSON,
+        .duracao = CHEGADAS_DURACAO_PADRAO_S,
+        .aquecimento = CHEGADAS_AQUECIMENTO_PADRAO_S,
+    };
+    const char *arquivo_linha_base = LINHA_BASE_PADRAO;
+    bool gravar_linha_base = false;
+    int escala = 0;
+    int regioes = 0;
+
+    for (int i = 3; i < argc; i++) {
+        if (strncmp(argv[i], "--politica=", 11) == 0) {
+            config.politica = politica_buscar(argv[i] + 11);
+            if (config.politica == NULL) {
+                printf("Erro: política desconhecida '%s'\n", argv[i] + 11);
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--semente=", 10) == 0) {
+            config.semente = (unsigned int)strtoul(argv[i] + 10, NULL, 10);
+        } else if (strncmp(argv[i], "--escala=", 9) == 0) {
+            escala = atoi(argv[i] + 9);
+            if (escala <= 0) {
+                printf("Erro: a escala de tempo deve ser positiva!\n");
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--pilha=", 8) == 0) {
+            int pilha_kb = atoi(argv[i] + 8);
+            if (pilha_kb < 0) {
+                printf("Erro: o tamanho de pilha não pode ser negativo!\n");
+                return 1;
+            }
+            config.tamanho_pilha = (size_t)pilha_kb * 1024;
+        } else if (strncmp(argv[i], "--espera=", 9) == 0) {
+            if (!espera_definir_modo(argv[i] + 9)) {
+                printf("Erro: modo de espera desconhecido '%s'\n", argv[i] + 9);
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--controlador=", 14) == 0) {
+            if (!atc_definir_modo(argv[i] + 14)) {
+                printf("Erro: controlador desconhecido '%s'\n", argv[i] + 14);
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--regioes=", 10) == 0) {
+            regioes = atoi(argv[i] + 10);
+            if (regioes < 1 || regioes > REGIOES_MAX || regioes > num_setores) {
+                printf("Erro: o número de regiões deve estar entre 1 e %d e não passar dos setores!\n",
+                       REGIOES_MAX);
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--deteccao=", 11) == 0) {
+            if (!atc_definir_deteccao(argv[i] + 11)) {
+                printf("Erro: modo de detecção desconhecido '%s'\n", argv[i] + 11);
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--medicao=", 10) == 0) {
+            if (!medicao_definir(argv[i] + 10)) {
+                printf("Erro: medição desconhecida '%s'\n", argv[i] + 10);
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--temporizador=", 15) == 0) {
+            if (!temporizador_definir(argv[i] + 15)) {
+                printf("Erro: temporizador desconhecido '%s'\n", argv[i] + 15);
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--vitima=", 9) == 0) {
+            if (!vitima_definir(argv[i] + 9)) {
+                printf("Erro: escolha de vítima desconhecida '%s'\n", argv[i] + 9);
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--monitor=", 10) == 0) {
+            config.intervalo_monitor_ms = atoi(argv[i] + 10);
+            if (config.intervalo_monitor_ms <= 0) {
+                printf("Erro: o intervalo do monitor deve ser positivo!\n");
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--posicionamento=", 17) == 0) {
+            if (!topologia_definir_posicionamento(argv[i] + 17)) {
+                printf("Erro: posicionamento desconhecido '%s'\n", argv[i] + 17);
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--chegadas=", 11) == 0) {
+            if (!chegadas_interpretar(argv[i] + 11, &chegadas)) {
+                printf("Erro: chegadas inválidas '%s' (use poisson:TAXA ou constante:TAXA)\n", argv[i] + 11);
+                return 1;
+            }
+            regime_aberto = true;
+        } else if (strncmp(argv[i], "--duracao=", 10) == 0) {
+            chegadas.duracao = atof(argv[i] + 10);
+            if (!(chegadas.duracao > 0)) {
+                printf("Erro: a duração deve ser positiva!\n");
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--aquecimento=", 14) == 0) {
+            chegadas.aquecimento = atof(argv[i] + 14);
+            if (chegadas.aquecimento < 0) {
+                printf("Erro: o aquecimento não pode ser negativo!\n");
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--emergencias=", 14) == 0) {
+            if (!atc_definir_emergencias(atof(argv[i] + 14) / 100.0)) {
+                printf("Erro: a porcentagem de emergências deve estar entre 0 e 100!\n");
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--checkpoint=", 13) == 0) {
+            // ARQ[:S]; o último ':' separa o intervalo do caminho
+            static char caminho_checkpoint[4096];
+            snprintf(caminho_checkpoint, sizeof(caminho_checkpoint), "%s", argv[i] + 13);
+            char *separador = strrchr(caminho_checkpoint, ':');
+            if (separador != NULL) {
+                char *fim;
+                config.intervalo_checkpoint_s = (int)strtol(separador + 1, &fim, 10);
+                if (*fim != '\0' || config.intervalo_checkpoint_s <= 0) {
+                    printf("Erro: o intervalo de checkpoint deve ser um número positivo de segundos!\n");
+                    return 1;
+                }
+                *separador = '\0';
+            }
+            if (caminho_checkpoint[0] == '\0') {
+                printf("Erro: --checkpoint precisa de um arquivo\n");
+                return 1;
+            }
+            config.checkpoint = caminho_checkpoint;
+        } else if (strncmp(argv[i], "--restaurar=", 12) == 0) {
+            config.restaurar = argv[i] + 12;
+        } else if (strcmp(argv[i], "--heranca") == 0) {
+            atc_definir_heranca(true);
+        } else if (strcmp(argv[i], "--contadores-hw") == 0) {
+            if (!desempenho_ligar(true)) {
+                printf("Erro: contadores de hardware não compilados (SEM_CONTADORES_HW ou fora do Linux)\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--reservas") == 0) {
+            config.reservas = true;
+        } else if (strcmp(argv[i], "--silencioso") == 0) {
+            modo_silencioso = true;
+        } else if (strcmp(argv[i], "--benchmark") == 0) {
+            modo_benchmark = true;
+        } else if (strcmp(argv[i], "--benchmark=controlador") == 0) {
+            modo_benchmark = true;
+            benchmark_controlador = true;
+        } else if (strcmp(argv[i], "--benchmark=deteccao") == 0) {
+            modo_benchmark = true;
+            benchmark_detector = true;
+        } else if (strcmp(argv[i], "--benchmark=vitima") == 0) {
+            modo_benchmark = true;
+            benchmark_vitima = true;
+        } else if (strcmp(argv[i], "--benchmark=reservas") == 0) {
+            modo_benchmark = true;
+            benchmark_reserva = true;
+        } else if (strcmp(argv[i], "--benchmark=memoria") == 0) {
+            modo_benchmark = true;
+            benchmark_memoria_frota = true;
+        } else if (strcmp(argv[i], "--benchmark=numa") == 0) {
+            modo_benchmark = true;
+            benchmark_posicionamento = true;
+        } else if (strcmp(argv[i], "--benchmark=chegadas") == 0) {
+            modo_benchmark = true;
+            benchmark_regime_aberto = true;
+        } else if (strcmp(argv[i], "--benchmark=emergencia") == 0) {
+            modo_benchmark = true;
+            benchmark_emergencia = true;
+        } else if (strcmp(argv[i], "--benchmark=medicao") == 0) {
+            modo_benchmark = true;
+            benchmark_medicao_trafego = true;
+        } else if (strcmp(argv[i], "--benchmark=temporizador") == 0) {
+            modo_benchmark = true;
+            benchmark_sono = true;
+        } else if (strcmp(argv[i], "--benchmark=heranca") == 0) {
+            modo_benchmark = true;
+            benchmark_prioridade_herdada = true;
+        } else if (strcmp(argv[i], "--benchmark=estresse") == 0) {
+            modo_benchmark = true;
+            benchmark_estresse_verificado = true;
+        } else if (strncmp(argv[i], "--linha-base=", 13) == 0) {
+            arquivo_linha_base = argv[i] + 13;
+        } else if (strcmp(argv[i], "--gravar-linha-base") == 0) {
+            gravar_linha_base = true;
+        } else {
+            printf("Erro: opção desconhecida '%s'\n", argv[i]);
+            imprimir_uso(argv[0]);
+            return 1;
+        }
+    }
+
+    if (chegadas.aquecimento >= chegadas.duracao) {
+        printf("Erro: o aquecimento (%.1f s) deve terminar antes da duração (%.1f s)!\n",
+               chegadas.aquecimento, chegadas.duracao);
+        return 1;
+    }
+    if (regime_aberto && chegadas.taxa <= 0 && !benchmark_regime_aberto) {
+        printf("Erro: o regime aberto precisa de uma taxa (--chegadas=%s:TAXA)\n",
+               chegadas_nome_processo(chegadas.processo));
+        return 1;
+    }
+    if (regime_aberto) config.chegadas = &chegadas;
+
+    if (medicao_ativa() && config.reservas) {
+        printf("Erro: --medicao não é suportado com --reservas (a rota já é agendada em solo)\n");
+        return 1;
+    }
+
+    if (config.checkpoint != NULL || config.restaurar != NULL) {
+        const char *conflito = modo_benchmark ? "--benchmark" : regioes > 0 ? "--regioes" :
+                               regime_aberto ? "--chegadas" : config.reservas ? "--reservas" : NULL;
+        if (conflito != NULL) {
+            printf("Erro: checkpoints não são suportados com %s\n", conflito);
+            return 1;
+        }
+    }
+    if (config.restaurar != NULL) {
+        // A frota é recriada pela semente do arquivo: a configuração vem dele
+        checkpoint_cabecalho_t cabecalho;
+        if (!checkpoint_ler_cabecalho(config.restaurar, &cabecalho)) return 1;
+        config.politica = politica_buscar(cabecalho.politica);
+        if (config.politica == NULL || !atc_definir_emergencias(cabecalho.fracao_emergencias)) {
+            printf("Erro: checkpoint com política '%s' ou emergências desconhecidas\n", cabecalho.politica);
+            return 1;
+        }
+        num_setores = config.num_setores = cabecalho.setores;
+        num_aeronaves = config.num_aeronaves = cabecalho.aeronaves;
+        config.semente = cabecalho.semente;
+        if (escala == 0) escala = cabecalho.escala;
+    }
+
+    if (modo_benchmark) {
+        escala_tempo = escala > 0 ? escala : 100;
+        int status;
+        if (benchmark_controlador) {
+            status = benchmark_controladores(&config);
+        } else if (benchmark_detector) {
+            status = benchmark_deteccao(&config);
+        } else if (benchmark_vitima) {
+            status = benchmark_vitimas(&config);
+        } else if (benchmark_reserva) {
+            status = benchmark_reservas(&config);
+        } else if (benchmark_memoria_frota) {
+            status = benchmark_memoria(&config);
+        } else if (benchmark_posicionamento) {
+            status = benchmark_numa(&config);
+        } else if (benchmark_regime_aberto) {
+            status = benchmark_chegadas(&config);
+        } else if (benchmark_emergencia) {
+            status = benchmark_emergencias(&config);
+        } else if (benchmark_medicao_trafego) {
+            status = benchmark_medicao(&config);
+        } else if (benchmark_sono) {
+            status = benchmark_temporizador(&config);
+        } else if (benchmark_prioridade_herdada) {
+            status = benchmark_heranca(&config);
+        } else if (benchmark_estresse_verificado) {
+            status = benchmark_estresse(&config, arquivo_linha_base, gravar_linha_base);
+        } else {
+            status = benchmark_politicas(&config);
+        }
+        return status == 0 ? 0 : 1;
+    }
+    escala_tempo = escala > 0 ? escala : 1;
+
+    if (regioes > 0) {
+        if (config.reservas) {
+            printf("Erro: --reservas não é suportado com --regioes (o calendário é único)\n");
+            return 1;
+        }
+        if (regime_aberto) {
+            printf("Erro: --chegadas não é suportado com --regioes\n");
+            return 1;
+        }
+        if (atc_fracao_emergencias() > 0) {
+            printf("Erro: --emergencias não é suportado com --regioes\n");
+            return 1;
+        }
+        if (medicao_ativa()) {
+            printf("Erro: --medicao não é suportado com --regioes\n");
+            return 1;
+        }
+        if (desempenho_ligado()) {
+            printf("Erro: --contadores-hw não é suportado com --regioes\n");
+            return 1;
+        }
+        return executar_regioes(&config, regioes);
+    }
     
     printf("\n");
     printf("===============================================\n");
     printf("  SIMULADOR DE CONTROLE DE TRÁFEGO AÉREO (ATC)\n");
     printf("===============================================\n");
-    printf("Setores: %d | Aeronaves: %d\n", num_setores, num_aeronaves);
+    if (regime_aberto) {
+        printf("Setores: %d | Chegadas: %s a %.3f aeronaves/s por %.0f s (medição após %.0f s)\n",
+               num_setores, chegadas_nome_processo(chegadas.processo), chegadas.taxa,
+               chegadas.duracao, chegadas.aquecimento);
+    } else {
+        printf("Setores: %d | Aeronaves: %d\n", num_setores, num_aeronaves);
+    }
     printf("Prioridade: 1-%d (maior = mais prioritário)\n", PRIORIDADE_MAX);
-    printf("Pressione Ctrl+C para encerrar\n");
-    printf("===============================================\n\n");
-    
-    printf("[MAIN] Inicializando sistema ATC...\n");
-    atc_init(num_setores, num_aeronaves);
-    aeronaves = malloc(num_aeronaves * sizeof(aeronave_t*));
-    if (aeronaves == NULL) {
-        perror("Erro ao alocar array de aeronaves");
-        atc_finalizar();
-        return 1;
+    printf("Política de escalonamento: %s | Semente: %u\n", config.politica->nome, config.semente);
+    printf("Controlador: %s | Detecção de deadlock: %s | Vítimas: %s%s%s\n",
+           atc_nome_modo(), atc_nome_deteccao(), vitima_nome(),
+           config.reservas ? " | Reservas de rota" : "",
+           atc_heranca_ligada() ? " | Herança de prioridade" : "");
+    if (topologia_ativa()) {
+        printf("Posicionamento: %s (%d nós)\n", topologia_nome_posicionamento(), topologia_nos());
     }
-    
-    for (int i = 0; i < num_aeronaves; i++) {
-        aeronaves[i] = NULL;
-    }
-    printf("[MAIN] Criando %d aeronaves...\n", num_aeronaves);
-    for (int i = 0; i < num_aeronaves; i++) {
-        aeronaves[i] = aeronave_criar(i, num_setores);
-        if (aeronaves[i] == NULL) {
-            fprintf(stderr, "Erro ao criar aeronave %d\n", i);
-            trata_sinal(SIGTERM);
-            return 1;
-        }
+    if (atc_fracao_emergencias() > 0) {
+        printf("Emergências: %.1f%% da frota, com corredor e preempção\n", 100.0 * atc_fracao_emergencias());
     }
-    
-    printf("[MAIN] Iniciando voos...\n");
-    for (int i = 0; i < num_aeronaves; i++) {
-        if (pthread_create(&aeronaves[i]->thread, NULL, aeronave_executa, aeronaves[i]) != 0) {
-            perror("Erro ao criar thread da aeronave");
-            aeronave_destruir(aeronaves[i]);
-            aeronaves[i] = NULL;
+    if (medicao_ativa()) printf("Medição: %s\n", medicao_nome());
+    printf("Temporizador: %s\n", temporizador_nome());
+    if (config.restaurar != NULL) printf("Retomando: %s\n", config.restaurar);
+    if (config.checkpoint != NULL) {
+        if (config.intervalo_checkpoint_s > 0) {
+            printf("Checkpoint: %s a cada %d s e no Ctrl+C\n", config.checkpoint, config.intervalo_checkpoint_s);
+        } else {
+            printf("Checkpoint: %s no Ctrl+C\n", config.checkpoint);
         }
     }
+    printf("Pressione Ctrl+C para encerrar\n");
+    printf("===============================================\n\n");
     
-    printf("\n[MAIN] Todas as aeronaves iniciadas. Sistema operacional.\n");
-    printf("[MAIN] Aguardando conclusão das rotas...\n\n");
-    
-    for (int i = 0; i < num_aeronaves; i++) {
-        if (aeronaves[i] != NULL) {
-            pthread_join(aeronaves[i]->thread, NULL);
-            printf("[MAIN] Aeronave %d concluiu sua rota\n", i);
-            aeronave_destruir(aeronaves[i]);
-            aeronaves[i] = NULL;
-        }
+    if (!modo_silencioso) printf("[MAIN] Inicializando sistema ATC...\n");
+    simulacao_resultado_t resultado;
+    if (simulacao_executar(&config, &resultado) != 0) {
+        return 1;
     }
     
     printf("\n===============================================\n");
     printf("            RELATÓRIO FINAL\n");
     printf("===============================================\n");
     
+    if (regime_aberto) num_aeronaves = resultado.chegadas.aeronaves;
     printf("Setores configurados: %d\n", num_setores);
     printf("Aeronaves simuladas: %d\n", num_aeronaves);
     printf("Razão de contenção: %.2f aeronaves/setor\n", (float)num_aeronaves/num_setores);
+    printf("Vazão: %.2f setores concedidos/s\n", resultado.vazao);
+    printf("Espera por concessão: média %.1f ms | p50 %.1f ms | p99 %.1f ms\n",
+           resultado.espera_media, resultado.espera_p50, resultado.espera_p99);
+    if (regime_aberto) {
+        // Percentis já restritos à janela de medição; tudo em tempo simulado
+        printf("Regime aberto: %.3f chegadas/s na janela | vazão sustentada %.2f concessões/s | p50 %.1f ms | p99 %.1f ms\n",
+               resultado.chegadas.taxa_efetiva, resultado.vazao_sustentada,
+               resultado.espera_p50 * escala_tempo, resultado.espera_p99 * escala_tempo);
+        printf("Aeronaves no sistema: %d no início da janela, %d no fim | drenagem %.1f s\n",
+               resultado.chegadas.em_sistema_inicio, resultado.chegadas.em_sistema_fim,
+               resultado.chegadas.drenagem);
+    }
+    if (resultado.espera.emergencias > 0) {
+        printf("Emergências: %ld concessões | p50 %.1f ms | p99 %.1f ms | p99.9 %.1f ms | máx %.1f ms | %d preempções\n",
+               resultado.espera.emergencias, resultado.espera.emergencia_p50, resultado.espera.emergencia_p99,
+               resultado.espera.emergencia_p999, resultado.espera.emergencia_max, resultado.preempcoes);
+    }
+    if (resultado.espera.altas > 0) {
+        printf("Alta prioridade (P>=%d): %ld concessões | p50 %.1f ms | p99 %.1f ms | p99.9 %.1f ms | %ld heranças\n",
+               ESPERA_PRIORIDADE_ALTA, resultado.espera.altas, resultado.espera.alta_p50,
+               resultado.espera.alta_p99, resultado.espera.alta_p999, resultado.herancas);
+    }
+    if (config.restaurar != NULL) {
+        printf("Retomada em %.1f s simulados (contadores acumulados; tempos e vazão só desta execução)\n",
+               resultado.instante_restaurado);
+    }
+    if (resultado.checkpoints > 0) {
+        printf("Checkpoints: %d | frota segurada média %.2f ms, máx %.2f ms | escrita média %.2f ms | %ld bytes\n",
+               resultado.checkpoints, resultado.checkpoint_pausa_media_ms, resultado.checkpoint_pausa_max_ms,
+               resultado.checkpoint_escrita_media_ms, resultado.checkpoint_bytes);
+    }
+    if (resultado.estimativas > 0) {
+        printf("Estimativa de espera (%ld esperas em fila): estimada %.1f ms x medida %.1f ms | erro médio %.1f ms | viés %+.1f ms | %.0f%% entre 0.5x e 2x\n",
+               resultado.estimativas, resultado.espera_estimada_media, resultado.espera_medida_media,
+               resultado.estimativa_erro_medio, resultado.estimativa_vies, 100.0 * resultado.estimativas_na_faixa);
+    }
+    if (medicao_ativa()) {
+        printf("Medição (%s): %ld decolagens retidas | retenção média em solo %.1f ms\n",
+               medicao_nome(), resultado.retencoes, resultado.retencao_media);
+    }
+    printf("Sonos (%s): %ld | %ld temporizadores no kernel | atraso médio %.1f µs, máx %.1f µs | %ld trocas de contexto\n",
+           temporizador_nome(), resultado.sono.sonos, resultado.sono.armados, resultado.sono.atraso_medio_us,
+           resultado.sono.atraso_max_us, resultado.trocas_contexto);
+    if (resultado.sono.lotes > 0) {
+        printf("Roda de tempo: %ld ticks com despertares | %.1f aeronaves acordadas por tick\n",
+               resultado.sono.lotes, resultado.sono.por_lote);
+    }
+    printf("Inicialização: %.1f ms | RSS por aeronave: %.1f KB\n",
+           resultado.tempo_inicializacao, resultado.rss_por_aeronave);
+    if (config.reservas) {
+        printf("Reservas: makespan %.2f s (previsto %.2f s) | atraso em solo médio %.1f ms, máx %.1f ms | %.1f µs por reserva\n",
+               resultado.makespan, resultado.makespan_previsto, resultado.atraso_solo_medio,
+               resultado.atraso_solo_max, resultado.agendamento_medio_us);
+    }
+    printf("Latência de repasse (%s): média %.1f µs | p50 %.1f µs | p99 %.1f µs | máx %.1f µs\n",
+           espera_nome_modo(), resultado.espera.repasse_media, resultado.espera.repasse_p50,
+           resultado.espera.repasse_p99, resultado.espera.repasse_max);
+    printf("Esperas resolvidas: %ld girando | %ld cedendo a CPU | %ld dormindo\n",
+           resultado.espera.esperas_giro, resultado.espera.esperas_rendicao,
+           resultado.espera.esperas_dormindo);
+    if (desempenho_ligado()) {
+        desempenho_imprimir();
+    }
     printf("\nTodas as aeronaves completaram suas rotas!\n");
     printf("Sistema finalizado com sucesso.\n");
     printf("\nTécnicas de Concorrência Utilizadas:\n");
@@ -128,9 +596,5 @@ int main(int argc, char *argv[]) {
     printf("  • Fila de prioridade para escalonamento justo\n");
     printf("===============================================\n");
     
-    atc_finalizar();
-    
-    free(aeronaves);
-    
     return 0;
-}
\ No newline at end of file
+}
@@ -1,6 +1,15 @@
 #include "../include/aeronave.h"
 #include "../include/controlador.h"
 #include "../include/utils.h"
+#include "../include/relogio.h"
+#include "../include/reserva.h"
+#include "../include/espera.h"
+#include "../include/verificador.h"
+#include "../include/chegadas.h"
+#include "../include/contadores.h"
+#include "../include/checkpoint.h"
+#include "../include/medicao.h"
+#include "../include/temporizador.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
@@ -15,48 +24,99 @@ extern sem_t mutex_console;
 
 
 /**
- * Cria uma nova aeronave com parâmetros aleatórios
+ * Bytes por trecho de rota para um espaço aéreo
+ * @param total_setores: Número total de setores
+ * @return sizeof(uint16_t) se os ids cabem em 16 bits, sizeof(uint32_t) caso contrário
+ */
+size_t aeronave_tamanho_trecho(int total_setores) {
+    return total_setores <= SETORES_ROTA_CURTA ? sizeof(uint16_t) : sizeof(uint32_t);
+}
+
+/**
+ * Inicializa uma aeronave em memória já alocada (avulsa ou na arena da frota)
+ * Prioridade, rota e tempos de voo saem apenas da semente, sem tocar no rand() global
+ * @param a: Aeronave a ser inicializada
  * @param id: Identificador único da aeronave
  * @param total_setores: Número total de setores disponíveis no espaço aéreo
- * @return Ponteiro para a aeronave criada ou NULL em caso de falha
+ * @param rota: Buffer de comprimento_rota trechos de aeronave_tamanho_trecho(total_setores) bytes
+ * @param comprimento_rota: Número de trechos da rota
+ * @param semente: Semente do gerador aleatório próprio da aeronave
+ * @return 0 em caso de sucesso, -1 se o semáforo não puder ser criado
  */
-aeronave_t *aeronave_criar(int id, int total_setores) {
-    aeronave_t *a = malloc(sizeof(aeronave_t));
-    if (a == NULL) return NULL;
+int aeronave_inicializar(aeronave_t *a, int id, int total_setores, void *rota,
+                         int comprimento_rota, unsigned int semente) {
     a->id = id;
-    a->prioridade = 1 + (rand() % 1000);
+    a->semente = semente;
+    a->prioridade = 1 + (rand_r(&a->semente) % 1000);
     a->setor_atual = -1;
     a->setor_destino = -1;
-    a->tempo_solicitacao.tv_sec = 0;
-    a->tempo_solicitacao.tv_nsec = 0;
-    a->tempo_entrada = time(NULL);
-    a->total_espera = 0;
+    a->instante_solicitacao_ns = 0;
+    a->instante_entrada_ns = relogio_agora_ns();
+    memset(&a->espera, 0, sizeof(a->espera));
     a->precisa_recuar = false;
+    a->recuo_recente = false;
+    a->instante_repasse_ns = 0;
+    a->resposta_controle = RESPOSTA_PENDENTE;
+    a->pedido_setor.aeronave = a;
+    a->pedido_setor.liberar = false;
+    atomic_init(&a->pedido_setor.pendente, false);
+    a->pedido_liberacao.aeronave = a;
+    a->pedido_liberacao.liberar = true;
+    atomic_init(&a->pedido_liberacao.pendente, false);
     a->prioridade_original = a->prioridade;
     a->contador_recuos = 0;
     a->contador_esperas_longas = 0;
-    if (total_setores < 2) total_setores = 2;
-    a->comprimento_rota = 2 + (rand() % (total_setores - 1));
-    
-    a->rota = malloc(a->comprimento_rota * sizeof(int));
-    a->tempo_espera = malloc(a->comprimento_rota * sizeof(double));
-    
-    if (a->rota == NULL || a->tempo_espera == NULL) {
-        free(a->rota);
-        free(a->tempo_espera);
-        free(a);
-        return NULL;
-    }
-    
-    memset(a->tempo_espera, 0, a->comprimento_rota * sizeof(double));
-    
+    a->posicao_rota = 0;
+    a->comprimento_rota = comprimento_rota;
+    a->rota = rota;
+    a->rota_larga = aeronave_tamanho_trecho(total_setores) == sizeof(uint32_t);
+    a->emergencia = false;
+    a->proxima_emergencia = NULL;
+    atomic_init(&a->fase, FASE_LARGADA);
+    a->fim_voo_ns = 0;
+    a->voo_restante_ns = 0;
+    a->espera_estimada_ns = -1;
+
     for (int i = 0; i < a->comprimento_rota; i++) {
-        a->rota[i] = rand() % total_setores;
+        unsigned int setor = rand_r(&a->semente) % total_setores;
+        if (a->rota_larga) {
+            ((uint32_t *)rota)[i] = setor;
+        } else {
+            ((uint16_t *)rota)[i] = (uint16_t)setor;
+        }
     }
     
-    if (sem_init(&a->sem_aeronave, 0, 0) != 0) {
-        free(a->rota);
-        free(a->tempo_espera);
+    return sem_init(&a->sem_aeronave, 0, 0) == 0 ? 0 : -1;
+}
+
+/**
+ * Sorteia o comprimento de rota de uma aeronave usando o gerador global
+ * @param total_setores: Número total de setores disponíveis no espaço aéreo
+ * @return Comprimento entre 2 e total_setores
+ */
+int aeronave_sortear_comprimento_rota(int total_setores) {
+    if (total_setores < 2) total_setores = 2;
+    return 2 + (rand() % (total_setores - 1));
+}
+
+/**
+ * Cria uma nova aeronave com parâmetros aleatórios numa única alocação
+ * (a rota compacta fica logo depois da estrutura)
+ * @param id: Identificador único da aeronave
+ * @param total_setores: Número total de setores disponíveis no espaço aéreo
+ * @return Ponteiro para a aeronave criada ou NULL em caso de falha
+ */
+aeronave_t *aeronave_criar(int id, int total_setores) {
+    int comprimento = aeronave_sortear_comprimento_rota(total_setores);
+    // Semente derivada do gerador global: a carga fica reprodutível com srand()
+    unsigned int semente = (unsigned int)rand();
+
+    // Alinhada à linha de cache: aeronaves vizinhas não compartilham linhas
+    aeronave_t *a = NULL;
+    size_t tamanho = sizeof(aeronave_t) + comprimento * aeronave_tamanho_trecho(total_setores);
+    if (posix_memalign((void **)&a, LINHA_CACHE, tamanho) != 0) return NULL;
+
+    if (aeronave_inicializar(a, id, total_setores, a + 1, comprimento, semente) != 0) {
         free(a);
         return NULL;
     }
@@ -65,14 +125,13 @@ aeronave_t *aeronave_criar(int id, int total_setores) {
 }
 
 /**
- * Libera toda a memória alocada para uma aeronave
+ * Libera a memória de uma aeronave criada por aeronave_criar
+ * (aeronaves da frota são liberadas por frota_destruir)
  * @param aeronave: Ponteiro para a aeronave a ser destruída
  */
 void aeronave_destruir(aeronave_t *aeronave) {
     if (aeronave == NULL) return;
     
-    free(aeronave->rota);
-    free(aeronave->tempo_espera);
     sem_destroy(&aeronave->sem_aeronave);
     free(aeronave);
 }
@@ -93,22 +152,27 @@ void aeronave_imprimir_status(aeronave_t *aeronave) {
 }
 
 /**
- * Registra o tempo de espera de uma aeronave para acesso a um setor
+ * Registra o tempo de espera de uma aeronave para acesso a um setor nos seus
+ * agregados e no histograma de esperas da frota
  * @param aeronave: Ponteiro para a aeronave que está aguardando
- * @param inicio: Timestamp de quando a aeronave começou a aguardar
+ * @param inicio_ns: Instante (relogio_agora_ns) em que a aeronave começou a aguardar
  */
-void aeronave_registro_tempo_espera(aeronave_t *aeronave, struct timespec inicio) {
-    if (aeronave == NULL || (inicio.tv_sec == 0 && inicio.tv_nsec == 0)) return;
-    
-    struct timespec fim;
-    clock_gettime(CLOCK_REALTIME, &fim);
+void aeronave_registro_tempo_espera(aeronave_t *aeronave, long long inicio_ns) {
+    if (aeronave == NULL || inicio_ns == 0) return;
     
-    if (aeronave->total_espera < aeronave->comprimento_rota) {
-        double tempo_decorrido = (fim.tv_sec - inicio.tv_sec) + 
-                                  (fim.tv_nsec - inicio.tv_nsec) / 1000000000.0;
-        aeronave->tempo_espera[aeronave->total_espera] = tempo_decorrido;
-        aeronave->total_espera++;
+    long long espera_ns = relogio_agora_ns() - inicio_ns;
+    if (espera_ns < 0) espera_ns = 0;
+    espera_agregada_t *e = &aeronave->espera;
+    e->amostras++;
+    e->soma_ns += espera_ns;
+    if (espera_ns > e->max_ns) e->max_ns = espera_ns;
+    // Esperas desprezíveis ficam fora da média da aeronave
+    if (espera_ns > 1000000LL) {
+        e->amostras_media++;
+        e->soma_media_ns += espera_ns;
     }
+    espera_registrar_concessao(espera_ns, aeronave->emergencia,
+                               aeronave->prioridade_original >= ESPERA_PRIORIDADE_ALTA);
 }
 
 /**
@@ -117,20 +181,141 @@ void aeronave_registro_tempo_espera(aeronave_t *aeronave, struct timespec inicio
  * @return Média dos tempos de espera em segundos
  */
 double aeronave_calcular_media_espera(aeronave_t *aeronave) {
-    if (aeronave == NULL || aeronave->total_espera == 0) return 0.0;
-    
-    double soma = 0.0;
-    int contagem_valida = 0;
-    
-    for (int i = 0; i < aeronave->total_espera; i++) {
-        // Ignora tempos zerados ou negativos
-        if (aeronave->tempo_espera[i] > 0.001) {
-            soma += aeronave->tempo_espera[i];
-            contagem_valida++;
+    if (aeronave == NULL || aeronave->espera.amostras_media == 0) return 0.0;
+    return aeronave->espera.soma_media_ns / 1e9 / aeronave->espera.amostras_media;
+}
+
+/**
+ * Voo com reservas: sorteia os tempos de voo da rota, reserva todas as janelas
+ * de uma vez, espera em solo até a partida e entra em cada setor no início da
+ * sua janela. Os pedidos ao controlador continuam (ocupação, estatísticas e
+ * instantâneos), mas o setor já está livre quando o pedido chega
+ * @param a: Aeronave em execução
+ * @return true se a rota foi reservada e voada, false se a reserva falhou
+ */
+static bool aeronave_voar_reservado(aeronave_t *a) {
+    int *setores = malloc(sizeof(int) * a->comprimento_rota);
+    int *duracoes = malloc(sizeof(int) * a->comprimento_rota);
+    if (setores == NULL || duracoes == NULL) {
+        free(setores);
+        free(duracoes);
+        return false;
+    }
+
+    // Setores duplicados consecutivos viram um trecho só, como no voo reativo
+    int trechos = 0;
+    for (int i = 0; i < a->comprimento_rota; i++) {
+        int setor = aeronave_trecho(a, i);
+        if (trechos > 0 && setor == setores[trechos - 1]) continue;
+        setores[trechos] = setor;
+        duracoes[trechos] = TEMPO_VOO_MIN_MS + (rand_r(&a->semente) % TEMPO_VOO_VARIACAO_MS);
+        trechos++;
+    }
+
+    long long pedido = reserva_agora_ms();
+    long long instante = reserva_agendar(setores, duracoes, trechos, pedido);
+    if (instante < 0) {
+        free(setores);
+        free(duracoes);
+        return false;
+    }
+    log_evento("Aeronave %3d Reservou %d trechos, partida em %lld ms (atraso em solo %lld ms)\n",
+               a->id, trechos, instante, instante - pedido);
+
+    int trecho = 0;
+    for (a->posicao_rota = 0; a->posicao_rota < a->comprimento_rota; a->posicao_rota++) {
+        int setor_destino = aeronave_trecho(a, a->posicao_rota);
+        if (setor_destino == a->setor_atual) continue;
+
+        reserva_dormir_ate(instante);
+        if (!atc_solicitar_setor(a, setor_destino)) {
+            log_evento("Aeronave %3d Falha ao acessar S%d\n", a->id, setor_destino);
+            break;
         }
+        verificador_confirmar(setor_destino, a->id);
+
+        log_evento("Aeronave %3d Voando em S%d por %d ms (reservado)\n",
+                   a->id, setor_destino, duracoes[trecho]);
+        instante += duracoes[trecho++];
+    }
+    reserva_dormir_ate(instante);
+    if (a->setor_atual >= 0) verificador_confirmar(a->setor_atual, a->id);
+
+    free(setores);
+    free(duracoes);
+    return true;
+}
+
+/**
+ * Dorme o voo de um trecho e passa pelo ponto seguro do checkpoint no fim
+ * @param a: Aeronave em execução
+ * @param setor: Setor em que voa
+ * @param duracao_ns: Duração em ns de relógio (já comprimida pela escala)
+ */
+static void aeronave_dormir_voo(aeronave_t *a, int setor, long long duracao_ns) {
+    a->fim_voo_ns = relogio_agora_ns() + duracao_ns;
+    atomic_store(&a->fase, FASE_VOANDO);
+    temporizador_dormir_ns(duracao_ns);
+    verificador_confirmar(setor, a->id);
+    checkpoint_ponto_seguro(a, FASE_ENTRE_TRECHOS, FASE_POUSADA);
+}
+
+/**
+ * Voa um trecho já concedido (1-1.5 segundos, comprimido pela escala)
+ * @param a: Aeronave em execução
+ * @param setor: Setor concedido
+ */
+static void aeronave_voar(aeronave_t *a, int setor) {
+    verificador_confirmar(setor, a->id);
+    int tempo_voo_ms = TEMPO_VOO_MIN_MS + (rand_r(&a->semente) % TEMPO_VOO_VARIACAO_MS);
+    log_evento("Aeronave %3d Voando em S%d por %d ms\n", a->id, setor, tempo_voo_ms);
+    aeronave_dormir_voo(a, setor, (long long)tempo_voo_ms * 1000000LL / (escala_tempo > 0 ? escala_tempo : 1));
+}
+
+/**
+ * Segura a aeronave em solo enquanto o primeiro ou o segundo setor da rota
+ * estiver congestionado (medicao.h). Retida, ela fica estacionada para o
+ * checkpoint (ainda vai pedir o primeiro trecho)
+ * @param a: Aeronave em solo, antes do primeiro pedido
+ */
+static void aeronave_aguardar_medicao(aeronave_t *a) {
+    int primeiro = aeronave_trecho(a, 0);
+    int seguinte = a->comprimento_rota > 1 ? aeronave_trecho(a, 1) : -1;
+    long long inicio_ns = relogio_agora_ns();
+    bool retida = false;
+
+    long long espera_ns;
+    while ((espera_ns = medicao_admitir(primeiro, seguinte, relogio_agora_ns())) > 0) {
+        retida = true;
+        checkpoint_ponto_seguro(a, FASE_ESTACIONADA, FASE_ESTACIONADA);
+        temporizador_dormir_ns(espera_ns);
+    }
+    if (retida) {
+        contadores_incrementar(CONTADOR_RETENCOES);
+        contadores_adicionar(CONTADOR_RETENCAO_NS, relogio_agora_ns() - inicio_ns);
+    }
+}
+
+/**
+ * Retoma uma aeronave restaurada de um checkpoint no ponto em que ela parou
+ * @param a: Aeronave com o estado restaurado
+ * @return Próximo trecho da rota a pedir, -1 se a espera retomada falhou
+ */
+static int aeronave_retomar(aeronave_t *a) {
+    int setor = a->posicao_rota < a->comprimento_rota ? aeronave_trecho(a, a->posicao_rota) : -1;
+    switch (atomic_load(&a->fase)) {
+    case FASE_VOANDO:
+    case FASE_POUSADA:
+        aeronave_dormir_voo(a, setor, a->voo_restante_ns);
+        return a->posicao_rota + 1;
+    case FASE_PEDINDO:
+        // Estava numa fila: volta a esperar na mesma posição
+        if (!atc_retomar_espera(a, setor)) return -1;
+        aeronave_voar(a, setor);
+        return a->posicao_rota + 1;
+    default:
+        return a->posicao_rota;
     }
-    
-    return (contagem_valida > 0) ? (soma / contagem_valida) : 0.0;
 }
 
 /**
@@ -141,69 +326,68 @@ double aeronave_calcular_media_espera(aeronave_t *aeronave) {
 void *aeronave_executa(void *arg) {
     aeronave_t *a = (aeronave_t *)arg;
     if (a == NULL) pthread_exit(NULL);
+
+    contadores_registrar_thread();
+
+    // Nenhuma aeronave decola antes de a frota inteira existir
+    atc_aguardar_largada();
+    if (atomic_load(&a->fase) == FASE_CONCLUIDA) pthread_exit(NULL); // Restaurada já concluída
+    // No regime aberto, cada uma só aparece no seu instante de chegada
+    chegadas_aguardar(a->id);
     
-    sem_wait(&mutex_console);
-    imprimir_timestamp();
-    printf("Aeronave %3d [Prio:%4u] Iniciou - Rota: ", a->id, a->prioridade);
-    for (int i = 0; i < a->comprimento_rota; i++) {
-        printf("S%d", a->rota[i]);
-        if (i < a->comprimento_rota - 1) printf(" -> ");
+    if (!modo_silencioso) {
+        sem_wait(&mutex_console);
+        imprimir_timestamp();
+        printf("Aeronave %3d [Prio:%4u] Iniciou - Rota: ", a->id, a->prioridade);
+        for (int i = 0; i < a->comprimento_rota; i++) {
+            printf("S%d", aeronave_trecho(a, i));
+            if (i < a->comprimento_rota - 1) printf(" -> ");
+        }
+        printf("\n");
+        sem_post(&mutex_console);
     }
-    printf("\n");
-    sem_post(&mutex_console);
     
-    // Percorre toda a rota
-    for (int pos = 0; pos < a->comprimento_rota; pos++) {
-        int setor_destino = a->rota[pos];
+    // Percorre toda a rota (no modo de reservas, seguindo o calendário; restaurada
+    // de um checkpoint, a partir de onde parou)
+    bool reservado = reserva_ativa() && aeronave_voar_reservado(a);
+    int inicio = 0;
+    if (reservado) {
+        inicio = a->comprimento_rota;
+    } else if (atomic_load(&a->fase) != FASE_LARGADA) {
+        inicio = aeronave_retomar(a);
+        if (inicio < 0) {
+            log_evento("Aeronave %3d Falha ao retomar a espera\n", a->id);
+            inicio = a->comprimento_rota;
+        }
+    }
+    for (a->posicao_rota = inicio; a->posicao_rota < a->comprimento_rota; a->posicao_rota++) {
+        int setor_destino = aeronave_trecho(a, a->posicao_rota);
         
         // Pula se já está neste setor (setores duplicados consecutivos)
         if (setor_destino == a->setor_atual) {
             continue;
         }
         
-        // Solicita acesso ao próximo setor
+        // Solicita acesso ao próximo setor (a medição, antes de decolar, e um
+        // checkpoint em andamento seguram o pedido)
+        if (a->setor_atual < 0 && a->posicao_rota == 0 && medicao_ativa()) aeronave_aguardar_medicao(a);
+        checkpoint_ponto_seguro(a, FASE_PEDINDO, FASE_ESTACIONADA);
         int sucesso = atc_solicitar_setor(a, setor_destino);
         if (!sucesso) {
-            sem_wait(&mutex_console);
-            imprimir_timestamp();
-            printf("Aeronave %3d Falha ao acessar S%d\n", a->id, setor_destino);
-            sem_post(&mutex_console);
+            log_evento("Aeronave %3d Falha ao acessar S%d\n", a->id, setor_destino);
             break;
         }
         
-        // Libera setor anterior (se houver)
-        if (a->setor_atual >= 0) {
-            atc_liberar_setor(a, a->setor_atual);
-        }
-        
-        // Atualiza posição atual
-        a->setor_atual = setor_destino;
-        
-        // Simula tempo de voo no setor (1-1.5 segundos)
-        int tempo_voo_ms = 1000 + (rand() % 500);
-        struct timespec ts = {
-            .tv_sec = tempo_voo_ms / 1000,
-            .tv_nsec = (tempo_voo_ms % 1000) * 1000000
-        };
-        
-        sem_wait(&mutex_console);
-        imprimir_timestamp();
-        printf("Aeronave %3d Voando em S%d por %d ms\n", a->id, setor_destino, tempo_voo_ms);
-        sem_post(&mutex_console);
-        
-        nanosleep(&ts, NULL);
+        // O controlador já devolveu o setor anterior e atualizou setor_atual
+        aeronave_voar(a, setor_destino);
     }
     
     // Libera último setor ao concluir
-    if (a->setor_atual >= 0) {
-        atc_liberar_setor(a, a->setor_atual);
-        a->setor_atual = -1;
-    }
+    atc_deixar_setor(a);
+    atomic_store(&a->fase, FASE_CONCLUIDA);
+    chegadas_concluir();
     
-    sem_wait(&mutex_console);
-    imprimir_timestamp();
-    printf("Aeronave %3d Concluída! Tempo médio espera: %.2fs\n", a->id, aeronave_calcular_media_espera(a));
-    sem_post(&mutex_console);
+    log_evento("Aeronave %3d Concluída! Tempo médio espera: %.2fs\n", a->id, aeronave_calcular_media_espera(a));
     
     pthread_exit(NULL);
 }
\ No newline at end of file
@@ -0,0 +1,70 @@
+#include <string.h>
+#include "../include/anel_spsc.h"
+
+/**
+ * Calcula quantos bytes um anel ocupa (cabeçalho + mensagens), arredondado à linha de cache
+ * @param capacidade: Número de mensagens (potência de 2)
+ * @param tamanho_mensagem: Tamanho de cada mensagem em bytes
+ * @return Tamanho total em bytes
+ */
+size_t anel_spsc_tamanho(unsigned long capacidade, size_t tamanho_mensagem) {
+    size_t total = sizeof(anel_spsc_t) + capacidade * tamanho_mensagem;
+    return (total + LINHA_CACHE - 1) & ~(size_t)(LINHA_CACHE - 1);
+}
+
+/**
+ * Inicializa um anel vazio em memória já reservada
+ * @param anel: Ponteiro para a área do anel
+ * @param capacidade: Número de mensagens (potência de 2)
+ * @param tamanho_mensagem: Tamanho de cada mensagem em bytes
+ */
+void anel_spsc_inicializar(anel_spsc_t *anel, unsigned long capacidade, size_t tamanho_mensagem) {
+    atomic_init(&anel->cabeca, 0);
+    atomic_init(&anel->cauda, 0);
+    anel->capacidade = capacidade;
+    anel->tamanho_mensagem = tamanho_mensagem;
+}
+
+/**
+ * Copia uma mensagem para o anel (somente o produtor chama)
+ * @param anel: Anel de destino
+ * @param mensagem: Mensagem com tamanho_mensagem bytes
+ * @return false se o anel estiver cheio
+ */
+bool anel_spsc_enviar(anel_spsc_t *anel, const void *mensagem) {
+    unsigned long cauda = atomic_load_explicit(&anel->cauda, memory_order_relaxed);
+    unsigned long cabeca = atomic_load_explicit(&anel->cabeca, memory_order_acquire);
+    if (cauda - cabeca >= anel->capacidade) return false;
+
+    unsigned long posicao = cauda & (anel->capacidade - 1);
+    memcpy(anel->dados + posicao * anel->tamanho_mensagem, mensagem, anel->tamanho_mensagem);
+    atomic_store_explicit(&anel->cauda, cauda + 1, memory_order_release);
+    return true;
+}
+
+/**
+ * Retira a mensagem mais antiga do anel (somente o consumidor chama)
+ * @param anel: Anel de origem
+ * @param mensagem: Buffer com tamanho_mensagem bytes
+ * @return false se o anel estiver vazio
+ */
+bool anel_spsc_receber(anel_spsc_t *anel, void *mensagem) {
+    unsigned long cabeca = atomic_load_explicit(&anel->cabeca, memory_order_relaxed);
+    unsigned long cauda = atomic_load_explicit(&anel->cauda, memory_order_acquire);
+    if (cabeca == cauda) return false;
+
+    unsigned long posicao = cabeca & (anel->capacidade - 1);
+    memcpy(mensagem, anel->dados + posicao * anel->tamanho_mensagem, anel->tamanho_mensagem);
+    atomic_store_explicit(&anel->cabeca, cabeca + 1, memory_order_release);
+    return true;
+}
+
+/**
+ * Verifica se o anel está vazio (somente o consumidor chama)
+ * @param anel: Anel a verificar
+ * @return true se não há mensagens
+ */
+bool anel_spsc_vazio(anel_spsc_t *anel) {
+    return atomic_load_explicit(&anel->cabeca, memory_order_relaxed) ==
+           atomic_load_explicit(&anel->cauda, memory_order_seq_cst);
+}
@@ -0,0 +1,1195 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+#include "../include/benchmark.h"
+#include "../include/politica.h"
+#include "../include/controlador.h"
+#include "../include/relogio.h"
+#include "../include/vitima.h"
+#include "../include/reserva.h"
+#include "../include/aeronave.h"
+#include "../include/frota.h"
+#include "../include/utils.h"
+#include "../include/topologia.h"
+#include "../include/chegadas.h"
+#include "../include/medicao.h"
+#include "../include/temporizador.h"
+#include "../include/ocupacao.h"
+
+/**
+ * Executa a mesma carga (mesma semente, setores e frota) com cada política de
+ * escalonamento e imprime uma tabela comparativa de vazão e espera
+ * @param base: Configuração da carga; o campo politica é ignorado
+ * @return 0 se todas as execuções terminaram, -1 caso alguma tenha falhado
+ */
+int benchmark_politicas(const simulacao_config_t *base) {
+    bool silencioso_anterior = modo_silencioso;
+    modo_silencioso = true;
+
+    printf("[BENCH] Setores: %d | Aeronaves: %d | Semente: %u | Escala de tempo: %dx | Espera: %s\n",
+           base->num_setores, base->num_aeronaves, base->semente, escala_tempo, espera_nome_modo());
+    printf("%-12s %10s %12s %10s %10s %10s %10s %9s %7s %13s %12s %12s %9s\n",
+           "politica", "tempo(s)", "vazao(c/s)", "media(ms)", "p50(ms)", "p99(ms)",
+           "max(ms)", "deadlocks", "recuos", "repasse99(us)", "est_erro(ms)", "est_vies(ms)", "est_0.5-2x");
+
+    int status = 0;
+    for (int i = 0; i < total_politicas; i++) {
+        simulacao_config_t config = *base;
+        config.politica = politicas_disponiveis[i];
+
+        simulacao_resultado_t r;
+        if (simulacao_executar(&config, &r) != 0) {
+            printf("%-12s %10s\n", config.politica->nome, "FALHOU");
+            status = -1;
+            continue;
+        }
+        printf("%-12s %10.2f %12.1f %10.2f %10.2f %10.2f %10.2f %9d %7d %13.1f %12.2f %+12.2f %8.0f%%\n",
+               config.politica->nome, r.tempo_total, r.vazao, r.espera_media,
+               r.espera_p50, r.espera_p99, r.espera_max, r.deadlocks, r.recuos,
+               r.espera.repasse_p99, r.estimativa_erro_medio, r.estimativa_vies,
+               100.0 * r.estimativas_na_faixa);
+        fflush(stdout);
+    }
+
+    modo_silencioso = silencioso_anterior;
+    return status;
+}
+
+/**
+ * Executa a mesma carga com o controlador com travas e com o controlador
+ * central em lotes e imprime vazão e latências de cauda lado a lado
+ * @param base: Configuração da carga (a política escolhida é mantida)
+ * @return 0 se as duas execuções terminaram, -1 caso alguma tenha falhado
+ */
+int benchmark_controladores(const simulacao_config_t *base) {
+    static const char *modos[] = { "travas", "central" };
+    bool silencioso_anterior = modo_silencioso;
+    const char *modo_anterior = atc_nome_modo();
+    modo_silencioso = true;
+
+    printf("[BENCH] Setores: %d | Aeronaves: %d | Semente: %u | Escala de tempo: %dx | Política: %s | Espera: %s\n",
+           base->num_setores, base->num_aeronaves, base->semente, escala_tempo,
+           base->politica->nome, espera_nome_modo());
+    printf("%-12s %10s %12s %10s %10s %10s %13s %13s %8s\n",
+           "controlador", "tempo(s)", "vazao(c/s)", "media(ms)", "p99(ms)", "max(ms)",
+           "repasse50(us)", "repasse99(us)", "lote");
+
+    int status = 0;
+    for (int i = 0; i < (int)(sizeof(modos) / sizeof(modos[0])); i++) {
+        atc_definir_modo(modos[i]);
+
+        simulacao_resultado_t r;
+        if (simulacao_executar(base, &r) != 0) {
+            printf("%-12s %10s\n", modos[i], "FALHOU");
+            status = -1;
+            continue;
+        }
+        printf("%-12s %10.2f %12.1f %10.2f %10.2f %10.2f %13.1f %13.1f %8.1f\n",
+               modos[i], r.tempo_total, r.vazao, r.espera_media, r.espera_p99, r.espera_max,
+               r.espera.repasse_p50, r.espera.repasse_p99, r.tamanho_medio_lote);
+        fflush(stdout);
+    }
+
+    atc_definir_modo(modo_anterior);
+    modo_silencioso = silencioso_anterior;
+    return status;
+}
+
+/**
+ * Compara a detecção de deadlock a cada pedido com o detector periódico em duas
+ * cargas: a pedida e uma com 1/8 das aeronaves, onde quase não há ciclos e o
+ * custo da verificação por pedido é puro overhead na seção crítica
+ * @param base: Configuração da carga (controlador e política escolhidos são mantidos)
+ * @return 0 se todas as execuções terminaram, -1 caso alguma tenha falhado
+ */
+int benchmark_deteccao(const simulacao_config_t *base) {
+    static const char *modos[] = { "pedido", "periodica" };
+    bool silencioso_anterior = modo_silencioso;
+    char deteccao_anterior[32];
+    snprintf(deteccao_anterior, sizeof(deteccao_anterior), "%s", atc_nome_deteccao());
+    modo_silencioso = true;
+
+    printf("[BENCH] Setores: %d | Semente: %u | Escala de tempo: %dx | Controlador: %s | Política: %s\n",
+           base->num_setores, base->semente, escala_tempo, atc_nome_modo(), base->politica->nome);
+    printf("%-14s %9s %10s %12s %9s %7s %14s %12s %9s\n",
+           "deteccao", "aeronaves", "tempo(s)", "vazao(c/s)", "deadlocks", "recuos",
+           "secao_med(ns)", "secao_max(us)", "passadas");
+
+    int status = 0;
+    int cargas[] = { base->num_aeronaves, base->num_aeronaves / 8 > 2 ? base->num_aeronaves / 8 : 2 };
+    for (int c = 0; c < 2; c++) {
+        simulacao_config_t config = *base;
+        config.num_aeronaves = cargas[c];
+
+        for (int i = 0; i < (int)(sizeof(modos) / sizeof(modos[0])); i++) {
+            atc_definir_deteccao(modos[i]);
+
+            simulacao_resultado_t r;
+            if (simulacao_executar(&config, &r) != 0) {
+                printf("%-14s %9d %10s\n", atc_nome_deteccao(), config.num_aeronaves, "FALHOU");
+                status = -1;
+                continue;
+            }
+            printf("%-14s %9d %10.2f %12.1f %9d %7d %14.0f %12.1f %9ld\n",
+                   atc_nome_deteccao(), config.num_aeronaves, r.tempo_total, r.vazao, r.deadlocks,
+                   r.recuos, r.secao_critica_media_ns, r.secao_critica_max_us, r.passadas_deteccao);
+            fflush(stdout);
+        }
+    }
+
+    atc_definir_deteccao(deteccao_anterior);
+    modo_silencioso = silencioso_anterior;
+    return status;
+}
+
+/**
+ * Executa a mesma carga com cada função de custo de escolha de vítimas e
+ * imprime o trabalho perdido nos recuos (saltos de setor e espera descartada)
+ * @param base: Configuração da carga (controlador, detecção e política mantidos)
+ * @return 0 se todas as execuções terminaram, -1 caso alguma tenha falhado
+ */
+int benchmark_vitimas(const simulacao_config_t *base) {
+    bool silencioso_anterior = modo_silencioso;
+    char vitima_anterior[64];
+    snprintf(vitima_anterior, sizeof(vitima_anterior), "%s", vitima_nome());
+    modo_silencioso = true;
+
+    printf("[BENCH] Setores: %d | Aeronaves: %d | Semente: %u | Escala de tempo: %dx | Detecção: %s\n",
+           base->num_setores, base->num_aeronaves, base->semente, escala_tempo, atc_nome_deteccao());
+    printf("%-12s %10s %12s %10s %9s %7s %15s %17s %13s\n",
+           "vitima", "tempo(s)", "vazao(c/s)", "p99(ms)", "deadlocks", "recuos",
+           "saltos_perdidos", "fila_perdida(ms)", "pior_sequencia");
+
+    int status = 0;
+    for (int i = 0; i < total_vitimas; i++) {
+        vitima_definir(vitimas_disponiveis[i]->nome);
+
+        simulacao_resultado_t r;
+        if (simulacao_executar(base, &r) != 0) {
+            printf("%-12s %10s\n", vitimas_disponiveis[i]->nome, "FALHOU");
+            status = -1;
+            continue;
+        }
+        printf("%-12s %10.2f %12.1f %10.2f %9d %7d %15ld %17.1f %13d\n",
+               vitimas_disponiveis[i]->nome, r.tempo_total, r.vazao, r.espera_p99, r.deadlocks,
+               r.recuos, r.saltos_perdidos, r.espera_perdida * 1000.0, r.max_recuos_seguidos);
+        fflush(stdout);
+    }
+
+    vitima_definir(vitima_anterior);
+    modo_silencioso = silencioso_anterior;
+    return status;
+}
+
+#define AERONAVES_AGENDAMENTO 100000
+
+/**
+ * Mede só o calendário: reserva em sequência as rotas de AERONAVES_AGENDAMENTO
+ * aeronaves (mesma distribuição de rotas e tempos de voo da simulação), todas
+ * pedindo partida no instante zero, sem threads nem controlador
+ * @param setores: Número de setores
+ * @param semente: Semente das rotas
+ * @return 0 em caso de sucesso, -1 em caso de falha de alocação
+ */
+static int benchmark_agendamento(int setores, unsigned int semente) {
+    int *trechos_setor = malloc(sizeof(int) * setores);
+    int *duracoes = malloc(sizeof(int) * setores);
+    if (trechos_setor == NULL || duracoes == NULL || !reserva_inicializar(setores)) {
+        free(trechos_setor);
+        free(duracoes);
+        return -1;
+    }
+
+    srand(semente);
+    int status = 0;
+    long long inicio_ns = relogio_agora_ns();
+    for (int i = 0; i < AERONAVES_AGENDAMENTO; i++) {
+        int comprimento = aeronave_sortear_comprimento_rota(setores);
+        int trechos = 0;
+        for (int k = 0; k < comprimento; k++) {
+            int setor = rand() % setores;
+            if (trechos > 0 && setor == trechos_setor[trechos - 1]) continue;
+            trechos_setor[trechos] = setor;
+            duracoes[trechos] = TEMPO_VOO_MIN_MS + rand() % TEMPO_VOO_VARIACAO_MS;
+            trechos++;
+        }
+        if (reserva_agendar(trechos_setor, duracoes, trechos, 0) < 0) {
+            status = -1;
+            break;
+        }
+    }
+    double segundos = relogio_segundos_desde(inicio_ns);
+
+    reserva_estatisticas_t e;
+    reserva_obter_estatisticas(&e);
+    printf("[BENCH] Calendário: %ld reservas de rota (%ld janelas) em %.3f s: %.2f µs por reserva, "
+           "%.2f conflitos por reserva, %ld sem encaixe, makespan %.1f h simulado\n",
+           e.agendamentos, e.intervalos, segundos,
+           e.agendamentos > 0 ? segundos * 1e6 / e.agendamentos : 0.0,
+           e.agendamentos > 0 ? (double)e.conflitos / e.agendamentos : 0.0, e.reservas_no_fim,
+           e.makespan_ms / 3600000.0);
+
+    reserva_finalizar();
+    free(trechos_setor);
+    free(duracoes);
+    return status;
+}
+
+/**
+ * Executa a mesma carga com o controlador reativo e com reservas de rota e
+ * compara o makespan (largada até a última aeronave pousar), a espera em voo e
+ * o atraso em solo; depois mede o custo de reservar AERONAVES_AGENDAMENTO rotas
+ * @param base: Configuração da carga (controlador, detecção e política mantidos)
+ * @return 0 se todas as execuções terminaram, -1 caso alguma tenha falhado
+ */
+int benchmark_reservas(const simulacao_config_t *base) {
+    static const char *modos[] = { "reativo", "reservas" };
+    bool silencioso_anterior = modo_silencioso;
+    modo_silencioso = true;
+
+    printf("[BENCH] Setores: %d | Aeronaves: %d | Semente: %u | Escala de tempo: %dx | Controlador: %s\n",
+           base->num_setores, base->num_aeronaves, base->semente, escala_tempo, atc_nome_modo());
+    printf("%-10s %12s %12s %12s %10s %9s %7s %15s %14s\n",
+           "modo", "makespan(s)", "previsto(s)", "vazao(c/s)", "p99(ms)", "deadlocks", "recuos",
+           "solo_medio(ms)", "solo_max(ms)");
+
+    int status = 0;
+    for (int i = 0; i < (int)(sizeof(modos) / sizeof(modos[0])); i++) {
+        simulacao_config_t config = *base;
+        config.reservas = (i == 1);
+
+        simulacao_resultado_t r;
+        if (simulacao_executar(&config, &r) != 0) {
+            printf("%-10s %12s\n", modos[i], "FALHOU");
+            status = -1;
+            continue;
+        }
+        printf("%-10s %12.2f %12.2f %12.1f %10.2f %9d %7d %15.1f %14.1f\n",
+               modos[i], r.makespan, r.makespan_previsto, r.vazao, r.espera_p99, r.deadlocks,
+               r.recuos, r.atraso_solo_medio, r.atraso_solo_max);
+        fflush(stdout);
+    }
+
+    if (benchmark_agendamento(base->num_setores, base->semente) != 0) status = -1;
+
+    modo_silencioso = silencioso_anterior;
+    return status;
+}
+
+/**
+ * Executa a mesma carga com as threads livres e com o posicionamento numa
+ * (setores particionados por nó, aeronaves fixadas no nó da rota) e compara
+ * vazão, latências e a fração de concessões feitas de um núcleo de outro nó
+ * @param base: Configuração da carga (controlador, detecção e política mantidos)
+ * @return 0 se as duas execuções terminaram, -1 caso alguma tenha falhado
+ */
+int benchmark_numa(const simulacao_config_t *base) {
+    bool silencioso_anterior = modo_silencioso;
+    char posicionamento_anterior[32];
+    snprintf(posicionamento_anterior, sizeof(posicionamento_anterior), "%s", topologia_nome_posicionamento());
+    // "numa:N" escolhido na linha de comando é mantido; senão, os nós reais
+    const char *modos[] = { "livre", strncmp(posicionamento_anterior, "numa", 4) == 0 ? posicionamento_anterior : "numa" };
+    modo_silencioso = true;
+
+    topologia_definir_posicionamento(modos[1]);
+    printf("[BENCH] Setores: %d | Aeronaves: %d | Semente: %u | Escala de tempo: %dx | Controlador: %s | Nós: %d\n",
+           base->num_setores, base->num_aeronaves, base->semente, escala_tempo, atc_nome_modo(), topologia_nos());
+    if (topologia_nos() == 1) {
+        printf("[BENCH] Um nó só: nada é fixado e as duas execuções usam o mesmo posicionamento\n");
+    }
+    printf("%-14s %10s %12s %10s %10s %13s %12s %12s\n",
+           "posicionamento", "tempo(s)", "vazao(c/s)", "p50(ms)", "p99(ms)", "repasse99(us)",
+           "concessoes", "remotas(%)");
+
+    int status = 0;
+    for (int i = 0; i < 2; i++) {
+        topologia_definir_posicionamento(modos[i]);
+
+        simulacao_resultado_t r;
+        if (simulacao_executar(base, &r) != 0) {
+            printf("%-14s %10s\n", modos[i], "FALHOU");
+            status = -1;
+            continue;
+        }
+        char remotas[16] = "-";
+        if (r.acessos_setor > 0) {
+            snprintf(remotas, sizeof(remotas), "%.1f", 100.0 * r.acessos_remotos / r.acessos_setor);
+        }
+        printf("%-14s %10.2f %12.1f %10.2f %10.2f %13.1f %12d %12s\n",
+               modos[i], r.tempo_total, r.vazao, r.espera_p50, r.espera_p99,
+               r.espera.repasse_p99, r.transferencias, remotas);
+        fflush(stdout);
+    }
+
+    topologia_definir_posicionamento(posicionamento_anterior);
+    modo_silencioso = silencioso_anterior;
+    return status;
+}
+
+#define TOLERANCIA_LINHA_BASE 0.25 // Queda de vazão aceita contra a linha de base
+
+// Variante do build na chave da linha de base: os sanitizers e o perfil de
+// release (make release) mudam a vazão
+#if defined(__SANITIZE_ADDRESS__)
+#define VARIANTE_BUILD "san"
+#elif defined(NDEBUG)
+#define VARIANTE_BUILD "release"
+#else
+#define VARIANTE_BUILD "nosan"
+#endif
+
+/**
+ * Procura a vazão gravada para uma chave no arquivo de linha de base
+ * (uma linha "chave vazao" por configuração)
+ * @param arquivo: Caminho do arquivo
+ * @param chave: Configuração procurada
+ * @param vazao: Recebe a vazão gravada
+ * @return true se a chave existe no arquivo
+ */
+static bool linha_base_buscar(const char *arquivo, const char *chave, double *vazao) {
+    FILE *f = fopen(arquivo, "r");
+    if (f == NULL) return false;
+
+    char lida[128];
+    double valor;
+    bool encontrada = false;
+    while (fscanf(f, "%127s %lf", lida, &valor) == 2) {
+        if (strcmp(lida, chave) == 0) {
+            *vazao = valor;
+            encontrada = true;
+        }
+    }
+    fclose(f);
+    return encontrada;
+}
+
+/**
+ * Acrescenta uma configuração ao arquivo de linha de base
+ * @param arquivo: Caminho do arquivo (criado se não existir)
+ * @param chave: Configuração
+ * @param vazao: Vazão medida
+ * @return true se gravou
+ */
+static bool linha_base_gravar(const char *arquivo, const char *chave, double vazao) {
+    FILE *f = fopen(arquivo, "a");
+    if (f == NULL) {
+        perror("Erro ao gravar a linha de base");
+        return false;
+    }
+    fprintf(f, "%s %.1f\n", chave, vazao);
+    fclose(f);
+    return true;
+}
+
+/**
+ * Teste de estresse: roda a carga com cada combinação de controlador e
+ * detecção com o verificador ligado (no máximo um ocupante por setor, nenhum
+ * despertar perdido) e compara a vazão de concessões com a linha de base
+ * gravada para a mesma configuração. Configuração sem linha de base falha:
+ * a base só é gravada pedindo (gravar), e então substitui a anterior
+ * @param base: Configuração da carga (política e semente mantidas)
+ * @param arquivo_linha_base: Arquivo com as vazões de referência
+ * @param gravar: Grava a vazão medida como a nova base em vez de comparar
+ * @return 0 se não houve violação nem queda de vazão além da tolerância, -1 caso contrário
+ */
+int benchmark_estresse(const simulacao_config_t *base, const char *arquivo_linha_base, bool gravar) {
+    static const char *combinacoes[][2] = {
+        { "travas", "pedido" }, { "travas", "periodica" },
+        { "central", "pedido" }, { "central", "periodica" },
+    };
+    bool silencioso_anterior = modo_silencioso;
+    const char *modo_anterior = atc_nome_modo();
+    char deteccao_anterior[32];
+    snprintf(deteccao_anterior, sizeof(deteccao_anterior), "%s", atc_nome_deteccao());
+    modo_silencioso = true;
+
+    printf("[BENCH] Estresse: Setores: %d | Aeronaves: %d | Semente: %u | Escala de tempo: %dx | Política: %s\n",
+           base->num_setores, base->num_aeronaves, base->semente, escala_tempo, base->politica->nome);
+    printf("[BENCH] Linha de base: %s (tolerância %.0f%%, build %s%s)\n",
+           arquivo_linha_base, TOLERANCIA_LINHA_BASE * 100, VARIANTE_BUILD, gravar ? ", gravando" : "");
+    printf("%-12s %-14s %10s %12s %12s %10s %10s %14s %-10s\n",
+           "controlador", "deteccao", "tempo(s)", "vazao(c/s)", "base(c/s)", "concessoes",
+           "violacoes", "parada_max(ms)", "resultado");
+
+    int status = 0;
+    bool faltou_base = false;
+    for (int i = 0; i < (int)(sizeof(combinacoes) / sizeof(combinacoes[0])); i++) {
+        atc_definir_modo(combinacoes[i][0]);
+        atc_definir_deteccao(combinacoes[i][1]);
+        simulacao_config_t config = *base;
+        config.verificar = true;
+
+        simulacao_resultado_t r;
+        if (simulacao_executar(&config, &r) != 0) {
+            printf("%-12s %-14s %10s\n", combinacoes[i][0], atc_nome_deteccao(), "FALHOU");
+            status = -1;
+            continue;
+        }
+
+        const verificador_estatisticas_t *v = &r.verificacao;
+        long violacoes = v->violacoes_ocupacao + v->liberacoes_invalidas + v->setores_perdidos;
+        double vazao = r.makespan > 0 ? r.transferencias / r.makespan : 0.0;
+
+        char chave[128];
+        snprintf(chave, sizeof(chave), "%s/%s/%s/%dx%d/e%d/%s", atc_nome_modo(), atc_nome_deteccao(),
+                 base->politica->nome, base->num_setores, base->num_aeronaves, escala_tempo, VARIANTE_BUILD);
+        double vazao_base = 0.0;
+        const char *veredito = "ok";
+        if (violacoes > 0) {
+            veredito = "VIOLACAO";
+            status = -1;
+        }
+        if (gravar) {
+            // Uma execução com violação não vira referência
+            if (violacoes == 0) {
+                if (linha_base_gravar(arquivo_linha_base, chave, vazao)) {
+                    veredito = "gravada";
+                    vazao_base = vazao;
+                } else {
+                    status = -1;
+                }
+            }
+        } else if (linha_base_buscar(arquivo_linha_base, chave, &vazao_base)) {
+            if (vazao < vazao_base * (1.0 - TOLERANCIA_LINHA_BASE)) {
+                if (violacoes == 0) veredito = "REGRESSAO";
+                status = -1;
+            }
+        } else {
+            if (violacoes == 0) veredito = "SEM BASE";
+            faltou_base = true;
+            status = -1;
+        }
+
+        printf("%-12s %-14s %10.2f %12.1f %12.1f %10ld %10ld %14.1f %-10s\n",
+               atc_nome_modo(), atc_nome_deteccao(), r.makespan, vazao, vazao_base, v->concessoes,
+               violacoes, v->parada_max_ns / 1e6, veredito);
+        if (violacoes > 0) {
+            printf("             primeira violação: %s\n", v->primeira_violacao);
+        }
+        fflush(stdout);
+    }
+    if (faltou_base) {
+        printf("[BENCH] Sem linha de base para esta configuração e build em %s: grave com --gravar-linha-base\n",
+               arquivo_linha_base);
+    }
+
+    atc_definir_modo(modo_anterior);
+    atc_definir_deteccao(deteccao_anterior);
+    modo_silencioso = silencioso_anterior;
+    return status;
+}
+
+// Cargas oferecidas na varredura, em frações da taxa de referência (mais
+// densas embaixo: a espera em posse do setor satura bem antes da estimativa)
+static const double fracoes_varredura[] = { 0.05, 0.1, 0.15, 0.2, 0.25, 0.3, 0.4, 0.5, 0.6, 0.8, 1.0, 1.25 };
+#define ATENDIMENTO_SATURADO 0.9 // Abaixo disto da demanda de concessões, a fila só cresce
+#define SATURADAS_PARA_PARAR 2   // Pontos saturados seguidos que encerram a varredura
+
+/**
+ * Varredura do regime aberto: roda a carga com chegadas a taxas crescentes e
+ * imprime, para cada carga oferecida, a vazão de concessões sustentada na
+ * janela de medição e os percentis da espera (a curva vazão x latência). A
+ * referência é a taxa de --chegadas ou, sem ela, a capacidade estimada: cada
+ * setor atende um voo médio por vez e cada aeronave pede a rota média.
+ * Tudo em tempo simulado, comparável entre escalas
+ * @param base: Configuração da carga; num_aeronaves é ignorado (sai das chegadas)
+ * @return 0 se todas as execuções terminaram, -1 caso alguma tenha falhado
+ */
+int benchmark_chegadas(const simulacao_config_t *base) {
+    bool silencioso_anterior = modo_silencioso;
+    modo_silencioso = true;
+
+    chegadas_config_t modelo = {
+        .processo = CHEGADAS_POISSON,
+        .duracao = CHEGADAS_DURACAO_PADRAO_S,
+        .aquecimento = CHEGADAS_AQUECIMENTO_PADRAO_S,
+    };
+    if (base->chegadas != NULL) modelo = *base->chegadas;
+
+    double voo_medio_s = (TEMPO_VOO_MIN_MS + (TEMPO_VOO_VARIACAO_MS - 1) / 2.0) / 1000.0;
+    double rota_media = (base->num_setores + 2) / 2.0;
+    double capacidade_estimada = base->num_setores / voo_medio_s / rota_media;
+    double referencia = modelo.taxa > 0 ? modelo.taxa : capacidade_estimada;
+
+    printf("[BENCH] Setores: %d | Semente: %u | Escala de tempo: %dx | Controlador: %s | Chegadas: %s\n",
+           base->num_setores, base->semente, escala_tempo, atc_nome_modo(),
+           chegadas_nome_processo(modelo.processo));
+    printf("[BENCH] Janela: %.0f-%.0f s simulados | Capacidade estimada: %.3f aeronaves/s | Referência: %.3f aeronaves/s\n",
+           modelo.aquecimento, modelo.duracao, capacidade_estimada, referencia);
+    printf("%-10s %10s %12s %12s %12s %10s %10s %13s %12s %10s\n",
+           "taxa(a/s)", "aeronaves", "oferta(c/s)", "vazao(c/s)", "atendida(%)", "p50(ms)",
+           "p99(ms)", "fila(ini>fim)", "drenagem(s)", "saturada");
+
+    int status = 0;
+    int saturadas = 0;
+    double melhor_vazao = 0.0, melhor_taxa = 0.0, melhor_p99 = 0.0;
+    int pontos = sizeof(fracoes_varredura) / sizeof(fracoes_varredura[0]);
+    for (int i = 0; i < pontos && saturadas < SATURADAS_PARA_PARAR; i++) {
+        chegadas_config_t chegadas = modelo;
+        chegadas.taxa = referencia * fracoes_varredura[i];
+        simulacao_config_t config = *base;
+        config.chegadas = &chegadas;
+
+        simulacao_resultado_t r;
+        if (simulacao_executar(&config, &r) != 0) {
+            printf("%-10.3f %10s\n", chegadas.taxa, "FALHOU");
+            status = -1;
+            continue;
+        }
+
+        // Demanda de concessões: aeronaves que chegaram na janela vezes a rota média
+        double oferta = r.chegadas.taxa_efetiva * r.chegadas.trechos_por_aeronave;
+        double atendida = oferta > 0 ? r.vazao_sustentada / oferta : 0.0;
+        bool saturada = atendida < ATENDIMENTO_SATURADO;
+        saturadas = saturada ? saturadas + 1 : 0;
+        if (!saturada && r.vazao_sustentada > melhor_vazao) {
+            melhor_vazao = r.vazao_sustentada;
+            melhor_taxa = chegadas.taxa;
+            melhor_p99 = r.espera_p99 * escala_tempo;
+        }
+
+        char fila[32];
+        snprintf(fila, sizeof(fila), "%d>%d", r.chegadas.em_sistema_inicio, r.chegadas.em_sistema_fim);
+        printf("%-10.3f %10d %12.2f %12.2f %12.1f %10.1f %10.1f %13s %12.1f %10s\n",
+               chegadas.taxa, r.chegadas.aeronaves, oferta, r.vazao_sustentada, 100.0 * atendida,
+               r.espera_p50 * escala_tempo, r.espera_p99 * escala_tempo, fila, r.chegadas.drenagem,
+               saturada ? "sim" : "nao");
+        fflush(stdout);
+    }
+
+    if (melhor_vazao > 0) {
+        printf("\nMaior vazão sustentada sem saturar: %.2f concessões/s a %.3f aeronaves/s (p99 %.1f ms)\n",
+               melhor_vazao, melhor_taxa, melhor_p99);
+    } else {
+        printf("\nNenhuma carga da varredura ficou abaixo da saturação\n");
+    }
+    modo_silencioso = silencioso_anterior;
+    return status;
+}
+
+#define FRACAO_EMERGENCIAS_PADRAO 0.01 // Parte da frota em emergência sem --emergencias
+
+/**
+ * Compara a classe de emergência com e sem o corredor de preempção na mesma
+ * carga fechada (saturada: a frota inteira na largada). Imprime a espera das
+ * emergências até o p99.9 ao lado do limite que o corredor promete: cada
+ * emergência espera no máximo um voo para cada emergência à frente no
+ * corredor do setor, sem depender da fila comum
+ * @param base: Configuração da carga (a fração vem de --emergencias ou é 1%)
+ * @return 0 se todas as execuções terminaram, -1 caso alguma tenha falhado
+ */
+int benchmark_emergencias(const simulacao_config_t *base) {
+    bool silencioso_anterior = modo_silencioso;
+    double fracao_anterior = atc_fracao_emergencias();
+    double fracao = fracao_anterior > 0 ? fracao_anterior : FRACAO_EMERGENCIAS_PADRAO;
+    modo_silencioso = true;
+    atc_definir_emergencias(fracao);
+
+    double voo_max_ms = (double)(TEMPO_VOO_MIN_MS + TEMPO_VOO_VARIACAO_MS) / escala_tempo;
+    printf("[BENCH] Setores: %d | Aeronaves: %d | Semente: %u | Escala de tempo: %dx | Controlador: %s | Emergências: %.1f%%\n",
+           base->num_setores, base->num_aeronaves, base->semente, escala_tempo, atc_nome_modo(), 100.0 * fracao);
+    printf("[BENCH] Limite com o corredor: %.2f ms (um voo máximo) por emergência à frente no mesmo setor,\n"
+           "        mais %.2f ms até o ocupante em voo devolver o setor no fim do trecho\n",
+           voo_max_ms, voo_max_ms);
+    printf("%-10s %10s %12s %10s %11s %10s %10s %10s %11s %10s %11s\n",
+           "corredor", "tempo(s)", "vazao(c/s)", "p99(ms)", "p99.9(ms)", "emerg.", "e.p50(ms)",
+           "e.p99(ms)", "e.p99.9(ms)", "e.max(ms)", "preempcoes");
+
+    int status = 0;
+    const char *modos[] = { "desligado", "ligado" };
+    for (int i = 0; i < 2; i++) {
+        atc_definir_preempcao(i == 1);
+
+        simulacao_resultado_t r;
+        if (simulacao_executar(base, &r) != 0) {
+            printf("%-10s %10s\n", modos[i], "FALHOU");
+            status = -1;
+            continue;
+        }
+        const espera_estatisticas_t *e = &r.espera;
+        printf("%-10s %10.2f %12.1f %10.2f %11.2f %10ld %10.2f %10.2f %11.2f %10.2f %11d\n",
+               modos[i], r.tempo_total, r.vazao, r.espera_p99, e->concessao_p999, e->emergencias,
+               e->emergencia_p50, e->emergencia_p99, e->emergencia_p999, e->emergencia_max, r.preempcoes);
+        fflush(stdout);
+    }
+
+    atc_definir_preempcao(true);
+    atc_definir_emergencias(fracao_anterior);
+    modo_silencioso = silencioso_anterior;
+    return status;
+}
+
+/**
+ * Executa a mesma carga sem medição e com os critérios fila e taxa: a
+ * retenção em solo deve trocar recuos e esperas segurando setores por
+ * esperas antes da decolagem
+ * @param base: Configuração da carga (o critério da linha de comando entra por último)
+ * @return 0 se todas as execuções terminaram, -1 caso alguma tenha falhado
+ */
+int benchmark_medicao(const simulacao_config_t *base) {
+    bool silencioso_anterior = modo_silencioso;
+    char anterior[48];
+    snprintf(anterior, sizeof(anterior), "%s", medicao_nome());
+    modo_silencioso = true;
+
+    printf("[BENCH] Setores: %d | Aeronaves: %d (%.1f por setor) | Semente: %u | Escala de tempo: %dx | Controlador: %s\n",
+           base->num_setores, base->num_aeronaves, (double)base->num_aeronaves / base->num_setores,
+           base->semente, escala_tempo, atc_nome_modo());
+    printf("%-14s %10s %12s %10s %10s %9s %10s %11s\n", "medicao", "tempo(s)", "vazao(c/s)",
+           "p99(ms)", "deadlocks", "recuos", "retidos", "ret.med(ms)");
+
+    const char *criterios[] = { "desligada", "fila:1", "fila:2", "taxa", anterior };
+    int total = 4;
+    bool repetido = false;
+    for (int i = 0; i < total; i++) {
+        medicao_definir(criterios[i]);
+        if (strcmp(medicao_nome(), anterior) == 0) repetido = true;
+    }
+    if (!repetido) total++; // Critério da linha de comando fora da lista
+
+    int status = 0;
+    for (int i = 0; i < total; i++) {
+        medicao_definir(criterios[i]);
+
+        simulacao_resultado_t r;
+        if (simulacao_executar(base, &r) != 0) {
+            printf("%-14s %10s\n", medicao_nome(), "FALHOU");
+            status = -1;
+            continue;
+        }
+        printf("%-14s %10.2f %12.1f %10.2f %10d %9d %10ld %11.1f\n",
+               medicao_nome(), r.tempo_total, r.vazao, r.espera_p99, r.deadlocks, r.recuos,
+               r.retencoes, r.retencao_media);
+        fflush(stdout);
+    }
+
+    medicao_definir(anterior);
+    modo_silencioso = silencioso_anterior;
+    return status;
+}
+
+/**
+ * Executa a mesma carga com cada aeronave dormindo no kernel e com a roda de
+ * tempo (na tolerância da linha de comando, ou na padrão, e 10 vezes menor):
+ * temporizadores armados, trocas de contexto e atraso dos despertares
+ * @param base: Configuração da carga
+ * @return 0 se todas as execuções terminaram, -1 caso alguma tenha falhado
+ */
+int benchmark_temporizador(const simulacao_config_t *base) {
+    bool silencioso_anterior = modo_silencioso;
+    char anterior[32];
+    snprintf(anterior, sizeof(anterior), "%s", temporizador_nome());
+    modo_silencioso = true;
+
+    int tolerancia_us = TEMPORIZADOR_TOLERANCIA_PADRAO_US;
+    if (strncmp(anterior, "roda:", 5) == 0) tolerancia_us = atoi(anterior + 5);
+    char roda[32], roda_fina[32];
+    snprintf(roda, sizeof(roda), "roda:%d", tolerancia_us);
+    snprintf(roda_fina, sizeof(roda_fina), "roda:%d", tolerancia_us / 10 > 0 ? tolerancia_us / 10 : 1);
+
+    printf("[BENCH] Setores: %d | Aeronaves: %d | Semente: %u | Escala de tempo: %dx | Controlador: %s\n",
+           base->num_setores, base->num_aeronaves, base->semente, escala_tempo, atc_nome_modo());
+    printf("%-14s %10s %12s %10s %10s %11s %12s %13s %13s %11s\n", "temporizador", "tempo(s)", "vazao(c/s)",
+           "p99(ms)", "sonos", "no_kernel", "trocas_ctx", "atraso_med(us)", "atraso_max(us)", "por_tick");
+
+    const char *modos[] = { "nanosleep", roda, roda_fina };
+    int status = 0;
+    for (int i = 0; i < 3; i++) {
+        temporizador_definir(modos[i]);
+
+        simulacao_resultado_t r;
+        if (simulacao_executar(base, &r) != 0) {
+            printf("%-14s %10s\n", temporizador_nome(), "FALHOU");
+            status = -1;
+            continue;
+        }
+        printf("%-14s %10.2f %12.1f %10.2f %10ld %11ld %12ld %13.1f %13.1f %11.1f\n",
+               temporizador_nome(), r.tempo_total, r.vazao, r.espera_p99, r.sono.sonos, r.sono.armados,
+               r.trocas_contexto, r.sono.atraso_medio_us, r.sono.atraso_max_us, r.sono.por_lote);
+        fflush(stdout);
+    }
+
+    temporizador_definir(anterior);
+    modo_silencioso = silencioso_anterior;
+    return status;
+}
+
+/**
+ * Executa a mesma carga sem e com herança de prioridade. Com herança, quem
+ * ocupa um setor disputado voa na prioridade do melhor que o espera, então a
+ * cauda das aeronaves de prioridade alta (originais a partir de
+ * ESPERA_PRIORIDADE_ALTA) deve encurtar sem mexer muito na vazão
+ * @param base: Configuração da carga
+ * @return 0 se todas as execuções terminaram, -1 caso alguma tenha falhado
+ */
+int benchmark_heranca(const simulacao_config_t *base) {
+    bool silencioso_anterior = modo_silencioso;
+    bool heranca_anterior = atc_heranca_ligada();
+    modo_silencioso = true;
+
+    printf("[BENCH] Setores: %d | Aeronaves: %d | Semente: %u | Escala de tempo: %dx | Controlador: %s | Política: %s\n",
+           base->num_setores, base->num_aeronaves, base->semente, escala_tempo, atc_nome_modo(),
+           base->politica->nome);
+    printf("%-10s %10s %12s %10s %8s %10s %10s %11s %10s %9s %9s\n",
+           "heranca", "tempo(s)", "vazao(c/s)", "p99(ms)", "altas", "a.p50(ms)", "a.p99(ms)",
+           "a.p99.9(ms)", "deadlocks", "recuos", "herancas");
+
+    int status = 0;
+    const char *modos[] = { "desligada", "ligada" };
+    for (int i = 0; i < 2; i++) {
+        atc_definir_heranca(i == 1);
+
+        simulacao_resultado_t r;
+        if (simulacao_executar(base, &r) != 0) {
+            printf("%-10s %10s\n", modos[i], "FALHOU");
+            status = -1;
+            continue;
+        }
+        const espera_estatisticas_t *e = &r.espera;
+        printf("%-10s %10.2f %12.1f %10.2f %8ld %10.2f %10.2f %11.2f %10d %9d %9ld\n",
+               modos[i], r.tempo_total, r.vazao, r.espera_p99, e->altas, e->alta_p50, e->alta_p99,
+               e->alta_p999, r.deadlocks, r.recuos, r.herancas);
+        fflush(stdout);
+    }
+
+    atc_definir_heranca(heranca_anterior);
+    modo_silencioso = silencioso_anterior;
+    return status;
+}
+
+/**
+ * Cria a frota da carga sem disparar as threads e mede a memória por
+ * aeronave: estrutura, vista por id e rota compacta na arena, e o RSS que a
+ * criação acrescentou (pilhas das threads não entram)
+ * @param base: Configuração da carga (setores, aeronaves e semente)
+ * @return 0 em caso de sucesso, -1 se a frota não pôde ser criada
+ */
+int benchmark_memoria(const simulacao_config_t *base) {
+    int n = base->num_aeronaves;
+    bool silencioso_anterior = modo_silencioso;
+    modo_silencioso = true;
+    srand(base->semente);
+    atc_init(base->num_setores, n);
+
+    long rss_antes = memoria_rss_kb();
+    long long inicio_ns = relogio_agora_ns();
+    frota_t frota;
+    if (frota_criar(&frota, n, base->num_setores) != 0) {
+        fprintf(stderr, "Erro ao criar a frota de %d aeronaves\n", n);
+        atc_finalizar();
+        modo_silencioso = silencioso_anterior;
+        return -1;
+    }
+    double criacao_ms = (relogio_agora_ns() - inicio_ns) / 1e6;
+    long rss_depois = memoria_rss_kb();
+
+    long trechos = 0;
+    for (int i = 0; i < n; i++) {
+        trechos += frota.aeronaves[i].comprimento_rota;
+    }
+    size_t tamanho_trecho = aeronave_tamanho_trecho(base->num_setores);
+
+    printf("[BENCH] Setores: %d | Aeronaves: %d | Semente: %u | Trechos por rota: %.2f (%zu bytes cada)\n",
+           base->num_setores, n, base->semente, (double)trechos / n, tamanho_trecho);
+    printf("%-22s %12s\n", "memoria", "bytes/aeronave");
+    printf("%-22s %12zu\n", "aeronave_t", sizeof(aeronave_t));
+    printf("%-22s %12zu\n", "vista por id", sizeof(aeronave_t *));
+    printf("%-22s %12.1f\n", "rota compacta", (double)trechos * tamanho_trecho / n);
+    printf("%-22s %12.1f\n", "arena (total)", (double)frota.tamanho_arena / n);
+    printf("%-22s %12.1f\n", "RSS da criacao", (rss_depois - rss_antes) * 1024.0 / n);
+    printf("[BENCH] Frota criada em %.1f ms numa única alocação de %.1f MB\n",
+           criacao_ms, frota.tamanho_arena / (1024.0 * 1024.0));
+
+    frota_destruir(&frota);
+    atc_finalizar();
+    modo_silencioso = silencioso_anterior;
+    return 0;
+}
+
+#define CHAMADAS_RELOGIO 2000000
+
+static volatile long long sumidouro_relogio; // Impede o compilador de descartar as leituras
+
+/**
+ * Timestamp de log como era antes do módulo de relógio (gettimeofday + localtime)
+ */
+static void timestamp_legado(char *destino, size_t tamanho) {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    time_t agora = tv.tv_sec;
+    struct tm *tm_info = localtime(&agora);
+    snprintf(destino, tamanho, "[%02d:%02d:%02d.%06ld] ",
+             tm_info->tm_hour, tm_info->tm_min, tm_info->tm_sec, (long)tv.tv_usec);
+}
+
+static long long leitura_monotonic() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static long long leitura_realtime() {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/**
+ * Mede o custo médio de uma leitura de relógio
+ * @return Nanossegundos por chamada
+ */
+static double medir_leitura(long long (*ler)()) {
+    long long inicio = relogio_monotonico_raw_ns();
+    long long soma = 0;
+    for (int i = 0; i < CHAMADAS_RELOGIO; i++) {
+        soma ^= ler();
+    }
+    sumidouro_relogio = soma;
+    return (double)(relogio_monotonico_raw_ns() - inicio) / CHAMADAS_RELOGIO;
+}
+
+/**
+ * Mede o custo médio de formatar um timestamp de log
+ * @return Nanossegundos por chamada
+ */
+static double medir_timestamp(void (*formatar)(char *, size_t)) {
+    char timestamp[64];
+    long long inicio = relogio_monotonico_raw_ns();
+    long long soma = 0;
+    for (int i = 0; i < CHAMADAS_RELOGIO; i++) {
+        formatar(timestamp, sizeof(timestamp));
+        soma ^= timestamp[15];
+    }
+    sumidouro_relogio = soma;
+    return (double)(relogio_monotonico_raw_ns() - inicio) / CHAMADAS_RELOGIO;
+}
+
+/**
+ * Compara o custo por chamada das leituras de tempo e do timestamp de log
+ * antigos com os do módulo de relógio
+ * @return 0 sempre
+ */
+int benchmark_relogio() {
+    printf("[BENCH] Relógio: fonte %s | %d chamadas por medida\n", relogio_nome_fonte(), CHAMADAS_RELOGIO);
+    printf("%-42s %12s\n", "operacao", "ns/chamada");
+    printf("%-42s %12.1f\n", "timestamp legado (gettimeofday+localtime)", medir_timestamp(timestamp_legado));
+    printf("%-42s %12.1f\n", "relogio_formatar_timestamp (cache)", medir_timestamp(relogio_formatar_timestamp));
+    printf("%-42s %12.1f\n", "clock_gettime(CLOCK_REALTIME)", medir_leitura(leitura_realtime));
+    printf("%-42s %12.1f\n", "clock_gettime(CLOCK_MONOTONIC)", medir_leitura(leitura_monotonic));
+    printf("%-42s %12.1f\n", "clock_gettime(CLOCK_MONOTONIC_RAW)", medir_leitura(relogio_monotonico_raw_ns));
+    printf("%-42s %12.1f\n", "relogio_agora_ns", medir_leitura(relogio_agora_ns));
+    return 0;
+}
+
+#define MICRO_LOTE 16        // Operações entre duas leituras do relógio
+#define MICRO_MEDIDA_MS 20   // Tempo mínimo medido em cada linha
+
+static const int micro_profundidades[] = { 1, 8, 64, 512 };
+static const int micro_cadeias[] = { 1, 4, 16, 64, 256 };
+static volatile long micro_sumidouro; // Impede o compilador de descartar os resultados
+
+/**
+ * Imprime uma linha CSV do microbenchmark
+ */
+static void micro_imprimir(const char *operacao, const char *contexto, int tamanho, long long ns, long operacoes) {
+    printf("%s,%s,%s,%d,%.1f,%ld\n", VARIANTE_BUILD, operacao, contexto, tamanho,
+           operacoes > 0 ? (double)ns / operacoes : 0.0, operacoes);
+}
+
+/**
+ * Mede fila_inserir, fila_remover_aeronave e fila_remover numa fila mantida
+ * com uma profundidade: cada lote insere MICRO_LOTE aeronaves extras e as
+ * retira do meio, depois tira MICRO_LOTE da cabeça e as devolve (fora da medida)
+ * @param politica: Política da fila
+ * @param aeronaves: profundidade + MICRO_LOTE aeronaves
+ * @param profundidade: Aeronaves na fila antes de cada lote
+ */
+static void micro_fila(const politica_fila_t *politica, aeronave_t *aeronaves, int profundidade) {
+    fila_prioridade_t fila;
+    fila_inicializar(&fila);
+    fila_definir_politica(&fila, politica);
+    for (int i = 0; i < profundidade; i++) {
+        fila_inserir(&fila, &aeronaves[i]);
+    }
+    aeronave_t *extras = &aeronaves[profundidade];
+    aeronave_t *cabeca[MICRO_LOTE];
+    long long ns_inserir = 0, ns_remover_aeronave = 0, ns_remover = 0;
+    long lotes = 0;
+    long long fim = relogio_monotonico_raw_ns() + MICRO_MEDIDA_MS * 1000000LL;
+    long soma = 0;
+
+    while (relogio_monotonico_raw_ns() < fim) {
+        long long t0 = relogio_monotonico_raw_ns();
+        for (int k = 0; k < MICRO_LOTE; k++) {
+            fila_inserir(&fila, &extras[k]);
+        }
+        long long t1 = relogio_monotonico_raw_ns();
+        for (int k = 0; k < MICRO_LOTE; k++) {
+            soma += fila_remover_aeronave(&fila, &extras[(k * 7) % MICRO_LOTE]); // 7 é primo com o lote
+        }
+        long long t2 = relogio_monotonico_raw_ns();
+        for (int k = 0; k < MICRO_LOTE; k++) {
+            cabeca[k] = fila_remover(&fila);
+        }
+        long long t3 = relogio_monotonico_raw_ns();
+        for (int k = 0; k < MICRO_LOTE; k++) {
+            if (cabeca[k] != NULL) fila_inserir(&fila, cabeca[k]);
+        }
+        ns_inserir += t1 - t0;
+        ns_remover_aeronave += t2 - t1;
+        ns_remover += t3 - t2;
+        lotes++;
+    }
+    micro_sumidouro = soma;
+    fila_destruir(&fila);
+
+    micro_imprimir("fila_inserir", politica->nome, profundidade, ns_inserir, lotes * MICRO_LOTE);
+    micro_imprimir("fila_remover_aeronave", politica->nome, profundidade, ns_remover_aeronave, lotes * MICRO_LOTE);
+    micro_imprimir("fila_remover", politica->nome, profundidade, ns_remover, lotes * MICRO_LOTE);
+}
+
+/**
+ * Mede verificar_deadlock numa cadeia de espera sem ciclo: A0..A(n-1)
+ * ocupam S0..S(n-1), cada Ai aguarda S(i+1) e a última não aguarda nada; o
+ * solicitante ocupa Sn e pede S0, percorrendo a cadeia inteira
+ * @param comprimento: Aeronaves na cadeia
+ * @return 0 em caso de sucesso, -1 se a frota não pôde ser criada
+ */
+static int micro_cadeia(int comprimento) {
+    int n = comprimento + 1;
+    atc_init(n, n);
+    frota_t frota;
+    if (frota_criar(&frota, n, n) != 0) {
+        fprintf(stderr, "Erro ao criar a frota de %d aeronaves\n", n);
+        atc_finalizar();
+        return -1;
+    }
+    aeronave_t *solicitante = &frota.aeronaves[comprimento];
+    for (int i = 0; i < n; i++) {
+        atc_solicitar_setor(&frota.aeronaves[i], i);
+    }
+    for (int i = 0; i + 1 < comprimento; i++) {
+        atc_simular_espera(&frota.aeronaves[i], i + 1);
+    }
+
+    long long ns = 0;
+    long operacoes = 0;
+    long soma = 0;
+    long long fim = relogio_monotonico_raw_ns() + MICRO_MEDIDA_MS * 1000000LL;
+    while (relogio_monotonico_raw_ns() < fim) {
+        long long t0 = relogio_monotonico_raw_ns();
+        for (int k = 0; k < MICRO_LOTE; k++) {
+            soma += verificar_deadlock(solicitante, 0);
+        }
+        ns += relogio_monotonico_raw_ns() - t0;
+        operacoes += MICRO_LOTE;
+    }
+    micro_sumidouro = soma;
+    micro_imprimir("verificar_deadlock", "cadeia", comprimento, ns, operacoes);
+
+    for (int i = 0; i < n; i++) {
+        atc_simular_espera(&frota.aeronaves[i], -1);
+        atc_deixar_setor(&frota.aeronaves[i]);
+    }
+    frota_destruir(&frota);
+    atc_finalizar();
+    return 0;
+}
+
+/**
+ * Mede o par atc_solicitar_setor + atc_deixar_setor sem disputa (uma
+ * aeronave, setor sempre livre) num modo do controlador
+ * @param modo: Nome do modo (atc_definir_modo)
+ * @return 0 em caso de sucesso, -1 se a frota não pôde ser criada
+ */
+static int micro_par(const char *modo) {
+    atc_definir_modo(modo);
+    atc_init(2, 1);
+    frota_t frota;
+    if (frota_criar(&frota, 1, 2) != 0) {
+        fprintf(stderr, "Erro ao criar a frota de 1 aeronave\n");
+        atc_finalizar();
+        return -1;
+    }
+    aeronave_t *a = &frota.aeronaves[0];
+
+    long long ns = 0;
+    long operacoes = 0;
+    long long fim = relogio_monotonico_raw_ns() + MICRO_MEDIDA_MS * 1000000LL;
+    while (relogio_monotonico_raw_ns() < fim) {
+        long long t0 = relogio_monotonico_raw_ns();
+        for (int k = 0; k < MICRO_LOTE; k++) {
+            atc_solicitar_setor(a, 0);
+            atc_deixar_setor(a);
+        }
+        ns += relogio_monotonico_raw_ns() - t0;
+        operacoes += MICRO_LOTE;
+    }
+    micro_imprimir("solicitar_e_deixar", atc_nome_modo(), 1, ns, operacoes);
+
+    frota_destruir(&frota);
+    atc_finalizar();
+    return 0;
+}
+
+static const int micro_setores[] = { 1024, 65536, 1048576 };
+
+#define MICRO_CANDIDATOS 64 // Candidatos de ocupacao_menos_carregados
+#define MICRO_K 4
+
+// Mapa das consultas de ocupação: o índice (ocupacao.h) e, para comparar, o
+// mesmo estado num int por setor, como setores_ocupados
+static int *micro_ocupante = NULL;
+static int micro_total_setores = 0;
+static int micro_candidatos[MICRO_CANDIDATOS];
+
+static long micro_contar_bitmap() {
+    return ocupacao_livres(1, micro_total_setores);
+}
+
+static long micro_contar_int() {
+    long livres = 0;
+    for (int s = 1; s < micro_total_setores; s++) {
+        livres += micro_ocupante[s] == -1;
+    }
+    return livres;
+}
+
+static long micro_primeiro_bitmap() {
+    return ocupacao_primeiro_livre(0, micro_total_setores);
+}
+
+static long micro_primeiro_int() {
+    for (int s = 0; s < micro_total_setores; s++) {
+        if (micro_ocupante[s] == -1) return s;
+    }
+    return -1;
+}
+
+static long micro_menos_carregados() {
+    int saida[MICRO_K];
+    return ocupacao_menos_carregados(micro_candidatos, MICRO_CANDIDATOS, MICRO_K, saida) + saida[0];
+}
+
+/**
+ * Mede uma consulta de ocupação e imprime a linha CSV
+ */
+static void micro_consulta(const char *operacao, const char *contexto, long (*consulta)()) {
+    long long ns = 0;
+    long operacoes = 0;
+    long soma = 0;
+    long long fim = relogio_monotonico_raw_ns() + MICRO_MEDIDA_MS * 1000000LL;
+    while (relogio_monotonico_raw_ns() < fim) {
+        long long t0 = relogio_monotonico_raw_ns();
+        for (int k = 0; k < MICRO_LOTE; k++) {
+            soma += consulta();
+        }
+        ns += relogio_monotonico_raw_ns() - t0;
+        operacoes += MICRO_LOTE;
+    }
+    micro_sumidouro = soma;
+    micro_imprimir(operacao, contexto, micro_total_setores, ns, operacoes);
+}
+
+/**
+ * Mede as consultas do índice de ocupação contra a varredura de um int por
+ * setor: contagem de livres com 90% dos setores ocupados, primeiro livre com
+ * só o último setor livre (pior caso da varredura) e os k menos carregados
+ * entre candidatos sorteados
+ * @param setores: Setores no mapa
+ * @return 0 em caso de sucesso, -1 sem memória
+ */
+static int micro_ocupacao(int setores) {
+    micro_ocupante = malloc(sizeof(int) * setores);
+    if (micro_ocupante == NULL || !ocupacao_inicializar(setores)) {
+        fprintf(stderr, "Erro ao alocar o mapa de %d setores\n", setores);
+        free(micro_ocupante);
+        micro_ocupante = NULL;
+        return -1;
+    }
+    micro_total_setores = setores;
+    for (int s = 0; s < setores; s++) {
+        micro_ocupante[s] = -1;
+        if (rand() % 10 == 0) continue;
+        micro_ocupante[s] = s;
+        ocupacao_ocupar(s);
+        for (int f = rand() % 8; f > 0; f--) {
+            ocupacao_enfileirar(s);
+        }
+    }
+    for (int i = 0; i < MICRO_CANDIDATOS; i++) {
+        micro_candidatos[i] = rand() % setores;
+    }
+    micro_consulta("ocupacao_livres", "bitmap", micro_contar_bitmap);
+    micro_consulta("ocupacao_livres", "int", micro_contar_int);
+    micro_consulta("ocupacao_menos_carregados", "k4_de_64", micro_menos_carregados);
+
+    for (int s = 0; s < setores; s++) {
+        micro_ocupante[s] = s;
+        ocupacao_ocupar(s);
+    }
+    micro_ocupante[setores - 1] = -1;
+    ocupacao_liberar(setores - 1);
+    micro_consulta("ocupacao_primeiro_livre", "bitmap", micro_primeiro_bitmap);
+    micro_consulta("ocupacao_primeiro_livre", "int", micro_primeiro_int);
+
+    ocupacao_finalizar();
+    free(micro_ocupante);
+    micro_ocupante = NULL;
+    return 0;
+}
+
+/**
+ * Microbenchmarks das primitivas do controlador, fora de qualquer simulação:
+ * operações da fila por política e profundidade, verificar_deadlock por
+ * comprimento da cadeia de espera, o par pedir/deixar setor em cada modo e as
+ * consultas do índice de ocupação por número de setores.
+ * Saída em CSV (build,operacao,contexto,tamanho,ns_op,operacoes) para
+ * comparar versões de fila_prioridade.c e controlador.c
+ * @return 0 se todas as medidas rodaram, -1 caso alguma tenha falhado
+ */
+int benchmark_micro() {
+    bool silencioso_anterior = modo_silencioso;
+    modo_silencioso = true;
+    srand(1);
+    int status = 0;
+    printf("build,operacao,contexto,tamanho,ns_op,operacoes\n");
+
+    int maior = micro_profundidades[sizeof(micro_profundidades) / sizeof(micro_profundidades[0]) - 1];
+    atc_init(1, maior + MICRO_LOTE);
+    frota_t frota;
+    if (frota_criar(&frota, maior + MICRO_LOTE, 1) != 0) {
+        fprintf(stderr, "Erro ao criar a frota de %d aeronaves\n", maior + MICRO_LOTE);
+        atc_finalizar();
+        modo_silencioso = silencioso_anterior;
+        return -1;
+    }
+    for (int p = 0; p < total_politicas; p++) {
+        for (size_t d = 0; d < sizeof(micro_profundidades) / sizeof(micro_profundidades[0]); d++) {
+            micro_fila(politicas_disponiveis[p], frota.aeronaves, micro_profundidades[d]);
+        }
+        fflush(stdout);
+    }
+    frota_destruir(&frota);
+    atc_finalizar();
+
+    for (size_t c = 0; c < sizeof(micro_cadeias) / sizeof(micro_cadeias[0]); c++) {
+        if (micro_cadeia(micro_cadeias[c]) != 0) status = -1;
+    }
+    fflush(stdout);
+
+    char modo_anterior[16];
+    snprintf(modo_anterior, sizeof(modo_anterior), "%s", atc_nome_modo());
+    if (micro_par("travas") != 0) status = -1;
+    if (micro_par("central") != 0) status = -1;
+    atc_definir_modo(modo_anterior);
+    fflush(stdout);
+
+    for (size_t t = 0; t < sizeof(micro_setores) / sizeof(micro_setores[0]); t++) {
+        if (micro_ocupacao(micro_setores[t]) != 0) status = -1;
+    }
+
+    modo_silencioso = silencioso_anterior;
+    return status;
+}
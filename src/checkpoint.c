@@ -0,0 +1,327 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+#include "../include/checkpoint.h"
+#include "../include/controlador.h"
+#include "../include/relogio.h"
+#include "../include/utils.h"
+
+#define CHECKPOINT_INTERVALO_VARREDURA_NS 200000 // Entre varreduras enquanto alguém ainda está em trânsito
+
+// Estado salvo de uma aeronave (tamanho fixo; rota e prioridade original
+// saem da semente e são conferidas pela soma do cabeçalho)
+typedef struct {
+    int32_t posicao_rota;
+    int32_t setor_atual;
+    uint32_t prioridade;          // Efetiva, com boost
+    uint32_t semente;             // Gerador dos tempos de voo
+    int32_t contador_recuos;
+    int32_t contador_esperas_longas;
+    int64_t tempo_ns;             // Voando: voo restante; pedindo: espera já feita (ns simulados)
+    espera_agregada_t espera;
+    int32_t fase;
+    uint8_t recuo_recente;
+    uint8_t reservado[3];
+} registro_aeronave_t;
+
+// Pausa pedida pelo checkpoint: as aeronaves que chegam a um ponto seguro dormem aqui
+static _Atomic bool pausa = false;
+static pthread_mutex_t mutex_pausa = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond_pausa = PTHREAD_COND_INITIALIZER;
+
+/**
+ * Destrava mutex_pausa se a aeronave for cancelada dormindo na pausa
+ */
+static void checkpoint_soltar_pausa(void *arg) {
+    (void)arg;
+    pthread_mutex_unlock(&mutex_pausa);
+}
+
+/**
+ * Ponto em que uma aeronave pode ser segurada por um checkpoint. Publica a
+ * fase seguinte e só então confere a pausa (as duas operações com ordem
+ * sequencial, como a gravação faz no sentido oposto): ou a aeronave vê a
+ * pausa e para, ou a gravação vê a fase nova e espera por ela
+ * @param a: Aeronave em execução
+ * @param fase_seguinte: Fase em que a aeronave segue se não houver pausa
+ * @param fase_parada: Fase publicada enquanto dorme na pausa
+ */
+void checkpoint_ponto_seguro(aeronave_t *a, fase_aeronave_t fase_seguinte, fase_aeronave_t fase_parada) {
+    atomic_store(&a->fase, fase_seguinte);
+    while (atomic_load(&pausa)) {
+        pthread_mutex_lock(&mutex_pausa);
+        pthread_cleanup_push(checkpoint_soltar_pausa, NULL);
+        atomic_store(&a->fase, fase_parada);
+        while (atomic_load(&pausa)) {
+            pthread_cond_wait(&cond_pausa, &mutex_pausa);
+        }
+        pthread_cleanup_pop(1);
+        atomic_store(&a->fase, fase_seguinte);
+    }
+}
+
+/**
+ * Encerra a pausa e acorda as aeronaves seguradas
+ */
+static void checkpoint_soltar_frota() {
+    pthread_mutex_lock(&mutex_pausa);
+    atomic_store(&pausa, false);
+    pthread_cond_broadcast(&cond_pausa);
+    pthread_mutex_unlock(&mutex_pausa);
+}
+
+/**
+ * Soma FNV-1a das rotas e prioridades originais: a frota recriada pela
+ * semente precisa ser a mesma que foi gravada
+ */
+static uint64_t checkpoint_somar_rotas(const frota_t *frota) {
+    uint64_t soma = 14695981039346656037ULL;
+    for (int i = 0; i < frota->tamanho; i++) {
+        const aeronave_t *a = &frota->aeronaves[i];
+        uint32_t valores[2] = {a->prioridade_original, (uint32_t)a->comprimento_rota};
+        for (int v = 0; v < 2; v++) {
+            soma = (soma ^ valores[v]) * 1099511628211ULL;
+        }
+        for (int t = 0; t < a->comprimento_rota; t++) {
+            soma = (soma ^ (uint32_t)aeronave_trecho(a, t)) * 1099511628211ULL;
+        }
+    }
+    return soma;
+}
+
+/**
+ * Lê o estado de uma aeronave, se ela estiver parada
+ * Deve ser chamada entre atc_congelar e atc_descongelar
+ * @param a: Aeronave da frota (NULL se a thread não iniciou)
+ * @param agora_ns: Instante da varredura
+ * @param r: Recebe o registro
+ * @return false se a aeronave está em trânsito e a varredura precisa ser refeita
+ */
+static bool checkpoint_ler_aeronave(const aeronave_t *a, long long agora_ns, registro_aeronave_t *r) {
+    memset(r, 0, sizeof(*r));
+    r->setor_atual = -1;
+    if (a == NULL) {
+        r->fase = FASE_CONCLUIDA;
+        return true;
+    }
+
+    int fase = atomic_load(&a->fase);
+    r->fase = fase;
+    r->prioridade = atc_prioridade_propria(a);
+    r->semente = a->semente;
+    if (fase == FASE_LARGADA) return true; // Ainda não escreveu nada além do que a criação deixou
+
+    switch (fase) {
+    case FASE_ENTRE_TRECHOS:
+        return false;
+    case FASE_PEDINDO:
+        // Na fila, o pedido está inteiro no controlador; fora dela, ainda chega ou já sai
+        if (atc_fila_da_aeronave(a->id) < 0) return false;
+        r->tempo_ns = (agora_ns - a->instante_solicitacao_ns) * escala_tempo;
+        break;
+    case FASE_VOANDO:
+        r->tempo_ns = a->fim_voo_ns > agora_ns ? (a->fim_voo_ns - agora_ns) * escala_tempo : 0;
+        break;
+    default:
+        break;
+    }
+    r->posicao_rota = a->posicao_rota;
+    r->setor_atual = a->setor_atual;
+    r->contador_recuos = a->contador_recuos;
+    r->contador_esperas_longas = a->contador_esperas_longas;
+    r->espera = a->espera;
+    r->recuo_recente = a->recuo_recente;
+    return true;
+}
+
+/**
+ * Grava um checkpoint da execução em andamento. Segura a frota nos pontos
+ * seguros, varre as aeronaves sob mutex_ctrl até encontrar todas paradas,
+ * copia o estado do controlador para a memória e solta a frota antes de
+ * escrever o arquivo (num temporário renomeado no fim: um checkpoint
+ * interrompido não estraga o anterior)
+ * @param caminho: Arquivo de destino
+ * @param frota: Frota em execução
+ * @param modelo: Cabeçalho com a configuração da execução; instante_simulado_ns
+ *                é o tempo já acumulado na largada (0 numa execução nova)
+ * @param largada_ns: relogio_agora_ns da largada desta execução
+ * @param medidas: Recebe os tempos da gravação (pode ser NULL)
+ * @return true se o arquivo foi gravado
+ */
+bool checkpoint_gravar(const char *caminho, frota_t *frota, const checkpoint_cabecalho_t *modelo,
+                       long long largada_ns, checkpoint_medidas_t *medidas) {
+    registro_aeronave_t *registros = malloc(sizeof(registro_aeronave_t) * frota->tamanho);
+    if (registros == NULL) {
+        perror("malloc checkpoint");
+        return false;
+    }
+    checkpoint_cabecalho_t cabecalho = *modelo;
+    char *estado = NULL;
+    size_t tamanho_estado = 0;
+    contadores_t contadores;
+    int tentativas = 0;
+    bool copiado = false;
+
+    long long inicio_ns = relogio_agora_ns();
+    atomic_store(&pausa, true);
+    while (!copiado) {
+        tentativas++;
+        atc_congelar();
+        long long agora_ns = relogio_agora_ns();
+        bool parada = true;
+        for (int i = 0; i < frota->tamanho && parada; i++) {
+            parada = checkpoint_ler_aeronave(frota->ponteiros[i], agora_ns, &registros[i]);
+        }
+        if (parada) {
+            FILE *memoria = open_memstream(&estado, &tamanho_estado);
+            copiado = memoria != NULL && atc_salvar_estado(memoria);
+            if (memoria != NULL) fclose(memoria);
+            contadores_ler(&contadores);
+            cabecalho.instante_simulado_ns = modelo->instante_simulado_ns + (agora_ns - largada_ns) * escala_tempo;
+        }
+        atc_descongelar();
+
+        if (parada && !copiado) break; // Sem memória para a cópia: não adianta insistir
+        if (!copiado) {
+            struct timespec ts = {.tv_sec = 0, .tv_nsec = CHECKPOINT_INTERVALO_VARREDURA_NS};
+            nanosleep(&ts, NULL);
+        }
+    }
+    checkpoint_soltar_frota();
+    long long copia_ns = relogio_agora_ns();
+
+    bool ok = copiado;
+    char temporario[4096];
+    snprintf(temporario, sizeof(temporario), "%s.tmp", caminho);
+    FILE *f = ok ? fopen(temporario, "wb") : NULL;
+    if (ok && f == NULL) {
+        perror("fopen checkpoint");
+        ok = false;
+    }
+    if (ok) {
+        for (int c = 0; c < CONTADORES_TOTAL; c++) {
+            cabecalho.contadores[c] = contadores.valor[c];
+        }
+        cabecalho.soma_rotas = checkpoint_somar_rotas(frota);
+        uint64_t tamanho = tamanho_estado;
+        ok = fwrite(&cabecalho, sizeof(cabecalho), 1, f) == 1 &&
+             fwrite(registros, sizeof(registro_aeronave_t), frota->tamanho, f) == (size_t)frota->tamanho &&
+             fwrite(&tamanho, sizeof(tamanho), 1, f) == 1 &&
+             fwrite(estado, 1, tamanho_estado, f) == tamanho_estado;
+        if (fclose(f) != 0) ok = false;
+        if (!ok) {
+            fprintf(stderr, "Erro ao escrever o checkpoint em %s\n", temporario);
+        } else if (rename(temporario, caminho) != 0) {
+            perror("rename checkpoint");
+            ok = false;
+        }
+    }
+
+    if (medidas != NULL) {
+        medidas->pausa_ms = (copia_ns - inicio_ns) / 1e6;
+        medidas->escrita_ms = (relogio_agora_ns() - copia_ns) / 1e6;
+        medidas->bytes = ok ? (long)(sizeof(cabecalho) + sizeof(registro_aeronave_t) * frota->tamanho +
+                                     sizeof(uint64_t) + tamanho_estado) : 0;
+        medidas->tentativas = tentativas;
+    }
+    free(estado);
+    free(registros);
+    return ok;
+}
+
+/**
+ * Lê e confere o cabeçalho de um checkpoint
+ * @param caminho: Arquivo gravado por checkpoint_gravar
+ * @param cabecalho: Recebe o cabeçalho
+ * @return true se o arquivo é um checkpoint desta versão
+ */
+bool checkpoint_ler_cabecalho(const char *caminho, checkpoint_cabecalho_t *cabecalho) {
+    FILE *f = fopen(caminho, "rb");
+    if (f == NULL) {
+        perror("fopen checkpoint");
+        return false;
+    }
+    bool ok = fread(cabecalho, sizeof(*cabecalho), 1, f) == 1;
+    fclose(f);
+    if (!ok || memcmp(cabecalho->magica, CHECKPOINT_MAGICA, 4) != 0 ||
+        cabecalho->versao != CHECKPOINT_VERSAO || cabecalho->setores <= 0 || cabecalho->aeronaves <= 0) {
+        fprintf(stderr, "%s não é um checkpoint válido (versão %d)\n", caminho, CHECKPOINT_VERSAO);
+        return false;
+    }
+    cabecalho->politica[sizeof(cabecalho->politica) - 1] = '\0';
+    return true;
+}
+
+/**
+ * Aplica o registro gravado a uma aeronave recém-criada (antes da largada)
+ */
+static void checkpoint_aplicar_registro(aeronave_t *a, const registro_aeronave_t *r, long long agora_ns) {
+    int escala = escala_tempo > 0 ? escala_tempo : 1;
+    a->posicao_rota = r->posicao_rota;
+    a->setor_atual = r->setor_atual;
+    a->semente = r->semente;
+    a->contador_recuos = r->contador_recuos;
+    a->contador_esperas_longas = r->contador_esperas_longas;
+    a->espera = r->espera;
+    a->recuo_recente = r->recuo_recente;
+    a->voo_restante_ns = 0;
+    if (r->fase == FASE_VOANDO) {
+        a->voo_restante_ns = r->tempo_ns / escala;
+    } else if (r->fase == FASE_PEDINDO) {
+        a->instante_solicitacao_ns = agora_ns - r->tempo_ns / escala;
+        a->instante_repasse_ns = 0;
+        a->resposta_controle = RESPOSTA_PENDENTE;
+    }
+    atomic_store(&a->fase, r->fase);
+    if (r->prioridade != a->prioridade) atc_definir_prioridade(a, r->prioridade);
+}
+
+/**
+ * Restaura um checkpoint sobre a frota recriada com a mesma semente: estado
+ * de cada aeronave, ocupação, filas, corredores e contadores acumulados
+ * Chamada depois de frota_criar e antes de iniciar as threads
+ * @param caminho: Arquivo gravado por checkpoint_gravar
+ * @param frota: Frota recém-criada (mesmos setores, aeronaves e semente)
+ * @param cabecalho: Recebe o cabeçalho lido
+ * @return true se o estado foi restaurado
+ */
+bool checkpoint_restaurar(const char *caminho, frota_t *frota, checkpoint_cabecalho_t *cabecalho) {
+    if (!checkpoint_ler_cabecalho(caminho, cabecalho)) return false;
+    if (cabecalho->aeronaves != frota->tamanho || cabecalho->soma_rotas != checkpoint_somar_rotas(frota)) {
+        fprintf(stderr, "A frota recriada não é a do checkpoint %s\n", caminho);
+        return false;
+    }
+    FILE *f = fopen(caminho, "rb");
+    if (f == NULL) {
+        perror("fopen checkpoint");
+        return false;
+    }
+
+    bool ok = fseek(f, sizeof(*cabecalho), SEEK_SET) == 0;
+    long long agora_ns = relogio_agora_ns();
+    for (int i = 0; i < frota->tamanho && ok; i++) {
+        registro_aeronave_t r;
+        ok = fread(&r, sizeof(r), 1, f) == 1 && r.fase >= FASE_LARGADA && r.fase <= FASE_CONCLUIDA &&
+             r.posicao_rota >= 0 && r.posicao_rota <= frota->aeronaves[i].comprimento_rota;
+        if (ok && frota->ponteiros[i] != NULL) {
+            checkpoint_aplicar_registro(frota->ponteiros[i], &r, agora_ns);
+        }
+    }
+    uint64_t tamanho_estado = 0;
+    ok = ok && fread(&tamanho_estado, sizeof(tamanho_estado), 1, f) == 1;
+    long inicio_estado = ok ? ftell(f) : -1;
+    ok = ok && atc_restaurar_estado(f) && (uint64_t)(ftell(f) - inicio_estado) == tamanho_estado;
+    fclose(f);
+    if (!ok) {
+        fprintf(stderr, "Checkpoint %s truncado ou incoerente com a frota\n", caminho);
+        return false;
+    }
+
+    for (int c = 0; c < CONTADORES_TOTAL; c++) {
+        if (cabecalho->contadores[c] != 0) contadores_adicionar((contador_t)c, cabecalho->contadores[c]);
+    }
+    return true;
+}
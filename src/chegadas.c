@@ -0,0 +1,205 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <stdatomic.h>
+#include "../include/chegadas.h"
+#include "../include/relogio.h"
+#include "../include/utils.h"
+
+// Chegadas da execução em andamento
+typedef struct {
+    chegadas_config_t config;
+    long long *instante_ns;    // Por aeronave: chegada em ns simulados desde a largada
+    int total;
+    long long origem_ns;       // Largada (relogio_agora_ns)
+    _Alignas(LINHA_CACHE) _Atomic int chegadas;
+    _Atomic int concluidas;
+} chegadas_t;
+
+static chegadas_t estado;
+static bool ativas = false;
+
+/**
+ * Converte ns simulados desde a largada em instante do relógio
+ */
+static long long chegadas_instante_relogio(long long simulado_ns) {
+    return estado.origem_ns + simulado_ns / (escala_tempo > 0 ? escala_tempo : 1);
+}
+
+/**
+ * Dorme até um instante absoluto do relógio (prazos absolutos: o atraso de
+ * acordar de uma chegada não empurra as seguintes)
+ * @param alvo_ns: Instante em relogio_agora_ns
+ */
+static void chegadas_dormir_ate(long long alvo_ns) {
+    long long restante_ns = alvo_ns - relogio_agora_ns();
+    if (restante_ns <= 0) return;
+    struct timespec ts = {
+        .tv_sec = restante_ns / 1000000000LL,
+        .tv_nsec = restante_ns % 1000000000LL
+    };
+    nanosleep(&ts, NULL);
+}
+
+/**
+ * Interpreta o processo de chegadas da linha de comando
+ * @param texto: "poisson[:TAXA]" ou "constante[:TAXA]" (aeronaves por segundo simulado)
+ * @param config: Recebe processo e taxa (0 se omitida); duração e aquecimento ficam intactos
+ * @return true se o processo for conhecido e a taxa, se houver, for positiva
+ */
+bool chegadas_interpretar(const char *texto, chegadas_config_t *config) {
+    const char *separador = strchr(texto, ':');
+    size_t tamanho = separador != NULL ? (size_t)(separador - texto) : strlen(texto);
+    if (tamanho == 7 && strncmp(texto, "poisson", 7) == 0) {
+        config->processo = CHEGADAS_POISSON;
+    } else if (tamanho == 9 && strncmp(texto, "constante", 9) == 0) {
+        config->processo = CHEGADAS_CONSTANTE;
+    } else {
+        return false;
+    }
+
+    config->taxa = 0.0;
+    if (separador != NULL) {
+        char *fim;
+        config->taxa = strtod(separador + 1, &fim);
+        if (*fim != '\0' || !(config->taxa > 0.0)) return false;
+    }
+    return true;
+}
+
+/**
+ * @return Nome do processo de chegadas
+ */
+const char *chegadas_nome_processo(processo_chegadas_t processo) {
+    return processo == CHEGADAS_POISSON ? "poisson" : "constante";
+}
+
+/**
+ * Sorteia os instantes de chegada em [0, duracao) e liga o regime aberto para
+ * a próxima execução (antes de atc_init: o tamanho da frota sai daqui)
+ * @param config: Processo, taxa, duração e aquecimento
+ * @param semente: Semente da carga (o sorteio não toca no rand() global)
+ * @return Número de aeronaves que chegam, -1 em caso de falha de alocação
+ */
+int chegadas_preparar(const chegadas_config_t *config, unsigned int semente) {
+    chegadas_finalizar();
+    estado.config = *config;
+
+    // Capacidade pela média mais folga: Poisson raramente passa de 6 desvios
+    double esperadas = config->taxa * config->duracao;
+    long capacidade = (long)(esperadas + 6.0 * sqrt(esperadas) + 16.0);
+    estado.instante_ns = malloc(sizeof(long long) * capacidade);
+    if (estado.instante_ns == NULL) {
+        perror("malloc chegadas");
+        return -1;
+    }
+
+    long long duracao_ns = (long long)(config->duracao * 1e9);
+    double intervalo_medio_ns = 1e9 / config->taxa;
+    double instante = 0.0;
+    while (estado.total < capacidade) {
+        if (config->processo == CHEGADAS_POISSON) {
+            // 1 - u em (0, 1]: o logaritmo nunca recebe zero
+            double u = rand_r(&semente) / ((double)RAND_MAX + 1.0);
+            instante += -log(1.0 - u) * intervalo_medio_ns;
+        } else {
+            instante = estado.total * intervalo_medio_ns;
+        }
+        if (instante >= duracao_ns) break;
+        estado.instante_ns[estado.total++] = (long long)instante;
+    }
+
+    atomic_store(&estado.chegadas, 0);
+    atomic_store(&estado.concluidas, 0);
+    ativas = true;
+    return estado.total;
+}
+
+/**
+ * Desliga o regime aberto e libera os instantes sorteados
+ */
+void chegadas_finalizar() {
+    ativas = false;
+    free(estado.instante_ns);
+    estado.instante_ns = NULL;
+    estado.total = 0;
+}
+
+/**
+ * @return true se a execução em andamento está no regime aberto
+ */
+bool chegadas_ativas() {
+    return ativas;
+}
+
+/**
+ * Define a largada, a partir da qual contam os instantes de chegada
+ * @param origem_ns: relogio_agora_ns no momento de atc_liberar_largada
+ */
+void chegadas_definir_origem(long long origem_ns) {
+    estado.origem_ns = origem_ns;
+}
+
+/**
+ * Segura a aeronave (já liberada na largada) até o seu instante de chegada
+ * Sem o regime aberto, volta na hora
+ * @param id: Id da aeronave (índice do instante sorteado)
+ */
+void chegadas_aguardar(int id) {
+    if (!ativas || id < 0 || id >= estado.total) return;
+    chegadas_dormir_ate(chegadas_instante_relogio(estado.instante_ns[id]));
+    atomic_fetch_add_explicit(&estado.chegadas, 1, memory_order_relaxed);
+}
+
+/**
+ * Conta uma aeronave que terminou a rota
+ */
+void chegadas_concluir() {
+    if (!ativas) return;
+    atomic_fetch_add_explicit(&estado.concluidas, 1, memory_order_relaxed);
+}
+
+/**
+ * Aeronaves que já chegaram e ainda não concluíram
+ */
+static int chegadas_em_sistema(int *chegadas) {
+    *chegadas = atomic_load(&estado.chegadas);
+    return *chegadas - atomic_load(&estado.concluidas);
+}
+
+/**
+ * Acompanha a janela de medição (na thread principal, depois da largada):
+ * dorme até o início e até o fim da janela e mede quantas aeronaves estão no
+ * sistema em cada borda e a taxa de chegada observada entre elas
+ * @param estatisticas: Recebe as medidas da janela
+ */
+void chegadas_acompanhar_janela(chegadas_estatisticas_t *estatisticas) {
+    memset(estatisticas, 0, sizeof(*estatisticas));
+    if (!ativas) return;
+    estatisticas->aeronaves = estado.total;
+
+    const chegadas_config_t *c = &estado.config;
+    int chegadas_inicio, chegadas_fim;
+    chegadas_dormir_ate(chegadas_instante_relogio((long long)(c->aquecimento * 1e9)));
+    estatisticas->em_sistema_inicio = chegadas_em_sistema(&chegadas_inicio);
+    chegadas_dormir_ate(chegadas_instante_relogio((long long)(c->duracao * 1e9)));
+    estatisticas->em_sistema_fim = chegadas_em_sistema(&chegadas_fim);
+
+    double janela = c->duracao - c->aquecimento;
+    if (janela > 0) estatisticas->taxa_efetiva = (chegadas_fim - chegadas_inicio) / janela;
+}
+
+/**
+ * Completa as medidas com o tempo de drenagem, depois que a frota terminou
+ * @param conclusao_ns: relogio_agora_ns da última conclusão
+ * @param estatisticas: Medidas já preenchidas por chegadas_acompanhar_janela
+ */
+void chegadas_registrar_fim(long long conclusao_ns, chegadas_estatisticas_t *estatisticas) {
+    if (!ativas) return;
+    long long fim_chegadas_ns = chegadas_instante_relogio((long long)(estado.config.duracao * 1e9));
+    long long drenagem_ns = conclusao_ns - fim_chegadas_ns;
+    if (drenagem_ns < 0) drenagem_ns = 0;
+    estatisticas->drenagem = drenagem_ns * (double)(escala_tempo > 0 ? escala_tempo : 1) / 1e9;
+}
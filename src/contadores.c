@@ -0,0 +1,132 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "../include/contadores.h"
+#include "../include/utils.h"
+
+// Bloco de uma thread: os contadores começam numa linha de cache própria e o
+// tamanho do bloco é múltiplo dela, então blocos vizinhos nunca dividem linha
+typedef struct bloco_contadores {
+    _Alignas(LINHA_CACHE) _Atomic long long valor[CONTADORES_TOTAL];
+    struct bloco_contadores *proximo; // Escrito antes de o bloco ser publicado
+} bloco_contadores_t;
+
+static _Atomic(bloco_contadores_t *) blocos = NULL; // Todos os blocos da execução
+static _Atomic unsigned int geracao = 1;            // Muda a cada reinício: blocos antigos deixam de valer
+static bool ligados = false;
+
+// Sem memória para um bloco, ou fora de uma execução, a thread conta aqui com
+// soma atômica: fica certo, só perde o isolamento de linha
+static bloco_contadores_t bloco_compartilhado;
+
+static _Thread_local bloco_contadores_t *bloco_local = NULL;
+static _Thread_local unsigned int geracao_local = 0;
+
+/**
+ * Libera os blocos da execução anterior
+ */
+static void contadores_liberar_blocos() {
+    bloco_contadores_t *b = atomic_exchange(&blocos, NULL);
+    while (b != NULL) {
+        bloco_contadores_t *proximo = b->proximo;
+        free(b);
+        b = proximo;
+    }
+    for (int c = 0; c < CONTADORES_TOTAL; c++) {
+        atomic_store(&bloco_compartilhado.valor[c], 0);
+    }
+}
+
+/**
+ * Zera os contadores para uma nova execução (em atc_init, sem outras threads
+ * contando). Blocos registrados antes deixam de valer e cada thread ganha um
+ * novo no próximo evento
+ */
+void contadores_reiniciar() {
+    contadores_liberar_blocos();
+    atomic_fetch_add(&geracao, 1);
+    ligados = true;
+}
+
+/**
+ * Libera os blocos no fim da execução (em atc_finalizar, depois da última
+ * leitura). Eventos contados depois disto vão para o bloco compartilhado
+ */
+void contadores_finalizar() {
+    ligados = false;
+    contadores_liberar_blocos();
+    atomic_fetch_add(&geracao, 1);
+}
+
+/**
+ * Dá à thread chamadora o seu bloco de contadores. Chamada no início de cada
+ * thread que conta eventos; quem não chamar é registrado no primeiro evento
+ */
+void contadores_registrar_thread() {
+    unsigned int atual = atomic_load(&geracao);
+    if (bloco_local != NULL && geracao_local == atual) return;
+    geracao_local = atual;
+
+    void *memoria = NULL;
+    if (!ligados || posix_memalign(&memoria, LINHA_CACHE, sizeof(bloco_contadores_t)) != 0) {
+        bloco_local = &bloco_compartilhado;
+        return;
+    }
+    bloco_contadores_t *bloco = memoria;
+    for (int c = 0; c < CONTADORES_TOTAL; c++) {
+        atomic_init(&bloco->valor[c], 0);
+    }
+
+    // Publica no início da lista; leitores só seguem proximo de blocos já publicados
+    bloco->proximo = atomic_load(&blocos);
+    while (!atomic_compare_exchange_weak(&blocos, &bloco->proximo, bloco));
+    bloco_local = bloco;
+}
+
+/**
+ * Soma uma quantidade a um contador no bloco da thread chamadora
+ * @param contador: Evento contado
+ * @param quantidade: Valor somado (ns, pedidos, ...)
+ */
+void contadores_adicionar(contador_t contador, long long quantidade) {
+    if (bloco_local == NULL || geracao_local != atomic_load_explicit(&geracao, memory_order_relaxed)) {
+        contadores_registrar_thread();
+    }
+    bloco_contadores_t *bloco = bloco_local;
+    if (bloco == &bloco_compartilhado) {
+        atomic_fetch_add_explicit(&bloco->valor[contador], quantidade, memory_order_relaxed);
+        return;
+    }
+    // Só esta thread escreve no bloco: leitura e escrita simples bastam
+    long long valor = atomic_load_explicit(&bloco->valor[contador], memory_order_relaxed);
+    atomic_store_explicit(&bloco->valor[contador], valor + quantidade, memory_order_relaxed);
+}
+
+/**
+ * Conta um evento no bloco da thread chamadora
+ * @param contador: Evento contado
+ */
+void contadores_incrementar(contador_t contador) {
+    contadores_adicionar(contador, 1);
+}
+
+/**
+ * Soma os blocos de todas as threads. Pode rodar com a execução em andamento:
+ * cada contador lido é um valor que existiu, mas contadores diferentes podem
+ * vir de instantes um pouco diferentes
+ * @param totais: Recebe a soma de cada contador e o número de blocos
+ */
+void contadores_ler(contadores_t *totais) {
+    memset(totais, 0, sizeof(*totais));
+    for (bloco_contadores_t *b = atomic_load(&blocos); b != NULL; b = b->proximo) {
+        for (int c = 0; c < CONTADORES_TOTAL; c++) {
+            totais->valor[c] += atomic_load_explicit(&b->valor[c], memory_order_relaxed);
+        }
+        totais->threads++;
+    }
+    for (int c = 0; c < CONTADORES_TOTAL; c++) {
+        totais->valor[c] += atomic_load_explicit(&bloco_compartilhado.valor[c], memory_order_relaxed);
+    }
+}
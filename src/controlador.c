@@ -1,16 +1,42 @@
+#define _GNU_SOURCE // sem_clockwait
 #include "../include/controlador.h"
 #include "../include/fila_prioridade.h"
+#include "../include/politica.h"
+#include "../include/espera.h"
+#include "../include/fila_mpsc.h"
+#include "../include/relogio.h"
+#include "../include/instantaneo.h"
+#include "../include/grafo_espera.h"
+#include "../include/vitima.h"
+#include "../include/verificador.h"
+#include "../include/topologia.h"
+#include "../include/contadores.h"
+#include "../include/desempenho.h"
+#include "../include/temporizador.h"
+#include "../include/estimativa.h"
+#include "../include/ocupacao.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
 #include <errno.h>
+#include <string.h>
 #include <time.h>
+#include <sched.h>
+#include <float.h>
+#include <stdatomic.h>
 
 // Constantes para prevenção de starvation
 #define MAX_RECUOS_CONSECUTIVOS 2    // Após 2 recuos, ganha boost
 #define BOOST_PRIORIDADE 700         // Valor adicionado à prioridade
 #define TEMPO_ESPERA_LONGO 3.0       // 3 segundos é considerado espera longa
 
+#define TENTAR_NOVAMENTE -1          // Retorno interno de atc_tentar_setor após recuo
+
+#define LOTE_MAX 64                  // Pedidos atendidos por passada do controlador central
+#define DESPERTAR_MAX (3 * LOTE_MAX) // Cabe o caso comum (ele, repasse, vítima); cadeias de repasse maiores acordam na hora
+
+#define PERIODO_DETECCAO_PADRAO_MS 100 // Entre passadas do detector periódico (tempo simulado, como o recuo)
+
 int total_setores;
 int total_aeronaves;
 int *setores_ocupados; //Array que guarda o ID da aeronave no setor(ou -1 se livre)
@@ -21,11 +47,599 @@ sem_t mutex_console; //Mutex para proteger a escrita na tela
 pthread_t thread_controlador; //Thread do controlador central
 int simulacao_ativa = 1; //Flag para parar loop controlador
 
-// Estatísticas da execução
-static int total_deadlocks_detectados = 0;
-static int total_recuos_forcados = 0;
-static int total_boosts_aplicados = 0;
-static struct timespec tempo_inicio_simulacao;
+static const politica_fila_t *politica_filas = &politica_prioridade; //Ordem de atendimento das filas
+
+// Estatísticas da execução: os eventos vão para os contadores por thread
+// (contadores.h); aqui ficam só os máximos, escritos sob mutex_ctrl
+static long long inicio_simulacao_ns;
+static int max_recuos_seguidos = 0;         // Pior sequência de recuos de uma mesma aeronave
+
+// Posicionamento NUMA: com o modo numa ativo, setores_ocupados e fila_setores vêm
+// de páginas novas e cada nó inicializa a própria faixa de setores. Com mais de
+// um nó, cada concessão conta se foi feita de um núcleo de outro nó
+static bool setores_por_no = false;
+static bool medir_acessos = false;
+
+// Largada: as threads das aeronaves esperam aqui até a frota inteira estar criada
+static pthread_mutex_t mutex_largada = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond_largada = PTHREAD_COND_INITIALIZER;
+static bool largada_liberada = false;
+
+// Visão do controlador sobre a frota, indexada pelo id da aeronave (struct-of-arrays)
+// Cada array começa numa linha de cache própria e só é escrito sob mutex_ctrl,
+// então a caminhada da detecção de deadlock lê memória contígua em vez de
+// seguir ponteiros para aeronave_t espalhadas pelo heap
+typedef struct {
+    int capacidade;
+    unsigned int *prioridade;  // Prioridade efetiva (espelho de aeronave->prioridade)
+    unsigned int *propria;     // Prioridade sem herança (original ou com boost)
+    int *setor_aguardado;      // Setor em cuja fila a aeronave espera, -1 se nenhum
+    unsigned int *marca_visita;// Época da última visita na busca de ciclos
+    aeronave_t **aeronave;     // id -> aeronave
+    unsigned int epoca_visita;
+    void *bloco;               // Alocação única que contém todos os arrays
+} tabela_aeronaves_t;
+
+static tabela_aeronaves_t tabela;
+
+// Classe de emergência: cada setor tem um corredor FIFO só para emergências,
+// atendido antes da fila comum, e uma emergência desaloja o ocupante comum do
+// setor que pede. Assim ela só espera por outras emergências: no máximo um voo
+// para cada emergência à frente no mesmo corredor. O setor de cada aeronave
+// é setor_atual (escrito só sob mutex_ctrl), então achá-lo é O(1)
+typedef struct {
+    aeronave_t *inicio;
+    aeronave_t *fim;
+} corredor_emergencia_t;
+
+static double fracao_emergencias = 0.0;  // Parte da frota na classe de emergência
+static bool preempcao_ligada = true;     // false: emergências marcadas, mas na fila comum
+static corredor_emergencia_t *corredores; // Um por setor (só com emergências e preempção)
+
+// Herança de prioridade: o ocupante de um setor passa a valer a maior
+// prioridade efetiva de quem espera por ele, e isso segue pela cadeia de
+// espera (se o ocupante aguarda outro setor, o dono desse herda também). A
+// prioridade própria fica em tabela.propria e volta a valer quando o setor é
+// devolvido. A escolha de vítimas e o boost olham só a própria
+static bool heranca_ligada = false;
+
+static void atc_liberar_setor_interno(aeronave_t *aeronave, int setor_liberado);
+static void atc_contabilizar_perda(aeronave_t *aeronave, bool devolve_setor, bool sai_da_fila);
+static int atc_aguardar_resposta(aeronave_t *aeronave, int setor_desejado);
+
+// Controlador central (modo central): as aeronaves inserem pedidos numa fila
+// lock-free e só a thread do controlador toca o estado dos setores, uma vez
+// por lote, então mutex_ctrl deixa de pular entre os núcleos a cada pedido
+static modo_controlador_t modo_controlador = CONTROLADOR_TRAVAS;
+static fila_mpsc_t fila_pedidos;
+static sem_t sem_controlador;                 // Onde a thread do controlador dorme sem pedidos
+static _Atomic bool controlador_dormindo = false;
+static _Atomic bool controlador_encerrando = false;
+static bool controlador_iniciado = false;
+static bool atendendo_lote = false;           // Acordar aeronaves só depois da passada (sob mutex_ctrl)
+static aeronave_t *despertar[DESPERTAR_MAX];
+static int total_despertar = 0;
+
+// Detecção de deadlock: a cada pedido contestado (cadeia a partir do solicitante,
+// dentro da seção crítica) ou periódica (Tarjan sobre um instantaneo, fora dela)
+static modo_deteccao_t modo_deteccao = DETECCAO_POR_PEDIDO;
+static int periodo_deteccao_ms = PERIODO_DETECCAO_PADRAO_MS;
+static grafo_espera_t grafo_espera;
+static char nome_deteccao[32] = "pedido";
+
+// Tempo de posse de mutex_ctrl (escrito sob a própria trava; soma e número
+// de posses nos contadores)
+static long long instante_travado_ns = 0;
+static long long max_secao_ns = 0;
+
+/**
+ * Entra na seção crítica do controlador e marca o início da posse
+ */
+static inline void atc_travar() {
+    desempenho_entrar(DESEMPENHO_TRAVA);
+    sem_wait(&mutex_ctrl);
+    desempenho_sair();
+    instante_travado_ns = relogio_agora_ns();
+}
+
+/**
+ * Contabiliza quanto tempo mutex_ctrl ficou com esta thread e a libera
+ */
+static inline void atc_destravar() {
+    long long posse = relogio_agora_ns() - instante_travado_ns;
+    contadores_incrementar(CONTADOR_SECOES);
+    contadores_adicionar(CONTADOR_SECAO_NS, posse);
+    if (posse > max_secao_ns) max_secao_ns = posse;
+    instantaneo_publicar();
+    sem_post(&mutex_ctrl);
+}
+
+/**
+ * Arredonda um tamanho para o próximo múltiplo da linha de cache
+ * @param tamanho: Tamanho em bytes
+ * @return Tamanho arredondado
+ */
+static size_t alinhar_linha_cache(size_t tamanho) {
+    return (tamanho + LINHA_CACHE - 1) & ~(size_t)(LINHA_CACHE - 1);
+}
+
+/**
+ * Aloca a tabela de aeronaves num único bloco alinhado à linha de cache
+ * @param capacidade: Número máximo de aeronaves (ids de 0 a capacidade-1)
+ * @return true em caso de sucesso, false se a alocação falhar
+ */
+static bool tabela_inicializar(int capacidade) {
+    size_t t_prioridade = alinhar_linha_cache(sizeof(unsigned int) * capacidade);
+    size_t t_propria = alinhar_linha_cache(sizeof(unsigned int) * capacidade);
+    size_t t_aguardado = alinhar_linha_cache(sizeof(int) * capacidade);
+    size_t t_visita = alinhar_linha_cache(sizeof(unsigned int) * capacidade);
+    size_t t_ponteiros = alinhar_linha_cache(sizeof(aeronave_t *) * capacidade);
+
+    void *bloco = NULL;
+    if (posix_memalign(&bloco, LINHA_CACHE, t_prioridade + t_propria + t_aguardado + t_visita + t_ponteiros) != 0) {
+        return false;
+    }
+
+    char *cursor = bloco;
+    tabela.prioridade = (unsigned int *)cursor;   cursor += t_prioridade;
+    tabela.propria = (unsigned int *)cursor;      cursor += t_propria;
+    tabela.setor_aguardado = (int *)cursor;       cursor += t_aguardado;
+    tabela.marca_visita = (unsigned int *)cursor; cursor += t_visita;
+    tabela.aeronave = (aeronave_t **)cursor;
+    tabela.bloco = bloco;
+    tabela.capacidade = capacidade;
+    tabela.epoca_visita = 0;
+
+    for (int i = 0; i < capacidade; i++) {
+        tabela.prioridade[i] = 0;
+        tabela.propria[i] = 0;
+        tabela.setor_aguardado[i] = -1;
+        tabela.marca_visita[i] = 0;
+        tabela.aeronave[i] = NULL;
+    }
+    return true;
+}
+
+/**
+ * @return true se a aeronave usa o corredor de emergência dos setores
+ */
+static inline bool atc_no_corredor(const aeronave_t *aeronave) {
+    return corredores != NULL && aeronave->emergencia;
+}
+
+/**
+ * Aplica uma nova prioridade efetiva mantendo tabela, espelho e estimador
+ * coerentes. Em fila comum, a aeronave muda de faixa no estimador e de lugar
+ * na fila se a chave da política depender da prioridade
+ * Deve ser chamada com mutex_ctrl
+ * @param aeronave: Aeronave a ser alterada
+ * @param prioridade: Nova prioridade efetiva
+ */
+static void atc_aplicar_prioridade(aeronave_t *aeronave, unsigned int prioridade) {
+    if (aeronave->id >= 0 && aeronave->id < tabela.capacidade) {
+        // Em fila, a aeronave muda de faixa na composição do estimador
+        int setor = tabela.setor_aguardado[aeronave->id];
+        if (setor >= 0 && !atc_no_corredor(aeronave)) {
+            estimativa_desenfileirar(setor, aeronave->prioridade, false);
+            estimativa_enfileirar(setor, prioridade, false);
+            unsigned int antiga = aeronave->prioridade;
+            aeronave->prioridade = prioridade;
+            double chave;
+            if (fila_reposicionar(&fila_setores[setor], aeronave, antiga, &chave)) {
+                instantaneo_enfileirar(aeronave->id, setor, chave);
+            }
+        }
+        tabela.prioridade[aeronave->id] = prioridade;
+    }
+    aeronave->prioridade = prioridade;
+    instantaneo_prioridade(aeronave->id, prioridade);
+}
+
+/**
+ * Maior prioridade efetiva entre quem espera um setor (fila comum e corredor)
+ * Deve ser chamada com mutex_ctrl
+ * @param setor: Índice do setor
+ * @return Maior prioridade, 0 se ninguém espera
+ */
+static unsigned int atc_maior_prioridade_aguardando(int setor) {
+    unsigned int maior = 0;
+    if (politica_filas == &politica_prioridade) {
+        // A fila está em ordem de prioridade (reposicionada a cada mudança)
+        aeronave_t *cabeca = fila_espiar(&fila_setores[setor]);
+        if (cabeca != NULL) maior = cabeca->prioridade;
+    } else {
+        for (no_fila_t *no = fila_setores[setor].inicio; no != NULL; no = no->proximo) {
+            if (no->aeronave->prioridade > maior) maior = no->aeronave->prioridade;
+        }
+    }
+    for (aeronave_t *a = corredores != NULL ? corredores[setor].inicio : NULL; a != NULL; a = a->proxima_emergencia) {
+        if (a->prioridade > maior) maior = a->prioridade;
+    }
+    return maior;
+}
+
+/**
+ * Recalcula a prioridade efetiva de uma aeronave: a própria ou, com herança,
+ * a maior de quem espera o setor que ela ocupa. Se mudou e ela aguarda outro
+ * setor, o ocupante desse setor é recalculado em seguida, e assim pela cadeia
+ * de espera até um elo que não muda. O limite de passos cobre os ciclos de
+ * deadlock ainda não desfeitos
+ * Deve ser chamada com mutex_ctrl
+ * @param aeronave: Primeiro elo (NULL não faz nada)
+ */
+static void atc_propagar_prioridade(aeronave_t *aeronave) {
+    for (int passos = 0; aeronave != NULL && passos < tabela.capacidade; passos++) {
+        int id = aeronave->id;
+        if (id < 0 || id >= tabela.capacidade) return;
+        unsigned int efetiva = tabela.propria[id];
+        int setor = aeronave->setor_atual;
+        if (heranca_ligada && setor >= 0 && setores_ocupados[setor] == id) {
+            unsigned int herdada = atc_maior_prioridade_aguardando(setor);
+            if (herdada > efetiva) efetiva = herdada;
+        }
+        if (efetiva == aeronave->prioridade) return;
+        if (efetiva > aeronave->prioridade && efetiva > tabela.propria[id]) {
+            contadores_incrementar(CONTADOR_HERANCAS);
+        }
+        atc_aplicar_prioridade(aeronave, efetiva);
+
+        int aguardado = tabela.setor_aguardado[id];
+        int ocupante = aguardado >= 0 ? setores_ocupados[aguardado] : -1;
+        aeronave = ocupante >= 0 && ocupante < tabela.capacidade ? tabela.aeronave[ocupante] : NULL;
+    }
+}
+
+/**
+ * Recalcula o ocupante de um setor cuja fila mudou (só com herança)
+ * Deve ser chamada com mutex_ctrl
+ * @param setor: Setor cuja fila ganhou ou perdeu alguém
+ */
+static void atc_propagar_setor(int setor) {
+    if (!heranca_ligada || setor < 0 || setor >= total_setores) return;
+    int ocupante = setores_ocupados[setor];
+    if (ocupante >= 0 && ocupante < tabela.capacidade) atc_propagar_prioridade(tabela.aeronave[ocupante]);
+}
+
+/**
+ * Altera a prioridade própria de uma aeronave (boost ou vinda de fora). A
+ * efetiva é recalculada com a herança e repassada pela cadeia de espera
+ * Deve ser chamada com mutex_ctrl
+ * @param aeronave: Aeronave a ser alterada
+ * @param prioridade: Nova prioridade própria
+ */
+static void atc_atualizar_prioridade(aeronave_t *aeronave, unsigned int prioridade) {
+    if (aeronave->id < 0 || aeronave->id >= tabela.capacidade) {
+        aeronave->prioridade = prioridade;
+        return;
+    }
+    tabela.propria[aeronave->id] = prioridade;
+    atc_propagar_prioridade(aeronave);
+}
+
+/**
+ * Coloca uma aeronave na fila de espera de um setor e registra a espera na tabela
+ * Emergências entram no fim do corredor do setor, à frente de toda a fila comum
+ * Deve ser chamada com mutex_ctrl
+ */
+static void atc_enfileirar(aeronave_t *aeronave, int setor) {
+    desempenho_entrar(DESEMPENHO_ENFILEIRAR);
+    // Estimativa feita antes de entrar, comparada com a espera medida na concessão
+    aeronave->espera_estimada_ns = estimativa_calcular(setor, aeronave->prioridade, atc_no_corredor(aeronave),
+                                                       politica_filas == &politica_prioridade,
+                                                       relogio_agora_ns());
+    estimativa_enfileirar(setor, aeronave->prioridade, atc_no_corredor(aeronave));
+    ocupacao_enfileirar(setor);
+    double chave;
+    if (atc_no_corredor(aeronave)) {
+        corredor_emergencia_t *c = &corredores[setor];
+        aeronave->proxima_emergencia = NULL;
+        if (c->fim != NULL) {
+            c->fim->proxima_emergencia = aeronave;
+        } else {
+            c->inicio = aeronave;
+        }
+        c->fim = aeronave;
+        chave = -DBL_MAX; // No instantaneo, antes de qualquer chave da política
+    } else {
+        chave = fila_inserir(&fila_setores[setor], aeronave);
+    }
+    tabela.setor_aguardado[aeronave->id] = setor;
+    instantaneo_enfileirar(aeronave->id, setor, chave);
+    atc_propagar_setor(setor);
+    desempenho_sair();
+}
+
+/**
+ * Retira a próxima aeronave a receber um setor: a cabeça do corredor de
+ * emergência, senão a primeira da fila comum. O(1) no corredor
+ * Deve ser chamada com mutex_ctrl
+ * @param setor: Setor liberado
+ * @return Aeronave retirada ou NULL se ninguém espera
+ */
+static aeronave_t *atc_proxima_da_fila(int setor) {
+    if (corredores != NULL && corredores[setor].inicio != NULL) {
+        corredor_emergencia_t *c = &corredores[setor];
+        aeronave_t *proxima = c->inicio;
+        c->inicio = proxima->proxima_emergencia;
+        if (c->inicio == NULL) c->fim = NULL;
+        proxima->proxima_emergencia = NULL;
+        estimativa_desenfileirar(setor, proxima->prioridade, true);
+        ocupacao_desenfileirar(setor);
+        return proxima;
+    }
+    aeronave_t *proxima = fila_remover(&fila_setores[setor]);
+    if (proxima != NULL) {
+        estimativa_desenfileirar(setor, proxima->prioridade, false);
+        ocupacao_desenfileirar(setor);
+    }
+    return proxima;
+}
+
+/**
+ * Tira uma aeronave da fila em que espera (vítima de deadlock)
+ * Deve ser chamada com mutex_ctrl
+ * @param aeronave: Aeronave em espera
+ * @param setor: Setor cuja fila ela aguarda
+ * @return true se estava na fila e foi retirada
+ */
+static bool atc_retirar_da_fila(aeronave_t *aeronave, int setor) {
+    if (!atc_no_corredor(aeronave)) {
+        if (!fila_remover_aeronave(&fila_setores[setor], aeronave)) return false;
+        estimativa_desenfileirar(setor, aeronave->prioridade, false);
+        ocupacao_desenfileirar(setor);
+        return true;
+    }
+    corredor_emergencia_t *c = &corredores[setor];
+    aeronave_t *anterior = NULL;
+    for (aeronave_t *a = c->inicio; a != NULL; anterior = a, a = a->proxima_emergencia) {
+        if (a != aeronave) continue;
+        if (anterior != NULL) {
+            anterior->proxima_emergencia = a->proxima_emergencia;
+        } else {
+            c->inicio = a->proxima_emergencia;
+        }
+        if (c->fim == a) c->fim = anterior;
+        a->proxima_emergencia = NULL;
+        estimativa_desenfileirar(setor, a->prioridade, true);
+        ocupacao_desenfileirar(setor);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Acorda uma aeronave bloqueada no seu semáforo. Durante um lote do
+ * controlador central o sem_post fica para depois da passada, fora de
+ * mutex_ctrl; se a lista encher (um repasse em cadeia pode acordar mais de
+ * três por pedido), o excedente acorda na hora, ainda sob a trava
+ * Deve ser chamada com mutex_ctrl
+ */
+static void atc_acordar(aeronave_t *aeronave) {
+    if (atendendo_lote && total_despertar < DESPERTAR_MAX) {
+        despertar[total_despertar++] = aeronave;
+        return;
+    }
+    sem_post(&aeronave->sem_aeronave);
+}
+
+/**
+ * Registra a concessão de um setor. A aeronave passa a ocupá-lo e deixa o
+ * anterior no mesmo passo: setor_atual só muda sob mutex_ctrl, porque o
+ * detector e a thread do controlador leem e zeram o campo de aeronaves paradas
+ * Deve ser chamada com mutex_ctrl
+ * @param aeronave: Aeronave que recebe o setor
+ * @param setor: Setor concedido
+ * @return Setor que a aeronave deixou e precisa ser liberado, -1 se nenhum
+ */
+static int atc_ocupar(aeronave_t *aeronave, int setor) {
+    verificador_ocupar(setor, aeronave->id);
+    if (medir_acessos) {
+        contadores_incrementar(CONTADOR_ACESSOS_SETOR);
+        if (topologia_no_atual() != topologia_no_do_setor(setor, total_setores)) {
+            contadores_incrementar(CONTADOR_ACESSOS_REMOTOS);
+        }
+    }
+    setores_ocupados[setor] = aeronave->id;
+    ocupacao_ocupar(setor);
+    estimativa_ocupar(setor, relogio_agora_ns());
+    contadores_incrementar(CONTADOR_TRANSFERENCIAS);
+    int anterior = aeronave->setor_atual;
+    aeronave->setor_atual = setor;
+    atc_propagar_prioridade(aeronave); // Herda de quem ainda espera o setor
+    return anterior != setor ? anterior : -1;
+}
+
+/**
+ * Desaloja o ocupante comum do setor pedido por uma emergência, se ele pode
+ * sair agora: parado na fila de outro setor, recua como vítima de deadlock
+ * (sai da fila sem o setor, acorda e pede de novo) e o setor fica livre para
+ * a emergência. Em voo (ou entre o fim do trecho e o próximo pedido) ele
+ * está dentro do setor: a emergência espera à frente do corredor e o
+ * ocupante o devolve no próximo ponto seguro (atc_ceder_a_emergencia ou a
+ * concessão do trecho seguinte, que repassa o setor ao corredor)
+ * Deve ser chamada com mutex_ctrl
+ * @param emergencia: Aeronave que pede o setor
+ * @param setor: Setor pedido
+ * @return true se o setor ficou livre para ela
+ */
+static bool atc_desalojar(aeronave_t *emergencia, int setor) {
+    if (!atc_no_corredor(emergencia)) return false;
+    int ocupante_id = setores_ocupados[setor];
+    if (ocupante_id < 0 || ocupante_id == emergencia->id || ocupante_id >= tabela.capacidade) return false;
+    aeronave_t *ocupante = tabela.aeronave[ocupante_id];
+    if (ocupante == NULL || ocupante->emergencia || ocupante->setor_atual != setor) return false;
+    int setor_fila = tabela.setor_aguardado[ocupante_id];
+    if (setor_fila < 0) return false; // Voando: sai no fim do trecho
+
+    atc_contabilizar_perda(ocupante, true, true);
+    atc_retirar_da_fila(ocupante, setor_fila);
+    tabela.setor_aguardado[ocupante_id] = -1;
+    instantaneo_desenfileirar(ocupante_id);
+    atc_propagar_setor(setor_fila);
+    ocupante->precisa_recuar = true;
+
+    // Livre direto, sem repasse: quem o recebe é a emergência que pediu
+    verificador_desocupar(setor, ocupante_id);
+    setores_ocupados[setor] = -1;
+    ocupacao_liberar(setor);
+    estimativa_liberar(setor, relogio_agora_ns());
+    ocupante->setor_atual = -1;
+    instantaneo_ocupante(setor, -1);
+    atc_propagar_prioridade(ocupante);
+    atc_acordar(ocupante);
+    contadores_incrementar(CONTADOR_PREEMPCOES);
+    log_evento("!!! EMERGÊNCIA !!! A%d desaloja A%d de S%d (A%d recua da fila de S%d)\n",
+               emergencia->id, ocupante_id, setor, ocupante_id, setor_fila);
+    return true;
+}
+
+/**
+ * Ponto seguro do ocupante comum: ele vai esperar por outro setor segurando o
+ * atual, e uma emergência espera por esse setor no corredor. Devolve o setor
+ * antes de entrar na fila (a cabeça do corredor o recebe no repasse) em vez
+ * de segurá-lo durante a espera
+ * Deve ser chamada com mutex_ctrl
+ * @param aeronave: Aeronave que vai entrar numa fila
+ */
+static void atc_ceder_a_emergencia(aeronave_t *aeronave) {
+    int setor = aeronave->setor_atual;
+    if (corredores == NULL || aeronave->emergencia || setor < 0 || corredores[setor].inicio == NULL) return;
+    atc_contabilizar_perda(aeronave, true, false);
+    aeronave->setor_atual = -1;
+    contadores_incrementar(CONTADOR_PREEMPCOES);
+    log_evento("!!! EMERGÊNCIA !!! A%d cede S%d a A%d antes de esperar\n",
+               aeronave->id, setor, corredores[setor].inicio->id);
+    atc_liberar_setor_interno(aeronave, setor);
+}
+
+/**
+ * Define a parte da frota na classe de emergência (antes de atc_init)
+ * As emergências ficam espalhadas por igual entre os ids
+ * @param fracao: Entre 0 (nenhuma) e 1 (todas)
+ * @return true se a fração for válida
+ */
+bool atc_definir_emergencias(double fracao) {
+    if (!(fracao >= 0.0 && fracao <= 1.0)) return false;
+    fracao_emergencias = fracao;
+    return true;
+}
+
+/**
+ * @return Parte da frota na classe de emergência
+ */
+double atc_fracao_emergencias() {
+    return fracao_emergencias;
+}
+
+/**
+ * Liga ou desliga o corredor e a preempção das emergências (antes de atc_init)
+ * Desligado, as emergências são só marcadas e esperam na fila comum
+ * @param ligada: true para o corredor com preempção (padrão)
+ */
+void atc_definir_preempcao(bool ligada) {
+    preempcao_ligada = ligada;
+}
+
+/**
+ * Liga ou desliga a herança de prioridade (antes de atc_init)
+ * @param ligada: true para o ocupante herdar a prioridade de quem o espera
+ */
+void atc_definir_heranca(bool ligada) {
+    heranca_ligada = ligada;
+}
+
+/**
+ * @return true se a herança de prioridade está ligada
+ */
+bool atc_heranca_ligada() {
+    return heranca_ligada;
+}
+
+/**
+ * Define a política de escalonamento das filas de espera (antes de atc_init)
+ * @param politica: Política a ser usada; NULL volta para prioridade estrita
+ */
+void atc_definir_politica(const politica_fila_t *politica) {
+    politica_filas = politica ? politica : &politica_prioridade;
+}
+
+/**
+ * Seleciona como os pedidos chegam ao controlador (antes de atc_init)
+ * @param nome: "travas" (cada aeronave sob mutex_ctrl) ou "central" (thread servidora)
+ * @return true se o nome for conhecido
+ */
+bool atc_definir_modo(const char *nome) {
+    if (strcmp(nome, "travas") == 0) {
+        modo_controlador = CONTROLADOR_TRAVAS;
+    } else if (strcmp(nome, "central") == 0) {
+        modo_controlador = CONTROLADOR_CENTRAL;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @return Nome do modo do controlador em uso
+ */
+const char *atc_nome_modo() {
+    return modo_controlador == CONTROLADOR_CENTRAL ? "central" : "travas";
+}
+
+/**
+ * Seleciona quando a detecção de deadlock roda (antes de atc_init)
+ * @param nome: "pedido" (a cada pedido contestado) ou "periodica[:MS]" (detector
+ *              em segundo plano a cada MS ms simulados, padrão PERIODO_DETECCAO_PADRAO_MS)
+ * @return true se o nome for conhecido e o período for positivo
+ */
+bool atc_definir_deteccao(const char *nome) {
+    if (strcmp(nome, "pedido") == 0) {
+        modo_deteccao = DETECCAO_POR_PEDIDO;
+        snprintf(nome_deteccao, sizeof(nome_deteccao), "pedido");
+        return true;
+    }
+    if (strncmp(nome, "periodica", 9) != 0) {
+        return false;
+    }
+
+    int periodo = PERIODO_DETECCAO_PADRAO_MS;
+    if (nome[9] == ':') {
+        periodo = atoi(nome + 10);
+    } else if (nome[9] != '\0') {
+        return false;
+    }
+    if (periodo <= 0) {
+        return false;
+    }
+    modo_deteccao = DETECCAO_PERIODICA;
+    periodo_deteccao_ms = periodo;
+    snprintf(nome_deteccao, sizeof(nome_deteccao), "periodica:%d", periodo);
+    return true;
+}
+
+/**
+ * @return Nome do modo de detecção em uso (com o período, se periódica)
+ */
+const char *atc_nome_deteccao() {
+    return nome_deteccao;
+}
+
+/**
+ * Inicializa a faixa de setores de um nó (roda num núcleo do próprio nó no
+ * posicionamento numa, então as páginas da faixa ficam nele)
+ * @param no: Índice do nó
+ * @param contexto: Não utilizado
+ */
+static void atc_inicializar_faixa(int no, void *contexto) {
+    (void)contexto;
+    int inicio, fim;
+    topologia_faixa_do_no(no, total_setores, &inicio, &fim);
+    for (int i = inicio; i < fim; i++) {
+        setores_ocupados[i] = -1;
+        fila_inicializar(&fila_setores[i]);
+        fila_definir_politica(&fila_setores[i], politica_filas);
+    }
+}
 
 /**
  * Inicializa o sistema de controle de tráfego aéreo
@@ -35,238 +649,882 @@ static struct timespec tempo_inicio_simulacao;
 void atc_init(int setores, int n_aeronaves){
     total_setores = setores;
     total_aeronaves = n_aeronaves;
+    simulacao_ativa = 1;
+    contadores_reiniciar();
+    desempenho_reiniciar();
+    max_recuos_seguidos = 0;
+    largada_liberada = false;
+    espera_reiniciar();
     
-    // Marca início da simulação
-    clock_gettime(CLOCK_REALTIME, &tempo_inicio_simulacao);
+    // Marca início da simulação (reiniciado na largada)
+    inicio_simulacao_ns = relogio_agora_ns();
     
-    //Alocação de memoria
-    setores_ocupados = (int*)malloc(sizeof(int) * total_setores);
-    fila_setores = (fila_prioridade_t *)malloc(sizeof(fila_prioridade_t)* total_setores);
+    //Alocação de memoria (no posicionamento numa, páginas ainda sem nó)
+    setores_por_no = topologia_ativa();
+    medir_acessos = topologia_nos() > 1;
+    if (setores_por_no) {
+        setores_ocupados = topologia_alocar(sizeof(int) * total_setores);
+        fila_setores = topologia_alocar(sizeof(fila_prioridade_t) * total_setores);
+    } else {
+        setores_ocupados = (int*)malloc(sizeof(int) * total_setores);
+        fila_setores = (fila_prioridade_t *)malloc(sizeof(fila_prioridade_t)* total_setores);
+    }
+
+    corredores = NULL;
+    if (fracao_emergencias > 0 && preempcao_ligada) {
+        corredores = calloc(total_setores, sizeof(corredor_emergencia_t));
+    }
 
-    if (setores_ocupados == NULL || fila_setores == NULL) {
+    if (setores_ocupados == NULL || fila_setores == NULL || !tabela_inicializar(total_aeronaves) ||
+        (fracao_emergencias > 0 && preempcao_ligada && corredores == NULL) ||
+        !instantaneo_inicializar(total_setores, total_aeronaves) ||
+        !estimativa_inicializar(total_setores, PRIORIDADE_MAX + BOOST_PRIORIDADE,
+                                (TEMPO_VOO_MIN_MS + TEMPO_VOO_VARIACAO_MS / 2) * 1000000LL / escala_tempo) ||
+        !ocupacao_inicializar(total_setores)) {
         fprintf(stderr, "ERRO: Falha na alocação de memória inicial\n");
         return;
     }
 
-    sem_init(&mutex_ctrl, 0, 1);
-    sem_init(&mutex_console, 0, 1);
-    for(int i = 0; i < total_setores; i++){
-        setores_ocupados[i] = -1;
-        fila_inicializar(&fila_setores[i]);
+    sem_init(&mutex_ctrl, 0, 1);
+    sem_init(&mutex_console, 0, 1);
+    topologia_em_cada_no(atc_inicializar_faixa, NULL);
+
+    max_secao_ns = 0;
+    controlador_iniciado = false;
+
+    if (modo_deteccao == DETECCAO_PERIODICA && !grafo_espera_inicializar(&grafo_espera, total_aeronaves)) {
+        fprintf(stderr, "Aviso: sem memória para o detector periódico, usando detecção por pedido\n");
+        atc_definir_deteccao("pedido");
+    }
+
+    // O modo central sempre tem a thread do controlador; no modo com travas ela
+    // só existe para rodar o detector periódico
+    void *(*executar)(void *) = NULL;
+    if (modo_controlador == CONTROLADOR_CENTRAL) {
+        fila_mpsc_inicializar(&fila_pedidos);
+        executar = controlador_central_executar;
+    } else if (modo_deteccao == DETECCAO_PERIODICA) {
+        executar = controlador_detector_executar;
+    }
+    if (executar != NULL) {
+        sem_init(&sem_controlador, 0, 0);
+        atomic_store(&controlador_dormindo, false);
+        atomic_store(&controlador_encerrando, false);
+        if (pthread_create(&thread_controlador, NULL, executar, NULL) != 0) {
+            perror("Erro ao criar thread do controlador");
+            modo_controlador = CONTROLADOR_TRAVAS;
+            if (modo_deteccao == DETECCAO_PERIODICA) {
+                grafo_espera_destruir(&grafo_espera);
+                atc_definir_deteccao("pedido");
+            }
+            sem_destroy(&sem_controlador);
+        } else {
+            controlador_iniciado = true;
+        }
+    }
+}
+
+/**
+ * Registra uma aeronave na tabela do controlador (antes de iniciar sua thread)
+ * @param aeronave: Aeronave cujo id indexa a tabela
+ * @return true se registrada, false se o id estiver fora da capacidade
+ */
+bool atc_registrar_aeronave(aeronave_t *aeronave) {
+    if (aeronave == NULL || aeronave->id < 0 || aeronave->id >= tabela.capacidade) {
+        return false;
+    }
+    // Espalhadas por igual: o id i é emergência quando floor(i * fração) avança
+    int id = aeronave->id;
+    aeronave->emergencia = (long)((id + 1) * fracao_emergencias) > (long)(id * fracao_emergencias);
+
+    atc_travar();
+    tabela.aeronave[aeronave->id] = aeronave;
+    tabela.prioridade[aeronave->id] = aeronave->prioridade;
+    tabela.propria[aeronave->id] = aeronave->prioridade;
+    tabela.setor_aguardado[aeronave->id] = -1;
+    instantaneo_prioridade(aeronave->id, aeronave->prioridade);
+    atc_destravar();
+    return true;
+}
+
+/**
+ * Marca na tabela que uma aeronave aguarda um setor, sem pô-la na fila nem
+ * fazê-la dormir: monta cadeias de espera sintéticas para medir
+ * verificar_deadlock (benchmark_micro)
+ * @param aeronave: Aeronave registrada
+ * @param setor: Setor aguardado (-1 desfaz a marca)
+ */
+void atc_simular_espera(aeronave_t *aeronave, int setor) {
+    atc_travar();
+    tabela.setor_aguardado[aeronave->id] = setor < total_setores ? setor : -1;
+    atc_destravar();
+}
+
+/**
+ * Consulta quem ocupa um setor
+ * @param setor: Índice do setor
+ * @return Id do ocupante ou -1 se o setor estiver livre ou for inválido
+ */
+int atc_ocupante_setor(int setor) {
+    if (setor < 0 || setor >= total_setores) return -1;
+    atc_travar();
+    int ocupante = setores_ocupados[setor];
+    atc_destravar();
+    return ocupante;
+}
+
+/**
+ * Consulta em qual fila de espera uma aeronave está
+ * @param id: Id da aeronave
+ * @return Setor aguardado ou -1 se a aeronave não estiver em nenhuma fila
+ */
+int atc_setor_aguardado(int id) {
+    if (id < 0 || id >= tabela.capacidade) return -1;
+    atc_travar();
+    int setor = tabela.setor_aguardado[id];
+    atc_destravar();
+    return setor;
+}
+
+/**
+ * Estima a espera de quem pedisse um setor agora, com uma dada prioridade,
+ * sem travar o controlador: O(1) sobre os agregados que o controlador mantém
+ * a cada entrada e saída de fila e a cada posse (estimativa.h)
+ * @param setor: Índice do setor
+ * @param prioridade: Prioridade efetiva de quem pediria
+ * @return Espera estimada em ns de relógio (comprimidos pela escala), -1 se o setor for inválido
+ */
+long long atc_estimar_espera(int setor, unsigned int prioridade) {
+    return estimativa_calcular(setor, prioridade, false, politica_filas == &politica_prioridade,
+                               relogio_agora_ns());
+}
+
+/**
+ * Redefine a prioridade própria de uma aeronave mantendo a tabela coerente
+ * (usada quando a prioridade vem de fora, p.ex. de outra região ou de um checkpoint)
+ * @param aeronave: Aeronave registrada
+ * @param prioridade: Nova prioridade própria
+ */
+void atc_definir_prioridade(aeronave_t *aeronave, unsigned int prioridade) {
+    atc_travar();
+    atc_atualizar_prioridade(aeronave, prioridade);
+    atc_destravar();
+}
+
+/**
+ * Prioridade de uma aeronave sem a herança (a que ela leva para outra região
+ * ou para um checkpoint). Não trava: quem chama é a própria aeronave ou quem
+ * já segura mutex_ctrl (o checkpoint, entre atc_congelar e atc_descongelar)
+ * @param aeronave: Aeronave registrada
+ * @return Prioridade própria
+ */
+unsigned int atc_prioridade_propria(const aeronave_t *aeronave) {
+    if (aeronave->id < 0 || aeronave->id >= tabela.capacidade) return aeronave->prioridade;
+    return tabela.propria[aeronave->id];
+}
+
+/**
+ * Congela o estado do controlador (ocupação, filas e corredores) para quem
+ * precisa lê-lo inteiro, como o checkpoint. Nenhum pedido anda até
+ * atc_descongelar
+ */
+void atc_congelar() {
+    atc_travar();
+}
+
+/**
+ * Libera o estado congelado por atc_congelar
+ */
+void atc_descongelar() {
+    atc_destravar();
+}
+
+/**
+ * Fila em que uma aeronave espera, sem travar (entre atc_congelar e atc_descongelar)
+ * @param id: Id da aeronave
+ * @return Setor aguardado ou -1
+ */
+int atc_fila_da_aeronave(int id) {
+    if (id < 0 || id >= tabela.capacidade) return -1;
+    return tabela.setor_aguardado[id];
+}
+
+/**
+ * Grava um bloco e devolve se foi tudo
+ */
+static bool atc_gravar(FILE *f, const void *dados, size_t tamanho) {
+    return fwrite(dados, 1, tamanho, f) == tamanho;
+}
+
+/**
+ * Lê um bloco e devolve se veio tudo
+ */
+static bool atc_ler(FILE *f, void *dados, size_t tamanho) {
+    return fread(dados, 1, tamanho, f) == tamanho;
+}
+
+/**
+ * Grava ocupação, filas (na ordem de atendimento, com as chaves) e corredores
+ * de emergência de cada setor. Chaves temporais (edf) vão relativas ao
+ * instante da gravação, para continuarem válidas em outro relógio
+ * Deve ser chamada entre atc_congelar e atc_descongelar
+ * @param f: Arquivo (ou memória) de destino
+ * @return true se gravou tudo
+ */
+bool atc_salvar_estado(FILE *f) {
+    double base = politica_filas->chave_temporal ? relogio_agora_ns() / 1e9 : 0.0;
+    bool ok = true;
+    for (int s = 0; s < total_setores && ok; s++) {
+        int32_t ocupante = setores_ocupados[s];
+        int32_t tamanho = fila_setores[s].tamanho;
+        double tempo_virtual = fila_setores[s].tempo_virtual;
+        ok = atc_gravar(f, &ocupante, sizeof(ocupante)) && atc_gravar(f, &tamanho, sizeof(tamanho)) &&
+             atc_gravar(f, &tempo_virtual, sizeof(tempo_virtual));
+        for (no_fila_t *no = fila_setores[s].inicio; no != NULL && ok; no = no->proximo) {
+            int32_t id = no->aeronave->id;
+            double chave = no->chave - base;
+            ok = atc_gravar(f, &id, sizeof(id)) && atc_gravar(f, &chave, sizeof(chave));
+        }
+
+        int32_t emergencias = 0;
+        for (aeronave_t *a = corredores != NULL ? corredores[s].inicio : NULL; a != NULL; a = a->proxima_emergencia) {
+            emergencias++;
+        }
+        ok = ok && atc_gravar(f, &emergencias, sizeof(emergencias));
+        for (aeronave_t *a = corredores != NULL ? corredores[s].inicio : NULL; a != NULL && ok; a = a->proxima_emergencia) {
+            int32_t id = a->id;
+            ok = atc_gravar(f, &id, sizeof(id));
+        }
+    }
+    return ok;
+}
+
+/**
+ * Aeronave registrada com um id lido de um checkpoint
+ */
+static aeronave_t *atc_aeronave_gravada(int32_t id) {
+    return id >= 0 && id < tabela.capacidade ? tabela.aeronave[id] : NULL;
+}
+
+/**
+ * Restaura o estado gravado por atc_salvar_estado (depois de atc_init, com a
+ * frota registrada e setor_atual de cada aeronave já restaurado, antes da
+ * largada). Setores ainda em nome de quem já os deixou (liberação do modo
+ * central a caminho na gravação) são liberados aqui, repassando à fila
+ * @param f: Arquivo posicionado no início do estado do controlador
+ * @return true se o estado lido é coerente com a frota
+ */
+bool atc_restaurar_estado(FILE *f) {
+    double base = politica_filas->chave_temporal ? relogio_agora_ns() / 1e9 : 0.0;
+    bool ok = true;
+    atc_travar();
+    for (int s = 0; s < total_setores && ok; s++) {
+        int32_t ocupante, tamanho, emergencias;
+        double tempo_virtual;
+        ok = atc_ler(f, &ocupante, sizeof(ocupante)) && atc_ler(f, &tamanho, sizeof(tamanho)) &&
+             atc_ler(f, &tempo_virtual, sizeof(tempo_virtual)) &&
+             (ocupante == -1 || atc_aeronave_gravada(ocupante) != NULL);
+        if (!ok) break;
+        setores_ocupados[s] = ocupante;
+        instantaneo_ocupante(s, ocupante);
+        if (ocupante != -1) {
+            ocupacao_ocupar(s);
+            estimativa_ocupar(s, relogio_agora_ns());
+        }
+        fila_setores[s].tempo_virtual = tempo_virtual;
+
+        for (int i = 0; i < tamanho && ok; i++) {
+            int32_t id;
+            double chave;
+            ok = atc_ler(f, &id, sizeof(id)) && atc_ler(f, &chave, sizeof(chave));
+            aeronave_t *a = ok ? atc_aeronave_gravada(id) : NULL;
+            ok = a != NULL && fila_anexar(&fila_setores[s], a, chave + base);
+            if (!ok) break;
+            tabela.setor_aguardado[id] = s;
+            instantaneo_enfileirar(id, s, chave + base);
+            estimativa_enfileirar(s, a->prioridade, false);
+            ocupacao_enfileirar(s);
+        }
+
+        ok = ok && atc_ler(f, &emergencias, sizeof(emergencias)) && (emergencias == 0 || corredores != NULL);
+        for (int i = 0; i < emergencias && ok; i++) {
+            int32_t id;
+            aeronave_t *a = atc_ler(f, &id, sizeof(id)) ? atc_aeronave_gravada(id) : NULL;
+            ok = a != NULL;
+            if (!ok) break;
+            corredor_emergencia_t *c = &corredores[s];
+            a->proxima_emergencia = NULL;
+            if (c->fim != NULL) {
+                c->fim->proxima_emergencia = a;
+            } else {
+                c->inicio = a;
+            }
+            c->fim = a;
+            tabela.setor_aguardado[id] = s;
+            instantaneo_enfileirar(id, s, -DBL_MAX);
+            estimativa_enfileirar(s, a->prioridade, true);
+            ocupacao_enfileirar(s);
+        }
+    }
+
+    // setor_atual == s só com setores_ocupados[s] == id; o contrário pode
+    // faltar (liberação a caminho), e então o setor segue para a fila
+    for (int id = 0; id < tabela.capacidade && ok; id++) {
+        aeronave_t *a = tabela.aeronave[id];
+        if (a == NULL || a->setor_atual < 0) continue;
+        ok = a->setor_atual < total_setores && setores_ocupados[a->setor_atual] == id;
+        if (ok) verificador_ocupar(a->setor_atual, id);
+    }
+    for (int s = 0; s < total_setores && ok; s++) {
+        aeronave_t *ocupante = atc_aeronave_gravada(setores_ocupados[s]);
+        if (ocupante != NULL && ocupante->setor_atual != s) {
+            atc_liberar_setor_interno(ocupante, s);
+        }
+    }
+    // O arquivo guarda a prioridade própria: a herança é refeita sobre as filas restauradas
+    for (int id = 0; id < tabela.capacidade && ok && heranca_ligada; id++) {
+        atc_propagar_prioridade(tabela.aeronave[id]);
+    }
+    atc_destravar();
+    return ok;
+}
+
+/**
+ * Bloqueia a thread da aeronave até o controlador liberar a largada
+ */
+void atc_aguardar_largada() {
+    pthread_mutex_lock(&mutex_largada);
+    while (!largada_liberada) {
+        pthread_cond_wait(&cond_largada, &mutex_largada);
+    }
+    pthread_mutex_unlock(&mutex_largada);
+}
+
+/**
+ * Libera todas as aeronaves de uma vez e reinicia o relógio da simulação,
+ * de modo que o tempo de criação da frota não entra nas métricas de vazão
+ */
+void atc_liberar_largada() {
+    inicio_simulacao_ns = relogio_agora_ns();
+    pthread_mutex_lock(&mutex_largada);
+    largada_liberada = true;
+    pthread_cond_broadcast(&cond_largada);
+    pthread_mutex_unlock(&mutex_largada);
+}
+
+/**
+ * Copia as estatísticas acumuladas da execução atual
+ * @param estatisticas: Estrutura que recebe os contadores e o tempo decorrido
+ */
+void atc_obter_estatisticas(atc_estatisticas_t *estatisticas) {
+    if (estatisticas == NULL) return;
+
+    // Os máximos sob a trava; a posse desta leitura entra na soma lida depois
+    atc_travar();
+    estatisticas->secao_critica_max_ns = max_secao_ns;
+    estatisticas->max_recuos_seguidos = max_recuos_seguidos;
+    atc_destravar();
+
+    contadores_t c;
+    contadores_ler(&c);
+    estatisticas->deadlocks_detectados = (int)c.valor[CONTADOR_DEADLOCKS];
+    estatisticas->recuos_forcados = (int)c.valor[CONTADOR_RECUOS];
+    estatisticas->boosts_aplicados = (int)c.valor[CONTADOR_BOOSTS];
+    estatisticas->transferencias = (int)c.valor[CONTADOR_TRANSFERENCIAS];
+    estatisticas->lotes = (long)c.valor[CONTADOR_LOTES];
+    estatisticas->pedidos_em_lote = (long)c.valor[CONTADOR_PEDIDOS_LOTE];
+    estatisticas->secao_critica_media_ns = c.valor[CONTADOR_SECOES] > 0 ?
+        (double)c.valor[CONTADOR_SECAO_NS] / c.valor[CONTADOR_SECOES] : 0.0;
+    estatisticas->saltos_perdidos = (long)c.valor[CONTADOR_SALTOS_PERDIDOS];
+    estatisticas->espera_perdida = c.valor[CONTADOR_ESPERA_PERDIDA_NS] / 1e9;
+    estatisticas->acessos_setor = (long)c.valor[CONTADOR_ACESSOS_SETOR];
+    estatisticas->acessos_remotos = (long)c.valor[CONTADOR_ACESSOS_REMOTOS];
+    estatisticas->preempcoes = (int)c.valor[CONTADOR_PREEMPCOES];
+    estatisticas->herancas = c.valor[CONTADOR_HERANCAS];
+    estatisticas->passadas_deteccao = (long)c.valor[CONTADOR_PASSADAS_DETECCAO];
+    estatisticas->threads_contadores = c.threads;
+    estatisticas->estimativas = (long)c.valor[CONTADOR_ESTIMATIVAS];
+    estatisticas->retencoes = (long)c.valor[CONTADOR_RETENCOES];
+    estatisticas->retencao_media_ns = c.valor[CONTADOR_RETENCOES] > 0 ?
+        (double)c.valor[CONTADOR_RETENCAO_NS] / c.valor[CONTADOR_RETENCOES] : 0.0;
+    if (c.valor[CONTADOR_ESTIMATIVAS] > 0) {
+        double n = (double)c.valor[CONTADOR_ESTIMATIVAS];
+        estatisticas->estimativa_erro_medio_ns = c.valor[CONTADOR_ERRO_ESTIMATIVA_NS] / n;
+        estatisticas->estimativa_vies_ns = (c.valor[CONTADOR_ESPERA_ESTIMADA_NS] - c.valor[CONTADOR_ESPERA_MEDIDA_NS]) / n;
+        estatisticas->espera_estimada_media_ns = c.valor[CONTADOR_ESPERA_ESTIMADA_NS] / n;
+        estatisticas->espera_medida_media_ns = c.valor[CONTADOR_ESPERA_MEDIDA_NS] / n;
+        estatisticas->estimativas_na_faixa = c.valor[CONTADOR_ESTIMATIVAS_NA_FAIXA] / n;
+    }
+
+    estatisticas->tempo_total = relogio_segundos_desde(inicio_simulacao_ns);
+}
+
+/**
+ * Finaliza o sistema de controle de tráfego aéreo e exibe estatísticas da execução
+ */
+void atc_finalizar(){
+    simulacao_ativa = 0;
+
+    // A thread do controlador esvazia a fila antes de sair: pedidos de liberação
+    // apontam para aeronaves, que só podem ser destruídas depois disto
+    if (controlador_iniciado) {
+        atomic_store(&controlador_encerrando, true);
+        sem_post(&sem_controlador);
+        pthread_join(thread_controlador, NULL);
+        sem_destroy(&sem_controlador);
+        controlador_iniciado = false;
+    }
+    if (modo_deteccao == DETECCAO_PERIODICA) {
+        grafo_espera_destruir(&grafo_espera);
+    }
+    
+    // Calcula tempo total de execução
+    double tempo_total = relogio_segundos_desde(inicio_simulacao_ns);
+    
+    // Exibe estatísticas da execução
+    if (!modo_silencioso) {
+        atc_estatisticas_t e;
+        atc_obter_estatisticas(&e);
+        printf("\n[ATC] ========== ESTATÍSTICAS DA EXECUÇÃO ==========\n");
+        printf("[ATC] Política de escalonamento: %s\n", politica_filas->nome);
+        printf("[ATC] Controlador: %s | Detecção de deadlock: %s\n", atc_nome_modo(), atc_nome_deteccao());
+        printf("[ATC] Posse de mutex_ctrl: média %.0f ns | máx %.1f µs\n",
+               e.secao_critica_media_ns, e.secao_critica_max_ns / 1000.0);
+        if (modo_deteccao == DETECCAO_PERIODICA) {
+            printf("[ATC] Passadas do detector periódico: %ld\n", e.passadas_deteccao);
+        }
+        if (e.lotes > 0) {
+            printf("[ATC] Lotes atendidos: %ld (%.1f pedidos por lote)\n",
+                   e.lotes, (double)e.pedidos_em_lote / e.lotes);
+        }
+        printf("[ATC] Tempo total de simulação: %.2f segundos\n", tempo_total);
+        printf("[ATC] Total de setores concedidos: %d\n", e.transferencias);
+        printf("[ATC] Total de deadlocks detectados: %d\n", e.deadlocks_detectados);
+        printf("[ATC] Total de recuos forçados: %d (vítimas: %s)\n", e.recuos_forcados, vitima_nome());
+        printf("[ATC] Trabalho perdido nos recuos: %ld saltos de setor | %.2f s de fila | pior sequência %d recuos\n",
+               e.saltos_perdidos, e.espera_perdida, e.max_recuos_seguidos);
+        printf("[ATC] Total de boosts aplicados: %d\n", e.boosts_aplicados);
+        if (fracao_emergencias > 0) {
+            printf("[ATC] Preempções por emergências: %d%s\n", e.preempcoes,
+                   corredores != NULL ? "" : " (corredor desligado)");
+        }
+        printf("[ATC] Taxa de contenção: %.2f deadlocks/segundo\n", 
+               tempo_total > 0 ? e.deadlocks_detectados / tempo_total : 0);
+        printf("[ATC] Contadores somados de %d threads\n", e.threads_contadores);
+        printf("[ATC] ================================================\n\n");
+    }
+
+    for(int i = 0; i < total_setores; i++){
+        fila_destruir(&fila_setores[i]);
+    }
+    
+    if (setores_por_no) {
+        topologia_liberar(setores_ocupados, sizeof(int) * total_setores);
+        topologia_liberar(fila_setores, sizeof(fila_prioridade_t) * total_setores);
+    } else {
+        free(setores_ocupados);
+        free(fila_setores);
+    }
+    free(corredores);
+    corredores = NULL;
+    free(tabela.bloco);
+    memset(&tabela, 0, sizeof(tabela));
+    instantaneo_finalizar();
+    estimativa_finalizar();
+    ocupacao_finalizar();
+    desempenho_finalizar();
+    contadores_finalizar();
+
+    sem_destroy(&mutex_ctrl);
+    sem_destroy(&mutex_console);
+}
+
+/**
+ * Contabiliza um recuo forçado pela detecção de deadlock e aplica o boost
+ * anti-starvation após recuos demais
+ * Deve ser chamada com mutex_ctrl
+ * @param aeronave: Aeronave que foi acordada para recuar
+ */
+static void atc_registrar_recuo(aeronave_t *aeronave) {
+    aeronave->precisa_recuar = false;
+    aeronave->recuo_recente = true;
+    aeronave->contador_recuos++;
+    contadores_incrementar(CONTADOR_RECUOS);
+    if (aeronave->contador_recuos > max_recuos_seguidos) {
+        max_recuos_seguidos = aeronave->contador_recuos;
+    }
+
+    // Anti-starvation: após muitos recuos, aumenta prioridade temporariamente
+    if (aeronave->contador_recuos >= MAX_RECUOS_CONSECUTIVOS && 
+        tabela.propria[aeronave->id] == aeronave->prioridade_original) {
+        atc_atualizar_prioridade(aeronave, aeronave->prioridade_original + BOOST_PRIORIDADE);
+        contadores_incrementar(CONTADOR_BOOSTS);
+        log_evento(">>> A%d (P:%u) recebeu BOOST de prioridade -> %u (após %d recuos) <<<\n", 
+                   aeronave->id, aeronave->prioridade_original, 
+                   aeronave->prioridade, aeronave->contador_recuos);
+    }
+}
+
+/**
+ * Contabiliza o trabalho que um recuo joga fora
+ * Deve ser chamada com mutex_ctrl
+ * @param aeronave: Aeronave que recua
+ * @param devolve_setor: O recuo devolve o setor ocupado (um salto de setor perdido)
+ * @param sai_da_fila: O recuo tira a aeronave da fila (a espera acumulada se perde)
+ */
+static void atc_contabilizar_perda(aeronave_t *aeronave, bool devolve_setor, bool sai_da_fila) {
+    if (devolve_setor && aeronave->setor_atual >= 0) {
+        contadores_incrementar(CONTADOR_SALTOS_PERDIDOS);
+    }
+    if (sai_da_fila && aeronave->instante_solicitacao_ns > 0) {
+        contadores_adicionar(CONTADOR_ESPERA_PERDIDA_NS, relogio_agora_ns() - aeronave->instante_solicitacao_ns);
+    }
+}
+
+/**
+ * Compara a espera estimada na entrada da fila com a medida na concessão
+ * @param aeronave: Aeronave que recebeu o setor
+ * @param espera_ns: Espera medida desde o pedido
+ */
+static void atc_conferir_estimativa(aeronave_t *aeronave, long long espera_ns) {
+    long long estimada = aeronave->espera_estimada_ns;
+    if (estimada < 0) return;
+    aeronave->espera_estimada_ns = -1;
+    contadores_incrementar(CONTADOR_ESTIMATIVAS);
+    contadores_adicionar(CONTADOR_ESPERA_ESTIMADA_NS, estimada);
+    contadores_adicionar(CONTADOR_ESPERA_MEDIDA_NS, espera_ns);
+    contadores_adicionar(CONTADOR_ERRO_ESTIMATIVA_NS, estimada > espera_ns ? estimada - espera_ns : espera_ns - estimada);
+    if (2 * estimada >= espera_ns && estimada <= 2 * espera_ns) {
+        contadores_incrementar(CONTADOR_ESTIMATIVAS_NA_FAIXA);
+    }
+}
+
+/**
+ * Fecha uma espera que terminou em concessão: registra o tempo esperado e
+ * aplica o boost de esperas longas (só então precisa de mutex_ctrl)
+ * @param aeronave: Aeronave que recebeu o setor
+ * @param inicio_ns: Instante do pedido (relogio_agora_ns)
+ */
+static void atc_concluir_espera(aeronave_t *aeronave, long long inicio_ns) {
+    // Registra tempo de espera após receber acesso
+    aeronave_registro_tempo_espera(aeronave, inicio_ns);
+    atc_conferir_estimativa(aeronave, relogio_agora_ns() - inicio_ns);
+    
+    // Verifica se foi uma espera longa e aplica boost se necessário
+    double tempo_esperado = relogio_segundos_desde(inicio_ns);
+    
+    if (tempo_esperado > TEMPO_ESPERA_LONGO / escala_tempo) {
+        atc_travar();
+        aeronave->contador_esperas_longas++;
+        
+        // Boost após esperas longas
+        if (aeronave->contador_esperas_longas >= 2 && 
+            tabela.propria[aeronave->id] == aeronave->prioridade_original) {
+            atc_atualizar_prioridade(aeronave, aeronave->prioridade_original + BOOST_PRIORIDADE);
+            contadores_incrementar(CONTADOR_BOOSTS);
+            log_evento(">>> A%d (P:%u) recebeu BOOST -> %u (esperas longas: %.1fs) <<<\n", 
+                       aeronave->id, aeronave->prioridade_original, 
+                       aeronave->prioridade, tempo_esperado);
+        }
+        atc_destravar();
     }
+    
+    // Reseta contadores após sucesso (conseguiu o setor); só a própria thread escreve
+    aeronave->contador_recuos = 0;
 }
 
 /**
- * Finaliza o sistema de controle de tráfego aéreo e exibe estatísticas da execução
+ * Espera na fila de um setor até o repasse ou um recuo (modo com travas)
+ * @param aeronave: Aeronave já enfileirada (fora de mutex_ctrl)
+ * @param setor_desejado: Setor cuja fila ela aguarda
+ * @return 1 se recebeu o setor, TENTAR_NOVAMENTE se foi escolhida para recuar
  */
-void atc_finalizar(){
-    simulacao_ativa = 0;
+static int atc_aguardar_na_fila(aeronave_t *aeronave, int setor_desejado) {
+    long long inicio = aeronave->instante_solicitacao_ns;
+
+    // Aguarda sem timeout - mantém prioridade na fila
+    verificador_estacionar(aeronave->id, setor_desejado);
+    desempenho_entrar(DESEMPENHO_ESPERA);
+    espera_aguardar(&aeronave->sem_aeronave);
+    desempenho_sair();
+    verificador_despertar(aeronave->id);
     
-    // Calcula tempo total de execução
-    struct timespec tempo_fim;
-    clock_gettime(CLOCK_REALTIME, &tempo_fim);
-    double tempo_total = (tempo_fim.tv_sec - tempo_inicio_simulacao.tv_sec) + 
-                         (tempo_fim.tv_nsec - tempo_inicio_simulacao.tv_nsec) / 1e9;
+    // Latência do repasse: da liberação do setor até esta thread rodar de novo
+    // (o instante foi escrito antes do sem_post, então já está visível aqui)
+    if (aeronave->instante_repasse_ns != 0) {
+        espera_registrar_repasse(relogio_agora_ns() - aeronave->instante_repasse_ns);
+    }
     
-    // Exibe estatísticas da execução
-    printf("\n[ATC] ========== ESTATÍSTICAS DA EXECUÇÃO ==========\n");
-    printf("[ATC] Tempo total de simulação: %.2f segundos\n", tempo_total);
-    printf("[ATC] Total de deadlocks detectados: %d\n", total_deadlocks_detectados);
-    printf("[ATC] Total de recuos forçados: %d\n", total_recuos_forcados);
-    printf("[ATC] Total de boosts aplicados: %d\n", total_boosts_aplicados);
-    printf("[ATC] Taxa de contenção: %.2f deadlocks/segundo\n", 
-           tempo_total > 0 ? total_deadlocks_detectados / tempo_total : 0);
-    printf("[ATC] ================================================\n\n");
-
-    for(int i = 0; i < total_setores; i++){
-        fila_destruir(&fila_setores[i]);
+    // Verifica se foi acordado para RECUAR (deadlock)
+    atc_travar();
+    if (aeronave->precisa_recuar) {
+        atc_registrar_recuo(aeronave);
+        atc_destravar();
+        
+        log_evento("*** A%d recuando de S%d devido a deadlock (recuo #%d) ***\n", 
+                   aeronave->id, aeronave->setor_atual, aeronave->contador_recuos);
+        
+        // Volta ao início da função para tentar novamente
+        return TENTAR_NOVAMENTE;
     }
+    atc_destravar();
     
-    free(setores_ocupados);
-    free(fila_setores);
-
-    sem_destroy(&mutex_ctrl);
-    sem_destroy(&mutex_console);
+    atc_concluir_espera(aeronave, inicio);
+    return 1;
 }
 
 /**
- * Solicita acesso a um setor específico para uma aeronave
+ * Uma tentativa de obter o setor; recuos por deadlock pedem nova tentativa
  * @param aeronave: Ponteiro para a aeronave que está solicitando o setor
  * @param setor_desejado: Índice do setor que a aeronave deseja acessar
- * @return 1 se o setor foi obtido com sucesso, 0 se ocorreu um erro
+ * @return 1 se obteve o setor, 0 em caso de erro, TENTAR_NOVAMENTE após um recuo
  */
-int atc_solicitar_setor(aeronave_t *aeronave, int setor_desejado) {
-    sem_wait(&mutex_ctrl);
+static int atc_tentar_setor(aeronave_t *aeronave, int setor_desejado) {
+    atc_travar();
+    aeronave->instante_solicitacao_ns = relogio_agora_ns();
 
     if(setor_desejado < 0 || setor_desejado >= total_setores){
-        sem_post(&mutex_ctrl);
+        atc_destravar();
         return 0;
     }
     if (aeronave->setor_atual == setor_desejado) {
-        sem_post(&mutex_ctrl);
+        atc_destravar();
         return 1;
     }
 
+    // Uma emergência não espera por ocupante comum
+    atc_desalojar(aeronave, setor_desejado);
+
     // A aeronave espera se o setor já tem alguém (e não é ela mesma)
     bool setor_ocupado = (setores_ocupados[setor_desejado] != -1 && 
                           setores_ocupados[setor_desejado] != aeronave->id);
-    bool vai_travar = verificar_deadlock(aeronave, setor_desejado);
+    bool vai_travar = false;
+    if (modo_deteccao == DETECCAO_POR_PEDIDO) {
+        desempenho_entrar(DESEMPENHO_DEADLOCK);
+        vai_travar = verificar_deadlock(aeronave, setor_desejado);
+        desempenho_sair();
+    }
+    aeronave->recuo_recente = false;
     
     if (setor_ocupado || vai_travar) {
-        sem_wait(&mutex_console);
-        imprimir_timestamp();
         if (setor_ocupado && !vai_travar) {
-            printf("Aeronave %d (P:%d) aguardando setor %d (OCUPADO por %d)\n", 
-                   aeronave->id, aeronave->prioridade, setor_desejado, setores_ocupados[setor_desejado]);
+            log_evento("Aeronave %d (P:%d) aguardando setor %d (OCUPADO por %d)\n", 
+                       aeronave->id, aeronave->prioridade, setor_desejado, setores_ocupados[setor_desejado]);
         } else if (vai_travar) {
-            printf("Aeronave %d (P:%d) BLOQUEADO em S%d - liberando setor atual S%d para evitar deadlock\n", 
-                   aeronave->id, aeronave->prioridade, setor_desejado, aeronave->setor_atual);
+            log_evento("Aeronave %d (P:%d) BLOQUEADO em S%d - liberando setor atual S%d para evitar deadlock\n", 
+                       aeronave->id, aeronave->prioridade, setor_desejado, aeronave->setor_atual);
         }
-        sem_post(&mutex_console);
 
         // Se for bloqueio de deadlock, libera setor atual e aguarda um tempo
         if (vai_travar) {
+            atc_contabilizar_perda(aeronave, true, false);
             int setor_liberar = aeronave->setor_atual;
             aeronave->setor_atual = -1;
-            sem_post(&mutex_ctrl);
+            atc_destravar();
             
             if (setor_liberar >= 0) {
                 atc_liberar_setor(aeronave, setor_liberar);
             }
             
-            // Aguarda um pouco antes de tentar novamente
-            struct timespec pausa = {.tv_sec = 0, .tv_nsec = 100000000}; // 100ms
-            nanosleep(&pausa, NULL);
+            // Aguarda um pouco antes de tentar novamente (100ms simulados)
+            desempenho_entrar(DESEMPENHO_ESPERA);
+            temporizador_dormir_ms(100);
+            desempenho_sair();
             
             // Tenta novamente
-            return atc_solicitar_setor(aeronave, setor_desejado);
+            return TENTAR_NOVAMENTE;
         }
 
         // Entra na fila
-        fila_inserir(&fila_setores[setor_desejado], aeronave);
-        
-        // Captura início da espera com alta precisão
-        struct timespec inicio;
-        clock_gettime(CLOCK_REALTIME, &inicio);
-        
-        sem_post(&mutex_ctrl);
-        
-        // Aguarda sem timeout - mantém prioridade na fila
-        sem_wait(&aeronave->sem_aeronave);
-        
-        // Verifica se foi acordado para RECUAR (deadlock)
-        sem_wait(&mutex_ctrl);
-        if (aeronave->precisa_recuar) {
-            aeronave->precisa_recuar = false;
-            aeronave->contador_recuos++;
-            
-            // Anti-starvation: após muitos recuos, aumenta prioridade temporariamente
-            if (aeronave->contador_recuos >= MAX_RECUOS_CONSECUTIVOS && 
-                aeronave->prioridade == aeronave->prioridade_original) {
-                aeronave->prioridade = aeronave->prioridade_original + BOOST_PRIORIDADE;
-                total_boosts_aplicados++;
-                sem_wait(&mutex_console);
-                imprimir_timestamp();
-                printf(">>> A%d (P:%u) recebeu BOOST de prioridade -> %u (após %d recuos) <<<\n", 
-                       aeronave->id, aeronave->prioridade_original, 
-                       aeronave->prioridade, aeronave->contador_recuos);
-                sem_post(&mutex_console);
-            }
-            
-            sem_post(&mutex_ctrl);
-            
-            total_recuos_forcados++;
-            sem_wait(&mutex_console);
-            imprimir_timestamp();
-            printf("*** A%d recuando de S%d devido a deadlock (recuo #%d) ***\n", 
-                   aeronave->id, aeronave->setor_atual, aeronave->contador_recuos);
-            sem_post(&mutex_console);
-            
-            // Volta ao início da função para tentar novamente
-            return atc_solicitar_setor(aeronave, setor_desejado);
-        }
-        sem_post(&mutex_ctrl);
-        
-        // Registra tempo de espera após receber acesso
-        aeronave_registro_tempo_espera(aeronave, inicio);
-        
-        // Verifica se foi uma espera longa e aplica boost se necessário
-        struct timespec fim;
-        clock_gettime(CLOCK_REALTIME, &fim);
-        double tempo_esperado = (fim.tv_sec - inicio.tv_sec) + 
-                               (fim.tv_nsec - inicio.tv_nsec) / 1000000000.0;
-        
-        sem_wait(&mutex_ctrl);
-        if (tempo_esperado > TEMPO_ESPERA_LONGO) {
-            aeronave->contador_esperas_longas++;
-            
-            // Boost após esperas longas
-            if (aeronave->contador_esperas_longas >= 2 && 
-                aeronave->prioridade == aeronave->prioridade_original) {
-                aeronave->prioridade = aeronave->prioridade_original + BOOST_PRIORIDADE;
-                total_boosts_aplicados++;
-                sem_wait(&mutex_console);
-                imprimir_timestamp();
-                printf(">>> A%d (P:%u) recebeu BOOST -> %u (esperas longas: %.1fs) <<<\n", 
-                       aeronave->id, aeronave->prioridade_original, 
-                       aeronave->prioridade, tempo_esperado);
-                sem_post(&mutex_console);
-            }
-        }
-        
-        // Reseta contadores após sucesso (conseguiu o setor)
-        aeronave->contador_recuos = 0;
-        sem_post(&mutex_ctrl);
-        
-        return 1;
+        aeronave->instante_repasse_ns = 0;
+        atc_ceder_a_emergencia(aeronave);
+        atc_enfileirar(aeronave, setor_desejado);
+        atc_destravar();
+        return atc_aguardar_na_fila(aeronave, setor_desejado);
         
     } else {
         // --- CAMINHO LIVRE ---
-        // Ocupa o setor imediatamente
-        setores_ocupados[setor_desejado] = aeronave->id;
+        // Ocupa o setor imediatamente e devolve o anterior
+        int anterior = atc_ocupar(aeronave, setor_desejado);
+        instantaneo_ocupante(setor_desejado, aeronave->id);
         
-        sem_wait(&mutex_console);
-        imprimir_timestamp();
-        printf("Aeronave %d assumiu setor %d\n", aeronave->id, setor_desejado);
-        sem_post(&mutex_console);
+        log_evento("Aeronave %d assumiu setor %d\n", aeronave->id, setor_desejado);
+        atc_liberar_setor_interno(aeronave, anterior);
 
-        sem_post(&mutex_ctrl);
+        atc_destravar();
+        // Espera nula também é amostra: mantém as estatísticas por concessão
+        aeronave_registro_tempo_espera(aeronave, aeronave->instante_solicitacao_ns);
         return 1;
     }
 }
 
+/**
+ * Coloca um pedido na fila do controlador central e acorda a thread dele se
+ * estiver dormindo
+ * @param pedido: Pedido embutido na aeronave
+ * @param setor: Setor a adquirir ou liberar
+ */
+static void atc_enviar_pedido(pedido_controle_t *pedido, int setor) {
+    // Uma liberação anterior pode ainda não ter sido atendida: o nó não pode
+    // entrar duas vezes nem ser reescrito antes disso
+    while (atomic_load_explicit(&pedido->pendente, memory_order_acquire)) {
+        sched_yield();
+    }
+    pedido->setor = setor;
+    atomic_store_explicit(&pedido->pendente, true, memory_order_relaxed);
+    fila_mpsc_inserir(&fila_pedidos, &pedido->no);
+    // Par com controlador_dormir (liga a flag, depois olha a fila): a troca da
+    // inserção é só acq_rel, e sem a barreira os dois lados podem não se ver
+    // e o controlador dormir sem prazo com o pedido na fila
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_exchange(&controlador_dormindo, false)) {
+        sem_post(&sem_controlador);
+    }
+}
+
+/**
+ * Uma tentativa de obter o setor no modo central: envia o pedido e dorme até
+ * a thread do controlador responder
+ * @param aeronave: Aeronave que está solicitando o setor
+ * @param setor_desejado: Índice do setor desejado
+ * @return 1 se obteve o setor, 0 em caso de erro, TENTAR_NOVAMENTE após um recuo
+ */
+static int atc_tentar_setor_central(aeronave_t *aeronave, int setor_desejado) {
+    // setor_atual não é lido aqui: a thread do controlador o muda (preempção,
+    // recuo forçado) e é ela quem confere se a aeronave já está no setor
+    aeronave->instante_solicitacao_ns = relogio_agora_ns();
+    aeronave->instante_repasse_ns = 0;
+    aeronave->resposta_controle = RESPOSTA_PENDENTE;
+    atc_enviar_pedido(&aeronave->pedido_setor, setor_desejado);
+    return atc_aguardar_resposta(aeronave, setor_desejado);
+}
+
+/**
+ * Espera a resposta da thread do controlador a um pedido de setor (modo central)
+ * @param aeronave: Aeronave com o pedido enviado (ou já na fila do setor)
+ * @param setor_desejado: Setor pedido
+ * @return 1 se recebeu o setor, 0 em caso de erro, TENTAR_NOVAMENTE após um recuo
+ */
+static int atc_aguardar_resposta(aeronave_t *aeronave, int setor_desejado) {
+    long long inicio = aeronave->instante_solicitacao_ns;
+
+    verificador_estacionar(aeronave->id, setor_desejado);
+    desempenho_entrar(DESEMPENHO_ESPERA);
+    espera_aguardar(&aeronave->sem_aeronave);
+    desempenho_sair();
+    verificador_despertar(aeronave->id);
+
+    // O controlador escreveu a resposta e o instante antes do sem_post
+    if (aeronave->instante_repasse_ns != 0) {
+        espera_registrar_repasse(relogio_agora_ns() - aeronave->instante_repasse_ns);
+    }
+
+    switch (aeronave->resposta_controle) {
+    case RESPOSTA_CONCEDIDO:
+        atc_concluir_espera(aeronave, inicio);
+        return 1;
+    case RESPOSTA_JA_NO_SETOR:
+        return 1;
+    case RESPOSTA_BLOQUEADO:
+        // O controlador já liberou o setor atual; mesma pausa do modo com travas
+        desempenho_entrar(DESEMPENHO_ESPERA);
+        temporizador_dormir_ms(100);
+        desempenho_sair();
+        return TENTAR_NOVAMENTE;
+    case RESPOSTA_ERRO:
+        return 0;
+    default:
+        // Sem resposta: foi tirada da fila como vítima de um deadlock
+        atc_travar();
+        atc_registrar_recuo(aeronave);
+        int setor_atual = aeronave->setor_atual;
+        atc_destravar();
+        log_evento("*** A%d recuando de S%d devido a deadlock (recuo #%d) ***\n", 
+                   aeronave->id, setor_atual, aeronave->contador_recuos);
+        return TENTAR_NOVAMENTE;
+    }
+}
+
+/**
+ * Volta a esperar por um setor na fila em que a aeronave estava quando o
+ * checkpoint foi gravado (a fila já foi restaurada com ela dentro)
+ * @param aeronave: Aeronave restaurada na fase FASE_PEDINDO
+ * @param setor_desejado: Setor cuja fila ela aguarda
+ * @return 1 se o setor foi obtido com sucesso, 0 se ocorreu um erro
+ */
+int atc_retomar_espera(aeronave_t *aeronave, int setor_desejado) {
+    int resultado = modo_controlador == CONTROLADOR_CENTRAL ?
+        atc_aguardar_resposta(aeronave, setor_desejado) :
+        atc_aguardar_na_fila(aeronave, setor_desejado);
+    if (resultado == TENTAR_NOVAMENTE) {
+        resultado = atc_solicitar_setor(aeronave, setor_desejado);
+    }
+    return resultado;
+}
+
+/**
+ * Solicita acesso a um setor específico para uma aeronave. Na concessão o
+ * setor anterior é devolvido pelo próprio controlador e setor_atual passa a
+ * ser o novo, então a aeronave não libera nada entre um trecho e outro
+ * @param aeronave: Ponteiro para a aeronave que está solicitando o setor
+ * @param setor_desejado: Índice do setor que a aeronave deseja acessar
+ * @return 1 se o setor foi obtido com sucesso, 0 se ocorreu um erro
+ */
+int atc_solicitar_setor(aeronave_t *aeronave, int setor_desejado) {
+    // Laço em vez de recursão: recuos repetidos não crescem a pilha (threads têm pilha pequena)
+    int resultado;
+    do {
+        desempenho_entrar(DESEMPENHO_PEDIDO);
+        if (modo_controlador == CONTROLADOR_CENTRAL) {
+            resultado = atc_tentar_setor_central(aeronave, setor_desejado);
+        } else {
+            resultado = atc_tentar_setor(aeronave, setor_desejado);
+        }
+        desempenho_sair();
+    } while (resultado == TENTAR_NOVAMENTE);
+    return resultado;
+}
+
 /**
  * Libera internamente um setor (função auxiliar chamada por outras funções)
+ * Quem recebe o setor deixa o anterior no mesmo passo, então um repasse pode
+ * liberar outro setor: a cadeia segue em laço (as threads têm pilha pequena)
+ * Deve ser chamada com mutex_ctrl
  * @param aeronave: Ponteiro para a aeronave que está liberando o setor
- * @param setor_liberado: Índice do setor que está sendo liberado
+ * @param setor_liberado: Índice do setor que está sendo liberado (-1 = nenhum)
  */
 static void atc_liberar_setor_interno(aeronave_t *aeronave, int setor_liberado) {
-    if (setor_liberado < 0 || setor_liberado >= total_setores) {
-        return;
-    }
-
-    // Marcar setor livre
-    setores_ocupados[setor_liberado] = -1;
-    
-    // Remove a próxima aeronave da fila (maior prioridade)
-    aeronave_t *proxima_aeronave = fila_remover(&fila_setores[setor_liberado]);
+    desempenho_entrar(DESEMPENHO_REPASSE);
+    while (setor_liberado >= 0 && setor_liberado < total_setores) {
+        // Marcar setor livre
+        verificador_desocupar(setor_liberado, aeronave->id);
+        setores_ocupados[setor_liberado] = -1;
+        ocupacao_liberar(setor_liberado);
+        estimativa_liberar(setor_liberado, relogio_agora_ns());
+        atc_propagar_prioridade(aeronave); // O que herdou por este setor deixa de valer
+        
+        // Remove a próxima aeronave da fila (corredor de emergência, depois maior prioridade)
+        aeronave_t *proxima_aeronave = atc_proxima_da_fila(setor_liberado);
+        if (proxima_aeronave == NULL) {
+            instantaneo_ocupante(setor_liberado, -1);
+            log_evento("Aeronave %d liberou setor %d (Setor livre agora)\n", 
+                       aeronave->id, setor_liberado);
+            break;
+        }
 
-    if (proxima_aeronave != NULL) {
-        setores_ocupados[setor_liberado] = proxima_aeronave->id;
-        sem_post(&proxima_aeronave->sem_aeronave);
+        tabela.setor_aguardado[proxima_aeronave->id] = -1;
+        int anterior = atc_ocupar(proxima_aeronave, setor_liberado);
+        instantaneo_repassar(setor_liberado, proxima_aeronave->id);
+        proxima_aeronave->instante_repasse_ns = relogio_agora_ns();
+        proxima_aeronave->resposta_controle = RESPOSTA_CONCEDIDO;
+        atc_acordar(proxima_aeronave);
 
-        sem_wait(&mutex_console);
-        imprimir_timestamp();
-        printf("Controle: Setor %d liberado por %d e repassado para %d\n", 
-               setor_liberado, aeronave->id, proxima_aeronave->id);
-        sem_post(&mutex_console);
-    } else {
-        sem_wait(&mutex_console);
-        imprimir_timestamp();
-        printf("Aeronave %d liberou setor %d (Setor livre agora)\n", 
-               aeronave->id, setor_liberado);
-        sem_post(&mutex_console);
+        log_evento("Controle: Setor %d liberado por %d e repassado para %d\n", 
+                   setor_liberado, aeronave->id, proxima_aeronave->id);
+        aeronave = proxima_aeronave;
+        setor_liberado = anterior;
     }
+    desempenho_sair();
 }
 
 /**
@@ -275,13 +1533,86 @@ static void atc_liberar_setor_interno(aeronave_t *aeronave, int setor_liberado)
  * @param setor_liberado: Índice do setor que está sendo liberado
  */
 void atc_liberar_setor(aeronave_t *aeronave, int setor_liberado) {
-    sem_wait(&mutex_ctrl);
+    // No modo central a liberação não espera: o controlador repassa o setor no próximo lote
+    if (modo_controlador == CONTROLADOR_CENTRAL) {
+        atc_enviar_pedido(&aeronave->pedido_liberacao, setor_liberado);
+        return;
+    }
+    atc_travar();
     atc_liberar_setor_interno(aeronave, setor_liberado);
-    sem_post(&mutex_ctrl);
+    atc_destravar();
+}
+
+/**
+ * Devolve o setor que a aeronave ocupa (fim da rota ou saída para outra
+ * região) e zera setor_atual sob mutex_ctrl. Se outra thread já o devolveu
+ * por ela (recuo, ciclo entre regiões), não faz nada
+ * @param aeronave: Aeronave que deixa o setor atual
+ * @return Setor devolvido, -1 se a aeronave não ocupava nenhum
+ */
+int atc_deixar_setor(aeronave_t *aeronave) {
+    atc_travar();
+    int setor = aeronave->setor_atual;
+    aeronave->setor_atual = -1;
+    if (modo_controlador != CONTROLADOR_CENTRAL) {
+        atc_liberar_setor_interno(aeronave, setor);
+    }
+    atc_destravar();
+
+    if (modo_controlador == CONTROLADOR_CENTRAL && setor >= 0) {
+        atc_enviar_pedido(&aeronave->pedido_liberacao, setor);
+    }
+    return setor;
 }
 
 //-------Algumas funções auxiliares------
 
+/**
+ * Faz uma vítima de deadlock recuar: ela está dormindo na fila, então o
+ * controlador a tira de lá, devolve o setor que ela ocupa e a acorda
+ * Deve ser chamada com mutex_ctrl
+ * @param vitima: Aeronave em espera escolhida para recuar
+ */
+static void atc_forcar_recuo(aeronave_t *vitima) {
+    atc_contabilizar_perda(vitima, true, true);
+    int setor_fila = tabela.setor_aguardado[vitima->id];
+    if (setor_fila >= 0) {
+        atc_retirar_da_fila(vitima, setor_fila);
+    }
+    tabela.setor_aguardado[vitima->id] = -1;
+    instantaneo_desenfileirar(vitima->id);
+    atc_propagar_setor(setor_fila);
+    vitima->precisa_recuar = true;
+
+    int setor_liberar = vitima->setor_atual;
+    vitima->setor_atual = -1;
+    atc_liberar_setor_interno(vitima, setor_liberar);
+    atc_acordar(vitima);
+}
+
+/**
+ * Escolhe a vítima de um ciclo que passa pelo solicitante: a de menor custo de
+ * recuo (vitima_calcular_custo). Nos empates o solicitante recua, como antes
+ * Deve ser chamada com mutex_ctrl
+ * @param solicitante: Aeronave cujo pedido fecha o ciclo
+ * @param ocupante_id: Ocupante do setor pedido (primeiro elo do ciclo)
+ * @return Aeronave que deve recuar
+ */
+static aeronave_t *atc_escolher_vitima(aeronave_t *solicitante, int ocupante_id) {
+    long long agora = relogio_agora_ns();
+    aeronave_t *vitima = solicitante;
+    double menor_custo = vitima_calcular_custo(solicitante, tabela.propria[solicitante->id], agora);
+
+    for (int id = ocupante_id; id != solicitante->id; id = setores_ocupados[tabela.setor_aguardado[id]]) {
+        double custo = vitima_calcular_custo(tabela.aeronave[id], tabela.propria[id], agora);
+        if (custo < menor_custo) {
+            menor_custo = custo;
+            vitima = tabela.aeronave[id];
+        }
+    }
+    return vitima;
+}
+
 /**
  * Verifica se a concessão de um setor causaria deadlock usando detecção de ciclos
  * @param solicitante: Ponteiro para a aeronave que está solicitando o setor
@@ -307,94 +1638,70 @@ bool verificar_deadlock(aeronave_t *solicitante, int setor_desejado) {
     }
     
     // Busca por ciclo: segue a cadeia de dependências
-    int visitados[total_aeronaves];
-    for (int i = 0; i < total_aeronaves; i++) visitados[i] = 0;
-    
-    aeronave_t *menor_prioridade = solicitante;
-    unsigned int min_prioridade = solicitante->prioridade;
+    // Uma nova época dispensa zerar as marcas de visita a cada chamada
+    unsigned int epoca = ++tabela.epoca_visita;
+    if (epoca == 0) {
+        memset(tabela.marca_visita, 0, sizeof(unsigned int) * tabela.capacidade);
+        epoca = tabela.epoca_visita = 1;
+    }
     
     int atual_id = ocupante_id;
-    visitados[solicitante->id] = 1;
+    tabela.marca_visita[solicitante->id] = epoca;
     
     // Segue a cadeia de espera
-        while (atual_id != -1) {
+    while (atual_id != -1) {
         if (atual_id == solicitante->id) {
             // CICLO ENCONTRADO!
-            total_deadlocks_detectados++;
-            sem_wait(&mutex_console);
-            imprimir_timestamp();
-            printf("!! DEADLOCK em ciclo: A%d(P:%u) -> ... -> A%d !!\n",
-                   solicitante->id, solicitante->prioridade, solicitante->id);
+            contadores_incrementar(CONTADOR_DEADLOCKS);
             
-            // Sempre bloqueia o SOLICITANTE se ele está no ciclo
-            // Ele que está tentando entrar e causando o problema
-            // Usa prioridade EFETIVA (pode ter boost anti-starvation)
-            if (solicitante->prioridade <= min_prioridade) {
-                printf("   -> A%d (P:%u) bloqueado - menor/igual prioridade no ciclo\n", 
-                       solicitante->id, solicitante->prioridade);
-                sem_post(&mutex_console);
+            // Quem acabou de perder a vez num ciclo e o reencontra devolve o setor:
+            // escolher outra vítima só passaria a vez adiante (com custos que mudam
+            // a cada recuo, indefinidamente). Fora isso, só agora o custo de cada elo
+            // é calculado: a caminhada comum lê apenas a tabela
+            aeronave_t *vitima = solicitante->recuo_recente ? solicitante :
+                                 atc_escolher_vitima(solicitante, ocupante_id);
+            if (vitima == solicitante) {
+                log_evento("!! DEADLOCK em ciclo: A%d(P:%u) -> ... -> A%d !!\n"
+                           "   -> A%d (P:%u) bloqueado - menor custo de recuo no ciclo (%s)\n",
+                           solicitante->id, solicitante->prioridade, solicitante->id,
+                           solicitante->id, solicitante->prioridade, vitima_nome());
                 return true; // Bloqueia o solicitante
-            } else {
-                char boost_info[100] = "";
-                if (solicitante->prioridade > solicitante->prioridade_original) {
-                    snprintf(boost_info, sizeof(boost_info), " [BOOST: %u->%u]", 
-                            solicitante->prioridade_original, solicitante->prioridade);
-                }
-                printf("   -> A%d tem alta prioridade%s, forçando recuo de A%d (P:%u)\n",
-                       solicitante->id, boost_info, menor_prioridade->id, menor_prioridade->prioridade);
-                sem_post(&mutex_console);
-                
-                // Força a de menor prioridade a recuar
-                if (menor_prioridade->id != solicitante->id) {
-                    menor_prioridade->precisa_recuar = true;
-                    // Procura em qual fila está esperando e remove
-                    for (int s = 0; s < total_setores; s++) {
-                        if (fila_remover_aeronave(&fila_setores[s], menor_prioridade)) {
-                            sem_post(&menor_prioridade->sem_aeronave);
-                            break;
-                        }
-                    }
-                }
-                return false; // Permite solicitante continuar
             }
-        }        if (visitados[atual_id]) {
-            break; // Já visitado, mas não forma ciclo com solicitante
-        }
-        visitados[atual_id] = 1;
-        
-        // Busca a aeronave atual
-        aeronave_t *aero_atual = NULL;
-        for (int i = 0; i < total_aeronaves; i++) {
-            if (aeronaves[i] != NULL && aeronaves[i]->id == atual_id) {
-                aero_atual = aeronaves[i];
-                break;
+
+            char boost_info[100] = "";
+            if (tabela.propria[solicitante->id] > solicitante->prioridade_original) {
+                snprintf(boost_info, sizeof(boost_info), " [BOOST: %u->%u]", 
+                        solicitante->prioridade_original, solicitante->prioridade);
             }
-        }
-        
-        if (aero_atual == NULL) break;
-        
-        // Atualiza menor prioridade no ciclo
-        if (aero_atual->prioridade < min_prioridade) {
-            min_prioridade = aero_atual->prioridade;
-            menor_prioridade = aero_atual;
-        }
-        
-        // Procura qual setor essa aeronave está esperando
-        int proximo_setor = -1;
-        for (int s = 0; s < total_setores; s++) {
-            if (fila_vazio(&fila_setores[s])) continue;
+            log_evento("!! DEADLOCK em ciclo: A%d(P:%u) -> ... -> A%d !!\n"
+                       "   -> A%d continua%s, forçando recuo de A%d (P:%u, menor custo: %s)\n",
+                       solicitante->id, solicitante->prioridade, solicitante->id,
+                       solicitante->id, boost_info, vitima->id, vitima->prioridade, vitima_nome());
             
-            no_fila_t *no = fila_setores[s].inicio;
-            while (no != NULL) {
-                if (no->aeronave->id == atual_id) {
-                    proximo_setor = s;
-                    break;
-                }
-                no = no->proximo;
+            // Força a vítima a recuar; a tabela diz em qual fila está esperando
+            // Ela só perde a vez na fila: ao tentar de novo, se o ciclo ainda existir,
+            // é ela quem devolve o setor (ver recuo_recente)
+            vitima->precisa_recuar = true;
+            int setor_fila = tabela.setor_aguardado[vitima->id];
+            if (setor_fila >= 0 && atc_retirar_da_fila(vitima, setor_fila)) {
+                atc_contabilizar_perda(vitima, false, true);
+                tabela.setor_aguardado[vitima->id] = -1;
+                instantaneo_desenfileirar(vitima->id);
+                atc_propagar_setor(setor_fila);
+                atc_acordar(vitima);
             }
-            if (proximo_setor >= 0) break;
+            return false; // Permite solicitante continuar
+        }
+        if (atual_id < 0 || atual_id >= tabela.capacidade || tabela.aeronave[atual_id] == NULL) {
+            break;
+        }
+        if (tabela.marca_visita[atual_id] == epoca) {
+            break; // Já visitado, mas não forma ciclo com solicitante
         }
+        tabela.marca_visita[atual_id] = epoca;
         
+        // Qual setor essa aeronave está esperando?
+        int proximo_setor = tabela.setor_aguardado[atual_id];
         if (proximo_setor < 0) break; // Não está esperando nada
         
         // Quem ocupa o próximo setor?
@@ -406,56 +1713,310 @@ bool verificar_deadlock(aeronave_t *solicitante, int setor_desejado) {
 
 /**
  * Imprime o estado atual de ocupação de todos os setores do espaço aéreo
+ * Lê uma cópia do espelho (instantaneo), sem travar o controlador
  */
 void imprimir_estado_setores(){
+    instantaneo_t inst;
+    if (!instantaneo_capturar(&inst)) return;
+
     sem_wait(&mutex_console);
-    printf("ESTADO DOS SETORES:\n");
-    for(int i = 0; i < total_setores; i++){
-        if(setores_ocupados[i] == -1){
+    printf("ESTADO DOS SETORES (%d livres de %d):\n", ocupacao_livres(0, inst.total_setores), inst.total_setores);
+    for(int i = 0; i < inst.total_setores; i++){
+        if(inst.ocupante[i] == -1){
             printf("Setor %d: LIVRE\n", i);
         }
         else{
-            printf("Setor %d: OCUPADO por Aeronave %d\n", i, setores_ocupados[i]);
+            printf("Setor %d: OCUPADO por Aeronave %d\n", i, inst.ocupante[i]);
         }
     }
     sem_post(&mutex_console);
+    instantaneo_liberar(&inst);
+}
+
+/**
+ * Imprime a espera estimada em cada setor ocupado ou com fila, para a menor e
+ * a maior prioridade, sem travar o controlador
+ */
+void imprimir_estimativas() {
+    sem_wait(&mutex_console);
+    printf("ESPERA ESTIMADA POR SETOR (P%d / P%d):\n", 1, PRIORIDADE_MAX);
+    for (int s = 0; s < total_setores; s++) {
+        if (ocupacao_carga(s) == 0) continue; // Livre e sem fila
+        int fila = estimativa_tamanho_fila(s);
+        printf("Setor %d: %.1f ms / %.1f ms | fila %d | posse média %.1f ms\n", s,
+               atc_estimar_espera(s, 1) / 1e6, atc_estimar_espera(s, PRIORIDADE_MAX) / 1e6, fila,
+               estimativa_servico(s) / 1e6);
+    }
+    sem_post(&mutex_console);
+}
+
+/**
+ * Imprime os contadores de eventos somados ao vivo, sem travar o controlador
+ */
+void imprimir_contadores() {
+    contadores_t c;
+    contadores_ler(&c);
+    sem_wait(&mutex_console);
+    printf("CONTADORES: %lld concessões | %lld deadlocks | %lld recuos | %lld boosts | %lld preempções (%d threads)\n",
+           c.valor[CONTADOR_TRANSFERENCIAS], c.valor[CONTADOR_DEADLOCKS], c.valor[CONTADOR_RECUOS],
+           c.valor[CONTADOR_BOOSTS], c.valor[CONTADOR_PREEMPCOES], c.threads);
+    sem_post(&mutex_console);
+}
+
+/**
+ * Aplica um pedido no estado dos setores (modo central, thread do controlador)
+ * Mesmas regras de atc_tentar_setor, mas quem espera é a aeronave e não o controlador
+ * Deve ser chamada com mutex_ctrl
+ * @param pedido: Pedido retirado da fila
+ */
+static void atc_aplicar_pedido(pedido_controle_t *pedido) {
+    aeronave_t *aeronave = pedido->aeronave;
+    int setor = pedido->setor;
+
+    if (pedido->liberar) {
+        atc_liberar_setor_interno(aeronave, setor);
+        return;
+    }
+
+    if (setor < 0 || setor >= total_setores) {
+        aeronave->resposta_controle = RESPOSTA_ERRO;
+        atc_acordar(aeronave);
+        return;
+    }
+    if (aeronave->setor_atual == setor) {
+        aeronave->resposta_controle = RESPOSTA_JA_NO_SETOR;
+        atc_acordar(aeronave);
+        return;
+    }
+
+    atc_desalojar(aeronave, setor);
+
+    // --- CAMINHO LIVRE ---
+    if (setores_ocupados[setor] == -1 || setores_ocupados[setor] == aeronave->id) {
+        int anterior = atc_ocupar(aeronave, setor);
+        instantaneo_ocupante(setor, aeronave->id);
+        log_evento("Aeronave %d assumiu setor %d\n", aeronave->id, setor);
+        aeronave->instante_repasse_ns = relogio_agora_ns();
+        aeronave->resposta_controle = RESPOSTA_CONCEDIDO;
+        aeronave->recuo_recente = false;
+        atc_acordar(aeronave);
+        // A aeronave está parada esperando a resposta: o anterior sai neste lote
+        atc_liberar_setor_interno(aeronave, anterior);
+        return;
+    }
+
+    // A aeronave está bloqueada esperando a resposta: o controlador pode liberar por ela
+    bool vai_travar = false;
+    if (modo_deteccao == DETECCAO_POR_PEDIDO) {
+        desempenho_entrar(DESEMPENHO_DEADLOCK);
+        vai_travar = verificar_deadlock(aeronave, setor);
+        desempenho_sair();
+    }
+    aeronave->recuo_recente = false;
+    if (vai_travar) {
+        log_evento("Aeronave %d (P:%d) BLOQUEADO em S%d - liberando setor atual S%d para evitar deadlock\n", 
+                   aeronave->id, aeronave->prioridade, setor, aeronave->setor_atual);
+        atc_contabilizar_perda(aeronave, true, false);
+        int setor_liberar = aeronave->setor_atual;
+        aeronave->setor_atual = -1;
+        atc_liberar_setor_interno(aeronave, setor_liberar);
+        aeronave->resposta_controle = RESPOSTA_BLOQUEADO;
+        atc_acordar(aeronave);
+        return;
+    }
+
+    log_evento("Aeronave %d (P:%d) aguardando setor %d (OCUPADO por %d)\n", 
+               aeronave->id, aeronave->prioridade, setor, setores_ocupados[setor]);
+    atc_ceder_a_emergencia(aeronave);
+    atc_enfileirar(aeronave, setor);
+}
+
+/**
+ * Resolve um ciclo achado pelo detector periódico. O instantaneo pode estar
+ * velho, então o ciclo é conferido no estado atual antes de escolher a vítima
+ * (menor custo de recuo), que sai da fila e devolve o setor que ocupa
+ * @param ciclo: Ids em ordem de espera (ciclo[k] espera por ciclo[k+1])
+ * @param tamanho: Número de aeronaves no ciclo
+ * @param contexto: Não utilizado
+ */
+static void atc_resolver_ciclo(const int *ciclo, int tamanho, void *contexto) {
+    (void)contexto;
+    atc_travar();
+
+    for (int k = 0; k < tamanho; k++) {
+        int setor = tabela.setor_aguardado[ciclo[k]];
+        if (setor < 0 || setores_ocupados[setor] != ciclo[(k + 1) % tamanho]) {
+            atc_destravar(); // Já se desfez desde a cópia
+            return;
+        }
+    }
+
+    long long agora = relogio_agora_ns();
+    int vitima_id = ciclo[0];
+    double menor_custo = vitima_calcular_custo(tabela.aeronave[vitima_id], tabela.propria[vitima_id], agora);
+    for (int k = 1; k < tamanho; k++) {
+        double custo = vitima_calcular_custo(tabela.aeronave[ciclo[k]], tabela.propria[ciclo[k]], agora);
+        if (custo < menor_custo) {
+            menor_custo = custo;
+            vitima_id = ciclo[k];
+        }
+    }
+
+    contadores_incrementar(CONTADOR_DEADLOCKS);
+    aeronave_t *vitima = tabela.aeronave[vitima_id];
+    log_evento("!! DEADLOCK (detector) em ciclo de %d aeronaves: A%d -> ... -> A%d !!\n"
+               "   -> forçando recuo de A%d (P:%u), que libera S%d\n",
+               tamanho, ciclo[0], ciclo[0], vitima_id, tabela.prioridade[vitima_id],
+               vitima->setor_atual);
+
+    atc_forcar_recuo(vitima);
+    atc_destravar();
+}
+
+/**
+ * @return Período do detector em ns de relógio (comprimido pela escala de tempo)
+ */
+static long long atc_periodo_deteccao_ns() {
+    return (long long)periodo_deteccao_ms * 1000000LL / (escala_tempo > 0 ? escala_tempo : 1);
+}
+
+/**
+ * Uma passada do detector periódico: copia o estado sem travar, acha todos os
+ * ciclos com Tarjan e só trava para conferir e resolver cada um
+ */
+static void atc_detectar_ciclos() {
+    instantaneo_t inst;
+    if (!instantaneo_capturar(&inst)) return;
+    desempenho_entrar(DESEMPENHO_DEADLOCK);
+    grafo_espera_montar(&grafo_espera, &inst);
+    instantaneo_liberar(&inst);
+
+    grafo_espera_ciclos(&grafo_espera, atc_resolver_ciclo, NULL);
+    contadores_incrementar(CONTADOR_PASSADAS_DETECCAO);
+    desempenho_sair();
+}
+
+/**
+ * Dorme até chegar um pedido, o encerramento ser pedido ou o prazo vencer
+ * Os produtores só fazem sem_post se virem controlador_dormindo ligado; a
+ * flag e a fila são lidas aqui com seq_cst, par da barreira de atc_enviar_pedido
+ * @param prazo_ns: Instante (relogio_agora_ns) para acordar sozinho, 0 = sem prazo
+ */
+static void controlador_dormir(long long prazo_ns) {
+    atomic_store(&controlador_dormindo, true);
+    bool pedidos = modo_controlador == CONTROLADOR_CENTRAL && !fila_mpsc_vazia(&fila_pedidos);
+    if (!pedidos && !atomic_load(&controlador_encerrando)) {
+        if (prazo_ns == 0) {
+            sem_wait(&sem_controlador);
+        } else {
+            long long restante = prazo_ns - relogio_agora_ns();
+            if (restante > 0) {
+                // O prazo vem na escala de relogio_agora_ns: só a duração passa para a do kernel
+                struct timespec limite;
+                relogio_prazo_espera(relogio_espera_ns() + restante, &limite);
+                while (sem_clockwait(&sem_controlador, RELOGIO_ESPERA, &limite) != 0 && errno == EINTR) {
+                    continue;
+                }
+            }
+        }
+    }
+    atomic_store(&controlador_dormindo, false);
+}
+
+/**
+ * Thread do detector periódico no modo com travas: as aeronaves enfileiram
+ * sem verificar ciclos e esta thread os procura a cada periodo_deteccao_ms
+ * @param arg: Argumento genérico (não utilizado)
+ * @return NULL ao finalizar a execução
+ */
+void *controlador_detector_executar(void *arg) {
+    (void)arg;
+    contadores_registrar_thread();
+    long long periodo_ns = atc_periodo_deteccao_ns();
+    while (!atomic_load(&controlador_encerrando)) {
+        controlador_dormir(relogio_agora_ns() + periodo_ns);
+        if (atomic_load(&controlador_encerrando)) break;
+        atc_detectar_ciclos();
+    }
+    return NULL;
 }
 
 /**
- * Função principal do controlador central que monitora e exibe o estado do sistema
+ * Thread do controlador central (modo central): retira os pedidos em lotes,
+ * aplica concessões e repasses numa única passada sob mutex_ctrl e só então
+ * acorda as aeronaves atendidas
  * @param arg: Argumento genérico (não utilizado)
  * @return NULL ao finalizar a execução
  */
 void *controlador_central_executar(void *arg){
-    while(simulacao_ativa){
-        imprimir_estado_setores();
-        sleep(3);
+    (void)arg;
+    contadores_registrar_thread();
+    pedido_controle_t *lote[LOTE_MAX];
+    long long periodo_ns = atc_periodo_deteccao_ns();
+    long long proxima_deteccao_ns = modo_deteccao == DETECCAO_PERIODICA ? relogio_agora_ns() + periodo_ns : 0;
+
+    while (true) {
+        // Entre lotes: o detector periódico roda na mesma thread
+        if (proxima_deteccao_ns != 0 && relogio_agora_ns() >= proxima_deteccao_ns) {
+            atc_detectar_ciclos();
+            proxima_deteccao_ns = relogio_agora_ns() + periodo_ns;
+        }
+
+        int n = 0;
+        no_mpsc_t *no;
+        while (n < LOTE_MAX && (no = fila_mpsc_remover(&fila_pedidos)) != NULL) {
+            lote[n++] = (pedido_controle_t *)no;
+        }
+
+        if (n == 0) {
+            // Todas as aeronaves já terminaram quando o encerramento é pedido
+            if (atomic_load(&controlador_encerrando)) break;
+            if (!fila_mpsc_vazia(&fila_pedidos)) {
+                sched_yield(); // Um produtor está no meio da inserção
+            } else {
+                controlador_dormir(proxima_deteccao_ns);
+            }
+            continue;
+        }
+
+        atc_travar();
+        atendendo_lote = true;
+        for (int i = 0; i < n; i++) {
+            desempenho_entrar(DESEMPENHO_PEDIDO);
+            atc_aplicar_pedido(lote[i]);
+            desempenho_sair();
+            // Daqui em diante o dono pode reutilizar o pedido
+            atomic_store_explicit(&lote[i]->pendente, false, memory_order_release);
+        }
+        atendendo_lote = false;
+        contadores_incrementar(CONTADOR_LOTES);
+        contadores_adicionar(CONTADOR_PEDIDOS_LOTE, n);
+        int acordar = total_despertar;
+        total_despertar = 0;
+        atc_destravar();
+
+        // Só esta thread usa o vetor; os sem_post ficam fora da seção crítica
+        for (int i = 0; i < acordar; i++) {
+            sem_post(&despertar[i]->sem_aeronave);
+        }
     }
     return NULL;
 }
 
 /**
- * Libera forçadamente todos os setores ocupados por uma aeronave em situação de emergência
+ * Libera forçadamente o setor ocupado por uma aeronave em situação de emergência
+ * (uma aeronave ocupa no máximo um setor, setor_atual, então não há varredura)
  * @param aeronave: Ponteiro para a aeronave em situação de emergência
  */
 void liberar_setor_emergencia(aeronave_t *aeronave) {
-    sem_wait(&mutex_ctrl);
-    
-    int setor_encontrado = -1;
-    for (int i = 0; i < total_setores; i++) {
-        if (setores_ocupados[i] == aeronave->id) {
-            setor_encontrado = i;
-            break;
-        }
-    }
+    atc_travar();
     
+    int setor_encontrado = aeronave->setor_atual;
     if (setor_encontrado != -1) {
-        sem_wait(&mutex_console);
-        imprimir_timestamp();
-        printf("!!! EMERGÊNCIA !!! Aeronave %d (P:%d) liberando forçadamente setor %d\n", 
-               aeronave->id, aeronave->prioridade, setor_encontrado);
-        sem_post(&mutex_console);
+        log_evento("!!! EMERGÊNCIA !!! Aeronave %d (P:%d) liberando forçadamente setor %d\n", 
+                   aeronave->id, aeronave->prioridade, setor_encontrado);
         
+        aeronave->setor_atual = -1;
         atc_liberar_setor_interno(aeronave, setor_encontrado);
     } else {
         sem_wait(&mutex_console);
@@ -464,22 +2025,30 @@ void liberar_setor_emergencia(aeronave_t *aeronave) {
         sem_post(&mutex_console);
     }
     
-    sem_post(&mutex_ctrl);
+    atc_destravar();
 }
 
 /**
  * Imprime as filas de espera de todos os setores que possuem aeronaves aguardando acesso
  */
 void imprimir_fila_espera(){
-    sem_wait(&mutex_ctrl);
+    instantaneo_t inst;
+    if (!instantaneo_capturar(&inst)) return;
+
     sem_wait(&mutex_console);
 
     int filas_vazias = 1;
     printf("-----FILAS DE ESPERA POR SETOR:-----\n");
-    for(int i = 0; i < total_setores; i++){
-        if(!fila_vazio(&fila_setores[i])){
-            printf("Setor %02d: ", i);
-            fila_imprimir(&fila_setores[i]);
+    for(int i = 0; i < inst.total_setores; i++){
+        int inicio = inst.inicio_fila[i];
+        int fim = inst.inicio_fila[i + 1];
+        if(inicio < fim){
+            printf("Setor %02d: [", i);
+            for (int k = inicio; k < fim; k++) {
+                int id = inst.fila[k];
+                printf("A%d(P:%u)%s", id, inst.prioridade[id], k + 1 < fim ? ", " : "");
+            }
+            printf("]\n");
 
             filas_vazias = 0;
         }
@@ -489,6 +2058,5 @@ void imprimir_fila_espera(){
     }
     
     sem_post(&mutex_console);
-    sem_post(&mutex_ctrl);
-
+    instantaneo_liberar(&inst);
 }
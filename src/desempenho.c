@@ -0,0 +1,400 @@
+#define _GNU_SOURCE // syscall (perf_event_open não tem função na libc)
+#include "../include/desempenho.h"
+
+#ifdef DESEMPENHO_COMPILADO
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "../include/utils.h"
+
+#define LEITURA_CABECALHO 3 // nr, tempo habilitado e tempo contando antes dos valores
+
+// Eventos na ordem em que entram no grupo: o primeiro que abrir é o líder
+static const struct {
+    uint32_t tipo;
+    uint64_t config;
+    const char *nome;
+} eventos[DESEMPENHO_EVENTOS] = {
+    [DESEMPENHO_CICLOS] = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, "ciclos" },
+    [DESEMPENHO_INSTRUCOES] = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, "instr" },
+    [DESEMPENHO_FALHAS_L1] = { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D |
+                                                   (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                                   (PERF_COUNT_HW_CACHE_RESULT_MISS << 16), "L1d" },
+    [DESEMPENHO_FALHAS_LLC] = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, "LLC" },
+    [DESEMPENHO_FALHAS_DESVIO] = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, "desvios" },
+    [DESEMPENHO_TROCAS] = { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES, "trocas" },
+    [DESEMPENHO_TEMPO_CPU] = { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK, "cpu" },
+};
+
+static const char *nomes_fases[DESEMPENHO_FASES] = {
+    [DESEMPENHO_PEDIDO] = "pedido",
+    [DESEMPENHO_TRAVA] = "trava",
+    [DESEMPENHO_ESPERA] = "espera",
+    [DESEMPENHO_DEADLOCK] = "deadlock",
+    [DESEMPENHO_ENFILEIRAR] = "enfileirar",
+    [DESEMPENHO_REPASSE] = "repasse",
+    [DESEMPENHO_LOG] = "log",
+};
+
+// Somas de uma thread: só ela escreve, e só são lidas em desempenho_finalizar,
+// com as threads da execução já encerradas
+typedef struct bloco_desempenho {
+    _Alignas(LINHA_CACHE) long long valor[DESEMPENHO_FASES][DESEMPENHO_EVENTOS];
+    long long entradas[DESEMPENHO_FASES];
+    long long habilitado_ns[DESEMPENHO_FASES]; // Grupo habilitado durante a fase...
+    long long contando_ns[DESEMPENHO_FASES];   // ... e de fato na PMU (o resto foi multiplexado)
+    long long transbordos;                     // Entradas além de DESEMPENHO_PROFUNDIDADE
+    int posicao[DESEMPENHO_EVENTOS];           // Posição do evento na leitura do grupo, -1 = fora
+    uint64_t ultima[LEITURA_CABECALHO + DESEMPENHO_EVENTOS];
+    desempenho_fase_t pilha[DESEMPENHO_PROFUNDIDADE];
+    int profundidade;
+    struct bloco_desempenho *proximo;          // Escrito antes de o bloco ser publicado
+} bloco_desempenho_t;
+
+// Totais da última execução, montados em desempenho_finalizar
+typedef struct {
+    long long valor[DESEMPENHO_FASES][DESEMPENHO_EVENTOS];
+    long long entradas[DESEMPENHO_FASES];
+    long long entradas_medidas[DESEMPENHO_FASES][DESEMPENHO_EVENTOS]; // Só de threads com o evento
+    long long habilitado_ns[DESEMPENHO_FASES];
+    long long contando_ns[DESEMPENHO_FASES];
+    long long transbordos;
+    int threads;
+    int threads_medidas; // Threads com algum evento aberto
+    int com_evento[DESEMPENHO_EVENTOS];
+    bool valido;
+} resumo_desempenho_t;
+
+bool desempenho_ativo = false;
+static bool ligado = false;
+static resumo_desempenho_t resumo;
+
+static _Atomic(bloco_desempenho_t *) blocos = NULL;
+static _Atomic unsigned int geracao = 1; // Muda a cada execução: blocos antigos deixam de valer
+static _Atomic int erro_evento[DESEMPENHO_EVENTOS];      // Primeiro errno de quem não abriu
+static _Atomic bool so_usuario[DESEMPENHO_EVENTOS];      // Aberto sem o kernel (perf_event_paranoid)
+
+// Os descritores são da thread (fecham quando ela termina ou na próxima
+// execução), não do bloco: o bloco some em desempenho_finalizar
+static _Thread_local bloco_desempenho_t *bloco_local = NULL;
+static _Thread_local unsigned int geracao_local = 0;
+static _Thread_local int fds_locais[DESEMPENHO_EVENTOS];
+static _Thread_local int total_fds_locais = 0;
+
+static pthread_key_t chave_thread;
+static pthread_once_t chave_criada = PTHREAD_ONCE_INIT;
+
+/**
+ * Fecha os eventos da thread chamadora
+ */
+static void desempenho_fechar_locais() {
+    for (int i = 0; i < total_fds_locais; i++) {
+        close(fds_locais[i]);
+    }
+    total_fds_locais = 0;
+}
+
+/**
+ * Destrutor da chave da thread: fecha os eventos quando ela termina
+ * @param dado: Valor da chave (não utilizado)
+ */
+static void desempenho_fechar_thread(void *dado) {
+    (void)dado;
+    desempenho_fechar_locais();
+}
+
+static void desempenho_criar_chave() {
+    pthread_key_create(&chave_thread, desempenho_fechar_thread);
+}
+
+/**
+ * Abre um evento para a thread chamadora. Sem permissão para o kernel
+ * (perf_event_paranoid alto), tenta de novo contando só o modo usuário
+ * @param evento: Evento a abrir
+ * @param lider: fd do líder do grupo, -1 para abrir como líder
+ * @return fd do evento, -1 se indisponível
+ */
+static int desempenho_abrir_evento(desempenho_evento_t evento, int lider) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = eventos[evento].tipo;
+    attr.config = eventos[evento].config;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    attr.exclude_hv = 1;
+
+    int fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, lider, PERF_FLAG_FD_CLOEXEC);
+    if (fd < 0 && (errno == EACCES || errno == EPERM)) {
+        attr.exclude_kernel = 1;
+        fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, lider, PERF_FLAG_FD_CLOEXEC);
+        if (fd >= 0) atomic_store(&so_usuario[evento], true);
+    }
+    if (fd < 0) {
+        int nenhum = 0;
+        atomic_compare_exchange_strong(&erro_evento[evento], &nenhum, errno);
+    }
+    return fd;
+}
+
+/**
+ * Lê o grupo da thread chamadora de uma vez
+ * @param bloco: Bloco da thread (guarda a leitura anterior)
+ * @param leitura: Recebe cabeçalho e valores; se a leitura falhar, repete a anterior
+ */
+static void desempenho_ler(const bloco_desempenho_t *bloco, uint64_t *leitura) {
+    ssize_t lidos = read(fds_locais[0], leitura, sizeof(bloco->ultima));
+    if (lidos < (ssize_t)(LEITURA_CABECALHO * sizeof(uint64_t))) {
+        memcpy(leitura, bloco->ultima, sizeof(bloco->ultima));
+    }
+}
+
+/**
+ * Lê o grupo e soma a diferença desde a última leitura na fase do topo
+ * @param bloco: Bloco da thread chamadora
+ */
+static void desempenho_contabilizar(bloco_desempenho_t *bloco) {
+    if (total_fds_locais == 0) return;
+    uint64_t agora[LEITURA_CABECALHO + DESEMPENHO_EVENTOS] = {0};
+    desempenho_ler(bloco, agora);
+    if (bloco->profundidade > 0) {
+        desempenho_fase_t fase = bloco->pilha[bloco->profundidade - 1];
+        bloco->habilitado_ns[fase] += (long long)(agora[1] - bloco->ultima[1]);
+        bloco->contando_ns[fase] += (long long)(agora[2] - bloco->ultima[2]);
+        for (int e = 0; e < DESEMPENHO_EVENTOS; e++) {
+            int p = bloco->posicao[e];
+            if (p >= 0) {
+                bloco->valor[fase][e] += (long long)(agora[LEITURA_CABECALHO + p] -
+                                                     bloco->ultima[LEITURA_CABECALHO + p]);
+            }
+        }
+    }
+    memcpy(bloco->ultima, agora, sizeof(agora));
+}
+
+/**
+ * Bloco da thread chamadora nesta execução; na primeira fase da thread abre
+ * o grupo de eventos (os que o kernel aceitar) e publica o bloco
+ * @return Bloco da thread, NULL sem memória
+ */
+static bloco_desempenho_t *desempenho_bloco() {
+    unsigned int atual = atomic_load_explicit(&geracao, memory_order_relaxed);
+    if (geracao_local == atual) return bloco_local; // NULL se já falhou nesta execução
+    geracao_local = atual;
+    bloco_local = NULL;
+    desempenho_fechar_locais(); // Eventos de uma execução anterior desta mesma thread
+
+    void *memoria = NULL;
+    if (posix_memalign(&memoria, LINHA_CACHE, sizeof(bloco_desempenho_t)) != 0) return NULL;
+    bloco_desempenho_t *bloco = memoria;
+    memset(bloco, 0, sizeof(*bloco));
+
+    for (int e = 0; e < DESEMPENHO_EVENTOS; e++) {
+        bloco->posicao[e] = -1;
+        int fd = desempenho_abrir_evento(e, total_fds_locais > 0 ? fds_locais[0] : -1);
+        if (fd < 0) continue;
+        bloco->posicao[e] = total_fds_locais;
+        fds_locais[total_fds_locais++] = fd;
+    }
+    if (total_fds_locais > 0) {
+        pthread_once(&chave_criada, desempenho_criar_chave);
+        pthread_setspecific(chave_thread, fds_locais);
+        desempenho_contabilizar(bloco); // Só a leitura inicial: a pilha está vazia
+    }
+
+    bloco->proximo = atomic_load(&blocos);
+    while (!atomic_compare_exchange_weak(&blocos, &bloco->proximo, bloco));
+    bloco_local = bloco;
+    return bloco;
+}
+
+/**
+ * Entra numa fase: o que a thread gastou até aqui vai para a fase anterior
+ * @param fase: Fase que começa
+ */
+void desempenho_entrar_fase(desempenho_fase_t fase) {
+    bloco_desempenho_t *bloco = desempenho_bloco();
+    if (bloco == NULL) return;
+    bloco->entradas[fase]++;
+    if (bloco->profundidade >= DESEMPENHO_PROFUNDIDADE) {
+        // Fundo demais: a fase mais interna guardada fica com o custo
+        bloco->profundidade++;
+        bloco->transbordos++;
+        return;
+    }
+    desempenho_contabilizar(bloco);
+    bloco->pilha[bloco->profundidade++] = fase;
+}
+
+/**
+ * Sai da fase mais interna: o gasto desde a última troca fica com ela
+ */
+void desempenho_sair_fase() {
+    // Uma fase aberta numa execução anterior não tem mais bloco
+    if (geracao_local != atomic_load_explicit(&geracao, memory_order_relaxed)) return;
+    bloco_desempenho_t *bloco = bloco_local;
+    if (bloco == NULL || bloco->profundidade == 0) return;
+    if (bloco->profundidade > DESEMPENHO_PROFUNDIDADE) {
+        bloco->profundidade--;
+        return;
+    }
+    desempenho_contabilizar(bloco);
+    bloco->profundidade--;
+}
+
+/**
+ * Liga ou desliga a medição nas próximas execuções. Cada thread medida
+ * segura até DESEMPENHO_EVENTOS descritores, então o limite de arquivos
+ * abertos sobe até o máximo permitido
+ * @param valor: true para medir
+ * @return true (a medição está compilada)
+ */
+bool desempenho_ligar(bool valor) {
+    ligado = valor;
+    if (valor) {
+        struct rlimit limite;
+        if (getrlimit(RLIMIT_NOFILE, &limite) == 0 && limite.rlim_cur < limite.rlim_max) {
+            limite.rlim_cur = limite.rlim_max;
+            setrlimit(RLIMIT_NOFILE, &limite);
+        }
+    }
+    return true;
+}
+
+bool desempenho_ligado() {
+    return ligado;
+}
+
+/**
+ * Libera os blocos da execução anterior
+ */
+static void desempenho_liberar_blocos() {
+    bloco_desempenho_t *b = atomic_exchange(&blocos, NULL);
+    while (b != NULL) {
+        bloco_desempenho_t *proximo = b->proximo;
+        free(b);
+        b = proximo;
+    }
+}
+
+/**
+ * Começa a medir uma execução (em atc_init, antes das threads)
+ */
+void desempenho_reiniciar() {
+    desempenho_liberar_blocos();
+    atomic_fetch_add(&geracao, 1);
+    for (int e = 0; e < DESEMPENHO_EVENTOS; e++) {
+        atomic_store(&erro_evento[e], 0);
+        atomic_store(&so_usuario[e], false);
+    }
+    memset(&resumo, 0, sizeof(resumo));
+    desempenho_ativo = ligado;
+}
+
+/**
+ * Soma os blocos no resumo e os libera (em atc_finalizar, com as threads da
+ * execução encerradas). Fases abertas depois disto não contam
+ */
+void desempenho_finalizar() {
+    if (!desempenho_ativo) return;
+    desempenho_ativo = false;
+
+    bloco_desempenho_t *b = atomic_load(&blocos);
+    for (; b != NULL; b = b->proximo) {
+        bool medido = false;
+        for (int e = 0; e < DESEMPENHO_EVENTOS; e++) {
+            if (b->posicao[e] >= 0) {
+                medido = true;
+                resumo.com_evento[e]++;
+            }
+        }
+        resumo.threads++;
+        if (medido) resumo.threads_medidas++;
+        resumo.transbordos += b->transbordos;
+        for (int f = 0; f < DESEMPENHO_FASES; f++) {
+            resumo.entradas[f] += b->entradas[f];
+            resumo.habilitado_ns[f] += b->habilitado_ns[f];
+            resumo.contando_ns[f] += b->contando_ns[f];
+            for (int e = 0; e < DESEMPENHO_EVENTOS; e++) {
+                if (b->posicao[e] < 0) continue;
+                resumo.valor[f][e] += b->valor[f][e];
+                resumo.entradas_medidas[f][e] += b->entradas[f];
+            }
+        }
+    }
+    resumo.valido = true;
+    desempenho_liberar_blocos();
+    atomic_fetch_add(&geracao, 1);
+}
+
+/**
+ * Imprime uma média por entrada numa coluna, ou n/d sem o evento
+ * @param fase: Linha
+ * @param evento: Coluna
+ * @param divisor: Unidade (1 para contagens, 1000 para ns em µs)
+ * @param largura: Largura da coluna
+ */
+static void desempenho_imprimir_media(int fase, int evento, double divisor, int largura) {
+    if (resumo.entradas_medidas[fase][evento] == 0) {
+        printf(" %*s", largura, "n/d");
+        return;
+    }
+    printf(" %*.1f", largura, resumo.valor[fase][evento] / divisor / resumo.entradas_medidas[fase][evento]);
+}
+
+/**
+ * Imprime a tabela da última execução medida: médias por entrada em cada
+ * fase (exclusivas) e os eventos que ficaram de fora
+ */
+void desempenho_imprimir() {
+    if (!resumo.valido) return;
+    printf("Contadores por fase (exclusivos, média por entrada; %d de %d threads com eventos):\n",
+           resumo.threads_medidas, resumo.threads);
+    printf("%-11s %10s %10s %9s %6s %8s %8s %8s %7s %9s %8s\n", "fase", "entradas", "ciclos",
+           "instr", "IPC", "L1d", "LLC", "desvios", "trocas", "cpu(us)", "cobert.");
+    for (int f = 0; f < DESEMPENHO_FASES; f++) {
+        if (resumo.entradas[f] == 0) continue;
+        printf("%-11s %10lld", nomes_fases[f], resumo.entradas[f]);
+        desempenho_imprimir_media(f, DESEMPENHO_CICLOS, 1, 10);
+        desempenho_imprimir_media(f, DESEMPENHO_INSTRUCOES, 1, 9);
+        if (resumo.valor[f][DESEMPENHO_CICLOS] > 0 && resumo.entradas_medidas[f][DESEMPENHO_INSTRUCOES] > 0) {
+            printf(" %6.2f", (double)resumo.valor[f][DESEMPENHO_INSTRUCOES] / resumo.valor[f][DESEMPENHO_CICLOS]);
+        } else {
+            printf(" %6s", "n/d");
+        }
+        desempenho_imprimir_media(f, DESEMPENHO_FALHAS_L1, 1, 8);
+        desempenho_imprimir_media(f, DESEMPENHO_FALHAS_LLC, 1, 8);
+        desempenho_imprimir_media(f, DESEMPENHO_FALHAS_DESVIO, 1, 8);
+        desempenho_imprimir_media(f, DESEMPENHO_TROCAS, 1, 7);
+        desempenho_imprimir_media(f, DESEMPENHO_TEMPO_CPU, 1000, 9);
+        if (resumo.habilitado_ns[f] > 0) {
+            printf(" %7.1f%%\n", 100.0 * resumo.contando_ns[f] / resumo.habilitado_ns[f]);
+        } else {
+            printf(" %8s\n", "n/d");
+        }
+    }
+
+    for (int e = 0; e < DESEMPENHO_EVENTOS; e++) {
+        int erro = atomic_load(&erro_evento[e]);
+        if (erro != 0 && resumo.com_evento[e] == 0) {
+            printf("  %s: indisponível (%s)\n", eventos[e].nome, strerror(erro));
+        } else if (erro != 0) {
+            printf("  %s: indisponível em %d de %d threads (%s)\n", eventos[e].nome,
+                   resumo.threads - resumo.com_evento[e], resumo.threads, strerror(erro));
+        } else if (atomic_load(&so_usuario[e])) {
+            printf("  %s: só modo usuário (sem permissão para contar o kernel)\n", eventos[e].nome);
+        }
+    }
+    if (resumo.transbordos > 0) {
+        printf("  %lld entradas além de %d fases aninhadas foram somadas à fase de fora\n",
+               resumo.transbordos, DESEMPENHO_PROFUNDIDADE);
+    }
+}
+#endif // DESEMPENHO_COMPILADO
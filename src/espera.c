@@ -0,0 +1,372 @@
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <sched.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "../include/espera.h"
+#include "../include/utils.h"
+#include "../include/relogio.h"
+
+// Limites do giro: acima disso a espera esperada é longa e girar só queima CPU
+#define GIRO_MIN_NS 2000LL
+#define GIRO_MAX_NS 50000LL
+#define RENDICOES_MAX 16
+
+// Fração das esperas recentes resolvidas sem dormir, em 1/TAXA_ESCALA. Abaixo
+// de TAXA_MIN a aeronave vai direto para o semáforo, salvo uma em cada
+// SONDAGEM_PERIODO, que gira e cede para a taxa voltar a subir se as esperas
+// encurtarem
+#define TAXA_ESCALA 1024
+#define TAXA_MIN (TAXA_ESCALA / 8)
+#define SONDAGEM_PERIODO 16
+
+// Histograma logarítmico de latências: 8 sub-faixas por potência de 2 (erro < 12,5%)
+#define SUBFAIXAS_BITS 3
+#define SUBFAIXAS (1 << SUBFAIXAS_BITS)
+#define FAIXAS_HISTOGRAMA (64 * SUBFAIXAS)
+
+static modo_espera_t modo_espera = ESPERA_ADAPTATIVA;
+
+// Média móvel exponencial (peso 1/8) da latência de repasse: o quanto acordar
+// uma aeronave custa, que é o que o giro tenta economizar
+static _Atomic long long media_repasse_ns = 0;
+// Média móvel exponencial (peso 1/16) da fração de esperas resolvidas girando ou cedendo
+static _Atomic int taxa_curtas = TAXA_ESCALA;
+static _Atomic unsigned int sondagens = 0;
+
+static long cpus = 1;
+static pthread_once_t cpus_contadas = PTHREAD_ONCE_INIT;
+
+static _Atomic long total_giro = 0;
+static _Atomic long total_rendicao = 0;
+static _Atomic long total_dormindo = 0;
+
+static _Atomic unsigned long histograma_repasse[FAIXAS_HISTOGRAMA];
+static _Atomic long long soma_repasse_ns = 0;
+static _Atomic long long max_repasse_ns = 0;
+
+// Espera de cada concessão de setor (média e máximo ficam nos agregados das aeronaves)
+// (o máximo de cada histograma limita os percentis dele)
+static _Atomic unsigned long histograma_concessao[FAIXAS_HISTOGRAMA];
+static _Atomic long long max_concessao_ns = 0;
+static _Atomic unsigned long histograma_emergencia[FAIXAS_HISTOGRAMA]; // Só a classe de emergência
+static _Atomic long long max_emergencia_ns = 0;
+static _Atomic unsigned long histograma_alta[FAIXAS_HISTOGRAMA];      // Só prioridade própria alta
+static _Atomic long long max_alta_ns = 0;
+
+// Janela de medição do regime aberto: concessões fora dela (aquecimento e
+// drenagem) não entram no histograma. Fim 0 = sem janela, conta tudo
+static _Atomic long long janela_inicio_ns = 0;
+static _Atomic long long janela_fim_ns = 0;
+
+/**
+ * Dica ao processador de que estamos num laço de espera ativa
+ */
+static inline void pausa_cpu() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ volatile("yield");
+#endif
+}
+
+/**
+ * Seleciona o modo de espera pelo nome
+ * @param nome: "bloqueante" ou "adaptativa"
+ * @return true se o nome for conhecido
+ */
+bool espera_definir_modo(const char *nome) {
+    if (strcmp(nome, "bloqueante") == 0) {
+        modo_espera = ESPERA_BLOQUEANTE;
+    } else if (strcmp(nome, "adaptativa") == 0) {
+        modo_espera = ESPERA_ADAPTATIVA;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @return Nome do modo de espera em uso
+ */
+const char *espera_nome_modo() {
+    return modo_espera == ESPERA_BLOQUEANTE ? "bloqueante" : "adaptativa";
+}
+
+/**
+ * Zera a estimativa e as estatísticas (início de cada simulação)
+ */
+void espera_reiniciar() {
+    atomic_store(&media_repasse_ns, 0);
+    atomic_store(&taxa_curtas, TAXA_ESCALA);
+    atomic_store(&sondagens, 0);
+    atomic_store(&total_giro, 0);
+    atomic_store(&total_rendicao, 0);
+    atomic_store(&total_dormindo, 0);
+    atomic_store(&soma_repasse_ns, 0);
+    atomic_store(&max_repasse_ns, 0);
+    atomic_store(&max_concessao_ns, 0);
+    atomic_store(&max_emergencia_ns, 0);
+    atomic_store(&max_alta_ns, 0);
+    atomic_store(&janela_inicio_ns, 0);
+    atomic_store(&janela_fim_ns, 0);
+    for (int i = 0; i < FAIXAS_HISTOGRAMA; i++) {
+        atomic_store_explicit(&histograma_repasse[i], 0, memory_order_relaxed);
+        atomic_store_explicit(&histograma_concessao[i], 0, memory_order_relaxed);
+        atomic_store_explicit(&histograma_emergencia[i], 0, memory_order_relaxed);
+        atomic_store_explicit(&histograma_alta[i], 0, memory_order_relaxed);
+    }
+}
+
+/**
+ * Restringe o histograma de concessões a uma janela do relógio (depois de
+ * espera_reiniciar, antes da largada)
+ * @param inicio_ns: Primeiro instante contado (relogio_agora_ns)
+ * @param fim_ns: Último instante contado (0 = sem janela)
+ */
+void espera_definir_janela(long long inicio_ns, long long fim_ns) {
+    atomic_store(&janela_inicio_ns, inicio_ns);
+    atomic_store(&janela_fim_ns, fim_ns);
+}
+
+/**
+ * Incorpora uma latência de repasse na média que dá o orçamento do giro
+ * (CAS: duas aeronaves atualizando juntas não perdem uma das amostras)
+ */
+static void espera_atualizar_media(long long latencia_ns) {
+    long long media = atomic_load_explicit(&media_repasse_ns, memory_order_relaxed);
+    while (!atomic_compare_exchange_weak_explicit(&media_repasse_ns, &media, media + (latencia_ns - media) / 8,
+                                                  memory_order_relaxed, memory_order_relaxed));
+}
+
+/**
+ * Incorpora o desfecho de uma espera que tentou girar e ceder na taxa de
+ * esperas curtas
+ * @param curta: Resolvida antes de dormir no semáforo
+ */
+static void espera_atualizar_taxa(bool curta) {
+    int amostra = curta ? TAXA_ESCALA : 0;
+    int taxa = atomic_load_explicit(&taxa_curtas, memory_order_relaxed);
+    while (!atomic_compare_exchange_weak_explicit(&taxa_curtas, &taxa, taxa + (amostra - taxa) / 16,
+                                                  memory_order_relaxed, memory_order_relaxed));
+}
+
+static void espera_contar_cpus() {
+    cpus = sysconf(_SC_NPROCESSORS_ONLN);
+}
+
+/**
+ * Eleva o máximo atômico até o valor, se for maior
+ */
+static void espera_atualizar_max(_Atomic long long *max, long long valor) {
+    long long atual = atomic_load_explicit(max, memory_order_relaxed);
+    while (valor > atual && !atomic_compare_exchange_weak(max, &atual, valor));
+}
+
+/**
+ * Aguarda o semáforo. No modo adaptativo, enquanto as esperas recentes
+ * costumam acabar antes de dormir, gira por até duas vezes a latência média
+ * de repasse (havendo mais de uma CPU), depois cede a CPU algumas vezes e só
+ * então dorme no semáforo. A duração das esperas não serve de medida: com os
+ * trechos de voo ela fica em milissegundos e o giro nunca voltaria
+ * @param sem: Semáforo da aeronave
+ */
+void espera_aguardar(sem_t *sem) {
+    if (modo_espera == ESPERA_BLOQUEANTE) {
+        while (sem_wait(sem) != 0 && errno == EINTR);
+        atomic_fetch_add_explicit(&total_dormindo, 1, memory_order_relaxed);
+        return;
+    }
+
+    pthread_once(&cpus_contadas, espera_contar_cpus);
+
+    bool tentar = atomic_load_explicit(&taxa_curtas, memory_order_relaxed) >= TAXA_MIN ||
+                  atomic_fetch_add_explicit(&sondagens, 1, memory_order_relaxed) % SONDAGEM_PERIODO == 0;
+    if (tentar) {
+        // Fase 1: giro (inútil com uma CPU só: o ocupante não roda enquanto giramos)
+        if (cpus > 1) {
+            long long orcamento = 2 * atomic_load_explicit(&media_repasse_ns, memory_order_relaxed);
+            if (orcamento < GIRO_MIN_NS) orcamento = GIRO_MIN_NS;
+            if (orcamento > GIRO_MAX_NS) orcamento = GIRO_MAX_NS;
+            long long inicio = relogio_agora_ns();
+            for (unsigned int i = 1; ; i++) {
+                if (sem_trywait(sem) == 0) {
+                    atomic_fetch_add_explicit(&total_giro, 1, memory_order_relaxed);
+                    espera_atualizar_taxa(true);
+                    return;
+                }
+                pausa_cpu();
+                if ((i & 63) == 0 && relogio_agora_ns() - inicio > orcamento) break;
+            }
+        }
+
+        // Fase 2: cede a CPU (deixa o ocupante terminar sem pagar um sono)
+        for (int i = 0; i < RENDICOES_MAX; i++) {
+            sched_yield();
+            if (sem_trywait(sem) == 0) {
+                atomic_fetch_add_explicit(&total_rendicao, 1, memory_order_relaxed);
+                espera_atualizar_taxa(true);
+                return;
+            }
+        }
+        espera_atualizar_taxa(false);
+    }
+
+    // Fase 3: dorme no semáforo (futex)
+    while (sem_wait(sem) != 0 && errno == EINTR);
+    atomic_fetch_add_explicit(&total_dormindo, 1, memory_order_relaxed);
+}
+
+/**
+ * Índice da faixa do histograma para uma latência
+ */
+static int faixa_histograma(unsigned long long valor) {
+    if (valor < SUBFAIXAS) return (int)valor;
+    int expoente = 63 - __builtin_clzll(valor);
+    int sub = (int)((valor >> (expoente - SUBFAIXAS_BITS)) & (SUBFAIXAS - 1));
+    return (expoente - SUBFAIXAS_BITS + 1) * SUBFAIXAS + sub;
+}
+
+/**
+ * Limite inferior (em ns) dos valores de uma faixa do histograma
+ */
+static double limite_faixa(int faixa) {
+    if (faixa < SUBFAIXAS) return faixa;
+    int expoente = faixa / SUBFAIXAS + SUBFAIXAS_BITS - 1;
+    int sub = faixa % SUBFAIXAS;
+    return (double)((1ULL << expoente) + ((unsigned long long)sub << (expoente - SUBFAIXAS_BITS)));
+}
+
+/**
+ * Registra a latência de um repasse: da liberação do setor até o novo
+ * ocupante voltar a executar
+ * @param latencia_ns: Latência medida em nanossegundos
+ */
+void espera_registrar_repasse(long long latencia_ns) {
+    if (latencia_ns < 0) latencia_ns = 0;
+    atomic_fetch_add_explicit(&histograma_repasse[faixa_histograma(latencia_ns)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&soma_repasse_ns, latencia_ns, memory_order_relaxed);
+    espera_atualizar_max(&max_repasse_ns, latencia_ns);
+    espera_atualizar_media(latencia_ns);
+}
+
+/**
+ * Registra a espera de uma concessão de setor: do pedido até receber o setor
+ * @param espera_ns: Espera medida em nanossegundos
+ * @param emergencia: A aeronave é da classe de emergência (entra também no histograma dela)
+ * @param alta: A prioridade original da aeronave é pelo menos ESPERA_PRIORIDADE_ALTA (idem)
+ */
+void espera_registrar_concessao(long long espera_ns, bool emergencia, bool alta) {
+    if (espera_ns < 0) espera_ns = 0;
+    long long fim = atomic_load_explicit(&janela_fim_ns, memory_order_relaxed);
+    if (fim > 0) {
+        long long agora = relogio_agora_ns();
+        if (agora < atomic_load_explicit(&janela_inicio_ns, memory_order_relaxed) || agora > fim) return;
+    }
+    atomic_fetch_add_explicit(&histograma_concessao[faixa_histograma(espera_ns)], 1, memory_order_relaxed);
+    espera_atualizar_max(&max_concessao_ns, espera_ns);
+    if (emergencia) {
+        atomic_fetch_add_explicit(&histograma_emergencia[faixa_histograma(espera_ns)], 1, memory_order_relaxed);
+        espera_atualizar_max(&max_emergencia_ns, espera_ns);
+    }
+    if (alta) {
+        atomic_fetch_add_explicit(&histograma_alta[faixa_histograma(espera_ns)], 1, memory_order_relaxed);
+        espera_atualizar_max(&max_alta_ns, espera_ns);
+    }
+}
+
+/**
+ * Percentil aproximado a partir do histograma, em ns: interpola dentro da
+ * faixa pela posição da amostra entre as da faixa e nunca passa do máximo
+ * registrado (a faixa do topo vai muito além dele)
+ * @param contagens: Histograma
+ * @param total: Soma das contagens
+ * @param p: Percentil (0-100)
+ * @param max_ns: Maior valor registrado
+ */
+static double percentil_histograma(const unsigned long *contagens, long total, double p, long long max_ns) {
+    long alvo = (long)(p / 100.0 * total + 0.999999);
+    if (alvo < 1) alvo = 1;
+    long acumulado = 0;
+    for (int i = 0; i < FAIXAS_HISTOGRAMA; i++) {
+        if (contagens[i] == 0) continue;
+        if (acumulado + (long)contagens[i] >= alvo) {
+            double inicio = limite_faixa(i);
+            double fim = limite_faixa(i + 1);
+            double valor = inicio + (fim - inicio) * (double)(alvo - acumulado) / contagens[i];
+            return valor < (double)max_ns ? valor : (double)max_ns;
+        }
+        acumulado += contagens[i];
+    }
+    return (double)max_ns;
+}
+
+/**
+ * Copia as estatísticas de espera e latência de repasse
+ * @param estatisticas: Estrutura a ser preenchida
+ */
+void espera_obter_estatisticas(espera_estatisticas_t *estatisticas) {
+    memset(estatisticas, 0, sizeof(*estatisticas));
+    estatisticas->esperas_giro = atomic_load(&total_giro);
+    estatisticas->esperas_rendicao = atomic_load(&total_rendicao);
+    estatisticas->esperas_dormindo = atomic_load(&total_dormindo);
+
+    unsigned long contagens[FAIXAS_HISTOGRAMA];
+    long total = 0;
+    for (int i = 0; i < FAIXAS_HISTOGRAMA; i++) {
+        contagens[i] = atomic_load_explicit(&histograma_repasse[i], memory_order_relaxed);
+        total += contagens[i];
+    }
+    long concessoes = 0;
+    for (int i = 0; i < FAIXAS_HISTOGRAMA; i++) {
+        contagens[i] = atomic_load_explicit(&histograma_concessao[i], memory_order_relaxed);
+        concessoes += contagens[i];
+    }
+    estatisticas->concessoes = concessoes;
+    if (concessoes > 0) {
+        long long max_concessao = atomic_load(&max_concessao_ns);
+        estatisticas->concessao_p50 = percentil_histograma(contagens, concessoes, 50.0, max_concessao) / 1e6;
+        estatisticas->concessao_p99 = percentil_histograma(contagens, concessoes, 99.0, max_concessao) / 1e6;
+        estatisticas->concessao_p999 = percentil_histograma(contagens, concessoes, 99.9, max_concessao) / 1e6;
+    }
+
+    long emergencias = 0;
+    for (int i = 0; i < FAIXAS_HISTOGRAMA; i++) {
+        contagens[i] = atomic_load_explicit(&histograma_emergencia[i], memory_order_relaxed);
+        emergencias += contagens[i];
+    }
+    estatisticas->emergencias = emergencias;
+    if (emergencias > 0) {
+        long long max_emergencia = atomic_load(&max_emergencia_ns);
+        estatisticas->emergencia_p50 = percentil_histograma(contagens, emergencias, 50.0, max_emergencia) / 1e6;
+        estatisticas->emergencia_p99 = percentil_histograma(contagens, emergencias, 99.0, max_emergencia) / 1e6;
+        estatisticas->emergencia_p999 = percentil_histograma(contagens, emergencias, 99.9, max_emergencia) / 1e6;
+        estatisticas->emergencia_max = max_emergencia / 1e6;
+    }
+
+    long altas = 0;
+    for (int i = 0; i < FAIXAS_HISTOGRAMA; i++) {
+        contagens[i] = atomic_load_explicit(&histograma_alta[i], memory_order_relaxed);
+        altas += contagens[i];
+    }
+    estatisticas->altas = altas;
+    if (altas > 0) {
+        long long max_alta = atomic_load(&max_alta_ns);
+        estatisticas->alta_p50 = percentil_histograma(contagens, altas, 50.0, max_alta) / 1e6;
+        estatisticas->alta_p99 = percentil_histograma(contagens, altas, 99.0, max_alta) / 1e6;
+        estatisticas->alta_p999 = percentil_histograma(contagens, altas, 99.9, max_alta) / 1e6;
+    }
+
+    for (int i = 0; i < FAIXAS_HISTOGRAMA; i++) {
+        contagens[i] = atomic_load_explicit(&histograma_repasse[i], memory_order_relaxed);
+    }
+    estatisticas->repasses = total;
+    if (total == 0) return;
+
+    long long max_repasse = atomic_load(&max_repasse_ns);
+    estatisticas->repasse_media = atomic_load(&soma_repasse_ns) / 1000.0 / total;
+    estatisticas->repasse_p50 = percentil_histograma(contagens, total, 50.0, max_repasse) / 1000.0;
+    estatisticas->repasse_p99 = percentil_histograma(contagens, total, 99.0, max_repasse) / 1000.0;
+    estatisticas->repasse_max = max_repasse / 1000.0;
+}
@@ -0,0 +1,195 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include "../include/estimativa.h"
+#include "../include/utils.h"
+
+// Agregados de um setor numa linha de cache própria: o controlador escreve com
+// load e store relaxados (um escritor, sob mutex_ctrl) e qualquer thread lê
+typedef struct {
+    _Alignas(LINHA_CACHE) _Atomic long long servico_ns; // Média móvel da posse
+    _Atomic long long inicio_ns;                        // Posse em andamento (0 = livre)
+    _Atomic int corredor;                               // Emergências à espera
+    _Atomic int total;                                  // Fila comum
+    _Atomic int faixa[ESTIMATIVA_FAIXAS];               // Fila comum por faixa de prioridade
+} agregado_setor_t;
+
+static agregado_setor_t *agregados = NULL;
+static int total_setores = 0;
+static unsigned int largura_faixa = 1;
+
+/**
+ * Aloca os agregados com todos os setores livres e filas vazias
+ * @param setores: Número de setores
+ * @param prioridade_max: Maior prioridade efetiva (com boost); acima dela fica na última faixa
+ * @param servico_inicial_ns: Posse suposta antes da primeira amostra (relogio_agora_ns)
+ * @return true em caso de sucesso
+ */
+bool estimativa_inicializar(int setores, unsigned int prioridade_max, long long servico_inicial_ns) {
+    estimativa_finalizar();
+    void *memoria = NULL;
+    if (posix_memalign(&memoria, LINHA_CACHE, sizeof(agregado_setor_t) * setores) != 0) {
+        fprintf(stderr, "Erro ao alocar o estimador de espera\n");
+        return false;
+    }
+    agregados = memoria;
+    total_setores = setores;
+    largura_faixa = prioridade_max / ESTIMATIVA_FAIXAS + 1;
+    for (int s = 0; s < setores; s++) {
+        agregado_setor_t *a = &agregados[s];
+        atomic_init(&a->servico_ns, servico_inicial_ns);
+        atomic_init(&a->inicio_ns, 0);
+        atomic_init(&a->corredor, 0);
+        atomic_init(&a->total, 0);
+        for (int f = 0; f < ESTIMATIVA_FAIXAS; f++) {
+            atomic_init(&a->faixa[f], 0);
+        }
+    }
+    return true;
+}
+
+/**
+ * Libera os agregados
+ */
+void estimativa_finalizar() {
+    free(agregados);
+    agregados = NULL;
+    total_setores = 0;
+}
+
+/**
+ * Faixa de uma prioridade (maior faixa = atendida antes na política prioridade)
+ */
+static inline int estimativa_faixa(unsigned int prioridade) {
+    unsigned int f = prioridade / largura_faixa;
+    return f < ESTIMATIVA_FAIXAS ? (int)f : ESTIMATIVA_FAIXAS - 1;
+}
+
+/**
+ * Soma um valor a um contador do setor (só o escritor sob mutex_ctrl)
+ */
+static inline void estimativa_somar(_Atomic int *contador, int valor) {
+    atomic_store_explicit(contador, atomic_load_explicit(contador, memory_order_relaxed) + valor,
+                          memory_order_relaxed);
+}
+
+/**
+ * Conta uma aeronave que entrou na fila de um setor
+ * @param setor: Setor aguardado
+ * @param prioridade: Prioridade efetiva na entrada
+ * @param corredor: true se entrou no corredor de emergência
+ */
+void estimativa_enfileirar(int setor, unsigned int prioridade, bool corredor) {
+    if (agregados == NULL || setor < 0 || setor >= total_setores) return;
+    agregado_setor_t *a = &agregados[setor];
+    if (corredor) {
+        estimativa_somar(&a->corredor, 1);
+        return;
+    }
+    estimativa_somar(&a->total, 1);
+    estimativa_somar(&a->faixa[estimativa_faixa(prioridade)], 1);
+}
+
+/**
+ * Desconta uma aeronave que saiu da fila (atendida ou recuando)
+ * @param setor: Setor aguardado
+ * @param prioridade: Prioridade efetiva com que foi contada
+ * @param corredor: true se estava no corredor de emergência
+ */
+void estimativa_desenfileirar(int setor, unsigned int prioridade, bool corredor) {
+    if (agregados == NULL || setor < 0 || setor >= total_setores) return;
+    agregado_setor_t *a = &agregados[setor];
+    if (corredor) {
+        estimativa_somar(&a->corredor, -1);
+        return;
+    }
+    estimativa_somar(&a->total, -1);
+    estimativa_somar(&a->faixa[estimativa_faixa(prioridade)], -1);
+}
+
+/**
+ * Marca o início de uma posse do setor
+ * @param setor: Setor concedido
+ * @param agora_ns: Instante da concessão
+ */
+void estimativa_ocupar(int setor, long long agora_ns) {
+    if (agregados == NULL || setor < 0 || setor >= total_setores) return;
+    atomic_store_explicit(&agregados[setor].inicio_ns, agora_ns > 0 ? agora_ns : 1, memory_order_relaxed);
+}
+
+/**
+ * Fecha a posse do setor e a leva para a média móvel do serviço
+ * @param setor: Setor liberado
+ * @param agora_ns: Instante da liberação
+ */
+void estimativa_liberar(int setor, long long agora_ns) {
+    if (agregados == NULL || setor < 0 || setor >= total_setores) return;
+    agregado_setor_t *a = &agregados[setor];
+    long long inicio = atomic_load_explicit(&a->inicio_ns, memory_order_relaxed);
+    atomic_store_explicit(&a->inicio_ns, 0, memory_order_relaxed);
+    if (inicio == 0 || agora_ns < inicio) return;
+
+    long long media = atomic_load_explicit(&a->servico_ns, memory_order_relaxed);
+    media += (agora_ns - inicio - media) / ESTIMATIVA_PESO;
+    atomic_store_explicit(&a->servico_ns, media, memory_order_relaxed);
+}
+
+/**
+ * Estima quanto uma aeronave que pedisse o setor agora esperaria: o resto da
+ * posse em andamento mais uma posse média por aeronave à frente. Na política
+ * prioridade ficam à frente as faixas acima e metade da própria; nas outras,
+ * a fila inteira. Emergências só esperam o corredor. Uma posse que já passou
+ * da média ainda deve, no mínimo, meia média (as posses longas são as que
+ * seguram o setor esperando o trecho seguinte, e tendem a continuar)
+ * @param setor: Setor pedido
+ * @param prioridade: Prioridade efetiva de quem pediria
+ * @param corredor: true se quem pediria é emergência com corredor
+ * @param por_prioridade: true se a fila comum é atendida por prioridade
+ * @param agora_ns: Instante da estimativa (relogio_agora_ns)
+ * @return Espera estimada em ns de relógio, -1 se o setor for inválido
+ */
+long long estimativa_calcular(int setor, unsigned int prioridade, bool corredor, bool por_prioridade,
+                              long long agora_ns) {
+    if (agregados == NULL || setor < 0 || setor >= total_setores) return -1;
+    agregado_setor_t *a = &agregados[setor];
+    long long servico = atomic_load_explicit(&a->servico_ns, memory_order_relaxed);
+    long long inicio = atomic_load_explicit(&a->inicio_ns, memory_order_relaxed);
+
+    double frente = atomic_load_explicit(&a->corredor, memory_order_relaxed);
+    if (!corredor) {
+        if (por_prioridade) {
+            int propria = estimativa_faixa(prioridade);
+            for (int f = propria + 1; f < ESTIMATIVA_FAIXAS; f++) {
+                frente += atomic_load_explicit(&a->faixa[f], memory_order_relaxed);
+            }
+            frente += atomic_load_explicit(&a->faixa[propria], memory_order_relaxed) / 2.0;
+        } else {
+            frente += atomic_load_explicit(&a->total, memory_order_relaxed);
+        }
+    }
+    if (inicio == 0 && frente < 1.0) return 0; // Setor livre e ninguém à frente
+
+    long long restante = 0;
+    if (inicio != 0) {
+        restante = servico - (agora_ns - inicio);
+        if (restante < servico / 2) restante = servico / 2;
+    }
+    return restante + (long long)(frente * servico);
+}
+
+/**
+ * @return Posse média do setor em ns de relógio (média móvel), -1 se inválido
+ */
+long long estimativa_servico(int setor) {
+    if (agregados == NULL || setor < 0 || setor >= total_setores) return -1;
+    return atomic_load_explicit(&agregados[setor].servico_ns, memory_order_relaxed);
+}
+
+/**
+ * @return Aeronaves à espera do setor (fila comum e corredor)
+ */
+int estimativa_tamanho_fila(int setor) {
+    if (agregados == NULL || setor < 0 || setor >= total_setores) return 0;
+    return atomic_load_explicit(&agregados[setor].total, memory_order_relaxed) +
+           atomic_load_explicit(&agregados[setor].corredor, memory_order_relaxed);
+}
@@ -0,0 +1,69 @@
+#include <stddef.h>
+#include "../include/fila_mpsc.h"
+
+/**
+ * Inicializa uma fila vazia (apenas o nó sentinela)
+ * @param fila: Fila a ser inicializada
+ */
+void fila_mpsc_inicializar(fila_mpsc_t *fila) {
+    atomic_init(&fila->sentinela.proximo, NULL);
+    atomic_init(&fila->cabeca, &fila->sentinela);
+    fila->cauda = &fila->sentinela;
+}
+
+/**
+ * Insere um nó no fim da fila; pode ser chamada por qualquer thread
+ * @param fila: Fila de destino
+ * @param no: Nó a inserir (não pode estar em nenhuma fila)
+ */
+void fila_mpsc_inserir(fila_mpsc_t *fila, no_mpsc_t *no) {
+    atomic_store_explicit(&no->proximo, NULL, memory_order_relaxed);
+    no_mpsc_t *anterior = atomic_exchange_explicit(&fila->cabeca, no, memory_order_acq_rel);
+    // Entre a troca e este store a fila fica momentaneamente "partida"; o consumidor espera
+    atomic_store_explicit(&anterior->proximo, no, memory_order_release);
+}
+
+/**
+ * Remove o nó mais antigo; só pode ser chamada pela thread consumidora
+ * @param fila: Fila de origem
+ * @return Nó removido, ou NULL se a fila estiver vazia ou um produtor
+ *         estiver no meio de uma inserção (tente de novo em seguida)
+ */
+no_mpsc_t *fila_mpsc_remover(fila_mpsc_t *fila) {
+    no_mpsc_t *cauda = fila->cauda;
+    no_mpsc_t *proximo = atomic_load_explicit(&cauda->proximo, memory_order_acquire);
+
+    if (cauda == &fila->sentinela) {
+        if (proximo == NULL) return NULL;
+        fila->cauda = proximo;
+        cauda = proximo;
+        proximo = atomic_load_explicit(&cauda->proximo, memory_order_acquire);
+    }
+    if (proximo != NULL) {
+        fila->cauda = proximo;
+        return cauda;
+    }
+
+    // cauda é o último nó visível: só sai se ninguém estiver inserindo depois dele
+    if (cauda != atomic_load_explicit(&fila->cabeca, memory_order_acquire)) {
+        return NULL;
+    }
+    fila_mpsc_inserir(fila, &fila->sentinela);
+    proximo = atomic_load_explicit(&cauda->proximo, memory_order_acquire);
+    if (proximo != NULL) {
+        fila->cauda = proximo;
+        return cauda;
+    }
+    return NULL;
+}
+
+/**
+ * Verifica se a fila está vazia (thread consumidora)
+ * Uma inserção em andamento já conta como fila não vazia
+ * @param fila: Fila a verificar
+ * @return true se não há nós nem inserções pendentes
+ */
+bool fila_mpsc_vazia(fila_mpsc_t *fila) {
+    return fila->cauda == &fila->sentinela &&
+           atomic_load_explicit(&fila->cabeca, memory_order_seq_cst) == &fila->sentinela;
+}
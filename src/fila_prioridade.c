@@ -1,195 +1,294 @@
-#include <stdio.h>
-#include <stdlib.h>
-#include <stdbool.h>
-#include "../include/fila_prioridade.h"
-#include "../include/aeronave.h"
-
-/**
- * Inicializa uma fila de prioridade com valores padrão
- * @param fila: Ponteiro para a estrutura da fila de prioridade
-*/
-void fila_inicializar(fila_prioridade_t *fila)
-{
-    if (!fila) return;
-    fila->inicio = NULL;
-    fila->fim = NULL;
-    fila->tamanho = 0;
-}
-
-/**
- * Insere uma aeronave na fila de prioridade mantendo a ordem por prioridade
- * @param fila: Ponteiro para a estrutura da fila de prioridade
- * @param aeronave: Ponteiro para a aeronave a ser inserida
- */
-void fila_inserir(fila_prioridade_t *fila, aeronave_t *aeronave) {
-    if (!fila || !aeronave) return;
-
-    no_fila_t *novo = malloc(sizeof(no_fila_t));
-    if (!novo) {
-        perror("malloc no_fila");
-        return;
-    }
-    novo->aeronave = aeronave;
-    novo->proximo = NULL;
-
-    if (fila->inicio == NULL) {
-        fila->inicio = novo;
-        fila->fim = novo;
-    } else if (aeronave->prioridade > fila->inicio->aeronave->prioridade) {
-        novo->proximo = fila->inicio;
-        fila->inicio = novo;
-    } else if (fila->fim != NULL && aeronave->prioridade <= fila->fim->aeronave->prioridade) {
-        fila->fim->proximo = novo;
-        fila->fim = novo;
-    } else {
-        no_fila_t *atual = fila->inicio;
-        // Percorre a fila até encontrar posição correta (maior prioridade primeiro)
-        while (atual->proximo != NULL && 
-               atual->proximo->aeronave->prioridade >= aeronave->prioridade) {
-            atual = atual->proximo;
-        }
-        novo->proximo = atual->proximo;
-        atual->proximo = novo;
-        if (novo->proximo == NULL) {
-            fila->fim = novo;
-        }
-    }
-    fila->tamanho++;
-}
-
-/**
- * Remove e retorna a aeronave com maior prioridade da fila
- * @param fila: Ponteiro para a estrutura da fila de prioridade
- * @return Ponteiro para a aeronave removida ou NULL se a fila estiver vazia
- */
-aeronave_t *fila_remover(fila_prioridade_t *fila)
-{
-    if (!fila || fila->inicio == NULL) return NULL;
-
-    no_fila_t *removido = fila->inicio;
-    aeronave_t *aeronave = removido->aeronave;
-    
-    fila->inicio = fila->inicio->proximo;
-    if (fila->inicio == NULL) {
-        fila->fim = NULL;
-    }
-    
-    free(removido);
-    fila->tamanho--;
-    return aeronave;
-}
-
-/**
- * Verifica se a fila de prioridade está vazia
- * @param fila: Ponteiro para a estrutura da fila de prioridade
- * @return true se a fila estiver vazia, false caso contrário
- */
-bool fila_vazio(fila_prioridade_t *fila)
-{
-    return (fila == NULL || fila->inicio == NULL);
-}
-
-/**
- * Libera toda a memória alocada para a fila de prioridade
- * @param fila: Ponteiro para a estrutura da fila de prioridade
- */
-void fila_destruir(fila_prioridade_t *fila)
-{
-    if (!fila) return;
-    
-    no_fila_t *atual = fila->inicio;
-    while (atual != NULL) {
-        no_fila_t *proximo = atual->proximo;
-        free(atual);
-        atual = proximo;
-    }
-    fila->inicio = NULL;
-    fila->fim = NULL;
-    fila->tamanho = 0;
-}
-
-/**
- * Imprime o conteúdo da fila de prioridade no formato [A1(P:5), A2(P:3), ...]
- * @param fila: Ponteiro para a estrutura da fila de prioridade
- */
-void fila_imprimir(fila_prioridade_t *fila)
-{
-    if (!fila || fila->inicio == NULL) {
-        printf("(vazia)\n");
-        return;
-    }
-    
-    no_fila_t *atual = fila->inicio;
-    printf("[");
-    while (atual != NULL) {
-        printf("A%d(P:%u)", atual->aeronave->id, atual->aeronave->prioridade);
-        atual = atual->proximo;
-        if (atual != NULL) printf(", ");
-    }
-    printf("]\n");
-}
-
-/**
- * Retorna a aeronave com maior prioridade sem removê-la da fila
- * @param fila: Ponteiro para a estrutura da fila de prioridade
- * @return Ponteiro para a aeronave no início da fila ou NULL se vazia
- */
-aeronave_t *fila_espiar(fila_prioridade_t *fila)
-{
-    if (!fila || fila->inicio == NULL) return NULL;
-    return fila->inicio->aeronave;
-}
-
-/**
- * Rotaciona a fila movendo o primeiro elemento para o final
- * @param fila: Ponteiro para a estrutura da fila de prioridade
- */
-void fila_rotacionar(fila_prioridade_t *fila)
-{
-    if (!fila || fila->tamanho < 2) return;
-    
-    no_fila_t *primeiro = fila->inicio;
-    fila->inicio = primeiro->proximo;
-    primeiro->proximo = NULL;
-    fila->fim->proximo = primeiro;
-    fila->fim = primeiro;
-}
-
-/**
- * Remove uma aeronave específica da fila de prioridade
- * @param fila: Ponteiro para a estrutura da fila de prioridade
- * @param aeronave: Ponteiro para a aeronave a ser removida
- * @return true se a aeronave foi encontrada e removida, false caso contrário
- */
-bool fila_remover_aeronave(fila_prioridade_t *fila, aeronave_t *aeronave)
-{
-    if (!fila || !aeronave || fila->inicio == NULL) return false;
-    
-    if (fila->inicio->aeronave->id == aeronave->id) {
-        no_fila_t *removido = fila->inicio;
-        fila->inicio = fila->inicio->proximo;
-        if (fila->inicio == NULL) {
-            fila->fim = NULL;
-        }
-        free(removido);
-        fila->tamanho--;
-        return true;
-    }
-    
-    no_fila_t *anterior = fila->inicio;
-    while (anterior->proximo != NULL) {
-        if (anterior->proximo->aeronave->id == aeronave->id) {
-            no_fila_t *removido = anterior->proximo;
-            anterior->proximo = removido->proximo;
-            if (removido == fila->fim) {
-                fila->fim = anterior;
-            }
-            free(removido);
-            fila->tamanho--;
-            return true;
-        }
-        anterior = anterior->proximo;
-    }
-    
-    return false;
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "../include/fila_prioridade.h"
+#include "../include/aeronave.h"
+#include "../include/politica.h"
+
+/**
+ * Inicializa uma fila de prioridade com valores padrão
+ * @param fila: Ponteiro para a estrutura da fila de prioridade
+*/
+void fila_inicializar(fila_prioridade_t *fila)
+{
+    if (!fila) return;
+    fila->inicio = NULL;
+    fila->fim = NULL;
+    fila->tamanho = 0;
+    fila->politica = &politica_prioridade;
+    fila->tempo_virtual = 0.0;
+}
+
+/**
+ * Define a política de escalonamento usada nas próximas inserções
+ * @param fila: Ponteiro para a estrutura da fila de prioridade
+ * @param politica: Política a ser usada (NULL volta para prioridade estrita)
+ */
+void fila_definir_politica(fila_prioridade_t *fila, const politica_fila_t *politica)
+{
+    if (!fila) return;
+    fila->politica = politica ? politica : &politica_prioridade;
+}
+
+/**
+ * Liga um nó com a chave já calculada na posição da ordem (menor chave
+ * primeiro; entre chaves iguais, depois das que já estão na fila, ou antes
+ * delas para quem já esperava e só foi reposicionado)
+ * @param antes_dos_iguais: Encaixa à frente das chaves iguais à dele
+ */
+static void fila_encaixar(fila_prioridade_t *fila, no_fila_t *novo, bool antes_dos_iguais) {
+    novo->proximo = NULL;
+    if (fila->inicio == NULL) {
+        fila->inicio = novo;
+        fila->fim = novo;
+    } else if (novo->chave < fila->inicio->chave ||
+               (antes_dos_iguais && novo->chave == fila->inicio->chave)) {
+        novo->proximo = fila->inicio;
+        fila->inicio = novo;
+    } else if (fila->fim != NULL && (novo->chave > fila->fim->chave ||
+               (!antes_dos_iguais && novo->chave == fila->fim->chave))) {
+        fila->fim->proximo = novo;
+        fila->fim = novo;
+    } else {
+        no_fila_t *atual = fila->inicio;
+        // Percorre a fila até encontrar posição correta (menor chave primeiro)
+        while (atual->proximo != NULL && 
+               (atual->proximo->chave < novo->chave ||
+                (!antes_dos_iguais && atual->proximo->chave == novo->chave))) {
+            atual = atual->proximo;
+        }
+        novo->proximo = atual->proximo;
+        atual->proximo = novo;
+        if (novo->proximo == NULL) {
+            fila->fim = novo;
+        }
+    }
+}
+
+/**
+ * Insere uma aeronave na fila mantendo a ordem definida pela política (menor chave primeiro)
+ * @param fila: Ponteiro para a estrutura da fila de prioridade
+ * @param aeronave: Ponteiro para a aeronave a ser inserida
+ * @return Chave atribuída pela política (0 se a inserção falhar)
+ */
+double fila_inserir(fila_prioridade_t *fila, aeronave_t *aeronave) {
+    if (!fila || !aeronave) return 0.0;
+
+    no_fila_t *novo = malloc(sizeof(no_fila_t));
+    if (!novo) {
+        perror("malloc no_fila");
+        return 0.0;
+    }
+    novo->aeronave = aeronave;
+    novo->chave = fila->politica->calcular_chave(fila, aeronave);
+    fila_encaixar(fila, novo, false);
+    fila->tamanho++;
+    return novo->chave;
+}
+
+/**
+ * Recalcula a chave de uma aeronave já na fila (a prioridade dela mudou) e a
+ * move para a nova posição, reaproveitando o nó. Com a chave igual (fifo, ou
+ * política que não olha a prioridade) nada se move. Ela já esperava, então
+ * passa à frente de quem tem a mesma chave
+ * @param fila: Ponteiro para a estrutura da fila de prioridade
+ * @param aeronave: Aeronave na fila, já com a prioridade nova
+ * @param prioridade_antiga: Prioridade com que a chave atual foi calculada
+ * @param chave: Recebe a nova chave se a aeronave mudou de lugar
+ * @return true se a chave mudou e a aeronave foi reposicionada
+ */
+bool fila_reposicionar(fila_prioridade_t *fila, aeronave_t *aeronave, unsigned int prioridade_antiga, double *chave) {
+    if (!fila || !aeronave) return false;
+
+    no_fila_t *anterior = NULL;
+    no_fila_t *no = fila->inicio;
+    while (no != NULL && no->aeronave != aeronave) {
+        anterior = no;
+        no = no->proximo;
+    }
+    if (no == NULL) return false;
+    double nova = fila->politica->recalcular_chave ?
+        fila->politica->recalcular_chave(fila, aeronave, no->chave, prioridade_antiga) :
+        fila->politica->calcular_chave(fila, aeronave);
+    if (nova == no->chave) return false;
+
+    if (anterior != NULL) {
+        anterior->proximo = no->proximo;
+    } else {
+        fila->inicio = no->proximo;
+    }
+    if (fila->fim == no) fila->fim = anterior;
+    no->chave = nova;
+    fila_encaixar(fila, no, true);
+    if (chave) *chave = nova;
+    return true;
+}
+
+/**
+ * Acrescenta uma aeronave no fim da fila com uma chave já calculada, sem
+ * consultar a política (restauração de checkpoint: a ordem gravada é mantida)
+ * @param fila: Ponteiro para a estrutura da fila de prioridade
+ * @param aeronave: Ponteiro para a aeronave a ser inserida
+ * @param chave: Chave gravada (não menor que a do fim da fila)
+ * @return true se inseriu
+ */
+bool fila_anexar(fila_prioridade_t *fila, aeronave_t *aeronave, double chave) {
+    if (!fila || !aeronave) return false;
+
+    no_fila_t *novo = malloc(sizeof(no_fila_t));
+    if (!novo) {
+        perror("malloc no_fila");
+        return false;
+    }
+    novo->aeronave = aeronave;
+    novo->chave = chave;
+    novo->proximo = NULL;
+    if (fila->fim != NULL) {
+        fila->fim->proximo = novo;
+    } else {
+        fila->inicio = novo;
+    }
+    fila->fim = novo;
+    fila->tamanho++;
+    return true;
+}
+
+/**
+ * Remove e retorna a próxima aeronave a ser atendida (início da fila)
+ * @param fila: Ponteiro para a estrutura da fila de prioridade
+ * @return Ponteiro para a aeronave removida ou NULL se a fila estiver vazia
+ */
+aeronave_t *fila_remover(fila_prioridade_t *fila)
+{
+    if (!fila || fila->inicio == NULL) return NULL;
+
+    no_fila_t *removido = fila->inicio;
+    aeronave_t *aeronave = removido->aeronave;
+    if (fila->politica->ao_atender) {
+        fila->politica->ao_atender(fila, removido->chave);
+    }
+    
+    fila->inicio = fila->inicio->proximo;
+    if (fila->inicio == NULL) {
+        fila->fim = NULL;
+    }
+    
+    free(removido);
+    fila->tamanho--;
+    return aeronave;
+}
+
+/**
+ * Verifica se a fila de prioridade está vazia
+ * @param fila: Ponteiro para a estrutura da fila de prioridade
+ * @return true se a fila estiver vazia, false caso contrário
+ */
+bool fila_vazio(fila_prioridade_t *fila)
+{
+    return (fila == NULL || fila->inicio == NULL);
+}
+
+/**
+ * Libera toda a memória alocada para a fila de prioridade
+ * @param fila: Ponteiro para a estrutura da fila de prioridade
+ */
+void fila_destruir(fila_prioridade_t *fila)
+{
+    if (!fila) return;
+    
+    no_fila_t *atual = fila->inicio;
+    while (atual != NULL) {
+        no_fila_t *proximo = atual->proximo;
+        free(atual);
+        atual = proximo;
+    }
+    fila->inicio = NULL;
+    fila->fim = NULL;
+    fila->tamanho = 0;
+}
+
+/**
+ * Imprime o conteúdo da fila de prioridade no formato [A1(P:5), A2(P:3), ...]
+ * @param fila: Ponteiro para a estrutura da fila de prioridade
+ */
+void fila_imprimir(fila_prioridade_t *fila)
+{
+    if (!fila || fila->inicio == NULL) {
+        printf("(vazia)\n");
+        return;
+    }
+    
+    no_fila_t *atual = fila->inicio;
+    printf("[");
+    while (atual != NULL) {
+        printf("A%d(P:%u)", atual->aeronave->id, atual->aeronave->prioridade);
+        atual = atual->proximo;
+        if (atual != NULL) printf(", ");
+    }
+    printf("]\n");
+}
+
+/**
+ * Retorna a aeronave com maior prioridade sem removê-la da fila
+ * @param fila: Ponteiro para a estrutura da fila de prioridade
+ * @return Ponteiro para a aeronave no início da fila ou NULL se vazia
+ */
+aeronave_t *fila_espiar(fila_prioridade_t *fila)
+{
+    if (!fila || fila->inicio == NULL) return NULL;
+    return fila->inicio->aeronave;
+}
+
+/**
+ * Rotaciona a fila movendo o primeiro elemento para o final
+ * @param fila: Ponteiro para a estrutura da fila de prioridade
+ */
+void fila_rotacionar(fila_prioridade_t *fila)
+{
+    if (!fila || fila->tamanho < 2) return;
+    
+    no_fila_t *primeiro = fila->inicio;
+    fila->inicio = primeiro->proximo;
+    primeiro->proximo = NULL;
+    fila->fim->proximo = primeiro;
+    fila->fim = primeiro;
+}
+
+/**
+ * Remove uma aeronave específica da fila de prioridade
+ * @param fila: Ponteiro para a estrutura da fila de prioridade
+ * @param aeronave: Ponteiro para a aeronave a ser removida
+ * @return true se a aeronave foi encontrada e removida, false caso contrário
+ */
+bool fila_remover_aeronave(fila_prioridade_t *fila, aeronave_t *aeronave)
+{
+    if (!fila || !aeronave || fila->inicio == NULL) return false;
+    
+    if (fila->inicio->aeronave->id == aeronave->id) {
+        no_fila_t *removido = fila->inicio;
+        fila->inicio = fila->inicio->proximo;
+        if (fila->inicio == NULL) {
+            fila->fim = NULL;
+        }
+        free(removido);
+        fila->tamanho--;
+        return true;
+    }
+    
+    no_fila_t *anterior = fila->inicio;
+    while (anterior->proximo != NULL) {
+        if (anterior->proximo->aeronave->id == aeronave->id) {
+            no_fila_t *removido = anterior->proximo;
+            anterior->proximo = removido->proximo;
+            if (removido == fila->fim) {
+                fila->fim = anterior;
+            }
+            free(removido);
+            fila->tamanho--;
+            return true;
+        }
+        anterior = anterior->proximo;
+    }
+    
+    return false;
 }
\ No newline at end of file
@@ -0,0 +1,290 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <pthread.h>
+#include "../include/frota.h"
+#include "../include/controlador.h"
+#include "../include/utils.h"
+#include "../include/topologia.h"
+
+#define AERONAVES_POR_TRABALHADOR_MIN 256
+
+typedef struct {
+    frota_t *frota;
+    int inicio;
+    int fim;
+    int total_setores;
+    const int *deslocamentos; // Início da rota de cada aeronave nos blocos
+    const int *comprimentos;
+    const unsigned int *sementes;
+    const pthread_attr_t *atributos;
+    const pthread_attr_t *atributos_no; // Posicionamento numa: atributos fixados em cada nó
+    int falhas;
+    int iniciadas;
+} fatia_frota_t;
+
+/**
+ * Decide quantas threads auxiliares usar para um trabalho sobre a frota
+ * @param tamanho: Número de aeronaves
+ * @return Número de trabalhadores (pelo menos 1)
+ */
+static int frota_numero_trabalhadores(int tamanho) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpus < 1) cpus = 1;
+    int necessarios = (tamanho + AERONAVES_POR_TRABALHADOR_MIN - 1) / AERONAVES_POR_TRABALHADOR_MIN;
+    if (necessarios < 1) necessarios = 1;
+    return necessarios < cpus ? necessarios : (int)cpus;
+}
+
+/**
+ * Executa uma função sobre fatias contíguas da frota em paralelo
+ * Com um único trabalhador, ou sem memória para controlar as threads, roda
+ * na própria thread chamadora
+ * @param fatias: Array de fatias já preenchidas (uma por trabalhador)
+ * @param n: Número de fatias
+ * @param funcao: Função executada em cada fatia
+ */
+static void frota_paralelo(fatia_frota_t *fatias, int n, void *(*funcao)(void *)) {
+    pthread_t *trabalhadores = n > 1 ? malloc(sizeof(pthread_t) * n) : NULL;
+    bool *criado = n > 1 ? calloc(n, sizeof(bool)) : NULL;
+    if (trabalhadores == NULL || criado == NULL) {
+        for (int i = 0; i < n; i++) {
+            funcao(&fatias[i]);
+        }
+        free(criado);
+        free(trabalhadores);
+        return;
+    }
+
+    for (int i = 0; i < n; i++) {
+        criado[i] = pthread_create(&trabalhadores[i], NULL, funcao, &fatias[i]) == 0;
+        if (!criado[i]) funcao(&fatias[i]); // Sem thread auxiliar: faz aqui mesmo
+    }
+    for (int i = 0; i < n; i++) {
+        if (criado[i]) pthread_join(trabalhadores[i], NULL);
+    }
+    free(criado);
+    free(trabalhadores);
+}
+
+/**
+ * Divide a frota em n fatias de tamanho parecido
+ */
+static void frota_fatiar(fatia_frota_t *fatias, int n, const fatia_frota_t *modelo) {
+    int tamanho = modelo->frota->tamanho;
+    for (int i = 0; i < n; i++) {
+        fatias[i] = *modelo;
+        fatias[i].inicio = (int)((long)tamanho * i / n);
+        fatias[i].fim = (int)((long)tamanho * (i + 1) / n);
+    }
+}
+
+/**
+ * Inicializa e registra no controlador as aeronaves de uma fatia
+ */
+static void *frota_inicializar_fatia(void *arg) {
+    fatia_frota_t *fatia = arg;
+    frota_t *frota = fatia->frota;
+
+    for (int i = fatia->inicio; i < fatia->fim; i++) {
+        aeronave_t *a = &frota->aeronaves[i];
+        char *rota = (char *)frota->rotas +
+                     (size_t)fatia->deslocamentos[i] * aeronave_tamanho_trecho(fatia->total_setores);
+        if (aeronave_inicializar(a, i, fatia->total_setores, rota, fatia->comprimentos[i],
+                                 fatia->sementes[i]) != 0 ||
+            !atc_registrar_aeronave(a)) {
+            fatia->falhas++;
+            continue;
+        }
+        frota->ponteiros[i] = a;
+    }
+    return NULL;
+}
+
+/**
+ * Cria as threads das aeronaves de uma fatia (elas param na largada)
+ */
+static void *frota_iniciar_fatia(void *arg) {
+    fatia_frota_t *fatia = arg;
+    frota_t *frota = fatia->frota;
+
+    for (int i = fatia->inicio; i < fatia->fim; i++) {
+        aeronave_t *a = frota->ponteiros[i];
+        if (a == NULL) continue;
+        const pthread_attr_t *atributos = fatia->atributos;
+        if (fatia->atributos_no != NULL) {
+            atributos = &fatia->atributos_no[topologia_no_da_rota(a, fatia->total_setores)];
+        }
+        if (pthread_create(&a->thread, atributos, aeronave_executa, a) != 0) {
+            perror("Erro ao criar thread da aeronave");
+            sem_destroy(&a->sem_aeronave);
+            frota->ponteiros[i] = NULL;
+            fatia->falhas++;
+            continue;
+        }
+        fatia->iniciadas++;
+    }
+    return NULL;
+}
+
+/**
+ * Cria a frota inteira. Comprimentos e sementes são sorteados em sequência
+ * com o gerador global (carga reprodutível com srand); o resto da
+ * construção roda em paralelo sobre a arena
+ * @param frota: Estrutura a ser preenchida
+ * @param tamanho: Número de aeronaves
+ * @param total_setores: Número total de setores disponíveis no espaço aéreo
+ * @return 0 em caso de sucesso, -1 em caso de falha (nada fica alocado)
+ */
+int frota_criar(frota_t *frota, int tamanho, int total_setores) {
+    memset(frota, 0, sizeof(*frota));
+    frota->tamanho = tamanho;
+
+    int *deslocamentos = malloc(sizeof(int) * tamanho);
+    int *comprimentos = malloc(sizeof(int) * tamanho);
+    unsigned int *sementes = malloc(sizeof(unsigned int) * tamanho);
+    if (deslocamentos == NULL || comprimentos == NULL || sementes == NULL) {
+        free(deslocamentos);
+        free(comprimentos);
+        free(sementes);
+        return -1;
+    }
+
+    long total_trechos = 0;
+    for (int i = 0; i < tamanho; i++) {
+        comprimentos[i] = aeronave_sortear_comprimento_rota(total_setores);
+        sementes[i] = (unsigned int)rand();
+        deslocamentos[i] = (int)total_trechos;
+        total_trechos += comprimentos[i];
+    }
+
+    // Arena: [aeronaves][ponteiros][rotas]; aeronave_t é múltiplo da linha de cache
+    size_t bytes_aeronaves = sizeof(aeronave_t) * tamanho;
+    size_t bytes_ponteiros = sizeof(aeronave_t *) * tamanho;
+    size_t bytes_rotas = aeronave_tamanho_trecho(total_setores) * total_trechos;
+    void *arena = NULL;
+    if (total_trechos <= INT_MAX &&
+        posix_memalign(&arena, LINHA_CACHE, bytes_aeronaves + bytes_ponteiros + bytes_rotas) == 0) {
+        frota->arena = arena;
+        frota->tamanho_arena = bytes_aeronaves + bytes_ponteiros + bytes_rotas;
+        frota->aeronaves = arena;
+        frota->ponteiros = (aeronave_t **)((char *)arena + bytes_aeronaves);
+        frota->rotas = (char *)arena + bytes_aeronaves + bytes_ponteiros;
+        memset(frota->ponteiros, 0, bytes_ponteiros);
+    }
+
+    int status = -1;
+    if (frota->arena) {
+        fatia_frota_t modelo = {
+            .frota = frota,
+            .total_setores = total_setores,
+            .deslocamentos = deslocamentos,
+            .comprimentos = comprimentos,
+            .sementes = sementes,
+        };
+        int n = frota_numero_trabalhadores(tamanho);
+        fatia_frota_t fatias[n];
+        frota_fatiar(fatias, n, &modelo);
+        frota_paralelo(fatias, n, frota_inicializar_fatia);
+
+        status = 0;
+        for (int i = 0; i < n; i++) {
+            if (fatias[i].falhas > 0) status = -1;
+        }
+    }
+
+    free(deslocamentos);
+    free(comprimentos);
+    free(sementes);
+    if (status != 0) frota_destruir(frota);
+    return status;
+}
+
+/**
+ * Cria as threads de todas as aeronaves em paralelo, com pilha reduzida
+ * As aeronaves ficam paradas em atc_aguardar_largada até atc_liberar_largada
+ * No posicionamento numa cada thread fica nos núcleos do nó da própria rota
+ * @param frota: Frota já criada
+ * @param tamanho_pilha: Tamanho da pilha de cada thread em bytes (0 = padrão do sistema)
+ * @return Número de threads iniciadas
+ */
+int frota_iniciar_threads(frota_t *frota, size_t tamanho_pilha) {
+    pthread_attr_t atributos;
+    pthread_attr_init(&atributos);
+    if (tamanho_pilha > 0 && pthread_attr_setstacksize(&atributos, tamanho_pilha) != 0) {
+        fprintf(stderr, "Aviso: tamanho de pilha %zu inválido, usando o padrão\n", tamanho_pilha);
+    }
+
+    int nos = topologia_ativa() ? topologia_nos() : 0;
+    pthread_attr_t atributos_no[nos > 0 ? nos : 1];
+    for (int no = 0; no < nos; no++) {
+        pthread_attr_init(&atributos_no[no]);
+        if (tamanho_pilha > 0) pthread_attr_setstacksize(&atributos_no[no], tamanho_pilha);
+        if (!topologia_fixar_no(&atributos_no[no], no)) {
+            fprintf(stderr, "Aviso: não foi possível fixar threads no nó %d\n", no);
+        }
+    }
+
+    fatia_frota_t modelo = {
+        .frota = frota,
+        .total_setores = total_setores,
+        .atributos = &atributos,
+        .atributos_no = nos > 0 ? atributos_no : NULL,
+    };
+    int n = frota_numero_trabalhadores(frota->tamanho);
+    fatia_frota_t fatias[n];
+    frota_fatiar(fatias, n, &modelo);
+    frota_paralelo(fatias, n, frota_iniciar_fatia);
+
+    frota->threads_iniciadas = 0;
+    for (int i = 0; i < n; i++) {
+        frota->threads_iniciadas += fatias[i].iniciadas;
+    }
+    pthread_attr_destroy(&atributos);
+    for (int no = 0; no < nos; no++) {
+        pthread_attr_destroy(&atributos_no[no]);
+    }
+    return frota->threads_iniciadas;
+}
+
+/**
+ * Aguarda todas as aeronaves iniciadas concluírem suas rotas
+ * @param frota: Frota em execução
+ * @param verboso: Imprime uma linha por aeronave concluída
+ */
+void frota_aguardar(frota_t *frota, bool verboso) {
+    for (int i = 0; i < frota->tamanho; i++) {
+        if (frota->ponteiros[i] != NULL) {
+            pthread_join(frota->ponteiros[i]->thread, NULL);
+            if (verboso) printf("[MAIN] Aeronave %d concluiu sua rota\n", i);
+        }
+    }
+}
+
+/**
+ * Cancela as threads de todas as aeronaves iniciadas (encerramento por sinal)
+ * @param frota: Frota em execução
+ */
+void frota_cancelar(frota_t *frota) {
+    for (int i = 0; i < frota->tamanho && frota->ponteiros != NULL; i++) {
+        if (frota->ponteiros[i] != NULL) {
+            pthread_cancel(frota->ponteiros[i]->thread);
+        }
+    }
+}
+
+/**
+ * Libera a arena da frota e os semáforos das aeronaves
+ * @param frota: Frota a ser destruída (threads já encerradas)
+ */
+void frota_destruir(frota_t *frota) {
+    if (frota == NULL) return;
+    for (int i = 0; i < frota->tamanho && frota->ponteiros != NULL; i++) {
+        if (frota->ponteiros[i] != NULL) {
+            sem_destroy(&frota->ponteiros[i]->sem_aeronave);
+        }
+    }
+    free(frota->arena);
+    memset(frota, 0, sizeof(*frota));
+}
@@ -0,0 +1,142 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "../include/grafo_espera.h"
+
+/**
+ * Aloca os arrays do grafo e da busca num único bloco
+ * @param grafo: Grafo a inicializar
+ * @param capacidade: Número máximo de aeronaves (ids de 0 a capacidade-1)
+ * @return true em caso de sucesso, false se a alocação falhar
+ */
+bool grafo_espera_inicializar(grafo_espera_t *grafo, int capacidade) {
+    size_t inteiros = sizeof(int) * capacidade;
+    size_t marcas = sizeof(bool) * capacidade;
+    char *bloco = malloc(5 * inteiros + 2 * marcas);
+    if (bloco == NULL) {
+        perror("malloc grafo de espera");
+        return false;
+    }
+
+    grafo->capacidade = capacidade;
+    grafo->bloco = bloco;
+    grafo->proximo = (int *)bloco;              bloco += inteiros;
+    grafo->indice = (int *)bloco;               bloco += inteiros;
+    grafo->baixo = (int *)bloco;                bloco += inteiros;
+    grafo->pilha = (int *)bloco;                bloco += inteiros;
+    grafo->chamada = (int *)bloco;              bloco += inteiros;
+    grafo->na_pilha = (bool *)bloco;            bloco += marcas;
+    grafo->explorado = (bool *)bloco;
+
+    for (int i = 0; i < capacidade; i++) {
+        grafo->proximo[i] = -1;
+    }
+    return true;
+}
+
+/**
+ * Libera a memória do grafo
+ * @param grafo: Grafo inicializado por grafo_espera_inicializar
+ */
+void grafo_espera_destruir(grafo_espera_t *grafo) {
+    free(grafo->bloco);
+    grafo->bloco = NULL;
+    grafo->capacidade = 0;
+}
+
+/**
+ * Monta as arestas de espera a partir de uma cópia do estado do controlador
+ * @param grafo: Grafo a preencher
+ * @param instantaneo: Cópia obtida com instantaneo_capturar
+ */
+void grafo_espera_montar(grafo_espera_t *grafo, const instantaneo_t *instantaneo) {
+    for (int i = 0; i < grafo->capacidade; i++) {
+        grafo->proximo[i] = -1;
+    }
+    for (int s = 0; s < instantaneo->total_setores; s++) {
+        int ocupante = instantaneo->ocupante[s];
+        if (ocupante < 0 || ocupante >= grafo->capacidade) continue;
+        for (int k = instantaneo->inicio_fila[s]; k < instantaneo->inicio_fila[s + 1]; k++) {
+            int id = instantaneo->fila[k];
+            if (id >= 0 && id < grafo->capacidade && id != ocupante) {
+                grafo->proximo[id] = ocupante;
+            }
+        }
+    }
+}
+
+/**
+ * Encontra todos os ciclos do grafo numa única passada do algoritmo de Tarjan
+ * (componentes fortemente conexas), sem recursão
+ * @param grafo: Grafo montado por grafo_espera_montar
+ * @param ao_encontrar: Chamada uma vez por ciclo (pode ser NULL)
+ * @param contexto: Repassado a ao_encontrar
+ * @return Número de ciclos encontrados
+ */
+int grafo_espera_ciclos(grafo_espera_t *grafo, ao_encontrar_ciclo_t ao_encontrar, void *contexto) {
+    int n = grafo->capacidade;
+    for (int i = 0; i < n; i++) {
+        grafo->indice[i] = -1;
+        grafo->na_pilha[i] = false;
+        grafo->explorado[i] = false;
+    }
+
+    int proximo_indice = 0;
+    int topo = 0;
+    int ciclos = 0;
+
+    for (int raiz = 0; raiz < n; raiz++) {
+        // Quem não espera ninguém não está em ciclo; quem já foi visitado já foi resolvido
+        if (grafo->indice[raiz] != -1 || grafo->proximo[raiz] < 0) continue;
+
+        int profundidade = 0;
+        grafo->chamada[profundidade++] = raiz;
+        grafo->indice[raiz] = grafo->baixo[raiz] = proximo_indice++;
+        grafo->pilha[topo++] = raiz;
+        grafo->na_pilha[raiz] = true;
+
+        while (profundidade > 0) {
+            int v = grafo->chamada[profundidade - 1];
+            int w = grafo->proximo[v];
+
+            if (!grafo->explorado[v] && w >= 0) {
+                grafo->explorado[v] = true;
+                if (grafo->indice[w] == -1) {
+                    grafo->indice[w] = grafo->baixo[w] = proximo_indice++;
+                    grafo->pilha[topo++] = w;
+                    grafo->na_pilha[w] = true;
+                    grafo->chamada[profundidade++] = w;
+                    continue;
+                }
+                if (grafo->na_pilha[w] && grafo->indice[w] < grafo->baixo[v]) {
+                    grafo->baixo[v] = grafo->indice[w];
+                }
+            }
+
+            // v terminou: se é raiz de componente, desempilha a componente inteira
+            if (grafo->baixo[v] == grafo->indice[v]) {
+                int inicio = topo;
+                do {
+                    inicio--;
+                    grafo->na_pilha[grafo->pilha[inicio]] = false;
+                } while (grafo->pilha[inicio] != v);
+
+                // A pilha guarda os vértices na ordem de descoberta, que é a ordem de espera
+                int tamanho = topo - inicio;
+                if (tamanho > 1) {
+                    ciclos++;
+                    if (ao_encontrar) ao_encontrar(&grafo->pilha[inicio], tamanho, contexto);
+                }
+                topo = inicio;
+            }
+
+            profundidade--;
+            if (profundidade > 0) {
+                int pai = grafo->chamada[profundidade - 1];
+                if (grafo->baixo[v] < grafo->baixo[pai]) {
+                    grafo->baixo[pai] = grafo->baixo[v];
+                }
+            }
+        }
+    }
+    return ciclos;
+}
@@ -0,0 +1,260 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include "../include/instantaneo.h"
+#include "../include/utils.h"
+
+// Espelho do estado do controlador. Os campos são atômicos (acesso relaxado) para
+// que a leitura concorrente seja bem definida; a coerência vem da sequência:
+// ímpar enquanto uma escrita está em andamento, e o leitor descarta a cópia se
+// ela mudou entre o início e o fim
+typedef struct {
+    _Alignas(LINHA_CACHE) _Atomic unsigned long sequencia;
+    _Alignas(LINHA_CACHE) int total_setores;
+    int total_aeronaves;
+    unsigned long chegadas;           // Ordem de chegada às filas (desempate FIFO), só o escritor
+    _Atomic int *ocupante;            // Por setor
+    _Atomic int *aguardando;          // Por aeronave: setor em cuja fila espera, -1 se nenhum
+    _Atomic double *chave;            // Por aeronave: chave da política na fila
+    _Atomic unsigned long *chegada;   // Por aeronave: ordem de chegada à fila
+    _Atomic unsigned int *prioridade; // Por aeronave
+} espelho_t;
+
+static espelho_t espelho;
+static bool escrita_aberta = false; // Só sob mutex_ctrl
+
+typedef struct {
+    int setor;
+    int id;
+    double chave;
+    unsigned long chegada;
+} entrada_fila_t;
+
+/**
+ * Aloca o espelho vazio (todos os setores livres, nenhuma fila)
+ * @param setores: Número de setores
+ * @param aeronaves: Número máximo de aeronaves
+ * @return true em caso de sucesso
+ */
+bool instantaneo_inicializar(int setores, int aeronaves) {
+    espelho.total_setores = setores;
+    espelho.total_aeronaves = aeronaves;
+    espelho.chegadas = 0;
+    escrita_aberta = false;
+    atomic_store(&espelho.sequencia, 0);
+    espelho.ocupante = malloc(sizeof(*espelho.ocupante) * setores);
+    espelho.aguardando = malloc(sizeof(*espelho.aguardando) * aeronaves);
+    espelho.chave = malloc(sizeof(*espelho.chave) * aeronaves);
+    espelho.chegada = malloc(sizeof(*espelho.chegada) * aeronaves);
+    espelho.prioridade = malloc(sizeof(*espelho.prioridade) * aeronaves);
+    if (!espelho.ocupante || !espelho.aguardando || !espelho.chave ||
+        !espelho.chegada || !espelho.prioridade) {
+        instantaneo_finalizar();
+        return false;
+    }
+
+    for (int s = 0; s < setores; s++) {
+        atomic_init(&espelho.ocupante[s], -1);
+    }
+    for (int i = 0; i < aeronaves; i++) {
+        atomic_init(&espelho.aguardando[i], -1);
+        atomic_init(&espelho.chave[i], 0.0);
+        atomic_init(&espelho.chegada[i], 0);
+        atomic_init(&espelho.prioridade[i], 0);
+    }
+    return true;
+}
+
+/**
+ * Libera o espelho (nenhum leitor pode estar ativo)
+ */
+void instantaneo_finalizar() {
+    free(espelho.ocupante);
+    free(espelho.aguardando);
+    free(espelho.chave);
+    free(espelho.chegada);
+    free(espelho.prioridade);
+    memset(&espelho, 0, sizeof(espelho));
+}
+
+/**
+ * Abre a escrita da seção crítica atual na primeira mudança: a sequência fica
+ * ímpar até instantaneo_publicar, então o leitor nunca vê metade de uma
+ * transação do controlador (um setor repassado ainda com o dono antigo noutro)
+ */
+static inline void escrita_abrir() {
+    if (escrita_aberta) return;
+    unsigned long s = atomic_load_explicit(&espelho.sequencia, memory_order_relaxed);
+    atomic_store_explicit(&espelho.sequencia, s + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    escrita_aberta = true;
+}
+
+/**
+ * Fecha a escrita aberta na seção crítica, se houve alguma (atc_destravar,
+ * ainda sob mutex_ctrl). Seções que só leram não mexem na sequência
+ */
+void instantaneo_publicar() {
+    if (!escrita_aberta) return;
+    unsigned long s = atomic_load_explicit(&espelho.sequencia, memory_order_relaxed);
+    atomic_store_explicit(&espelho.sequencia, s + 1, memory_order_release);
+    escrita_aberta = false;
+}
+
+/**
+ * Registra o novo ocupante de um setor
+ * @param setor: Índice do setor
+ * @param id: Id do ocupante ou -1 para livre
+ */
+void instantaneo_ocupante(int setor, int id) {
+    if (espelho.ocupante == NULL || setor < 0 || setor >= espelho.total_setores) return;
+    escrita_abrir();
+    atomic_store_explicit(&espelho.ocupante[setor], id, memory_order_relaxed);
+}
+
+/**
+ * Repasse: a aeronave sai da fila do setor e passa a ocupá-lo
+ * @param setor: Setor repassado
+ * @param id: Id da aeronave que recebeu o setor
+ */
+void instantaneo_repassar(int setor, int id) {
+    if (espelho.ocupante == NULL || setor < 0 || setor >= espelho.total_setores) return;
+    escrita_abrir();
+    atomic_store_explicit(&espelho.ocupante[setor], id, memory_order_relaxed);
+    if (id >= 0 && id < espelho.total_aeronaves) {
+        atomic_store_explicit(&espelho.aguardando[id], -1, memory_order_relaxed);
+    }
+}
+
+/**
+ * Registra a entrada de uma aeronave na fila de um setor
+ * @param id: Id da aeronave
+ * @param setor: Setor aguardado
+ * @param chave: Chave de ordenação calculada pela política
+ */
+void instantaneo_enfileirar(int id, int setor, double chave) {
+    if (espelho.aguardando == NULL || id < 0 || id >= espelho.total_aeronaves) return;
+    escrita_abrir();
+    atomic_store_explicit(&espelho.chave[id], chave, memory_order_relaxed);
+    atomic_store_explicit(&espelho.chegada[id], ++espelho.chegadas, memory_order_relaxed);
+    atomic_store_explicit(&espelho.aguardando[id], setor, memory_order_relaxed);
+}
+
+/**
+ * Registra a saída de uma aeronave da fila sem receber o setor (recuo)
+ * @param id: Id da aeronave
+ */
+void instantaneo_desenfileirar(int id) {
+    if (espelho.aguardando == NULL || id < 0 || id >= espelho.total_aeronaves) return;
+    escrita_abrir();
+    atomic_store_explicit(&espelho.aguardando[id], -1, memory_order_relaxed);
+}
+
+/**
+ * Registra a prioridade efetiva de uma aeronave
+ * @param id: Id da aeronave
+ * @param prioridade: Nova prioridade
+ */
+void instantaneo_prioridade(int id, unsigned int prioridade) {
+    if (espelho.prioridade == NULL || id < 0 || id >= espelho.total_aeronaves) return;
+    escrita_abrir();
+    atomic_store_explicit(&espelho.prioridade[id], prioridade, memory_order_relaxed);
+}
+
+static int comparar_entradas(const void *a, const void *b) {
+    const entrada_fila_t *x = a, *y = b;
+    if (x->setor != y->setor) return x->setor - y->setor;
+    if (x->chave != y->chave) return (x->chave > y->chave) - (x->chave < y->chave);
+    return (x->chegada > y->chegada) - (x->chegada < y->chegada);
+}
+
+/**
+ * Copia o estado atual sem travar o controlador. As filas são remontadas a
+ * partir de (setor aguardado, chave, chegada), a mesma ordem de fila_inserir
+ * @param instantaneo: Recebe a cópia (liberar com instantaneo_liberar)
+ * @return true em caso de sucesso, false sem memória ou sem controlador ativo
+ */
+bool instantaneo_capturar(instantaneo_t *instantaneo) {
+    memset(instantaneo, 0, sizeof(*instantaneo));
+    int setores = espelho.total_setores;
+    int aeronaves = espelho.total_aeronaves;
+    if (espelho.ocupante == NULL) return false;
+
+    instantaneo->total_setores = setores;
+    instantaneo->total_aeronaves = aeronaves;
+    instantaneo->ocupante = malloc(sizeof(int) * setores);
+    instantaneo->inicio_fila = malloc(sizeof(int) * (setores + 1));
+    instantaneo->fila = malloc(sizeof(int) * (aeronaves > 0 ? aeronaves : 1));
+    instantaneo->prioridade = malloc(sizeof(unsigned int) * (aeronaves > 0 ? aeronaves : 1));
+    entrada_fila_t *entradas = malloc(sizeof(entrada_fila_t) * (aeronaves > 0 ? aeronaves : 1));
+    if (!instantaneo->ocupante || !instantaneo->inicio_fila || !instantaneo->fila ||
+        !instantaneo->prioridade || !entradas) {
+        free(entradas);
+        instantaneo_liberar(instantaneo);
+        return false;
+    }
+
+    unsigned long inicio, fim;
+    while (true) {
+        inicio = atomic_load_explicit(&espelho.sequencia, memory_order_acquire);
+        if (inicio & 1) {
+            instantaneo->tentativas++;
+            sched_yield();
+            continue;
+        }
+        for (int s = 0; s < setores; s++) {
+            instantaneo->ocupante[s] = atomic_load_explicit(&espelho.ocupante[s], memory_order_relaxed);
+        }
+        for (int i = 0; i < aeronaves; i++) {
+            entradas[i].id = i;
+            entradas[i].setor = atomic_load_explicit(&espelho.aguardando[i], memory_order_relaxed);
+            entradas[i].chave = atomic_load_explicit(&espelho.chave[i], memory_order_relaxed);
+            entradas[i].chegada = atomic_load_explicit(&espelho.chegada[i], memory_order_relaxed);
+            instantaneo->prioridade[i] = atomic_load_explicit(&espelho.prioridade[i], memory_order_relaxed);
+        }
+        atomic_thread_fence(memory_order_acquire);
+        fim = atomic_load_explicit(&espelho.sequencia, memory_order_relaxed);
+        if (fim == inicio) break;
+        instantaneo->tentativas++;
+    }
+    instantaneo->versao = inicio;
+
+    // Só as aeronaves em espera, agrupadas por setor e na ordem de atendimento
+    int em_espera = 0;
+    for (int i = 0; i < aeronaves; i++) {
+        if (entradas[i].setor >= 0 && entradas[i].setor < setores) {
+            entradas[em_espera++] = entradas[i];
+        }
+    }
+    qsort(entradas, em_espera, sizeof(entrada_fila_t), comparar_entradas);
+
+    int k = 0;
+    for (int s = 0; s < setores; s++) {
+        instantaneo->inicio_fila[s] = k;
+        while (k < em_espera && entradas[k].setor == s) {
+            instantaneo->fila[k] = entradas[k].id;
+            k++;
+        }
+    }
+    instantaneo->inicio_fila[setores] = k;
+
+    free(entradas);
+    return true;
+}
+
+/**
+ * Libera a memória de uma cópia
+ * @param instantaneo: Cópia obtida com instantaneo_capturar
+ */
+void instantaneo_liberar(instantaneo_t *instantaneo) {
+    free(instantaneo->ocupante);
+    free(instantaneo->inicio_fila);
+    free(instantaneo->fila);
+    free(instantaneo->prioridade);
+    instantaneo->ocupante = NULL;
+    instantaneo->inicio_fila = NULL;
+    instantaneo->fila = NULL;
+    instantaneo->prioridade = NULL;
+}
@@ -0,0 +1,159 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "../include/medicao.h"
+#include "../include/estimativa.h"
+#include "../include/utils.h"
+
+static modo_medicao_t modo = MEDICAO_DESLIGADA;
+static int limite_fila = MEDICAO_FILA_PADRAO;
+static double taxa = MEDICAO_TAXA_PADRAO;
+static int rajada = MEDICAO_RAJADA_PADRAO;
+static char nome[48] = "desligada";
+
+// Balde de fichas de cada setor como instante teórico da próxima entrada
+// (relogio_agora_ns): uma entrada em t é admitida se t >= tat - tolerancia
+static _Atomic long long *tat = NULL;
+static int total_setores = 0;
+static long long espacamento_ns = 0; // Entre entradas, em ns de relógio
+static long long tolerancia_ns = 0;  // (rajada - 1) espaçamentos
+
+/**
+ * Escolhe o critério de medição da linha de comando
+ * @param texto: "desligada", "fila[:N]" ou "taxa[:R[:B]]"
+ * @return true se o critério e os parâmetros forem válidos
+ */
+bool medicao_definir(const char *texto) {
+    if (strcmp(texto, "desligada") == 0) {
+        modo = MEDICAO_DESLIGADA;
+        snprintf(nome, sizeof(nome), "desligada");
+        return true;
+    }
+    if (strncmp(texto, "fila", 4) == 0 && (texto[4] == '\0' || texto[4] == ':')) {
+        int n = MEDICAO_FILA_PADRAO;
+        if (texto[4] == ':' && (sscanf(texto + 5, "%d", &n) != 1 || n < 1)) return false;
+        modo = MEDICAO_FILA;
+        limite_fila = n;
+        snprintf(nome, sizeof(nome), "fila:%d", n);
+        return true;
+    }
+    if (strncmp(texto, "taxa", 4) == 0 && (texto[4] == '\0' || texto[4] == ':')) {
+        double r = MEDICAO_TAXA_PADRAO;
+        int b = MEDICAO_RAJADA_PADRAO;
+        if (texto[4] == ':') {
+            int lidos = sscanf(texto + 5, "%lf:%d", &r, &b);
+            if (lidos < 1 || !(r > 0) || b < 1) return false;
+        }
+        modo = MEDICAO_TAXA;
+        taxa = r;
+        rajada = b;
+        snprintf(nome, sizeof(nome), "taxa:%g:%d", r, b);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @return Critério de medição em uso, com os parâmetros
+ */
+const char *medicao_nome() {
+    return nome;
+}
+
+/**
+ * @return true se alguma aeronave pode ser retida
+ */
+bool medicao_ativa() {
+    return modo != MEDICAO_DESLIGADA;
+}
+
+/**
+ * Prepara a medição para uma execução (depois de atc_init: a escala de tempo
+ * já vale e o critério fila lê os agregados do estimador)
+ * @param setores: Número de setores
+ * @return true em caso de sucesso
+ */
+bool medicao_inicializar(int setores) {
+    medicao_finalizar();
+    if (modo != MEDICAO_TAXA) return true;
+
+    tat = malloc(sizeof(*tat) * setores);
+    if (tat == NULL) {
+        perror("malloc medicao");
+        return false;
+    }
+    for (int s = 0; s < setores; s++) {
+        atomic_init(&tat[s], 0);
+    }
+    total_setores = setores;
+    espacamento_ns = (long long)(1e9 / taxa / (escala_tempo > 0 ? escala_tempo : 1));
+    tolerancia_ns = (rajada - 1) * espacamento_ns;
+    return true;
+}
+
+/**
+ * Libera o estado da medição
+ */
+void medicao_finalizar() {
+    free(tat);
+    tat = NULL;
+    total_setores = 0;
+}
+
+/**
+ * Quanto falta para o balde de um setor ter uma ficha
+ * @return 0 se já tem, senão quanto falta (ns)
+ */
+static long long medicao_falta_ficha(int setor, long long agora_ns) {
+    if (setor < 0 || setor >= total_setores) return 0;
+    long long falta = atomic_load_explicit(&tat[setor], memory_order_relaxed) - tolerancia_ns - agora_ns;
+    return falta > 0 ? falta : 0;
+}
+
+/**
+ * Tira uma ficha do balde de um setor, mesmo que ele esteja vazio (quem
+ * conferiu antes e perdeu a corrida fica devendo: o próximo espera mais)
+ */
+static void medicao_tirar_ficha(int setor, long long agora_ns) {
+    if (setor < 0 || setor >= total_setores) return;
+    long long atual = atomic_load_explicit(&tat[setor], memory_order_relaxed);
+    for (;;) {
+        long long base = atual > agora_ns ? atual : agora_ns;
+        if (atomic_compare_exchange_weak_explicit(&tat[setor], &atual, base + espacamento_ns,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+            return;
+        }
+    }
+}
+
+/**
+ * Decide se uma aeronave em solo pode decolar agora. Sem travas: lê o
+ * tamanho das filas no estimador ou tira fichas com CAS
+ * @param setor_primeiro: Primeiro setor da rota
+ * @param setor_seguinte: Segundo setor da rota (-1 se a rota tiver um só)
+ * @param agora_ns: Instante da consulta (relogio_agora_ns)
+ * @return 0 se admitida, senão quanto esperar (ns de relógio) antes de consultar de novo
+ */
+long long medicao_admitir(int setor_primeiro, int setor_seguinte, long long agora_ns) {
+    long long intervalo_ns = (long long)MEDICAO_INTERVALO_MS * 1000000LL / (escala_tempo > 0 ? escala_tempo : 1);
+    switch (modo) {
+    case MEDICAO_FILA:
+        if (estimativa_tamanho_fila(setor_primeiro) >= limite_fila) return intervalo_ns;
+        if (setor_seguinte >= 0 && estimativa_tamanho_fila(setor_seguinte) >= limite_fila) return intervalo_ns;
+        return 0;
+    case MEDICAO_TAXA: {
+        // Cada decolagem gasta uma ficha dos dois setores. Confere os dois
+        // baldes antes de tirar: ficha tirada por quem acaba retido seria perdida
+        long long espera = medicao_falta_ficha(setor_primeiro, agora_ns);
+        long long seguinte = medicao_falta_ficha(setor_seguinte, agora_ns);
+        if (seguinte > espera) espera = seguinte;
+        if (espera > 0) return espera;
+        medicao_tirar_ficha(setor_primeiro, agora_ns);
+        medicao_tirar_ficha(setor_seguinte, agora_ns);
+        return 0;
+    }
+    default:
+        return 0;
+    }
+}
@@ -0,0 +1,313 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include "../include/ocupacao.h"
+#include "../include/utils.h"
+
+#define PALAVRA_BITS 64
+
+static _Atomic uint64_t *livres = NULL;       // Bit s = setor s livre (bits além do último ficam em 0)
+static _Atomic uint64_t *resumo = NULL;       // Bit w = palavra w de livres tem algum setor livre
+static _Atomic uint16_t *profundidade = NULL; // Fila comum + corredor de cada setor
+static _Atomic int total_livres = 0;
+static int total_setores = 0;
+static int total_palavras = 0;
+
+static int contar_palavras_generico(const _Atomic uint64_t *palavras, int n);
+static int (*contar_palavras)(const _Atomic uint64_t *palavras, int n) = contar_palavras_generico;
+
+/**
+ * Soma os bits de n palavras (__builtin_popcountll sem instrução dedicada
+ * vira uma chamada à libgcc)
+ */
+static int contar_palavras_generico(const _Atomic uint64_t *palavras, int n) {
+    int total = 0;
+    for (int i = 0; i < n; i++) {
+        total += __builtin_popcountll(atomic_load_explicit(&palavras[i], memory_order_relaxed));
+    }
+    return total;
+}
+
+#if defined(__x86_64__) && defined(__GNUC__)
+/**
+ * Mesma soma com a instrução popcnt, escolhida em ocupacao_inicializar se o
+ * processador a tiver (o build não usa -march)
+ */
+__attribute__((target("popcnt")))
+static int contar_palavras_popcnt(const _Atomic uint64_t *palavras, int n) {
+    int total = 0;
+    for (int i = 0; i < n; i++) {
+        total += __builtin_popcountll(atomic_load_explicit(&palavras[i], memory_order_relaxed));
+    }
+    return total;
+}
+#endif
+
+/**
+ * Aloca um array alinhado à linha de cache
+ */
+static void *ocupacao_alocar(size_t tamanho) {
+    void *memoria = NULL;
+    if (posix_memalign(&memoria, LINHA_CACHE, tamanho) != 0) return NULL;
+    return memoria;
+}
+
+/**
+ * Aloca o índice com todos os setores livres e filas vazias
+ * @param setores: Número de setores
+ * @return true em caso de sucesso
+ */
+bool ocupacao_inicializar(int setores) {
+    ocupacao_finalizar();
+    int palavras = (setores + PALAVRA_BITS - 1) / PALAVRA_BITS;
+    int palavras_resumo = (palavras + PALAVRA_BITS - 1) / PALAVRA_BITS;
+    livres = ocupacao_alocar(sizeof(*livres) * (palavras > 0 ? palavras : 1));
+    resumo = ocupacao_alocar(sizeof(*resumo) * (palavras_resumo > 0 ? palavras_resumo : 1));
+    profundidade = ocupacao_alocar(sizeof(*profundidade) * (setores > 0 ? setores : 1));
+    if (livres == NULL || resumo == NULL || profundidade == NULL) {
+        fprintf(stderr, "Erro ao alocar o índice de ocupação\n");
+        ocupacao_finalizar();
+        return false;
+    }
+
+    for (int w = 0; w < palavras; w++) {
+        int restantes = setores - w * PALAVRA_BITS;
+        atomic_init(&livres[w], restantes >= PALAVRA_BITS ? ~0ULL : (1ULL << restantes) - 1);
+    }
+    for (int r = 0; r < palavras_resumo; r++) {
+        int restantes = palavras - r * PALAVRA_BITS;
+        atomic_init(&resumo[r], restantes >= PALAVRA_BITS ? ~0ULL : (1ULL << restantes) - 1);
+    }
+    for (int s = 0; s < setores; s++) {
+        atomic_init(&profundidade[s], 0);
+    }
+    atomic_init(&total_livres, setores);
+    total_setores = setores;
+    total_palavras = palavras;
+
+#if defined(__x86_64__) && defined(__GNUC__)
+    __builtin_cpu_init();
+    contar_palavras = __builtin_cpu_supports("popcnt") ? contar_palavras_popcnt : contar_palavras_generico;
+#endif
+    return true;
+}
+
+/**
+ * Libera o índice
+ */
+void ocupacao_finalizar() {
+    free(livres);
+    free(resumo);
+    free(profundidade);
+    livres = NULL;
+    resumo = NULL;
+    profundidade = NULL;
+    total_setores = 0;
+    total_palavras = 0;
+}
+
+/**
+ * Troca os bits de uma palavra (só o escritor sob mutex_ctrl)
+ */
+static inline void ocupacao_gravar(_Atomic uint64_t *palavra, uint64_t valor) {
+    atomic_store_explicit(palavra, valor, memory_order_relaxed);
+}
+
+/**
+ * Marca um setor como ocupado (nada muda se já estava)
+ * @param setor: Setor concedido
+ */
+void ocupacao_ocupar(int setor) {
+    if (livres == NULL || setor < 0 || setor >= total_setores) return;
+    int w = setor / PALAVRA_BITS;
+    uint64_t bit = 1ULL << (setor % PALAVRA_BITS);
+    uint64_t palavra = atomic_load_explicit(&livres[w], memory_order_relaxed);
+    if ((palavra & bit) == 0) return;
+    palavra &= ~bit;
+    ocupacao_gravar(&livres[w], palavra);
+    atomic_store_explicit(&total_livres, atomic_load_explicit(&total_livres, memory_order_relaxed) - 1,
+                          memory_order_relaxed);
+    if (palavra == 0) {
+        _Atomic uint64_t *r = &resumo[w / PALAVRA_BITS];
+        ocupacao_gravar(r, atomic_load_explicit(r, memory_order_relaxed) & ~(1ULL << (w % PALAVRA_BITS)));
+    }
+}
+
+/**
+ * Marca um setor como livre (nada muda se já estava)
+ * @param setor: Setor liberado
+ */
+void ocupacao_liberar(int setor) {
+    if (livres == NULL || setor < 0 || setor >= total_setores) return;
+    int w = setor / PALAVRA_BITS;
+    uint64_t bit = 1ULL << (setor % PALAVRA_BITS);
+    uint64_t palavra = atomic_load_explicit(&livres[w], memory_order_relaxed);
+    if (palavra & bit) return;
+    ocupacao_gravar(&livres[w], palavra | bit);
+    atomic_store_explicit(&total_livres, atomic_load_explicit(&total_livres, memory_order_relaxed) + 1,
+                          memory_order_relaxed);
+    if (palavra == 0) {
+        _Atomic uint64_t *r = &resumo[w / PALAVRA_BITS];
+        ocupacao_gravar(r, atomic_load_explicit(r, memory_order_relaxed) | (1ULL << (w % PALAVRA_BITS)));
+    }
+}
+
+/**
+ * Conta uma aeronave que entrou na fila (comum ou corredor) de um setor
+ * @param setor: Setor aguardado
+ */
+void ocupacao_enfileirar(int setor) {
+    if (profundidade == NULL || setor < 0 || setor >= total_setores) return;
+    uint16_t atual = atomic_load_explicit(&profundidade[setor], memory_order_relaxed);
+    if (atual < OCUPACAO_PROFUNDIDADE_MAX) {
+        atomic_store_explicit(&profundidade[setor], atual + 1, memory_order_relaxed);
+    }
+}
+
+/**
+ * Desconta uma aeronave que saiu da fila de um setor
+ * @param setor: Setor aguardado
+ */
+void ocupacao_desenfileirar(int setor) {
+    if (profundidade == NULL || setor < 0 || setor >= total_setores) return;
+    uint16_t atual = atomic_load_explicit(&profundidade[setor], memory_order_relaxed);
+    if (atual > 0) {
+        atomic_store_explicit(&profundidade[setor], atual - 1, memory_order_relaxed);
+    }
+}
+
+/**
+ * @return true se o setor está livre
+ */
+bool ocupacao_livre(int setor) {
+    if (livres == NULL || setor < 0 || setor >= total_setores) return false;
+    uint64_t palavra = atomic_load_explicit(&livres[setor / PALAVRA_BITS], memory_order_relaxed);
+    return (palavra >> (setor % PALAVRA_BITS)) & 1;
+}
+
+/**
+ * Carga de um setor: aeronaves na fila mais o ocupante
+ * @param setor: Índice do setor
+ * @return Carga, ou -1 se o setor for inválido
+ */
+int ocupacao_carga(int setor) {
+    if (profundidade == NULL || setor < 0 || setor >= total_setores) return -1;
+    return atomic_load_explicit(&profundidade[setor], memory_order_relaxed) + !ocupacao_livre(setor);
+}
+
+/**
+ * Conta os setores livres em [inicio, fim): as palavras inteiras com popcount
+ * e as das pontas com máscara. O intervalo todo sai de um contador, em O(1)
+ * @param inicio: Primeiro setor
+ * @param fim: Um além do último setor
+ * @return Setores livres no intervalo
+ */
+int ocupacao_livres(int inicio, int fim) {
+    if (livres == NULL) return 0;
+    if (inicio < 0) inicio = 0;
+    if (fim > total_setores) fim = total_setores;
+    if (inicio >= fim) return 0;
+    if (inicio == 0 && fim == total_setores) return atomic_load_explicit(&total_livres, memory_order_relaxed);
+
+    int wi = inicio / PALAVRA_BITS;
+    int wf = (fim - 1) / PALAVRA_BITS;
+    uint64_t mascara_inicio = ~0ULL << (inicio % PALAVRA_BITS);
+    uint64_t mascara_fim = ~0ULL >> (PALAVRA_BITS - 1 - (fim - 1) % PALAVRA_BITS);
+    uint64_t primeira = atomic_load_explicit(&livres[wi], memory_order_relaxed);
+    if (wi == wf) return __builtin_popcountll(primeira & mascara_inicio & mascara_fim);
+
+    uint64_t ultima = atomic_load_explicit(&livres[wf], memory_order_relaxed);
+    return __builtin_popcountll(primeira & mascara_inicio) + __builtin_popcountll(ultima & mascara_fim) +
+           contar_palavras(&livres[wi + 1], wf - wi - 1);
+}
+
+/**
+ * Próxima palavra de livres, a partir de w, com algum setor livre segundo o resumo
+ * @return Índice da palavra, ou total_palavras se não houver
+ */
+static int ocupacao_proxima_palavra(int w) {
+    if (w >= total_palavras) return total_palavras;
+    int r = w / PALAVRA_BITS;
+    int total_resumo = (total_palavras + PALAVRA_BITS - 1) / PALAVRA_BITS;
+    uint64_t bits = atomic_load_explicit(&resumo[r], memory_order_relaxed) & (~0ULL << (w % PALAVRA_BITS));
+    while (bits == 0) {
+        if (++r >= total_resumo) return total_palavras;
+        bits = atomic_load_explicit(&resumo[r], memory_order_relaxed);
+    }
+    return r * PALAVRA_BITS + __builtin_ctzll(bits);
+}
+
+/**
+ * Primeiro setor livre em [inicio, fim). Palavras sem livres são puladas pelo
+ * resumo, então um intervalo quase todo ocupado custa uma leitura a cada 4096 setores
+ * @param inicio: Primeiro setor
+ * @param fim: Um além do último setor
+ * @return Setor livre de menor índice, ou -1 se nenhum
+ */
+int ocupacao_primeiro_livre(int inicio, int fim) {
+    if (livres == NULL) return -1;
+    if (inicio < 0) inicio = 0;
+    if (fim > total_setores) fim = total_setores;
+    if (inicio >= fim) return -1;
+
+    int w = inicio / PALAVRA_BITS;
+    int wf = (fim - 1) / PALAVRA_BITS;
+    uint64_t palavra = atomic_load_explicit(&livres[w], memory_order_relaxed) & (~0ULL << (inicio % PALAVRA_BITS));
+    for (;;) {
+        if (palavra != 0) {
+            int setor = w * PALAVRA_BITS + __builtin_ctzll(palavra);
+            return setor < fim ? setor : -1;
+        }
+        // O resumo pode estar um passo atrás da palavra: se ela já não tem
+        // livres, segue para a próxima
+        w = ocupacao_proxima_palavra(w + 1);
+        if (w > wf) return -1;
+        palavra = atomic_load_explicit(&livres[w], memory_order_relaxed);
+    }
+}
+
+/**
+ * Primeiro setor livre de uma lista de candidatos, na ordem da lista
+ * @param candidatos: Índices de setores (inválidos são ignorados)
+ * @param n: Tamanho da lista
+ * @return Setor livre, ou -1 se nenhum
+ */
+int ocupacao_primeiro_livre_de(const int *candidatos, int n) {
+    for (int i = 0; i < n; i++) {
+        if (ocupacao_livre(candidatos[i])) return candidatos[i];
+    }
+    return -1;
+}
+
+/**
+ * Os k candidatos de menor carga (fila mais ocupante), em ordem crescente de
+ * carga; empates ficam na ordem da lista. Cada candidato custa uma leitura da
+ * profundidade e, se não entra entre os k, uma comparação; a busca para cedo
+ * quando já há k setores livres com fila vazia
+ * @param candidatos: Índices de setores (inválidos são ignorados)
+ * @param n: Tamanho da lista
+ * @param k: Quantos devolver (até OCUPACAO_K_MAX)
+ * @param saida: Recebe os setores escolhidos
+ * @return Quantos setores foram escritos em saida
+ */
+int ocupacao_menos_carregados(const int *candidatos, int n, int k, int *saida) {
+    if (k > OCUPACAO_K_MAX) k = OCUPACAO_K_MAX;
+    int cargas[OCUPACAO_K_MAX];
+    int escolhidos = 0;
+    for (int i = 0; i < n && k > 0; i++) {
+        int carga = ocupacao_carga(candidatos[i]);
+        if (carga < 0) continue;
+        if (escolhidos == k && carga >= cargas[k - 1]) continue;
+
+        int j = escolhidos < k ? escolhidos++ : k - 1;
+        while (j > 0 && cargas[j - 1] > carga) {
+            cargas[j] = cargas[j - 1];
+            saida[j] = saida[j - 1];
+            j--;
+        }
+        cargas[j] = carga;
+        saida[j] = candidatos[i];
+        if (escolhidos == k && cargas[k - 1] == 0) break;
+    }
+    return escolhidos;
+}
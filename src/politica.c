@@ -0,0 +1,102 @@
+#include <string.h>
+#include "../include/politica.h"
+#include "../include/aeronave.h"
+#include "../include/utils.h"
+
+/**
+ * Prioridade estrita: maior prioridade primeiro, FIFO nos empates
+ */
+static double chave_prioridade(fila_prioridade_t *fila, aeronave_t *aeronave) {
+    (void)fila;
+    return -(double)aeronave->prioridade;
+}
+
+/**
+ * FIFO: chave constante, a ordem de chegada decide
+ */
+static double chave_fifo(fila_prioridade_t *fila, aeronave_t *aeronave) {
+    (void)fila;
+    (void)aeronave;
+    return 0.0;
+}
+
+/**
+ * Earliest-deadline-first: o prazo da solicitação é o instante do pedido mais
+ * uma tolerância inversamente proporcional à prioridade (P:1000 tolera um tempo
+ * de voo nominal, P:1 tolera mil). Pedidos antigos acabam passando à frente.
+ */
+static double chave_edf(fila_prioridade_t *fila, aeronave_t *aeronave) {
+    (void)fila;
+    double pedido = aeronave->instante_solicitacao_ns / 1e9;
+    double voo_nominal = (TEMPO_VOO_MIN_MS + TEMPO_VOO_VARIACAO_MS / 2) / 1000.0 / escala_tempo;
+    unsigned int prioridade = aeronave->prioridade > 0 ? aeronave->prioridade : 1;
+    return pedido + voo_nominal * PRIORIDADE_MAX / prioridade;
+}
+
+/**
+ * Weighted fair queueing: cada aeronave é um fluxo de peso igual à prioridade.
+ * A tag de término é o relógio virtual da fila mais o custo normalizado pelo peso.
+ */
+static double chave_wfq(fila_prioridade_t *fila, aeronave_t *aeronave) {
+    unsigned int peso = aeronave->prioridade > 0 ? aeronave->prioridade : 1;
+    return fila->tempo_virtual + (double)PRIORIDADE_MAX / peso;
+}
+
+/**
+ * Troca só o termo do peso na tag de quem já está na fila: a tag de início é
+ * o relógio virtual de quando entrou, não o de agora
+ */
+static double rechave_wfq(fila_prioridade_t *fila, aeronave_t *aeronave, double chave, unsigned int prioridade_antiga) {
+    (void)fila;
+    unsigned int peso_antigo = prioridade_antiga > 0 ? prioridade_antiga : 1;
+    unsigned int peso = aeronave->prioridade > 0 ? aeronave->prioridade : 1;
+    double inicio = chave - (double)PRIORIDADE_MAX / peso_antigo;
+    return inicio + (double)PRIORIDADE_MAX / peso;
+}
+
+/**
+ * Avança o relógio virtual do WFQ até a tag da aeronave atendida
+ */
+static void wfq_ao_atender(fila_prioridade_t *fila, double chave) {
+    if (chave > fila->tempo_virtual) {
+        fila->tempo_virtual = chave;
+    }
+}
+
+/**
+ * Shortest-remaining-route-first: menos setores restantes na rota primeiro
+ */
+static double chave_srrf(fila_prioridade_t *fila, aeronave_t *aeronave) {
+    (void)fila;
+    return (double)(aeronave->comprimento_rota - aeronave->posicao_rota);
+}
+
+const politica_fila_t politica_prioridade = { "prioridade", chave_prioridade, NULL, NULL, false };
+const politica_fila_t politica_fifo = { "fifo", chave_fifo, NULL, NULL, false };
+const politica_fila_t politica_edf = { "edf", chave_edf, NULL, NULL, true };
+const politica_fila_t politica_wfq = { "wfq", chave_wfq, rechave_wfq, wfq_ao_atender, false };
+const politica_fila_t politica_srrf = { "srrf", chave_srrf, NULL, NULL, false };
+
+const politica_fila_t *const politicas_disponiveis[] = {
+    &politica_prioridade,
+    &politica_fifo,
+    &politica_edf,
+    &politica_wfq,
+    &politica_srrf,
+};
+const int total_politicas = sizeof(politicas_disponiveis) / sizeof(politicas_disponiveis[0]);
+
+/**
+ * Busca uma política de escalonamento pelo nome
+ * @param nome: Nome da política (prioridade, fifo, edf, wfq, srrf)
+ * @return Ponteiro para a política ou NULL se o nome for desconhecido
+ */
+const politica_fila_t *politica_buscar(const char *nome) {
+    if (nome == NULL) return NULL;
+    for (int i = 0; i < total_politicas; i++) {
+        if (strcmp(politicas_disponiveis[i]->nome, nome) == 0) {
+            return politicas_disponiveis[i];
+        }
+    }
+    return NULL;
+}
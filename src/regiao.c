@@ -0,0 +1,985 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include "../include/regiao.h"
+#include "../include/anel_spsc.h"
+#include "../include/fila_mpsc.h"
+#include "../include/controlador.h"
+#include "../include/frota.h"
+#include "../include/espera.h"
+#include "../include/utils.h"
+#include "../include/relogio.h"
+
+// Detecção de ciclos entre regiões (edge-chasing): uma aeronave que segura um
+// setor e espera há mais de LIMIAR_SONDA_MS por um setor remoto envia uma sonda
+// que percorre a cadeia de espera; se a sonda voltar a ela, existe um ciclo
+#define PERIODO_SONDA_MS 50
+#define LIMIAR_SONDA_MS 100
+#define SALTOS_SONDA_MAX 64
+
+// Cada região escreve em dois anéis por destino, cada um com um único
+// produtor: o da receptora (pedidos e concessões que as aeronaves deixam na
+// fila de saída local, mais as sondas encaminhadas) e o da detectora (sondas
+// novas). As aeronaves nunca tocam os anéis nem disputam trava para enviar
+#define CANAL_RECEPTOR 0
+#define CANAL_DETECTOR 1
+#define CANAIS_ANEL 2
+
+typedef enum {
+    MSG_PEDIDO,     // A aeronave quer um setor desta região (leva o estado dela)
+    MSG_CONCEDIDO,  // O setor pedido foi concedido: a origem libera o setor antigo
+    MSG_ABANDONO,   // A aeronave não conseguiu o setor local e deixou a simulação: a origem também libera
+    MSG_SONDA       // Sonda de ciclo de espera
+} tipo_mensagem_t;
+
+typedef struct {
+    int tipo;
+    int regiao_origem;      // Quem enviou o PEDIDO / região do iniciador da SONDA
+    int aeronave;
+    int setor;              // Setor global pedido, concedido ou investigado
+    int iniciador;          // SONDA: aeronave que começou a sonda
+    int saltos;             // SONDA: regiões já atravessadas
+    unsigned int prioridade;
+    unsigned int prioridade_original;
+    unsigned int semente;
+    int posicao_rota;
+    int contador_recuos;
+    int contador_esperas_longas;
+} mensagem_regiao_t;
+
+// Onde as threads de uma região dormem, na memória compartilhada (semáforos
+// entre processos): quem produz só faz sem_post se vir a flag ligada
+typedef struct {
+    sem_t sem_receptor;              // Receptora sem mensagens a tratar nem a enviar
+    sem_t sem_principal;             // Thread principal esperando a frota terminar
+    _Atomic bool receptor_dormindo;
+    _Atomic bool principal_dormindo;
+    _Atomic bool aguardando_espaco;  // A receptora tem um envio parado por anel cheio
+} sinais_regiao_t;
+
+// Cabeçalho da memória compartilhada; os anéis vêm logo depois, anel (i -> j)
+// do canal c no índice (i*R+j)*CANAIS_ANEL+c
+typedef struct {
+    sem_t sem_prontas;               // Um sem_post por região preparada (ou que falhou)
+    sem_t sem_largada;               // Um sem_post por região quando a largada é dada
+    _Atomic int regioes_com_falha;   // Regiões que não conseguiram se preparar
+    _Atomic int largada;             // 1 = largar, -1 = abortar (alguma região falhou)
+    _Atomic int aeronaves_concluidas;
+    long long inicio_ns;
+    int total_regioes;
+    size_t tamanho_anel;
+    size_t deslocamento_aneis;
+    sinais_regiao_t sinais[REGIOES_MAX];
+    regiao_resultado_t resultados[REGIOES_MAX];
+} memoria_regioes_t;
+
+// Mensagem de uma aeronave para outra região, na fila de saída local até a
+// receptora copiá-la para o anel. Cada aeronave tem uma por tipo: a próxima
+// do mesmo tipo só sai depois que a anterior chegou ao destino
+typedef struct {
+    no_mpsc_t no;                    // Primeiro campo: o nó da fila é a própria mensagem
+    _Atomic bool em_uso;             // Na fila de saída ou parada por anel cheio
+    int destino;
+    mensagem_regiao_t mensagem;
+} envio_local_t;
+
+#define ENVIO_PEDIDO 0
+#define ENVIO_CONCEDIDO 1
+#define ENVIOS_POR_AERONAVE 2
+
+// Estado do processo de uma região (cada processo tem a sua cópia após o fork)
+static memoria_regioes_t *memoria;
+static int regiao_id;
+static int total_regioes_ativas;
+static int setores_globais;
+static int setor_base;
+static frota_t frota_regiao;
+static _Atomic int *aguardando_remoto;       // Setor global esperado em outra região, -1 se nenhum
+static _Atomic long long *inicio_espera_remota;
+static int *regiao_a_notificar;              // Quem espera o CONCEDIDO do 1º setor local, -1 se ninguém
+static _Atomic bool *thread_ativa;
+static mensagem_regiao_t *pedido_adiado;     // PEDIDO que chegou com a thread anterior ainda saindo
+static _Atomic bool *tem_pedido_adiado;      // Quem trocar para false inicia a aeronave
+static _Atomic int threads_ativas;
+static _Atomic bool regiao_encerrando;
+static _Atomic int contagem_pedidos;
+static _Atomic int contagem_sondas;
+static _Atomic int contagem_ciclos;
+static envio_local_t *envios;                // ENVIOS_POR_AERONAVE por aeronave
+static fila_mpsc_t fila_saida;               // Envios das aeronaves (consumidora: a receptora)
+static envio_local_t *envio_pendente;        // Retirado da fila, esperando espaço no anel (só a receptora)
+static pthread_attr_t atributos_aeronave;
+
+/**
+ * Primeiro setor global de uma região
+ */
+static int regiao_setor_inicial(int regiao) {
+    return (int)((long)setores_globais * regiao / total_regioes_ativas);
+}
+
+/**
+ * Região que controla um setor global
+ */
+static int regiao_do_setor(int setor) {
+    int regiao = (int)((long)setor * total_regioes_ativas / setores_globais);
+    while (regiao > 0 && setor < regiao_setor_inicial(regiao)) regiao--;
+    while (regiao < total_regioes_ativas - 1 && setor >= regiao_setor_inicial(regiao + 1)) regiao++;
+    return regiao;
+}
+
+/**
+ * Anel usado para mensagens da região origem para a região destino
+ * @param canal: CANAL_RECEPTOR ou CANAL_DETECTOR (o produtor do anel)
+ */
+static anel_spsc_t *regiao_anel(int origem, int destino, int canal) {
+    char *base = (char *)memoria + memoria->deslocamento_aneis;
+    size_t indice = (size_t)(origem * memoria->total_regioes + destino) * CANAIS_ANEL + canal;
+    return (anel_spsc_t *)(base + indice * memoria->tamanho_anel);
+}
+
+/**
+ * Acorda uma thread que dorme num semáforo da memória compartilhada, se ela
+ * anunciou que ia dormir
+ */
+static void regiao_acordar(sem_t *sem, _Atomic bool *dormindo) {
+    if (atomic_exchange(dormindo, false)) {
+        sem_post(sem);
+    }
+}
+
+/**
+ * Acorda a receptora de uma região (mensagem nova ou espaço livre num anel)
+ */
+static void regiao_acordar_receptor(int regiao) {
+    regiao_acordar(&memoria->sinais[regiao].sem_receptor, &memoria->sinais[regiao].receptor_dormindo);
+}
+
+/**
+ * Envia um pedido ou uma concessão de uma aeronave: a mensagem vai para a
+ * fila de saída local e a receptora a copia para o anel (nunca é descartada)
+ * @param a: Aeronave que envia
+ * @param tipo: ENVIO_PEDIDO ou ENVIO_CONCEDIDO (concessão ou abandono, o aviso à origem)
+ * @param destino: Região de destino
+ * @param mensagem: Mensagem a ser enviada
+ */
+static void regiao_enviar(aeronave_t *a, int tipo, int destino, const mensagem_regiao_t *mensagem) {
+    envio_local_t *envio = &envios[a->id * ENVIOS_POR_AERONAVE + tipo];
+    // A anterior do mesmo tipo já chegou ao destino quando a aeronave volta a
+    // enviar; só esperaria aqui com os anéis cheios há muito tempo
+    while (atomic_load(&envio->em_uso)) {
+        sched_yield();
+    }
+    envio->destino = destino;
+    envio->mensagem = *mensagem;
+    atomic_store(&envio->em_uso, true);
+    fila_mpsc_inserir(&fila_saida, &envio->no);
+    regiao_acordar_receptor(regiao_id);
+}
+
+/**
+ * Envia uma sonda pelo anel do canal (só a thread produtora dele chama)
+ * Sondas são descartadas com o anel cheio: o detector manda outra depois
+ * @param canal: CANAL_RECEPTOR ou CANAL_DETECTOR
+ * @param destino: Região de destino
+ * @param sonda: Mensagem a ser enviada
+ */
+static void regiao_enviar_sonda(int canal, int destino, const mensagem_regiao_t *sonda) {
+    if (anel_spsc_enviar(regiao_anel(regiao_id, destino, canal), sonda)) {
+        regiao_acordar_receptor(destino);
+    }
+}
+
+/**
+ * Copia um envio da fila de saída para o anel da receptora. Com o anel cheio
+ * pede ao consumidor que avise quando abrir espaço (e confere de novo, caso
+ * o espaço tenha aberto antes do pedido)
+ * @return false se o anel continua cheio
+ */
+static bool regiao_transmitir(envio_local_t *envio) {
+    anel_spsc_t *anel = regiao_anel(regiao_id, envio->destino, CANAL_RECEPTOR);
+    if (!anel_spsc_enviar(anel, &envio->mensagem)) {
+        atomic_store(&memoria->sinais[regiao_id].aguardando_espaco, true);
+        atomic_thread_fence(memory_order_seq_cst);
+        if (!anel_spsc_enviar(anel, &envio->mensagem)) return false;
+    }
+    atomic_store(&envio->em_uso, false);
+    regiao_acordar_receptor(envio->destino);
+    return true;
+}
+
+/**
+ * Esvazia a fila de saída nos anéis, na ordem em que as aeronaves enviaram
+ * (só a receptora chama). Para no primeiro anel cheio
+ * @return true se enviou alguma mensagem
+ */
+static bool regiao_drenar_saida() {
+    bool enviou = false;
+    while (true) {
+        if (envio_pendente == NULL) {
+            no_mpsc_t *no = fila_mpsc_remover(&fila_saida);
+            if (no == NULL) break;
+            envio_pendente = (envio_local_t *)no;
+        }
+        if (!regiao_transmitir(envio_pendente)) break;
+        envio_pendente = NULL;
+        enviou = true;
+    }
+    return enviou;
+}
+
+/**
+ * Acorda a thread principal de uma região (progresso da frota)
+ */
+static void regiao_acordar_principal(int regiao) {
+    regiao_acordar(&memoria->sinais[regiao].sem_principal, &memoria->sinais[regiao].principal_dormindo);
+}
+
+/**
+ * Conta uma aeronave concluída na frota inteira e acorda a thread principal
+ * de cada região para conferir se a simulação acabou
+ */
+static void regiao_contar_concluida() {
+    atomic_fetch_add(&memoria->aeronaves_concluidas, 1);
+    for (int r = 0; r < total_regioes_ativas; r++) {
+        regiao_acordar_principal(r);
+    }
+}
+
+static void regiao_receber_aeronave(aeronave_t *a, const mensagem_regiao_t *pedido);
+
+/**
+ * Última ação da thread de uma aeronave nesta região. Se a aeronave já
+ * voltou a pedir um setor daqui enquanto esta thread saía, é ela quem
+ * inicia a próxima (a receptora não espera por ela)
+ */
+static void regiao_encerrar_thread(aeronave_t *a) {
+    atomic_store(&thread_ativa[a->id], false);
+    if (atomic_exchange(&tem_pedido_adiado[a->id], false)) {
+        regiao_receber_aeronave(a, &pedido_adiado[a->id]);
+    }
+    if (atomic_fetch_sub(&threads_ativas, 1) == 1) {
+        regiao_acordar_principal(regiao_id);
+    }
+}
+
+/**
+ * Pede um setor de outra região e bloqueia até a concessão
+ * O setor atual continua ocupado durante a espera (ou é liberado pelo
+ * processamento de sondas se a espera fechar um ciclo entre regiões)
+ */
+static void regiao_solicitar_remoto(aeronave_t *a, int destino, int regiao_destino) {
+    mensagem_regiao_t m = {
+        .tipo = MSG_PEDIDO,
+        .regiao_origem = regiao_id,
+        .aeronave = a->id,
+        .setor = destino,
+        .prioridade = atc_prioridade_propria(a),
+        .prioridade_original = a->prioridade_original,
+        .semente = a->semente,
+        .posicao_rota = a->posicao_rota,
+        .contador_recuos = a->contador_recuos,
+        .contador_esperas_longas = a->contador_esperas_longas,
+    };
+
+    atomic_store(&inicio_espera_remota[a->id], relogio_agora_ns());
+    atomic_store(&aguardando_remoto[a->id], destino);
+    atomic_fetch_add(&contagem_pedidos, 1);
+    regiao_enviar(a, ENVIO_PEDIDO, regiao_destino, &m);
+
+    espera_aguardar(&a->sem_aeronave);
+}
+
+/**
+ * Encerra o voo de uma aeronave cujo pedido local falhou: devolve o setor
+ * que ela ocupa aqui e, se acabou de chegar de outra região, avisa a origem
+ * para soltar o setor de lá (sem concessão: ela não voa nem avança na rota).
+ * Conta como concluída para a simulação terminar, como uma thread não criada
+ * @param a: Aeronave cujo pedido falhou
+ * @param destino: Setor global pedido
+ */
+static void regiao_abandonar_voo(aeronave_t *a, int destino) {
+    log_evento("[R%d] Aeronave %3d Falha ao acessar S%d\n", regiao_id, a->id, destino);
+    atc_deixar_setor(a);
+    if (regiao_a_notificar[a->id] >= 0) {
+        mensagem_regiao_t m = {
+            .tipo = MSG_ABANDONO,
+            .regiao_origem = regiao_id,
+            .aeronave = a->id,
+            .setor = destino,
+        };
+        regiao_enviar(a, ENVIO_CONCEDIDO, regiao_a_notificar[a->id], &m);
+        regiao_a_notificar[a->id] = -1;
+    }
+    regiao_contar_concluida();
+    regiao_encerrar_thread(a);
+}
+
+/**
+ * Thread de uma aeronave enquanto ela voa nesta região. Setores locais passam
+ * pelo controlador local; ao conseguir um setor de outra região a thread termina
+ * e o voo continua no processo daquela região
+ */
+static void *regiao_aeronave_executa(void *arg) {
+    aeronave_t *a = (aeronave_t *)arg;
+
+    while (a->posicao_rota < a->comprimento_rota) {
+        int destino = aeronave_trecho(a, a->posicao_rota);
+        int atual_global = a->setor_atual >= 0 ? a->setor_atual + setor_base : -1;
+        if (destino == atual_global) {
+            a->posicao_rota++;
+            continue;
+        }
+
+        int regiao_destino = regiao_do_setor(destino);
+        if (regiao_destino != regiao_id) {
+            regiao_solicitar_remoto(a, destino, regiao_destino);
+            atc_deixar_setor(a);
+            regiao_encerrar_thread(a);
+            return NULL;
+        }
+
+        if (!atc_solicitar_setor(a, destino - setor_base)) {
+            regiao_abandonar_voo(a, destino);
+            return NULL;
+        }
+
+        // Primeiro setor após chegar de outra região: avisa a origem para liberar o anterior
+        if (regiao_a_notificar[a->id] >= 0) {
+            mensagem_regiao_t m = {
+                .tipo = MSG_CONCEDIDO,
+                .regiao_origem = regiao_id,
+                .aeronave = a->id,
+                .setor = destino,
+            };
+            regiao_enviar(a, ENVIO_CONCEDIDO, regiao_a_notificar[a->id], &m);
+            regiao_a_notificar[a->id] = -1;
+        }
+
+        int tempo_voo_ms = TEMPO_VOO_MIN_MS + (rand_r(&a->semente) % TEMPO_VOO_VARIACAO_MS);
+        log_evento("[R%d] Aeronave %3d Voando em S%d por %d ms\n", regiao_id, a->id, destino, tempo_voo_ms);
+        dormir_ms(tempo_voo_ms);
+        a->posicao_rota++;
+    }
+
+    atc_deixar_setor(a);
+    log_evento("[R%d] Aeronave %3d Concluída!\n", regiao_id, a->id);
+    regiao_contar_concluida();
+    regiao_encerrar_thread(a);
+    return NULL;
+}
+
+/**
+ * Cria a thread que voa a aeronave nesta região
+ * Espera a thread anterior da mesma aeronave (se houver) terminar de sair
+ */
+static void regiao_iniciar_aeronave(aeronave_t *a) {
+    while (atomic_load(&thread_ativa[a->id])) {
+        sched_yield();
+    }
+    atomic_store(&thread_ativa[a->id], true);
+    atomic_fetch_add(&threads_ativas, 1);
+
+    pthread_t thread;
+    if (pthread_create(&thread, &atributos_aeronave, regiao_aeronave_executa, a) != 0) {
+        perror("Erro ao criar thread da aeronave");
+        memoria->resultados[regiao_id].status = -1;
+        regiao_encerrar_thread(a);
+        // A aeronave se perde; conta como concluída para a simulação terminar
+        regiao_contar_concluida();
+    }
+}
+
+/**
+ * Desfaz um ciclo entre regiões: o iniciador libera o setor que segura aqui
+ * e continua esperando pelo setor remoto (como o recuo do controlador local)
+ */
+static void regiao_desfazer_ciclo(int id) {
+    aeronave_t *a = frota_regiao.ponteiros[id];
+    if (a == NULL || atomic_load(&aguardando_remoto[id]) < 0) {
+        return; // Já foi atendida: o ciclo não existe mais
+    }
+
+    // A própria thread pode estar devolvendo o setor agora (concessão remota):
+    // atc_deixar_setor troca setor_atual sob mutex_ctrl, então só uma das duas o libera
+    int setor = atc_deixar_setor(a);
+    if (setor < 0) {
+        return; // Não segura nada aqui
+    }
+    atomic_fetch_add(&contagem_ciclos, 1);
+    log_evento("[R%d] !! DEADLOCK entre regiões: A%d libera S%d e continua aguardando S%d !!\n",
+               regiao_id, id, setor + setor_base, atomic_load(&aguardando_remoto[id]));
+}
+
+/**
+ * Segue uma sonda pela cadeia de espera local: ocupante -> setor que ele
+ * aguarda -> ocupante... até a cadeia acabar, sair para outra região
+ * (a sonda é encaminhada) ou voltar ao iniciador (ciclo)
+ */
+static void regiao_seguir_sonda(const mensagem_regiao_t *sonda) {
+    int setor = sonda->setor - setor_base;
+
+    for (int passos = 0; passos < frota_regiao.tamanho; passos++) {
+        int ocupante = atc_ocupante_setor(setor);
+        if (ocupante < 0) return;
+
+        if (ocupante == sonda->iniciador) {
+            if (sonda->regiao_origem == regiao_id) {
+                regiao_desfazer_ciclo(ocupante);
+            }
+            return;
+        }
+
+        int remoto = atomic_load(&aguardando_remoto[ocupante]);
+        if (remoto >= 0) {
+            if (sonda->saltos >= SALTOS_SONDA_MAX) return;
+            mensagem_regiao_t encaminhada = *sonda;
+            encaminhada.setor = remoto;
+            encaminhada.saltos++;
+            regiao_enviar_sonda(CANAL_RECEPTOR, regiao_do_setor(remoto), &encaminhada);
+            return;
+        }
+
+        setor = atc_setor_aguardado(ocupante);
+        if (setor < 0) return;
+    }
+}
+
+/**
+ * Recebe a aeronave que pediu um setor daqui: restaura o estado que veio no
+ * pedido e inicia a thread (a anterior desta aeronave já saiu)
+ * @param a: Aeronave
+ * @param pedido: Mensagem MSG_PEDIDO
+ */
+static void regiao_receber_aeronave(aeronave_t *a, const mensagem_regiao_t *pedido) {
+    a->prioridade_original = pedido->prioridade_original;
+    atc_definir_prioridade(a, pedido->prioridade); // A detecção de deadlock lê a prioridade da tabela
+    a->semente = pedido->semente;
+    a->posicao_rota = pedido->posicao_rota;
+    a->contador_recuos = pedido->contador_recuos;
+    a->contador_esperas_longas = pedido->contador_esperas_longas;
+    a->setor_atual = -1;
+    a->precisa_recuar = false;
+    a->recuo_recente = false;
+    regiao_a_notificar[a->id] = pedido->regiao_origem;
+    regiao_iniciar_aeronave(a);
+}
+
+/**
+ * Trata uma mensagem recebida de outra região
+ */
+static void regiao_processar_mensagem(const mensagem_regiao_t *m) {
+    if (m->aeronave < 0 || m->aeronave >= frota_regiao.tamanho) return;
+    aeronave_t *a = frota_regiao.ponteiros[m->aeronave];
+    if (a == NULL) return;
+
+    switch (m->tipo) {
+    case MSG_PEDIDO:
+        // A thread anterior desta aeronave pode estar saindo (a concessão que
+        // a libera pode vir atrás deste pedido): quem chegar por último entre
+        // ela e a receptora inicia a aeronave, sem ninguém esperar
+        pedido_adiado[a->id] = *m;
+        atomic_store(&tem_pedido_adiado[a->id], true);
+        if (!atomic_load(&thread_ativa[a->id]) && atomic_exchange(&tem_pedido_adiado[a->id], false)) {
+            regiao_receber_aeronave(a, &pedido_adiado[a->id]);
+        }
+        break;
+
+    case MSG_ABANDONO:
+        log_evento("[R%d] Aeronave %3d abandonou o voo na R%d: libera o setor daqui\n",
+                   regiao_id, a->id, m->regiao_origem);
+        // fallthrough: a thread que espera aqui devolve o setor e sai
+    case MSG_CONCEDIDO:
+        atomic_store(&aguardando_remoto[a->id], -1);
+        sem_post(&a->sem_aeronave);
+        break;
+
+    case MSG_SONDA:
+        regiao_seguir_sonda(m);
+        break;
+    }
+}
+
+/**
+ * Consome os anéis de entrada de todas as outras regiões. Quem estava com
+ * envio parado por anel cheio é acordado quando a leitura abre espaço
+ * @return true se tratou alguma mensagem
+ */
+static bool regiao_receber_mensagens() {
+    mensagem_regiao_t m;
+    bool recebeu = false;
+    for (int origem = 0; origem < total_regioes_ativas; origem++) {
+        if (origem == regiao_id) continue;
+        for (int canal = 0; canal < CANAIS_ANEL; canal++) {
+            anel_spsc_t *anel = regiao_anel(origem, regiao_id, canal);
+            bool leu = false;
+            while (anel_spsc_receber(anel, &m)) {
+                regiao_processar_mensagem(&m);
+                leu = true;
+            }
+            if (leu) recebeu = true;
+            if (!leu || canal != CANAL_RECEPTOR) continue;
+            atomic_thread_fence(memory_order_seq_cst);
+            if (atomic_load(&memoria->sinais[origem].aguardando_espaco) &&
+                atomic_exchange(&memoria->sinais[origem].aguardando_espaco, false)) {
+                regiao_acordar_receptor(origem);
+            }
+        }
+    }
+    return recebeu;
+}
+
+/**
+ * Confere se a receptora tem trabalho (depois de anunciar que vai dormir)
+ */
+static bool regiao_receptor_ocupada() {
+    if (atomic_load(&regiao_encerrando)) return true;
+    if (envio_pendente == NULL) {
+        if (!fila_mpsc_vazia(&fila_saida)) return true;
+    } else if (!atomic_load(&memoria->sinais[regiao_id].aguardando_espaco)) {
+        return true; // O consumidor já avisou que abriu espaço
+    }
+    for (int origem = 0; origem < total_regioes_ativas; origem++) {
+        if (origem == regiao_id) continue;
+        for (int canal = 0; canal < CANAIS_ANEL; canal++) {
+            if (!anel_spsc_vazio(regiao_anel(origem, regiao_id, canal))) return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Thread receptora: repassa a fila de saída local aos anéis e consome os
+ * anéis de entrada; sem nada a fazer dorme no semáforo da região até um
+ * produtor (local ou de outra região) acordá-la
+ */
+static void *regiao_receptor_executa(void *arg) {
+    (void)arg;
+    sinais_regiao_t *sinais = &memoria->sinais[regiao_id];
+
+    while (!atomic_load(&regiao_encerrando)) {
+        bool trabalhou = regiao_drenar_saida();
+        if (regiao_receber_mensagens()) trabalhou = true;
+        if (trabalhou) continue;
+
+        atomic_store(&sinais->receptor_dormindo, true);
+        if (!regiao_receptor_ocupada()) {
+            while (sem_wait(&sinais->sem_receptor) != 0 && errno == EINTR);
+        }
+        atomic_store(&sinais->receptor_dormindo, false);
+    }
+    return NULL;
+}
+
+/**
+ * Thread detectora: periodicamente manda sondas pelas aeronaves que esperam
+ * há muito tempo por setores de outras regiões
+ */
+static void *regiao_detector_executa(void *arg) {
+    (void)arg;
+    long long limiar_ns = (long long)LIMIAR_SONDA_MS * 1000000LL / escala_tempo;
+
+    while (!atomic_load(&regiao_encerrando)) {
+        dormir_ms(PERIODO_SONDA_MS);
+        long long agora = relogio_agora_ns();
+
+        for (int id = 0; id < frota_regiao.tamanho; id++) {
+            int remoto = atomic_load(&aguardando_remoto[id]);
+            if (remoto < 0) continue;
+            if (agora - atomic_load(&inicio_espera_remota[id]) < limiar_ns) continue;
+
+            mensagem_regiao_t sonda = {
+                .tipo = MSG_SONDA,
+                .regiao_origem = regiao_id,
+                .aeronave = id,
+                .iniciador = id,
+                .setor = remoto,
+            };
+            regiao_enviar_sonda(CANAL_DETECTOR, regiao_do_setor(remoto), &sonda);
+            atomic_fetch_add(&contagem_sondas, 1);
+            atomic_store(&inicio_espera_remota[id], agora); // Próxima sonda só após outro limiar
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Preenche o resultado desta região com as estatísticas locais
+ */
+static void regiao_coletar_resultado(regiao_resultado_t *r) {
+    atc_estatisticas_t estatisticas;
+    atc_obter_estatisticas(&estatisticas);
+    r->transferencias = estatisticas.transferencias;
+    r->deadlocks = estatisticas.deadlocks_detectados;
+    r->recuos = estatisticas.recuos_forcados;
+    r->pedidos_remotos = atomic_load(&contagem_pedidos);
+    r->sondas_enviadas = atomic_load(&contagem_sondas);
+    r->ciclos_inter_regioes = atomic_load(&contagem_ciclos);
+    r->fim_ns = relogio_agora_ns();
+
+    long amostras = 0;
+    long long soma_ns = 0, max_ns = 0;
+    for (int i = 0; i < frota_regiao.tamanho; i++) {
+        aeronave_t *a = frota_regiao.ponteiros[i];
+        if (a == NULL) continue;
+        amostras += a->espera.amostras;
+        soma_ns += a->espera.soma_ns;
+        if (a->espera.max_ns > max_ns) max_ns = a->espera.max_ns;
+    }
+    r->amostras_espera = (int)amostras;
+    r->soma_espera = soma_ns / 1e6;
+    espera_estatisticas_t esperas;
+    espera_obter_estatisticas(&esperas);
+    r->espera_p99 = esperas.concessao_p99;
+    r->espera_max = max_ns / 1e6;
+}
+
+/**
+ * Avisa o processo pai que esta região terminou a preparação e espera a
+ * largada. Uma região que falhou também avisa, senão o pai esperaria para
+ * sempre; nesse caso todas abortam
+ * @param pronta: false se a preparação falhou
+ * @return true se a largada foi dada, false se alguma região falhou
+ */
+static bool regiao_aguardar_largada(bool pronta) {
+    if (!pronta) {
+        atomic_fetch_add(&memoria->regioes_com_falha, 1);
+    }
+    sem_post(&memoria->sem_prontas);
+    while (sem_wait(&memoria->sem_largada) != 0 && errno == EINTR);
+    return atomic_load(&memoria->largada) > 0;
+}
+
+/**
+ * Libera o estado local da região (controlador, frota e vetores por aeronave)
+ */
+static void regiao_liberar_estado() {
+    atc_finalizar();
+    aeronaves = NULL;
+    frota_destruir(&frota_regiao);
+    free(aguardando_remoto);
+    free(inicio_espera_remota);
+    free(regiao_a_notificar);
+    free(thread_ativa);
+    free(pedido_adiado);
+    free(tem_pedido_adiado);
+    free(envios);
+    aguardando_remoto = NULL;
+    inicio_espera_remota = NULL;
+    regiao_a_notificar = NULL;
+    thread_ativa = NULL;
+    pedido_adiado = NULL;
+    tem_pedido_adiado = NULL;
+    envios = NULL;
+}
+
+/**
+ * Para a receptora e a detectora da região
+ */
+static void regiao_parar_threads(pthread_t *receptor, pthread_t *detector) {
+    atomic_store(&regiao_encerrando, true);
+    regiao_acordar_receptor(regiao_id);
+    if (receptor != NULL) pthread_join(*receptor, NULL);
+    if (detector != NULL) pthread_join(*detector, NULL);
+}
+
+/**
+ * Espera a frota inteira terminar (nenhuma aeronave pendente em região
+ * alguma e nenhuma thread desta ainda saindo): a thread principal dorme no
+ * semáforo da região e é acordada a cada conclusão
+ * @param n: Tamanho da frota
+ */
+static void regiao_aguardar_frota(int n) {
+    sinais_regiao_t *sinais = &memoria->sinais[regiao_id];
+    while (true) {
+        atomic_store(&sinais->principal_dormindo, true);
+        if (atomic_load(&memoria->aeronaves_concluidas) >= n && atomic_load(&threads_ativas) == 0) break;
+        while (sem_wait(&sinais->sem_principal) != 0 && errno == EINTR);
+    }
+    atomic_store(&sinais->principal_dormindo, false);
+}
+
+/**
+ * Corpo do processo de uma região: controlador local para a fatia de setores,
+ * cópia determinística da frota, receptora de mensagens e detector de ciclos
+ * @return 0 em caso de sucesso
+ */
+static int regiao_processo(const simulacao_config_t *config, int regiao) {
+    regiao_id = regiao;
+    setor_base = regiao_setor_inicial(regiao);
+    int setores_locais = regiao_setor_inicial(regiao + 1) - setor_base;
+    int n = config->num_aeronaves;
+    regiao_resultado_t *resultado = &memoria->resultados[regiao];
+    resultado->setor_inicial = setor_base;
+    resultado->setor_final = setor_base + setores_locais;
+
+    srand(config->semente);
+    atc_definir_politica(config->politica);
+    atc_init(setores_locais, n);
+
+    // Todas as regiões criam a mesma frota a partir da semente: rotas e sementes
+    // coincidem, então pedidos entre regiões só precisam levar o estado dinâmico
+    if (frota_criar(&frota_regiao, n, setores_globais) != 0) {
+        atc_finalizar();
+        regiao_aguardar_largada(false);
+        return -1;
+    }
+    aeronaves = frota_regiao.ponteiros;
+
+    aguardando_remoto = malloc(sizeof(*aguardando_remoto) * n);
+    inicio_espera_remota = malloc(sizeof(*inicio_espera_remota) * n);
+    regiao_a_notificar = malloc(sizeof(int) * n);
+    thread_ativa = malloc(sizeof(*thread_ativa) * n);
+    pedido_adiado = malloc(sizeof(*pedido_adiado) * n);
+    tem_pedido_adiado = malloc(sizeof(*tem_pedido_adiado) * n);
+    envios = calloc((size_t)n * ENVIOS_POR_AERONAVE, sizeof(envio_local_t));
+    if (!aguardando_remoto || !inicio_espera_remota || !regiao_a_notificar || !thread_ativa ||
+        !pedido_adiado || !tem_pedido_adiado || !envios) {
+        perror("Erro ao alocar o estado da região");
+        regiao_liberar_estado();
+        regiao_aguardar_largada(false);
+        return -1;
+    }
+    for (int i = 0; i < n; i++) {
+        atomic_init(&aguardando_remoto[i], -1);
+        atomic_init(&inicio_espera_remota[i], 0);
+        atomic_init(&thread_ativa[i], false);
+        atomic_init(&tem_pedido_adiado[i], false);
+        regiao_a_notificar[i] = -1;
+    }
+    for (int i = 0; i < n * ENVIOS_POR_AERONAVE; i++) {
+        atomic_init(&envios[i].em_uso, false);
+    }
+    fila_mpsc_inicializar(&fila_saida);
+    envio_pendente = NULL;
+
+    pthread_attr_init(&atributos_aeronave);
+    pthread_attr_setdetachstate(&atributos_aeronave, PTHREAD_CREATE_DETACHED);
+    if (config->tamanho_pilha > 0) {
+        pthread_attr_setstacksize(&atributos_aeronave, config->tamanho_pilha);
+    }
+
+    pthread_t receptor, detector;
+    int erro = pthread_create(&receptor, NULL, regiao_receptor_executa, NULL);
+    bool com_receptor = erro == 0;
+    if (com_receptor) erro = pthread_create(&detector, NULL, regiao_detector_executa, NULL);
+    bool com_detector = com_receptor && erro == 0;
+    if (!com_detector) {
+        errno = erro; // pthread_create devolve o erro em vez de usar errno
+        perror(com_receptor ? "Erro ao criar a thread detectora" : "Erro ao criar a thread receptora");
+    }
+
+    // Largada conjunta de todas as regiões
+    if (!regiao_aguardar_largada(com_detector)) {
+        regiao_parar_threads(com_receptor ? &receptor : NULL, com_detector ? &detector : NULL);
+        pthread_attr_destroy(&atributos_aeronave);
+        regiao_liberar_estado();
+        return -1;
+    }
+    atc_liberar_largada();
+
+    for (int i = 0; i < n; i++) {
+        aeronave_t *a = frota_regiao.ponteiros[i];
+        if (a != NULL && regiao_do_setor(aeronave_trecho(a, 0)) == regiao) {
+            regiao_iniciar_aeronave(a);
+        }
+    }
+
+    // A região só termina quando a frota inteira terminou: até lá pode receber pedidos
+    regiao_aguardar_frota(n);
+    regiao_parar_threads(&receptor, &detector);
+
+    regiao_coletar_resultado(resultado);
+
+    pthread_attr_destroy(&atributos_aeronave);
+    regiao_liberar_estado();
+    return resultado->status;
+}
+
+/**
+ * Destrói os semáforos das primeiras regiões e os da largada
+ * @param total_regioes: Regiões com semáforos criados
+ */
+static void regioes_destruir_sinais(int total_regioes) {
+    for (int r = 0; r < total_regioes; r++) {
+        sem_destroy(&memoria->sinais[r].sem_receptor);
+        sem_destroy(&memoria->sinais[r].sem_principal);
+    }
+    sem_destroy(&memoria->sem_prontas);
+    sem_destroy(&memoria->sem_largada);
+}
+
+/**
+ * Cria os semáforos entre processos da memória compartilhada (antes dos fork)
+ * @param total_regioes: Número de regiões
+ * @return true se todos foram criados
+ */
+static bool regioes_iniciar_sinais(int total_regioes) {
+    int criados = 0;
+    bool ok = sem_init(&memoria->sem_prontas, 1, 0) == 0;
+    if (ok && sem_init(&memoria->sem_largada, 1, 0) != 0) {
+        sem_destroy(&memoria->sem_prontas);
+        ok = false;
+    }
+    for (; ok && criados < total_regioes; criados++) {
+        sinais_regiao_t *sinais = &memoria->sinais[criados];
+        if (sem_init(&sinais->sem_receptor, 1, 0) != 0) break;
+        if (sem_init(&sinais->sem_principal, 1, 0) != 0) {
+            sem_destroy(&sinais->sem_receptor);
+            break;
+        }
+    }
+    if (ok && criados == total_regioes) return true;
+
+    perror("Erro ao criar os semáforos das regiões");
+    if (ok) {
+        regioes_destruir_sinais(criados);
+    }
+    return false;
+}
+
+/**
+ * Executa a simulação dividida em regiões, uma por processo. Os processos
+ * conversam por anéis SPSC numa área de memória compartilhada POSIX
+ * @param config: Parâmetros da execução (os setores são divididos entre as regiões)
+ * @param total_regioes: Número de regiões/processos (1 a REGIOES_MAX)
+ * @param resultado: Recebe o resultado agregado e o de cada região
+ * @return 0 em caso de sucesso, -1 em caso de falha
+ */
+int regioes_executar(const simulacao_config_t *config, int total_regioes, regioes_resultado_t *resultado) {
+    if (total_regioes < 1 || total_regioes > REGIOES_MAX || total_regioes > config->num_setores) {
+        fprintf(stderr, "Erro: número de regiões deve estar entre 1 e %d (e não passar dos setores)\n",
+                REGIOES_MAX);
+        return -1;
+    }
+    total_regioes_ativas = total_regioes;
+    setores_globais = config->num_setores;
+
+    // Cada anel comporta todos os pedidos e concessões que podem estar pendentes
+    unsigned long capacidade = 1024;
+    while (capacidade < 2UL * config->num_aeronaves + 64 && capacidade < (1UL << 16)) {
+        capacidade <<= 1;
+    }
+    size_t tamanho_cabecalho = (sizeof(memoria_regioes_t) + LINHA_CACHE - 1) & ~(size_t)(LINHA_CACHE - 1);
+    size_t tamanho_anel = anel_spsc_tamanho(capacidade, sizeof(mensagem_regiao_t));
+    size_t tamanho_total = tamanho_cabecalho + (size_t)total_regioes * total_regioes * CANAIS_ANEL * tamanho_anel;
+
+    char nome[64];
+    snprintf(nome, sizeof(nome), "/atc_regioes_%d", (int)getpid());
+    int fd = shm_open(nome, O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        perror("shm_open");
+        return -1;
+    }
+    if (ftruncate(fd, (off_t)tamanho_total) != 0) {
+        perror("ftruncate");
+        close(fd);
+        shm_unlink(nome);
+        return -1;
+    }
+    memoria = mmap(NULL, tamanho_total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    shm_unlink(nome); // O mapeamento continua válido e é herdado pelos filhos
+    if (memoria == MAP_FAILED) {
+        perror("mmap");
+        return -1;
+    }
+
+    memset(memoria, 0, tamanho_cabecalho);
+    memoria->total_regioes = total_regioes;
+    memoria->tamanho_anel = tamanho_anel;
+    memoria->deslocamento_aneis = tamanho_cabecalho;
+    for (int i = 0; i < total_regioes; i++) {
+        for (int j = 0; j < total_regioes; j++) {
+            for (int canal = 0; canal < CANAIS_ANEL; canal++) {
+                anel_spsc_inicializar(regiao_anel(i, j, canal), capacidade, sizeof(mensagem_regiao_t));
+            }
+        }
+    }
+    if (!regioes_iniciar_sinais(total_regioes)) {
+        munmap(memoria, tamanho_total);
+        memoria = NULL;
+        return -1;
+    }
+
+    fflush(stdout);
+    pid_t filhos[REGIOES_MAX];
+    int criados = 0;
+    for (int r = 0; r < total_regioes; r++) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            signal(SIGINT, SIG_DFL);
+            signal(SIGTERM, SIG_DFL);
+            int status = regiao_processo(config, r);
+            fflush(stdout);
+            _exit(status == 0 ? 0 : 1);
+        }
+        if (pid < 0) {
+            perror("fork");
+            break;
+        }
+        filhos[criados++] = pid;
+    }
+
+    int status = 0;
+    if (criados < total_regioes) {
+        for (int i = 0; i < criados; i++) kill(filhos[i], SIGTERM);
+        status = -1;
+    } else {
+        for (int r = 0; r < total_regioes; r++) {
+            while (sem_wait(&memoria->sem_prontas) != 0 && errno == EINTR);
+        }
+        if (atomic_load(&memoria->regioes_com_falha) > 0) {
+            fprintf(stderr, "Erro: %d região(ões) falharam na preparação\n", atomic_load(&memoria->regioes_com_falha));
+            atomic_store(&memoria->largada, -1);
+            status = -1;
+        } else {
+            memoria->inicio_ns = relogio_agora_ns();
+            atomic_store(&memoria->largada, 1);
+        }
+        for (int r = 0; r < total_regioes; r++) {
+            sem_post(&memoria->sem_largada);
+        }
+    }
+
+    for (int i = 0; i < criados; i++) {
+        int status_filho = 0;
+        while (waitpid(filhos[i], &status_filho, 0) < 0 && errno == EINTR);
+        if (!WIFEXITED(status_filho) || WEXITSTATUS(status_filho) != 0) status = -1;
+    }
+
+    if (resultado != NULL && status == 0) {
+        memset(resultado, 0, sizeof(*resultado));
+        resultado->total_regioes = total_regioes;
+        long long fim_ns = memoria->inicio_ns;
+        int amostras = 0;
+        double soma = 0.0;
+        for (int r = 0; r < total_regioes; r++) {
+            regiao_resultado_t *rr = &memoria->resultados[r];
+            resultado->regioes[r] = *rr;
+            resultado->transferencias += rr->transferencias;
+            amostras += rr->amostras_espera;
+            soma += rr->soma_espera;
+            if (rr->espera_p99 > resultado->espera_p99) resultado->espera_p99 = rr->espera_p99;
+            if (rr->espera_max > resultado->espera_max) resultado->espera_max = rr->espera_max;
+            if (rr->fim_ns > fim_ns) fim_ns = rr->fim_ns;
+        }
+        resultado->tempo_total = (fim_ns - memoria->inicio_ns) / 1e9;
+        resultado->vazao = resultado->tempo_total > 0 ? resultado->transferencias / resultado->tempo_total : 0.0;
+        resultado->espera_media = amostras > 0 ? soma / amostras : 0.0;
+    }
+
+    regioes_destruir_sinais(total_regioes);
+    munmap(memoria, tamanho_total);
+    memoria = NULL;
+    return status;
+}
@@ -0,0 +1,186 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include "../include/relogio.h"
+
+#define CALIBRACAO_MS 20
+
+static fonte_relogio_t fonte = RELOGIO_MONOTONICO_RAW;
+
+// Conversão do TSC: ns = ns_base + (ciclos - ciclos_base) * ns_por_ciclo
+// A base é uma leitura do relógio RAW, então as duas fontes têm a mesma origem
+static double ns_por_ciclo = 0.0;
+static unsigned long long ciclos_base = 0;
+static long long ns_base = 0;
+
+// Relógio de parede derivado do monotônico: parede = monotônico + deslocamento
+static long long deslocamento_parede_ns = 0;
+
+// Cache por thread do "[HH:MM:SS." do segundo atual: localtime_r só roda uma vez por segundo
+static _Thread_local long long segundo_cache = -1;
+static _Thread_local char prefixo_cache[12];
+
+/**
+ * Lê o contador de ciclos do processador (0 onde não houver)
+ */
+static inline unsigned long long ler_tsc() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/**
+ * Lê o relógio monotônico bruto do kernel (sem correção de frequência do NTP)
+ * @return Instante atual em nanossegundos (origem arbitrária)
+ */
+long long relogio_monotonico_raw_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/**
+ * O TSC só serve se for invariante (constant_tsc e nonstop_tsc) e se o próprio
+ * kernel o usa como fonte de tempo, sinal de que está sincronizado entre os núcleos
+ * @return true se o TSC pode ser usado como relógio
+ */
+static bool tsc_confiavel() {
+#if defined(__x86_64__) || defined(__i386__)
+    char linha[4096];
+    bool fonte_tsc = false, constante = false, sem_parada = false;
+
+    FILE *arquivo = fopen("/sys/devices/system/clocksource/clocksource0/current_clocksource", "r");
+    if (arquivo != NULL) {
+        fonte_tsc = fgets(linha, sizeof(linha), arquivo) != NULL && strncmp(linha, "tsc", 3) == 0;
+        fclose(arquivo);
+    }
+    if (!fonte_tsc) return false;
+
+    arquivo = fopen("/proc/cpuinfo", "r");
+    if (arquivo == NULL) return false;
+    while (fgets(linha, sizeof(linha), arquivo) != NULL) {
+        if (strncmp(linha, "flags", 5) == 0) {
+            constante = strstr(linha, " constant_tsc") != NULL;
+            sem_parada = strstr(linha, " nonstop_tsc") != NULL;
+            break;
+        }
+    }
+    fclose(arquivo);
+    return constante && sem_parada;
+#else
+    return false;
+#endif
+}
+
+/**
+ * Escolhe a fonte do relógio (TSC calibrado se confiável, senão CLOCK_MONOTONIC_RAW)
+ * e fixa o deslocamento do relógio de parede. Deve ser chamada no início do main,
+ * antes de criar threads ou processos
+ */
+void relogio_inicializar() {
+    tzset();
+    fonte = RELOGIO_MONOTONICO_RAW;
+
+    if (tsc_confiavel()) {
+        long long ns_inicio = relogio_monotonico_raw_ns();
+        unsigned long long ciclos_inicio = ler_tsc();
+        struct timespec pausa = { .tv_sec = 0, .tv_nsec = CALIBRACAO_MS * 1000000L };
+        nanosleep(&pausa, NULL);
+        long long ns_fim = relogio_monotonico_raw_ns();
+        unsigned long long ciclos_fim = ler_tsc();
+
+        if (ciclos_fim > ciclos_inicio && ns_fim > ns_inicio) {
+            ns_por_ciclo = (double)(ns_fim - ns_inicio) / (double)(ciclos_fim - ciclos_inicio);
+            ciclos_base = ciclos_fim;
+            ns_base = ns_fim;
+            fonte = RELOGIO_TSC;
+        }
+    }
+
+    struct timespec parede;
+    clock_gettime(CLOCK_REALTIME, &parede);
+    deslocamento_parede_ns = (long long)parede.tv_sec * 1000000000LL + parede.tv_nsec - relogio_agora_ns();
+}
+
+/**
+ * @return Nome da fonte em uso
+ */
+const char *relogio_nome_fonte() {
+    return fonte == RELOGIO_TSC ? "tsc" : "monotonic_raw";
+}
+
+/**
+ * Lê o relógio monotônico da simulação (todas as medições de tempo passam por aqui)
+ * @return Instante atual em nanossegundos (origem arbitrária, comum a todos os processos filhos)
+ */
+long long relogio_agora_ns() {
+    if (fonte == RELOGIO_TSC) {
+        return ns_base + (long long)((double)(long long)(ler_tsc() - ciclos_base) * ns_por_ciclo);
+    }
+    return relogio_monotonico_raw_ns();
+}
+
+/**
+ * @param inicio_ns: Instante lido com relogio_agora_ns
+ * @return Segundos decorridos desde o instante
+ */
+double relogio_segundos_desde(long long inicio_ns) {
+    return (relogio_agora_ns() - inicio_ns) / 1e9;
+}
+
+/**
+ * Lê o relógio dos prazos de espera (RELOGIO_ESPERA). É outra escala que a
+ * de relogio_agora_ns: só serve para montar prazos de sem_clockwait e
+ * pthread_cond_timedwait
+ * @return Instante atual em nanossegundos
+ */
+long long relogio_espera_ns() {
+    struct timespec ts;
+    clock_gettime(RELOGIO_ESPERA, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/**
+ * Converte um instante de relogio_espera_ns no prazo absoluto das esperas
+ * @param instante_ns: Instante em nanossegundos na escala de relogio_espera_ns
+ * @param prazo: Recebe o prazo para sem_clockwait(RELOGIO_ESPERA) ou pthread_cond_timedwait
+ */
+void relogio_prazo_espera(long long instante_ns, struct timespec *prazo) {
+    prazo->tv_sec = instante_ns / 1000000000LL;
+    prazo->tv_nsec = instante_ns % 1000000000LL;
+}
+
+/**
+ * Escreve o timestamp de parede "[HH:MM:SS.uuuuuu] " sem chamar localtime a cada linha
+ * @param destino: Buffer de saída (RELOGIO_TAMANHO_TIMESTAMP bytes bastam)
+ * @param tamanho: Tamanho do buffer
+ */
+void relogio_formatar_timestamp(char *destino, size_t tamanho) {
+    if (tamanho < RELOGIO_TAMANHO_TIMESTAMP) {
+        if (tamanho > 0) destino[0] = '\0';
+        return;
+    }
+
+    long long parede = relogio_agora_ns() + deslocamento_parede_ns;
+    long long segundo = parede / 1000000000LL;
+    long micros = (long)(parede % 1000000000LL) / 1000;
+
+    if (segundo != segundo_cache) {
+        time_t t = (time_t)segundo;
+        struct tm tm_info;
+        localtime_r(&t, &tm_info);
+        snprintf(prefixo_cache, sizeof(prefixo_cache), "[%02d:%02d:%02d.",
+                 tm_info.tm_hour, tm_info.tm_min, tm_info.tm_sec);
+        segundo_cache = segundo;
+    }
+
+    memcpy(destino, prefixo_cache, 10);
+    for (int i = 15; i >= 10; i--) {
+        destino[i] = (char)('0' + micros % 10);
+        micros /= 10;
+    }
+    memcpy(destino + 16, "] ", 3);
+}
@@ -0,0 +1,386 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <semaphore.h>
+#include "../include/reserva.h"
+#include "../include/relogio.h"
+#include "../include/utils.h"
+
+#define CAPACIDADE_INICIAL_JANELAS 1024
+// Adiamentos por busca antes de desistir dela: num calendário lotado a primeira
+// partida viável pode estar a milhares de folgas de distância
+#define CONFLITOS_RESERVA_MAX 16
+// Pontos de partida das buscas seguintes, entre minimo_ms e o fim do calendário mais curto da rota
+#define RECOMECOS_RESERVA 4
+
+// Janela de ocupação [inicio, fim) de um setor, em ms simulados desde a origem.
+// Cada setor é uma treap (árvore de busca por inicio, heap por peso) sobre um
+// pool único de nós; como as janelas de um setor não se sobrepõem, ordenar por
+// início também ordena por fim. Cada nó agrega a sua subárvore (primeiro início,
+// último fim e maior folga entre janelas vizinhas), o que deixa a busca pela
+// primeira folga de um dado tamanho pular trechos lotados do calendário
+typedef struct {
+    long long inicio;
+    long long fim;
+    long long menor_inicio; // Subárvore: início da primeira janela
+    long long maior_fim;    // Subárvore: fim da última janela
+    long long maior_folga;  // Subárvore: maior intervalo livre entre duas janelas
+    int esquerda;
+    int direita;
+    unsigned int peso;
+} janela_t;
+
+static struct {
+    bool ativo;
+    int total_setores;
+    int *raiz;          // Por setor: nó raiz da treap (-1 = calendário vazio)
+    janela_t *janelas;  // Pool de nós de todos os setores
+    int total_janelas;
+    int capacidade_janelas;
+    unsigned int semente_pesos;
+    long long origem_ns;
+    reserva_estatisticas_t estatisticas;
+} calendario;
+
+static sem_t mutex_reservas;
+
+/**
+ * Cria um calendário vazio por setor e ativa o modo de reservas
+ * @param setores: Número de setores
+ * @return true em caso de sucesso, false se a alocação falhar
+ */
+bool reserva_inicializar(int setores) {
+    memset(&calendario, 0, sizeof(calendario));
+    calendario.raiz = malloc(sizeof(int) * setores);
+    calendario.janelas = malloc(sizeof(janela_t) * CAPACIDADE_INICIAL_JANELAS);
+    if (calendario.raiz == NULL || calendario.janelas == NULL) {
+        perror("malloc calendário de reservas");
+        free(calendario.raiz);
+        free(calendario.janelas);
+        memset(&calendario, 0, sizeof(calendario));
+        return false;
+    }
+    for (int s = 0; s < setores; s++) {
+        calendario.raiz[s] = -1;
+    }
+    calendario.total_setores = setores;
+    calendario.capacidade_janelas = CAPACIDADE_INICIAL_JANELAS;
+    calendario.semente_pesos = 2463534242u;
+    calendario.origem_ns = relogio_agora_ns();
+    sem_init(&mutex_reservas, 0, 1);
+    calendario.ativo = true;
+    return true;
+}
+
+/**
+ * Libera os calendários e desativa o modo de reservas (nenhuma aeronave ativa)
+ */
+void reserva_finalizar() {
+    if (!calendario.ativo) return;
+    sem_destroy(&mutex_reservas);
+    free(calendario.raiz);
+    free(calendario.janelas);
+    memset(&calendario, 0, sizeof(calendario));
+}
+
+/**
+ * @return true se as aeronaves devem reservar a rota antes de decolar
+ */
+bool reserva_ativa() {
+    return calendario.ativo;
+}
+
+/**
+ * Define o instante zero dos calendários (a largada da frota)
+ * @param origem_ns: Instante em relogio_agora_ns
+ */
+void reserva_definir_origem(long long origem_ns) {
+    calendario.origem_ns = origem_ns;
+}
+
+/**
+ * @return ms simulados desde a origem (o relógio real multiplicado pela escala)
+ */
+long long reserva_agora_ms() {
+    long long decorrido_ns = relogio_agora_ns() - calendario.origem_ns;
+    return decorrido_ns * (escala_tempo > 0 ? escala_tempo : 1) / 1000000LL;
+}
+
+/**
+ * Dorme até um instante dos calendários. Os prazos são absolutos, então o
+ * atraso de acordar de um trecho não se acumula nos seguintes
+ * @param instante_ms: ms simulados desde a origem
+ */
+void reserva_dormir_ate(long long instante_ms) {
+    long long alvo_ns = calendario.origem_ns +
+                        instante_ms * 1000000LL / (escala_tempo > 0 ? escala_tempo : 1);
+    long long restante_ns = alvo_ns - relogio_agora_ns();
+    if (restante_ns <= 0) return;
+    struct timespec ts = {
+        .tv_sec = restante_ns / 1000000000LL,
+        .tv_nsec = restante_ns % 1000000000LL
+    };
+    nanosleep(&ts, NULL);
+}
+
+/**
+ * Recalcula os agregados de um nó a partir dos filhos
+ * @param no: Índice do nó
+ */
+static void calendario_atualizar(int no) {
+    janela_t *janelas = calendario.janelas;
+    janela_t *j = &janelas[no];
+    j->menor_inicio = j->inicio;
+    j->maior_fim = j->fim;
+    j->maior_folga = 0;
+    if (j->esquerda >= 0) {
+        janela_t *e = &janelas[j->esquerda];
+        j->menor_inicio = e->menor_inicio;
+        j->maior_folga = e->maior_folga;
+        if (j->inicio - e->maior_fim > j->maior_folga) j->maior_folga = j->inicio - e->maior_fim;
+    }
+    if (j->direita >= 0) {
+        janela_t *d = &janelas[j->direita];
+        j->maior_fim = d->maior_fim;
+        if (d->maior_folga > j->maior_folga) j->maior_folga = d->maior_folga;
+        if (d->menor_inicio - j->fim > j->maior_folga) j->maior_folga = d->menor_inicio - j->fim;
+    }
+}
+
+static int girar_direita(int no) {
+    int filho = calendario.janelas[no].esquerda;
+    calendario.janelas[no].esquerda = calendario.janelas[filho].direita;
+    calendario.janelas[filho].direita = no;
+    calendario_atualizar(no);
+    calendario_atualizar(filho);
+    return filho;
+}
+
+static int girar_esquerda(int no) {
+    int filho = calendario.janelas[no].direita;
+    calendario.janelas[no].direita = calendario.janelas[filho].esquerda;
+    calendario.janelas[filho].esquerda = no;
+    calendario_atualizar(no);
+    calendario_atualizar(filho);
+    return filho;
+}
+
+/**
+ * Insere um nó na treap de um setor (profundidade esperada O(log n))
+ * @param raiz: Raiz da subárvore
+ * @param no: Nó já preenchido
+ * @return Nova raiz da subárvore
+ */
+static int calendario_inserir(int raiz, int no) {
+    if (raiz < 0) {
+        calendario_atualizar(no);
+        return no;
+    }
+    janela_t *janelas = calendario.janelas;
+    if (janelas[no].inicio < janelas[raiz].inicio) {
+        janelas[raiz].esquerda = calendario_inserir(janelas[raiz].esquerda, no);
+        if (janelas[janelas[raiz].esquerda].peso > janelas[raiz].peso) return girar_direita(raiz);
+    } else {
+        janelas[raiz].direita = calendario_inserir(janelas[raiz].direita, no);
+        if (janelas[janelas[raiz].direita].peso > janelas[raiz].peso) return girar_esquerda(raiz);
+    }
+    calendario_atualizar(raiz);
+    return raiz;
+}
+
+/**
+ * Percorre a subárvore em ordem atrás da primeira folga de 'duracao' a partir
+ * de 'minimo', descartando subárvores que terminam antes de 'minimo' ou cujas
+ * folgas internas são todas menores que 'duracao'
+ * @param no: Raiz da subárvore
+ * @param minimo: Início mais cedo aceito
+ * @param duracao: Tamanho da folga procurada
+ * @param ultimo_fim: Fim da última janela antes da subárvore; sai com o fim da última visitada
+ * @return Início da folga encontrada ou -1 se ela não está dentro da subárvore
+ */
+static long long calendario_buscar_folga(int no, long long minimo, long long duracao, long long *ultimo_fim) {
+    if (no < 0) return -1;
+    const janela_t *j = &calendario.janelas[no];
+    if (j->maior_fim <= minimo || j->maior_folga < duracao) {
+        long long inicio = *ultimo_fim > minimo ? *ultimo_fim : minimo;
+        if (j->menor_inicio - inicio >= duracao) return inicio;
+        if (j->maior_fim > *ultimo_fim) *ultimo_fim = j->maior_fim;
+        return -1;
+    }
+
+    long long achado = calendario_buscar_folga(j->esquerda, minimo, duracao, ultimo_fim);
+    if (achado >= 0) return achado;
+    long long inicio = *ultimo_fim > minimo ? *ultimo_fim : minimo;
+    if (j->inicio - inicio >= duracao) return inicio;
+    if (j->fim > *ultimo_fim) *ultimo_fim = j->fim;
+    return calendario_buscar_folga(j->direita, minimo, duracao, ultimo_fim);
+}
+
+/**
+ * Primeiro instante a partir de 'minimo' em que o setor fica livre por 'duracao'
+ * @param setor: Índice do setor
+ * @param minimo: Início mais cedo aceito
+ * @param duracao: Tempo de ocupação pretendido
+ * @return Início da primeira folga que comporta a ocupação
+ */
+static long long calendario_primeira_folga(int setor, long long minimo, long long duracao) {
+    long long ultimo_fim = LLONG_MIN;
+    long long achado = calendario_buscar_folga(calendario.raiz[setor], minimo, duracao, &ultimo_fim);
+    if (achado >= 0) return achado;
+    return ultimo_fim > minimo ? ultimo_fim : minimo;
+}
+
+/**
+ * Garante espaço no pool para mais janelas
+ * @param adicionais: Janelas que serão inseridas
+ * @return true em caso de sucesso
+ */
+static bool calendario_reservar_espaco(int adicionais) {
+    if (calendario.total_janelas + adicionais <= calendario.capacidade_janelas) return true;
+    int capacidade = calendario.capacidade_janelas;
+    while (calendario.total_janelas + adicionais > capacidade) capacidade *= 2;
+    janela_t *janelas = realloc(calendario.janelas, sizeof(janela_t) * capacidade);
+    if (janelas == NULL) {
+        perror("realloc calendário de reservas");
+        return false;
+    }
+    calendario.janelas = janelas;
+    calendario.capacidade_janelas = capacidade;
+    return true;
+}
+
+static unsigned int sortear_peso() {
+    unsigned int x = calendario.semente_pesos;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    calendario.semente_pesos = x;
+    return x;
+}
+
+/**
+ * Busca a primeira partida a partir de 'minimo' em que cada trecho, voado em
+ * sequência sem espera, cabe livre no calendário do seu setor. A partida só
+ * anda para a frente: cada trecho que não cabe a adianta direto até uma folga
+ * onde ele cabe, e a busca recomeça do primeiro trecho
+ * @param setores: Setor de cada trecho
+ * @param duracoes_ms: Tempo de voo de cada trecho
+ * @param trechos: Número de trechos
+ * @param minimo: Partida mais cedo aceita
+ * @param limite: Adiamentos permitidos antes de desistir
+ * @param conflitos: Acumula os adiamentos feitos
+ * @return Partida encontrada ou -1 se o limite acabou antes
+ */
+static long long calendario_encaixar(const int *setores, const int *duracoes_ms, int trechos,
+                                     long long minimo, int limite, long *conflitos) {
+    long long partida = minimo;
+    long long deslocamento = 0;
+    for (int k = 0, adiamentos = 0; k < trechos; ) {
+        long long inicio = partida + deslocamento;
+        long long livre = calendario_primeira_folga(setores[k], inicio,
+                                                    duracoes_ms[k] + SEPARACAO_RESERVA_MS);
+        if (livre != inicio) {
+            if (++adiamentos > limite) return -1;
+            (*conflitos)++;
+            partida = livre - deslocamento;
+            deslocamento = 0;
+            k = 0;
+            continue;
+        }
+        deslocamento += duracoes_ms[k];
+        k++;
+    }
+    return partida;
+}
+
+/**
+ * Reserva a rota inteira na primeira partida viável a partir de minimo_ms e
+ * grava as janelas. Num calendário lotado a busca desde minimo_ms esgota o
+ * limite no trecho antigo, sem folgas; recomeça-se então de pontos cada vez
+ * mais adiante até o fim do calendário mais curto da rota, perto das folgas
+ * deixadas pelas reservas recentes, e em último caso depois do fim de todos
+ * eles, onde sempre cabe. A partida deixa de ser a primeira possível, mas cada
+ * reserva custa no máximo (1 + RECOMECOS_RESERVA) buscas limitadas
+ * @param setores: Setor de cada trecho (sem repetições consecutivas)
+ * @param duracoes_ms: Tempo de voo de cada trecho, em ms simulados
+ * @param trechos: Número de trechos
+ * @param minimo_ms: Partida mais cedo possível (ms simulados desde a origem)
+ * @return Partida reservada (o trecho k começa em partida + soma das durações anteriores) ou -1 em caso de falha
+ */
+long long reserva_agendar(const int *setores, const int *duracoes_ms, int trechos, long long minimo_ms) {
+    if (!calendario.ativo || trechos <= 0) return -1;
+    for (int k = 0; k < trechos; k++) {
+        if (setores[k] < 0 || setores[k] >= calendario.total_setores) return -1;
+    }
+
+    long long inicio_ns = relogio_agora_ns();
+    sem_wait(&mutex_reservas);
+
+    if (!calendario_reservar_espaco(trechos)) {
+        sem_post(&mutex_reservas);
+        return -1;
+    }
+
+    reserva_estatisticas_t *e = &calendario.estatisticas;
+    long long partida = calendario_encaixar(setores, duracoes_ms, trechos, minimo_ms,
+                                            CONFLITOS_RESERVA_MAX, &e->conflitos);
+    if (partida < 0) {
+        // Fim de cada calendário, descontado o voo até o trecho: o menor é onde
+        // a rota começa a encontrar setores livres, o maior é onde ela cabe inteira
+        long long menor_fim = LLONG_MAX, maior_fim = minimo_ms;
+        long long deslocamento = 0;
+        for (int k = 0; k < trechos; k++) {
+            int raiz = calendario.raiz[setores[k]];
+            long long fim = (raiz >= 0 ? calendario.janelas[raiz].maior_fim : 0) - deslocamento;
+            if (fim < menor_fim) menor_fim = fim;
+            if (fim > maior_fim) maior_fim = fim;
+            deslocamento += duracoes_ms[k];
+        }
+        for (int r = 1; r <= RECOMECOS_RESERVA && partida < 0 && menor_fim > minimo_ms; r++) {
+            long long inicio = minimo_ms + (menor_fim - minimo_ms) / RECOMECOS_RESERVA * r;
+            partida = calendario_encaixar(setores, duracoes_ms, trechos, inicio,
+                                          CONFLITOS_RESERVA_MAX, &e->conflitos);
+        }
+        if (partida < 0) {
+            partida = maior_fim;
+            e->reservas_no_fim++;
+        }
+    }
+
+    long long deslocamento = 0;
+    for (int k = 0; k < trechos; k++) {
+        int no = calendario.total_janelas++;
+        janela_t *janela = &calendario.janelas[no];
+        janela->inicio = partida + deslocamento;
+        janela->fim = janela->inicio + duracoes_ms[k] + SEPARACAO_RESERVA_MS;
+        janela->esquerda = janela->direita = -1;
+        janela->peso = sortear_peso();
+        calendario.raiz[setores[k]] = calendario_inserir(calendario.raiz[setores[k]], no);
+        deslocamento += duracoes_ms[k];
+    }
+
+    e->agendamentos++;
+    e->intervalos += trechos;
+    e->atraso_solo_ms += partida - minimo_ms;
+    if (partida - minimo_ms > e->atraso_solo_max_ms) e->atraso_solo_max_ms = partida - minimo_ms;
+    if (partida + deslocamento > e->makespan_ms) e->makespan_ms = partida + deslocamento;
+    e->tempo_agendamento_ns += relogio_agora_ns() - inicio_ns;
+
+    sem_post(&mutex_reservas);
+    return partida;
+}
+
+/**
+ * Copia as estatísticas acumuladas desde reserva_inicializar
+ * @param estatisticas: Estrutura a ser preenchida
+ */
+void reserva_obter_estatisticas(reserva_estatisticas_t *estatisticas) {
+    if (!calendario.ativo) {
+        memset(estatisticas, 0, sizeof(*estatisticas));
+        return;
+    }
+    sem_wait(&mutex_reservas);
+    *estatisticas = calendario.estatisticas;
+    sem_post(&mutex_reservas);
+}
@@ -0,0 +1,423 @@
+#define _GNU_SOURCE // sem_clockwait
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+#include <errno.h>
+#include <semaphore.h>
+#include <sys/resource.h>
+#include "../include/simulacao.h"
+#include "../include/controlador.h"
+#include "../include/aeronave.h"
+#include "../include/frota.h"
+#include "../include/utils.h"
+#include "../include/relogio.h"
+#include "../include/reserva.h"
+#include "../include/chegadas.h"
+#include "../include/checkpoint.h"
+#include "../include/medicao.h"
+#include "../include/temporizador.h"
+
+static frota_t frota; // Frota da execução em andamento
+
+// Observador periódico: lê cópias do estado (instantaneo) e nunca trava o controlador
+static pthread_t thread_monitor;
+static _Atomic bool monitor_ativo = false;
+
+// Checkpoints periódicos e o final, pedido pelo tratador de sinal (sem_post é
+// seguro dentro dele; o checkpoint em si roda nesta thread)
+typedef struct {
+    const char *caminho;
+    int intervalo_s;
+    checkpoint_cabecalho_t modelo;
+    long long largada_ns;
+    int gravados;
+    double soma_pausa_ms;
+    double pausa_max_ms;
+    double soma_escrita_ms;
+    long bytes;
+} checkpoints_t;
+
+static pthread_t thread_checkpoint;
+static sem_t sem_checkpoint;
+static _Atomic bool checkpoint_ativo = false;
+static _Atomic bool checkpoint_final = false; // Pedido por sinal: grava e encerra o processo
+static checkpoints_t checkpoints;
+
+/**
+ * Imprime a ocupação dos setores e as filas de espera a cada intervalo
+ * @param arg: Intervalo em ms (int convertido para ponteiro)
+ */
+static void *monitor_executar(void *arg) {
+    int intervalo_ms = (int)(long)arg;
+    struct timespec pausa = {
+        .tv_sec = intervalo_ms / 1000,
+        .tv_nsec = (long)(intervalo_ms % 1000) * 1000000L
+    };
+    while (atomic_load(&monitor_ativo)) {
+        nanosleep(&pausa, NULL);
+        if (!atomic_load(&monitor_ativo)) break;
+        imprimir_estado_setores();
+        imprimir_fila_espera();
+        imprimir_estimativas();
+        imprimir_contadores();
+    }
+    return NULL;
+}
+
+/**
+ * Grava um checkpoint e acumula as medidas
+ */
+static void checkpoint_executar_um() {
+    checkpoint_medidas_t medidas;
+    if (!checkpoint_gravar(checkpoints.caminho, &frota, &checkpoints.modelo, checkpoints.largada_ns, &medidas)) {
+        fprintf(stderr, "[CHECKPOINT] Falha ao gravar %s\n", checkpoints.caminho);
+        return;
+    }
+    checkpoints.gravados++;
+    checkpoints.soma_pausa_ms += medidas.pausa_ms;
+    checkpoints.soma_escrita_ms += medidas.escrita_ms;
+    if (medidas.pausa_ms > checkpoints.pausa_max_ms) checkpoints.pausa_max_ms = medidas.pausa_ms;
+    checkpoints.bytes = medidas.bytes;
+    if (!modo_silencioso) {
+        printf("[CHECKPOINT] %s: %ld bytes, frota segurada %.2f ms (%d varreduras), escrita %.2f ms\n",
+               checkpoints.caminho, medidas.bytes, medidas.pausa_ms, medidas.tentativas, medidas.escrita_ms);
+    }
+}
+
+/**
+ * Grava um checkpoint a cada intervalo; acordada antes do prazo, é o fim da
+ * execução ou um sinal. No sinal grava o checkpoint final e encerra o processo
+ */
+static void *checkpoint_thread_executar(void *arg) {
+    (void)arg;
+    while (atomic_load(&checkpoint_ativo)) {
+        int retorno;
+        if (checkpoints.intervalo_s > 0) {
+            struct timespec prazo;
+            relogio_prazo_espera(relogio_espera_ns() + checkpoints.intervalo_s * 1000000000LL, &prazo);
+            while ((retorno = sem_clockwait(&sem_checkpoint, RELOGIO_ESPERA, &prazo)) != 0 && errno == EINTR);
+        } else {
+            while ((retorno = sem_wait(&sem_checkpoint)) != 0 && errno == EINTR);
+        }
+
+        if (atomic_load(&checkpoint_final)) {
+            checkpoint_executar_um();
+            printf("[SISTEMA] Checkpoint final em %s - Finalizando...\n", checkpoints.caminho);
+            simulacao_abortar();
+            exit(0);
+        }
+        if (retorno != 0 && atomic_load(&checkpoint_ativo)) checkpoint_executar_um();
+    }
+    return NULL;
+}
+
+/**
+ * Pede o checkpoint final da execução em andamento e o encerramento do
+ * processo depois dele. Segura para o tratador de sinal
+ * @return false se não há checkpoints configurados (o chamador encerra do jeito normal)
+ */
+bool simulacao_pedir_checkpoint() {
+    if (!atomic_load(&checkpoint_ativo)) return false;
+    if (!atomic_exchange(&checkpoint_final, true)) sem_post(&sem_checkpoint); // Sinais repetidos: um só checkpoint
+    return true;
+}
+
+/**
+ * Junta os agregados de espera das aeronaves e preenche as métricas de espera
+ * (os percentis vêm do histograma de concessões, já copiado em resultado->espera)
+ * @param resultado: Estrutura de resultado a ser preenchida
+ */
+static void simulacao_coletar_esperas(simulacao_resultado_t *resultado) {
+    long amostras = 0;
+    long long soma_ns = 0, max_ns = 0;
+    for (int i = 0; i < total_aeronaves; i++) {
+        if (aeronaves[i] == NULL) continue;
+        const espera_agregada_t *e = &aeronaves[i]->espera;
+        amostras += e->amostras;
+        soma_ns += e->soma_ns;
+        if (e->max_ns > max_ns) max_ns = e->max_ns;
+    }
+    if (amostras == 0) return;
+
+    resultado->espera_media = soma_ns / 1e6 / amostras;
+    resultado->espera_p50 = resultado->espera.concessao_p50;
+    resultado->espera_p99 = resultado->espera.concessao_p99;
+    resultado->espera_max = max_ns / 1e6;
+}
+
+/**
+ * Executa uma simulação completa: inicializa o ATC, cria a frota a partir da
+ * semente, dispara as threads, aguarda todas concluírem e coleta as métricas
+ * No regime aberto a frota sai das chegadas sorteadas e cada aeronave só
+ * decola no seu instante; os percentis de espera cobrem só a janela de medição
+ * @param config: Parâmetros da execução
+ * @param resultado: Recebe as métricas da execução (pode ser NULL)
+ * @return 0 em caso de sucesso, -1 em caso de falha de alocação (ou nenhuma chegada)
+ */
+int simulacao_executar(const simulacao_config_t *config, simulacao_resultado_t *resultado) {
+    srand(config->semente);
+
+    // Regime aberto: a frota é exatamente quem chega durante a execução
+    int num_aeronaves = config->num_aeronaves;
+    if (config->chegadas != NULL) {
+        num_aeronaves = chegadas_preparar(config->chegadas, config->semente);
+        if (num_aeronaves <= 0) {
+            if (num_aeronaves == 0) {
+                fprintf(stderr, "Nenhuma chegada em %.1f s à taxa de %.3f aeronaves/s\n",
+                        config->chegadas->duracao, config->chegadas->taxa);
+            }
+            chegadas_finalizar();
+            return -1;
+        }
+    }
+
+    atc_definir_politica(config->politica);
+    atc_init(config->num_setores, num_aeronaves);
+    if (!medicao_inicializar(config->num_setores) || !temporizador_inicializar()) {
+        medicao_finalizar();
+        atc_finalizar();
+        chegadas_finalizar();
+        return -1;
+    }
+    if (config->reservas && !reserva_inicializar(config->num_setores)) {
+        medicao_finalizar();
+        temporizador_finalizar();
+        atc_finalizar();
+        chegadas_finalizar();
+        return -1;
+    }
+    if (config->verificar && !verificador_inicializar(config->num_setores, num_aeronaves)) {
+        reserva_finalizar();
+        medicao_finalizar();
+        temporizador_finalizar();
+        atc_finalizar();
+        chegadas_finalizar();
+        return -1;
+    }
+
+    long rss_antes = memoria_rss_kb();
+    long long inicio_ns = relogio_agora_ns();
+
+    if (!modo_silencioso) printf("[MAIN] Criando %d aeronaves...\n", num_aeronaves);
+    if (frota_criar(&frota, num_aeronaves, config->num_setores) != 0) {
+        fprintf(stderr, "Erro ao criar a frota de %d aeronaves\n", num_aeronaves);
+        verificador_finalizar();
+        reserva_finalizar();
+        medicao_finalizar();
+        temporizador_finalizar();
+        atc_finalizar();
+        chegadas_finalizar();
+        return -1;
+    }
+    aeronaves = frota.ponteiros;
+
+    // Retomada: a frota recriada pela semente recebe o estado gravado antes de decolar
+    checkpoint_cabecalho_t restaurado = {0};
+    if (config->restaurar != NULL) {
+        if (!checkpoint_restaurar(config->restaurar, &frota, &restaurado)) {
+            verificador_finalizar();
+            reserva_finalizar();
+            medicao_finalizar();
+            temporizador_finalizar();
+            atc_finalizar();
+            chegadas_finalizar();
+            aeronaves = NULL;
+            frota_destruir(&frota);
+            return -1;
+        }
+        if (!modo_silencioso) {
+            printf("[MAIN] Retomando %s em %.1f s simulados\n", config->restaurar,
+                   restaurado.instante_simulado_ns / 1e9);
+        }
+    }
+    
+    if (!modo_silencioso) printf("[MAIN] Iniciando voos...\n");
+    struct rusage uso_antes, uso_depois;
+    getrusage(RUSAGE_SELF, &uso_antes);
+    int iniciadas = frota_iniciar_threads(&frota, config->tamanho_pilha);
+
+    long long largada_ns = relogio_agora_ns();
+    long rss_depois = memoria_rss_kb();
+    reserva_definir_origem(largada_ns);
+    if (config->chegadas != NULL) {
+        // Só conta o regime: sem o aquecimento e sem a drenagem depois das chegadas
+        int escala = escala_tempo > 0 ? escala_tempo : 1;
+        chegadas_definir_origem(largada_ns);
+        espera_definir_janela(largada_ns + (long long)(config->chegadas->aquecimento * 1e9) / escala,
+                              largada_ns + (long long)(config->chegadas->duracao * 1e9) / escala);
+    }
+    atc_liberar_largada();
+
+    bool checkpoint_iniciado = false;
+    if (config->checkpoint != NULL) {
+        memset(&checkpoints, 0, sizeof(checkpoints));
+        checkpoints.caminho = config->checkpoint;
+        checkpoints.intervalo_s = config->intervalo_checkpoint_s;
+        checkpoints.largada_ns = largada_ns;
+        checkpoint_cabecalho_t *m = &checkpoints.modelo;
+        memcpy(m->magica, CHECKPOINT_MAGICA, sizeof(m->magica));
+        m->versao = CHECKPOINT_VERSAO;
+        m->setores = config->num_setores;
+        m->aeronaves = num_aeronaves;
+        m->semente = config->semente;
+        m->escala = escala_tempo;
+        snprintf(m->politica, sizeof(m->politica), "%s", config->politica->nome);
+        m->fracao_emergencias = atc_fracao_emergencias();
+        m->instante_simulado_ns = restaurado.instante_simulado_ns;
+
+        atomic_store(&checkpoint_final, false);
+        atomic_store(&checkpoint_ativo, true);
+        if (sem_init(&sem_checkpoint, 0, 0) != 0 ||
+            pthread_create(&thread_checkpoint, NULL, checkpoint_thread_executar, NULL) != 0) {
+            perror("Erro ao criar thread de checkpoint");
+            atomic_store(&checkpoint_ativo, false);
+        } else {
+            checkpoint_iniciado = true;
+        }
+    }
+
+    bool monitor_iniciado = false;
+    if (config->intervalo_monitor_ms > 0) {
+        atomic_store(&monitor_ativo, true);
+        if (pthread_create(&thread_monitor, NULL, monitor_executar,
+                           (void *)(long)config->intervalo_monitor_ms) != 0) {
+            perror("Erro ao criar thread do monitor");
+            atomic_store(&monitor_ativo, false);
+        } else {
+            monitor_iniciado = true;
+        }
+    }
+    
+    if (!modo_silencioso) {
+        printf("\n[MAIN] Todas as aeronaves iniciadas. Sistema operacional.\n");
+        printf("[MAIN] Aguardando conclusão das rotas...\n\n");
+    }
+    
+    chegadas_estatisticas_t medidas_chegadas;
+    chegadas_acompanhar_janela(&medidas_chegadas);
+    frota_aguardar(&frota, !modo_silencioso);
+    long long conclusao_ns = relogio_agora_ns();
+    getrusage(RUSAGE_SELF, &uso_depois);
+    temporizador_finalizar();
+    chegadas_registrar_fim(conclusao_ns, &medidas_chegadas);
+
+    if (monitor_iniciado) {
+        atomic_store(&monitor_ativo, false);
+        pthread_join(thread_monitor, NULL);
+    }
+    if (checkpoint_iniciado) {
+        atomic_store(&checkpoint_ativo, false);
+        sem_post(&sem_checkpoint);
+        pthread_join(thread_checkpoint, NULL);
+        sem_destroy(&sem_checkpoint);
+    }
+
+    if (resultado != NULL) {
+        atc_estatisticas_t estatisticas;
+        atc_obter_estatisticas(&estatisticas);
+
+        memset(resultado, 0, sizeof(*resultado));
+        resultado->tempo_total = estatisticas.tempo_total;
+        resultado->transferencias = estatisticas.transferencias;
+        // Os contadores seguem acumulados de um checkpoint restaurado; a vazão é desta execução
+        resultado->vazao = estatisticas.tempo_total > 0 ?
+                           (estatisticas.transferencias - restaurado.contadores[CONTADOR_TRANSFERENCIAS]) /
+                           estatisticas.tempo_total : 0.0;
+        resultado->deadlocks = estatisticas.deadlocks_detectados;
+        resultado->recuos = estatisticas.recuos_forcados;
+        resultado->boosts = estatisticas.boosts_aplicados;
+        resultado->tamanho_medio_lote = estatisticas.lotes > 0 ?
+                                        (double)estatisticas.pedidos_em_lote / estatisticas.lotes : 0.0;
+        resultado->secao_critica_media_ns = estatisticas.secao_critica_media_ns;
+        resultado->secao_critica_max_us = estatisticas.secao_critica_max_ns / 1000.0;
+        resultado->passadas_deteccao = estatisticas.passadas_deteccao;
+        resultado->saltos_perdidos = estatisticas.saltos_perdidos;
+        resultado->espera_perdida = estatisticas.espera_perdida;
+        resultado->max_recuos_seguidos = estatisticas.max_recuos_seguidos;
+        resultado->acessos_setor = estatisticas.acessos_setor;
+        resultado->acessos_remotos = estatisticas.acessos_remotos;
+        resultado->preempcoes = estatisticas.preempcoes;
+        resultado->herancas = estatisticas.herancas;
+        resultado->estimativas = estatisticas.estimativas;
+        resultado->retencoes = estatisticas.retencoes;
+        resultado->retencao_media = estatisticas.retencao_media_ns / 1e6;
+        temporizador_obter_estatisticas(&resultado->sono);
+        resultado->trocas_contexto = (uso_depois.ru_nvcsw - uso_antes.ru_nvcsw) +
+                                     (uso_depois.ru_nivcsw - uso_antes.ru_nivcsw);
+        resultado->estimativa_erro_medio = estatisticas.estimativa_erro_medio_ns / 1e6;
+        resultado->estimativa_vies = estatisticas.estimativa_vies_ns / 1e6;
+        resultado->espera_estimada_media = estatisticas.espera_estimada_media_ns / 1e6;
+        resultado->espera_medida_media = estatisticas.espera_medida_media_ns / 1e6;
+        resultado->estimativas_na_faixa = estatisticas.estimativas_na_faixa;
+        resultado->instante_restaurado = restaurado.instante_simulado_ns / 1e9;
+        if (checkpoint_iniciado && checkpoints.gravados > 0) {
+            resultado->checkpoints = checkpoints.gravados;
+            resultado->checkpoint_pausa_media_ms = checkpoints.soma_pausa_ms / checkpoints.gravados;
+            resultado->checkpoint_pausa_max_ms = checkpoints.pausa_max_ms;
+            resultado->checkpoint_escrita_media_ms = checkpoints.soma_escrita_ms / checkpoints.gravados;
+            resultado->checkpoint_bytes = checkpoints.bytes;
+        }
+        resultado->aeronaves_concluidas = iniciadas;
+        resultado->tempo_inicializacao = (largada_ns - inicio_ns) / 1e6;
+        resultado->makespan = (conclusao_ns - largada_ns) / 1e9;
+        resultado->rss_por_aeronave = (rss_depois > rss_antes) ?
+                                      (double)(rss_depois - rss_antes) / num_aeronaves : 0.0;
+        if (reserva_ativa()) {
+            reserva_estatisticas_t reservas;
+            reserva_obter_estatisticas(&reservas);
+            int escala = escala_tempo > 0 ? escala_tempo : 1;
+            resultado->makespan_previsto = reservas.makespan_ms / 1000.0 / escala;
+            if (reservas.agendamentos > 0) {
+                resultado->atraso_solo_medio = (double)reservas.atraso_solo_ms / reservas.agendamentos / escala;
+                resultado->agendamento_medio_us = reservas.tempo_agendamento_ns / 1000.0 / reservas.agendamentos;
+            }
+            resultado->atraso_solo_max = (double)reservas.atraso_solo_max_ms / escala;
+            resultado->conflitos_reserva = reservas.conflitos;
+        }
+        espera_obter_estatisticas(&resultado->espera);
+        simulacao_coletar_esperas(resultado);
+        if (config->chegadas != NULL) {
+            long trechos = 0;
+            for (int i = 0; i < num_aeronaves; i++) {
+                if (aeronaves[i] != NULL) trechos += aeronaves[i]->comprimento_rota;
+            }
+            resultado->chegadas = medidas_chegadas;
+            resultado->chegadas.trechos_por_aeronave = (double)trechos / num_aeronaves;
+            double janela = config->chegadas->duracao - config->chegadas->aquecimento;
+            resultado->vazao_sustentada = janela > 0 ? resultado->espera.concessoes / janela : 0.0;
+        }
+    }
+
+    // Antes da frota: o controlador central ainda pode ter liberações na fila
+    atc_finalizar();
+    medicao_finalizar();
+    reserva_finalizar();
+    if (config->verificar) {
+        verificador_finalizar();
+        if (resultado != NULL) verificador_obter_estatisticas(&resultado->verificacao);
+    }
+
+    chegadas_finalizar();
+    aeronaves = NULL;
+    frota_destruir(&frota);
+    return 0;
+}
+
+/**
+ * Interrompe a execução em andamento (tratador de sinal): cancela as
+ * aeronaves, finaliza o ATC e libera a frota
+ */
+void simulacao_abortar() {
+    frota_cancelar(&frota);
+    temporizador_finalizar();
+    atc_finalizar();
+    medicao_finalizar();
+    reserva_finalizar();
+    verificador_finalizar();
+    chegadas_finalizar();
+    aeronaves = NULL;
+    frota_destruir(&frota);
+}
@@ -0,0 +1,381 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include "../include/temporizador.h"
+#include "../include/contadores.h"
+#include "../include/utils.h"
+#include "../include/relogio.h"
+
+#define RODA_POSICOES (1 << RODA_BITS)
+#define RODA_MASCARA (RODA_POSICOES - 1)
+#define RODA_ALCANCE (1ULL << (RODA_BITS * RODA_NIVEIS)) // Ticks cobertos pelos níveis
+#define TICK_NENHUM UINT64_MAX
+
+// Prazo registrado por uma aeronave: vive na pilha de quem dorme e fica
+// encadeado na posição da roda até vencer (ou até a thread ser cancelada)
+typedef struct entrada_roda {
+    struct entrada_roda *proxima;
+    struct entrada_roda *anterior;
+    uint64_t expira;    // Tick em que vence
+    long long prazo_ns; // Para medir o atraso
+    int nivel;
+    int posicao;
+    bool armada;        // Ainda na roda
+    sem_t sem;
+} entrada_roda_t;
+
+static modo_temporizador_t modo = TEMPORIZADOR_NANOSLEEP;
+static long long tick_ns = TEMPORIZADOR_TOLERANCIA_PADRAO_US * 1000LL;
+static char nome[32] = "nanosleep";
+
+// Roda: níveis de 64 posições, cada nível 64 vezes mais largo que o anterior
+// (como os temporizadores clássicos do Linux). Tudo sob trava_roda
+static entrada_roda_t *posicoes[RODA_NIVEIS][RODA_POSICOES];
+static uint64_t ocupadas[RODA_NIVEIS]; // Um bit por posição com alguma entrada
+static uint64_t proximo_tick = 0;      // Próximo tick a processar
+static uint64_t alvo_tick = TICK_NENHUM; // Até quando a thread da roda dorme
+static long long base_ns = 0;          // Instante do tick 0
+static int pendentes = 0;
+static bool encerrando = false;
+static bool roda_iniciada = false;
+static pthread_t thread_roda;
+static pthread_mutex_t trava_roda = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond_roda;
+
+static _Atomic long long atraso_max_ns = 0;
+
+/**
+ * Escolhe como as aeronaves dormem (antes de inicializar)
+ * @param texto: "nanosleep" ou "roda[:US]" (US = tolerância em µs)
+ * @return true se o modo e a tolerância forem válidos
+ */
+bool temporizador_definir(const char *texto) {
+    if (strcmp(texto, "nanosleep") == 0) {
+        modo = TEMPORIZADOR_NANOSLEEP;
+        snprintf(nome, sizeof(nome), "nanosleep");
+        return true;
+    }
+    if (strncmp(texto, "roda", 4) == 0 && (texto[4] == '\0' || texto[4] == ':')) {
+        int tolerancia_us = TEMPORIZADOR_TOLERANCIA_PADRAO_US;
+        if (texto[4] == ':' && (sscanf(texto + 5, "%d", &tolerancia_us) != 1 || tolerancia_us < 1)) {
+            return false;
+        }
+        modo = TEMPORIZADOR_RODA;
+        tick_ns = tolerancia_us * 1000LL;
+        snprintf(nome, sizeof(nome), "roda:%dus", tolerancia_us);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @return Modo em uso, com a tolerância da roda
+ */
+const char *temporizador_nome() {
+    return nome;
+}
+
+/**
+ * Encadeia uma entrada no nível que cobre a distância até o prazo
+ * Deve ser chamada com trava_roda
+ */
+static void roda_inserir(entrada_roda_t *e) {
+    uint64_t expira = e->expira < proximo_tick ? proximo_tick : e->expira;
+    uint64_t distancia = expira - proximo_tick;
+    if (distancia >= RODA_ALCANCE) {
+        expira = proximo_tick + RODA_ALCANCE - 1; // Desce em cascata e é reposta com o prazo real
+        distancia = RODA_ALCANCE - 1;
+    }
+    int nivel = 0;
+    while (nivel < RODA_NIVEIS - 1 && distancia >= (1ULL << (RODA_BITS * (nivel + 1)))) {
+        nivel++;
+    }
+    int posicao = (int)((expira >> (RODA_BITS * nivel)) & RODA_MASCARA);
+
+    e->nivel = nivel;
+    e->posicao = posicao;
+    e->anterior = NULL;
+    e->proxima = posicoes[nivel][posicao];
+    if (e->proxima != NULL) e->proxima->anterior = e;
+    posicoes[nivel][posicao] = e;
+    ocupadas[nivel] |= 1ULL << posicao;
+}
+
+/**
+ * Tira uma entrada da sua posição em O(1)
+ * Deve ser chamada com trava_roda
+ */
+static void roda_remover(entrada_roda_t *e) {
+    if (e->anterior != NULL) {
+        e->anterior->proxima = e->proxima;
+    } else {
+        posicoes[e->nivel][e->posicao] = e->proxima;
+    }
+    if (e->proxima != NULL) e->proxima->anterior = e->anterior;
+    if (posicoes[e->nivel][e->posicao] == NULL) ocupadas[e->nivel] &= ~(1ULL << e->posicao);
+}
+
+/**
+ * Redistribui uma posição de um nível superior pelos níveis de baixo
+ * Deve ser chamada com trava_roda
+ * @return Índice da posição (0 = o nível de cima também vira)
+ */
+static int roda_cascatear(int nivel) {
+    int posicao = (int)((proximo_tick >> (RODA_BITS * nivel)) & RODA_MASCARA);
+    entrada_roda_t *e = posicoes[nivel][posicao];
+    posicoes[nivel][posicao] = NULL;
+    ocupadas[nivel] &= ~(1ULL << posicao);
+    while (e != NULL) {
+        entrada_roda_t *proxima = e->proxima;
+        roda_inserir(e);
+        e = proxima;
+    }
+    return posicao;
+}
+
+/**
+ * Processa o próximo tick: desce as cascatas que viram nele e tira da roda
+ * todas as entradas da posição do nível 0, encadeadas em vencidas para serem
+ * acordadas fora da trava
+ * Deve ser chamada com trava_roda
+ * @param vencidas: Lista que recebe as entradas do tick
+ * @return Entradas vencidas neste tick
+ */
+static int roda_processar_tick(entrada_roda_t **vencidas) {
+    int posicao = (int)(proximo_tick & RODA_MASCARA);
+    if (posicao == 0) {
+        for (int nivel = 1; nivel < RODA_NIVEIS && roda_cascatear(nivel) == 0; nivel++) {
+        }
+    }
+    int total = 0;
+    entrada_roda_t *e = posicoes[0][posicao];
+    posicoes[0][posicao] = NULL;
+    ocupadas[0] &= ~(1ULL << posicao);
+    while (e != NULL) {
+        entrada_roda_t *proxima = e->proxima;
+        e->armada = false;
+        e->proxima = *vencidas;
+        *vencidas = e;
+        pendentes--;
+        total++;
+        e = proxima;
+    }
+    proximo_tick++;
+    return total;
+}
+
+/**
+ * Próximo tick em que há algo a fazer: a primeira posição ocupada do nível 0
+ * daqui até a virada, senão a virada (onde os níveis de cima descem)
+ * Deve ser chamada com trava_roda
+ */
+static uint64_t roda_proximo_evento() {
+    if (pendentes == 0) return TICK_NENHUM;
+    int posicao = (int)(proximo_tick & RODA_MASCARA);
+    uint64_t adiante = ocupadas[0] >> posicao;
+    if (adiante != 0) return proximo_tick + (uint64_t)__builtin_ctzll(adiante);
+    return (proximo_tick | RODA_MASCARA) + 1;
+}
+
+/**
+ * Thread da roda: dorme até o próximo evento (um temporizador armado por vez
+ * para a frota inteira), processa os ticks vencidos e volta a dormir
+ */
+static void *temporizador_executar(void *arg) {
+    (void)arg;
+    pthread_mutex_lock(&trava_roda);
+    while (!encerrando) {
+        uint64_t agora_tick = (uint64_t)((relogio_espera_ns() - base_ns) / tick_ns);
+        if (pendentes == 0) {
+            if (proximo_tick <= agora_tick) proximo_tick = agora_tick + 1; // Roda vazia: nada a percorrer
+        } else {
+            entrada_roda_t *vencidas = NULL;
+            while (proximo_tick <= agora_tick && pendentes > 0) {
+                int acordadas = roda_processar_tick(&vencidas);
+                if (acordadas > 0) {
+                    contadores_incrementar(CONTADOR_LOTES_RODA);
+                    contadores_adicionar(CONTADOR_ACORDADAS_RODA, acordadas);
+                }
+            }
+            // Acorda fora da trava: quem registra prazos não espera pelos sem_post
+            if (vencidas != NULL) {
+                pthread_mutex_unlock(&trava_roda);
+                while (vencidas != NULL) {
+                    entrada_roda_t *proxima = vencidas->proxima; // Lido antes: acordada, a entrada some
+                    sem_post(&vencidas->sem);
+                    vencidas = proxima;
+                }
+                pthread_mutex_lock(&trava_roda);
+            }
+        }
+
+        // Com a trava solta acima, temporizador_finalizar pode ter sinalizado
+        // sem ninguém esperando: o aviso ficou em encerrando
+        if (encerrando) break;
+        alvo_tick = roda_proximo_evento();
+        if (alvo_tick == TICK_NENHUM) {
+            // Em laço: acordar à toa não pode virar volta sem prazo nem sinal perdido
+            while (!encerrando && (alvo_tick = roda_proximo_evento()) == TICK_NENHUM) {
+                pthread_cond_wait(&cond_roda, &trava_roda);
+            }
+        } else {
+            struct timespec ts;
+            relogio_prazo_espera(base_ns + (long long)alvo_tick * tick_ns, &ts);
+            contadores_incrementar(CONTADOR_TEMPORIZADORES_ARMADOS);
+            pthread_cond_timedwait(&cond_roda, &trava_roda, &ts);
+        }
+        alvo_tick = TICK_NENHUM;
+    }
+    pthread_mutex_unlock(&trava_roda);
+    return NULL;
+}
+
+/**
+ * Liga a thread da roda (no modo nanosleep não há nada a preparar)
+ * @return true em caso de sucesso
+ */
+bool temporizador_inicializar() {
+    atomic_store(&atraso_max_ns, 0);
+    if (modo != TEMPORIZADOR_RODA || roda_iniciada) return true;
+
+    memset(posicoes, 0, sizeof(posicoes));
+    memset(ocupadas, 0, sizeof(ocupadas));
+    pendentes = 0;
+    encerrando = false;
+    base_ns = relogio_espera_ns();
+    proximo_tick = 1;
+    alvo_tick = TICK_NENHUM;
+
+    pthread_condattr_t atributos;
+    pthread_condattr_init(&atributos);
+    pthread_condattr_setclock(&atributos, RELOGIO_ESPERA);
+    pthread_cond_init(&cond_roda, &atributos);
+    pthread_condattr_destroy(&atributos);
+
+    if (pthread_create(&thread_roda, NULL, temporizador_executar, NULL) != 0) {
+        perror("Erro ao criar a thread da roda de tempo");
+        pthread_cond_destroy(&cond_roda);
+        return false;
+    }
+    roda_iniciada = true;
+    return true;
+}
+
+/**
+ * Encerra a thread da roda. Entradas que sobrarem (aeronaves canceladas no
+ * meio do sono) não são mais tocadas
+ */
+void temporizador_finalizar() {
+    if (!roda_iniciada) return;
+    pthread_mutex_lock(&trava_roda);
+    encerrando = true;
+    pthread_cond_signal(&cond_roda);
+    pthread_mutex_unlock(&trava_roda);
+    pthread_join(thread_roda, NULL);
+    pthread_cond_destroy(&cond_roda);
+    roda_iniciada = false;
+}
+
+/**
+ * Desfaz o registro de quem foi cancelado dormindo na roda. Se a entrada já
+ * venceu, o sem_post está a caminho: espera por ele antes de a pilha sumir
+ */
+static void temporizador_cancelar_entrada(void *arg) {
+    entrada_roda_t *e = arg;
+    pthread_mutex_lock(&trava_roda);
+    bool vencida = !e->armada;
+    if (e->armada) {
+        roda_remover(e);
+        e->armada = false;
+        pendentes--;
+    }
+    pthread_mutex_unlock(&trava_roda);
+    if (vencida && roda_iniciada) sem_wait(&e->sem);
+}
+
+/**
+ * Registra o atraso de um despertar
+ */
+static void temporizador_registrar_atraso(long long prazo_ns) {
+    long long atraso = relogio_espera_ns() - prazo_ns;
+    if (atraso < 0) atraso = 0;
+    contadores_incrementar(CONTADOR_SONOS);
+    contadores_adicionar(CONTADOR_ATRASO_SONO_NS, atraso);
+    long long maximo = atomic_load_explicit(&atraso_max_ns, memory_order_relaxed);
+    while (atraso > maximo &&
+           !atomic_compare_exchange_weak_explicit(&atraso_max_ns, &maximo, atraso,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+/**
+ * Dorme pelo menos uma duração: sozinho no kernel (nanosleep) ou registrado
+ * na roda, parado num semáforo até o tick do prazo
+ * @param duracao_ns: Duração em ns de relógio (já comprimida pela escala)
+ */
+void temporizador_dormir_ns(long long duracao_ns) {
+    if (duracao_ns <= 0) return;
+    long long prazo_ns = relogio_espera_ns() + duracao_ns;
+
+    if (!roda_iniciada) {
+        struct timespec ts = {
+            .tv_sec = duracao_ns / 1000000000LL,
+            .tv_nsec = duracao_ns % 1000000000LL
+        };
+        contadores_incrementar(CONTADOR_TEMPORIZADORES_ARMADOS);
+        nanosleep(&ts, NULL);
+        temporizador_registrar_atraso(prazo_ns);
+        return;
+    }
+
+    entrada_roda_t e;
+    sem_init(&e.sem, 0, 0);
+    e.prazo_ns = prazo_ns;
+    e.expira = (uint64_t)((prazo_ns - base_ns + tick_ns - 1) / tick_ns); // Arredonda para cima
+
+    pthread_mutex_lock(&trava_roda);
+    roda_inserir(&e);
+    e.armada = true;
+    pendentes++;
+    if (alvo_tick == TICK_NENHUM || e.expira < alvo_tick) pthread_cond_signal(&cond_roda);
+    pthread_mutex_unlock(&trava_roda);
+
+    pthread_cleanup_push(temporizador_cancelar_entrada, &e);
+    while (sem_wait(&e.sem) != 0 && errno == EINTR) {
+    }
+    pthread_cleanup_pop(0);
+    sem_destroy(&e.sem);
+    temporizador_registrar_atraso(prazo_ns);
+}
+
+/**
+ * Dorme ms simulados (comprimidos pela escala de tempo)
+ * @param ms: Milissegundos simulados
+ */
+void temporizador_dormir_ms(int ms) {
+    temporizador_dormir_ns((long long)ms * 1000000LL / (escala_tempo > 0 ? escala_tempo : 1));
+}
+
+/**
+ * Lê as estatísticas de sono da execução (contadores por thread)
+ * @param estatisticas: Destino
+ */
+void temporizador_obter_estatisticas(temporizador_estatisticas_t *estatisticas) {
+    contadores_t c;
+    contadores_ler(&c);
+    memset(estatisticas, 0, sizeof(*estatisticas));
+    estatisticas->sonos = (long)c.valor[CONTADOR_SONOS];
+    estatisticas->armados = (long)c.valor[CONTADOR_TEMPORIZADORES_ARMADOS];
+    estatisticas->lotes = (long)c.valor[CONTADOR_LOTES_RODA];
+    estatisticas->por_lote = c.valor[CONTADOR_LOTES_RODA] > 0 ?
+        (double)c.valor[CONTADOR_ACORDADAS_RODA] / c.valor[CONTADOR_LOTES_RODA] : 0.0;
+    estatisticas->atraso_medio_us = c.valor[CONTADOR_SONOS] > 0 ?
+        (double)c.valor[CONTADOR_ATRASO_SONO_NS] / c.valor[CONTADOR_SONOS] / 1000.0 : 0.0;
+    estatisticas->atraso_max_us = atomic_load(&atraso_max_ns) / 1000.0;
+}
@@ -0,0 +1,304 @@
+#define _GNU_SOURCE // sched_getcpu, CPU_SET e pthread_attr_setaffinity_np
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <dirent.h>
+#include <sys/mman.h>
+#include "../include/topologia.h"
+
+#define CPUS_MAX CPU_SETSIZE
+
+typedef struct {
+    int nos;                             // Nós em uso (detectados ou simulados)
+    cpu_set_t cpus[TOPOLOGIA_NOS_MAX];   // Núcleos de cada nó
+    signed char no_da_cpu[CPUS_MAX];     // Núcleo -> nó (-1 fora da máscara do processo)
+    bool detectada;
+} topologia_t;
+
+static topologia_t topologia;
+static posicionamento_t posicionamento = POSICIONAMENTO_LIVRE;
+static int nos_simulados = 0; // "numa:N"; 0 = usa os nós reais
+static char nome_posicionamento[32] = "livre";
+
+/**
+ * Lê uma lista de núcleos no formato do sysfs ("0-3,8,10-11")
+ * @param caminho: Arquivo cpulist
+ * @param cpus: Recebe os núcleos
+ * @return true se a lista foi lida e não está vazia
+ */
+static bool ler_lista_cpus(const char *caminho, cpu_set_t *cpus) {
+    FILE *f = fopen(caminho, "r");
+    if (f == NULL) return false;
+
+    CPU_ZERO(cpus);
+    int inicio, fim;
+    char separador;
+    while (fscanf(f, "%d", &inicio) == 1) {
+        fim = inicio;
+        if (fscanf(f, "%c", &separador) == 1 && separador == '-') {
+            if (fscanf(f, "%d", &fim) != 1) break;
+            if (fscanf(f, "%c", &separador) != 1) separador = '\n';
+        }
+        for (int c = inicio; c <= fim && c < CPUS_MAX; c++) {
+            CPU_SET(c, cpus);
+        }
+        if (separador != ',') break;
+    }
+    fclose(f);
+    return CPU_COUNT(cpus) > 0;
+}
+
+/**
+ * Reparte os núcleos permitidos ao processo em nos_simulados grupos contíguos
+ * (com menos núcleos que nós, os nós compartilham núcleos)
+ * @param permitidas: Máscara de afinidade do processo
+ */
+static void topologia_simular(const cpu_set_t *permitidas) {
+    int lista[CPUS_MAX];
+    int total = 0;
+    for (int c = 0; c < CPUS_MAX; c++) {
+        if (CPU_ISSET(c, permitidas)) lista[total++] = c;
+    }
+    if (total == 0) lista[total++] = 0;
+
+    topologia.nos = nos_simulados;
+    for (int no = 0; no < topologia.nos; no++) {
+        CPU_ZERO(&topologia.cpus[no]);
+        int inicio = (int)((long)no * total / topologia.nos);
+        int fim = (int)((long)(no + 1) * total / topologia.nos);
+        if (fim <= inicio) fim = inicio + 1;
+        for (int k = inicio; k < fim; k++) {
+            CPU_SET(lista[k % total], &topologia.cpus[no]);
+        }
+    }
+}
+
+/**
+ * Descobre os nós NUMA pelo sysfs e o mapa núcleo -> nó (uma vez só)
+ * Sem o sysfs, é um nó com todos os núcleos do processo
+ */
+static void topologia_detectar() {
+    if (topologia.detectada) return;
+    topologia.detectada = true;
+
+    cpu_set_t permitidas;
+    if (sched_getaffinity(0, sizeof(permitidas), &permitidas) != 0) {
+        CPU_ZERO(&permitidas);
+        CPU_SET(0, &permitidas);
+    }
+
+    topologia.nos = 0;
+    if (nos_simulados > 0) {
+        topologia_simular(&permitidas);
+    } else {
+        DIR *dir = opendir("/sys/devices/system/node");
+        struct dirent *entrada;
+        while (dir != NULL && (entrada = readdir(dir)) != NULL && topologia.nos < TOPOLOGIA_NOS_MAX) {
+            int id;
+            char resto;
+            if (sscanf(entrada->d_name, "node%d%c", &id, &resto) != 1) continue;
+
+            char caminho[96];
+            snprintf(caminho, sizeof(caminho), "/sys/devices/system/node/node%d/cpulist", id);
+            cpu_set_t cpus;
+            if (!ler_lista_cpus(caminho, &cpus)) continue; // Nó só de memória
+            CPU_AND(&cpus, &cpus, &permitidas);
+            if (CPU_COUNT(&cpus) == 0) continue;
+            topologia.cpus[topologia.nos++] = cpus;
+        }
+        if (dir != NULL) closedir(dir);
+    }
+    if (topologia.nos == 0) {
+        topologia.nos = 1;
+        topologia.cpus[0] = permitidas;
+    }
+
+    memset(topologia.no_da_cpu, -1, sizeof(topologia.no_da_cpu));
+    for (int no = topologia.nos - 1; no >= 0; no--) {
+        for (int c = 0; c < CPUS_MAX; c++) {
+            if (CPU_ISSET(c, &topologia.cpus[no])) topologia.no_da_cpu[c] = (signed char)no;
+        }
+    }
+}
+
+/**
+ * Seleciona o posicionamento (antes de atc_init)
+ * @param nome: "livre", "numa" ou "numa:N" (N nós simulados)
+ * @return true se o nome for conhecido e N estiver entre 1 e TOPOLOGIA_NOS_MAX
+ */
+bool topologia_definir_posicionamento(const char *nome) {
+    // "livre" mantém os nós em uso: a medida de acessos remotos segue comparável
+    int simulados = nos_simulados;
+    if (strcmp(nome, "livre") == 0) {
+        posicionamento = POSICIONAMENTO_LIVRE;
+    } else if (strcmp(nome, "numa") == 0) {
+        simulados = 0;
+        posicionamento = POSICIONAMENTO_NUMA;
+    } else if (strncmp(nome, "numa:", 5) == 0) {
+        simulados = atoi(nome + 5);
+        if (simulados < 1 || simulados > TOPOLOGIA_NOS_MAX) return false;
+        posicionamento = POSICIONAMENTO_NUMA;
+    } else {
+        return false;
+    }
+
+    if (simulados != nos_simulados) {
+        nos_simulados = simulados;
+        topologia.detectada = false; // Refaz o mapa com os nós simulados (ou reais)
+    }
+    snprintf(nome_posicionamento, sizeof(nome_posicionamento), "%s", nome);
+    topologia_detectar();
+    return true;
+}
+
+/**
+ * @return Nome do posicionamento em uso
+ */
+const char *topologia_nome_posicionamento() {
+    return nome_posicionamento;
+}
+
+/**
+ * @return Número de nós (detectados ou simulados), pelo menos 1
+ */
+int topologia_nos() {
+    topologia_detectar();
+    return topologia.nos;
+}
+
+/**
+ * @return true se o posicionamento numa está em uso e há mais de um nó
+ */
+bool topologia_ativa() {
+    return posicionamento == POSICIONAMENTO_NUMA && topologia_nos() > 1;
+}
+
+/**
+ * Nó dono de um setor: os setores são divididos em faixas contíguas
+ * @param setor: Índice do setor
+ * @param total_setores: Número de setores
+ * @return Índice do nó
+ */
+int topologia_no_do_setor(int setor, int total_setores) {
+    if (total_setores <= 0) return 0;
+    return (int)((long)setor * topologia.nos / total_setores);
+}
+
+/**
+ * Faixa de setores de um nó (inversa de topologia_no_do_setor)
+ * @param no: Índice do nó
+ * @param total_setores: Número de setores
+ * @param inicio: Recebe o primeiro setor do nó
+ * @param fim: Recebe o setor seguinte ao último (faixa vazia se inicio == fim)
+ */
+void topologia_faixa_do_no(int no, int total_setores, int *inicio, int *fim) {
+    int nos = topologia.nos;
+    // Menor s com s * nos / total >= no, para bater com topologia_no_do_setor
+    *inicio = (int)(((long)no * total_setores + nos - 1) / nos);
+    *fim = (int)(((long)(no + 1) * total_setores + nos - 1) / nos);
+    if (*fim > total_setores) *fim = total_setores;
+}
+
+/**
+ * Nó que concentra a rota: o dono da maior parte dos trechos (empate: menor nó)
+ * @param aeronave: Aeronave com a rota já sorteada
+ * @param total_setores: Número de setores
+ * @return Índice do nó
+ */
+int topologia_no_da_rota(const aeronave_t *aeronave, int total_setores) {
+    int trechos[TOPOLOGIA_NOS_MAX] = {0};
+    int melhor = 0;
+    for (int i = 0; i < aeronave->comprimento_rota; i++) {
+        int no = topologia_no_do_setor(aeronave_trecho(aeronave, i), total_setores);
+        if (++trechos[no] > trechos[melhor] || (trechos[no] == trechos[melhor] && no < melhor)) {
+            melhor = no;
+        }
+    }
+    return melhor;
+}
+
+/**
+ * Nó do núcleo em que a thread chamadora está agora
+ * @return Índice do nó, -1 se desconhecido
+ */
+int topologia_no_atual() {
+    int cpu = sched_getcpu();
+    if (cpu < 0 || cpu >= CPUS_MAX) return -1;
+    return topologia.no_da_cpu[cpu];
+}
+
+/**
+ * Restringe as threads criadas com estes atributos aos núcleos de um nó
+ * @param atributos: Atributos de pthread_create já inicializados
+ * @param no: Índice do nó
+ * @return true se a afinidade foi aplicada
+ */
+bool topologia_fixar_no(pthread_attr_t *atributos, int no) {
+    if (no < 0 || no >= topologia.nos) return false;
+    return pthread_attr_setaffinity_np(atributos, sizeof(cpu_set_t), &topologia.cpus[no]) == 0;
+}
+
+typedef struct {
+    void (*funcao)(int no, void *contexto);
+    void *contexto;
+    int no;
+} tarefa_no_t;
+
+static void *topologia_executar_tarefa(void *arg) {
+    tarefa_no_t *tarefa = arg;
+    tarefa->funcao(tarefa->no, tarefa->contexto);
+    return NULL;
+}
+
+/**
+ * Executa uma função uma vez por nó, numa thread fixada nos núcleos daquele
+ * nó, em sequência. Serve para a primeira escrita (e com ela a página) da
+ * faixa de cada nó acontecer no próprio nó. Sem posicionamento ativo, roda
+ * tudo na thread chamadora
+ * @param funcao: Recebe o índice do nó e o contexto
+ * @param contexto: Repassado a funcao
+ */
+void topologia_em_cada_no(void (*funcao)(int no, void *contexto), void *contexto) {
+    if (!topologia_ativa()) {
+        for (int no = 0; no < topologia_nos(); no++) funcao(no, contexto);
+        return;
+    }
+
+    for (int no = 0; no < topologia.nos; no++) {
+        tarefa_no_t tarefa = { .funcao = funcao, .contexto = contexto, .no = no };
+        pthread_attr_t atributos;
+        pthread_attr_init(&atributos);
+        topologia_fixar_no(&atributos, no);
+        pthread_t thread;
+        if (pthread_create(&thread, &atributos, topologia_executar_tarefa, &tarefa) == 0) {
+            pthread_join(thread, NULL);
+        } else {
+            funcao(no, contexto); // Sem thread fixada: a página fica onde estiver
+        }
+        pthread_attr_destroy(&atributos);
+    }
+}
+
+/**
+ * Aloca páginas ainda não tocadas (a primeira escrita decide o nó de cada uma)
+ * @param tamanho: Bytes
+ * @return Memória zerada ou NULL
+ */
+void *topologia_alocar(size_t tamanho) {
+    void *memoria = mmap(NULL, tamanho, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memoria == MAP_FAILED) {
+        perror("mmap topologia");
+        return NULL;
+    }
+    return memoria;
+}
+
+/**
+ * Libera memória obtida com topologia_alocar
+ * @param memoria: Início da alocação (NULL é ignorado)
+ * @param tamanho: Mesmo tamanho passado a topologia_alocar
+ */
+void topologia_liberar(void *memoria, size_t tamanho) {
+    if (memoria != NULL) munmap(memoria, tamanho);
+}
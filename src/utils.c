@@ -1,115 +1,186 @@
-#include <stdio.h>
-#include <stdlib.h>
-#include <time.h>
-#include <unistd.h>
-#include <sys/time.h>
-#include "../include/utils.h"
-#include "../include/aeronave.h"
-
-/**
- * Imprime o timestamp atual no formato HH:MM:SS.microseconds
- */
-void imprimir_timestamp() {
-    struct timeval tv;
-    gettimeofday(&tv, NULL);
-    
-    time_t now = tv.tv_sec;
-    struct tm *tm_info = localtime(&now);
-    
-    printf("[%02d:%02d:%02d.%06ld] ", 
-           tm_info->tm_hour, 
-           tm_info->tm_min, 
-           tm_info->tm_sec, 
-           tv.tv_usec);
-}
-
-/**
- * Gera uma rota aleatória para uma aeronave
- * Otimizado para reduzir chamadas a rand() e operações de módulo
- * @param comprimento: Tamanho da rota (número de setores)
- * @param total_setores: Número total de setores disponíveis no espaço aéreo
- * @return Ponteiro para array de inteiros contendo a rota
- */
-int* gerar_rota_aleatoria(int comprimento, int total_setores) {
-    if (comprimento <= 0 || total_setores <= 0) {
-        return NULL;
-    }
-    
-    int *rota = malloc(sizeof(int) * comprimento);
-    if (!rota) {
-        perror("malloc rota");
-        return NULL;
-    }
-    
-    // Gera uma rota começando de um setor aleatório
-    int setor_atual = rand() % total_setores;
-    rota[0] = setor_atual;
-    
-    // Gera o resto da rota de forma sequencial ou com pequenos saltos
-    for (int i = 1; i < comprimento; i++) {
-        // Otimização: uma única chamada rand() por iteração
-        int aleatorio = rand();
-        int tipo_movimento = aleatorio % 100;
-        
-        if (tipo_movimento < 70) {
-            // 70% de chance: Move para setor adjacente (mais eficiente)
-            setor_atual = (setor_atual + 1) % total_setores;
-        } else if (tipo_movimento < 90) {
-            // 20% de chance: Move para setor adjacente anterior
-            setor_atual = (setor_atual + total_setores - 1) % total_setores;
-        } else {
-            // 10% de chance: Faz um salto aleatório pequeno
-            int salto = ((aleatorio >> 8) % 3) + 1;  // Reutiliza bits do rand()
-            int direcao = (aleatorio & 1) ? 1 : -1;
-            setor_atual = (setor_atual + (salto * direcao) + total_setores) % total_setores;
-        }
-        rota[i] = setor_atual;
-    }
-    
-    return rota;
-}
-
-/**
- * Gera um comprimento de rota aleatório baseado no total de setores
- * @param total_setores: Número total de setores no espaço aéreo
- * @return Comprimento da rota gerado aleatoriamente
- */
-int gerar_comprimento_rota(int total_setores) {
-    if (total_setores <= 0) {
-        return 3; // Valor padrão mínimo
-    }
-    
-    // Gera rota entre 50% e 150% do total de setores
-    int minimo = (total_setores / 2) > 3 ? (total_setores / 2) : 3;
-    int maximo = (total_setores * 3 / 2) > minimo ? (total_setores * 3 / 2) : minimo + 5;
-    
-    return minimo + (rand() % (maximo - minimo + 1));
-}
-
-/**
- * Calcula o tempo médio de espera de todas as aeronaves
- * Otimizado para evitar divisão desnecessária
- * @param aeronaves: Array de ponteiros para aeronaves
- * @param total_aeronaves: Número total de aeronaves
- * @return Tempo médio de espera em segundos
- */
-double calcular_tempo_medio(aeronave_t **aeronaves, int total_aeronaves) {
-    if (!aeronaves || total_aeronaves <= 0) {
-        return 0.0;
-    }
-    
-    double tempo_total = 0.0;
-    int aeronaves_validas = 0;
-    
-    // Percorre apenas uma vez o array
-    for (int i = 0; i < total_aeronaves; i++) {
-        if (aeronaves[i]) {
-            double media_aeronave = aeronave_calcular_media_espera(aeronaves[i]);
-            tempo_total += media_aeronave;
-            aeronaves_validas++;
-        }
-    }
-    
-    // Evita divisão se não houver aeronaves válidas
-    return (aeronaves_validas > 0) ? (tempo_total / aeronaves_validas) : 0.0;
-}
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <stdarg.h>
+#include <semaphore.h>
+#include "../include/utils.h"
+#include "../include/relogio.h"
+#include "../include/aeronave.h"
+#include "../include/desempenho.h"
+
+extern sem_t mutex_console;
+
+bool modo_silencioso = false;
+int escala_tempo = 1;
+
+/**
+ * Imprime o timestamp atual no formato HH:MM:SS.microseconds
+ */
+void imprimir_timestamp() {
+    char timestamp[RELOGIO_TAMANHO_TIMESTAMP];
+    relogio_formatar_timestamp(timestamp, sizeof(timestamp));
+    fputs(timestamp, stdout);
+}
+
+/**
+ * Imprime uma linha de evento com timestamp, protegida pelo mutex do console
+ * Não faz nada em modo silencioso
+ * @param formato: String de formato no estilo printf
+ */
+void log_evento(const char *formato, ...) {
+    if (modo_silencioso) return;
+
+    desempenho_entrar(DESEMPENHO_LOG);
+    va_list args;
+    va_start(args, formato);
+    sem_wait(&mutex_console);
+    imprimir_timestamp();
+    vprintf(formato, args);
+    sem_post(&mutex_console);
+    va_end(args);
+    desempenho_sair();
+}
+
+/**
+ * Dorme pelo tempo simulado informado, comprimido pela escala de tempo
+ * @param ms: Duração em milissegundos de tempo simulado
+ */
+void dormir_ms(int ms) {
+    long ns = (long)ms * 1000000L / (escala_tempo > 0 ? escala_tempo : 1);
+    struct timespec ts = {
+        .tv_sec = ns / 1000000000L,
+        .tv_nsec = ns % 1000000000L
+    };
+    nanosleep(&ts, NULL);
+}
+
+static int comparar_double(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Calcula um percentil (método do posto mais próximo). Ordena o array no lugar
+ * @param valores: Array de amostras
+ * @param n: Número de amostras
+ * @param p: Percentil desejado, entre 0 e 100
+ * @return Valor do percentil ou 0.0 se não houver amostras
+ */
+double percentil(double *valores, int n, double p) {
+    if (!valores || n <= 0) return 0.0;
+
+    qsort(valores, n, sizeof(double), comparar_double);
+    int indice = (int)((p / 100.0) * n + 0.999999) - 1;
+    if (indice < 0) indice = 0;
+    if (indice >= n) indice = n - 1;
+    return valores[indice];
+}
+
+/**
+ * Lê o conjunto residente (RSS) do processo em /proc/self/statm
+ * @return RSS em KB, ou 0 se a informação não estiver disponível
+ */
+long memoria_rss_kb() {
+    FILE *arquivo = fopen("/proc/self/statm", "r");
+    if (arquivo == NULL) return 0;
+
+    long paginas_total = 0, paginas_residentes = 0;
+    int lidos = fscanf(arquivo, "%ld %ld", &paginas_total, &paginas_residentes);
+    fclose(arquivo);
+    if (lidos != 2) return 0;
+
+    return paginas_residentes * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+/**
+ * Gera uma rota aleatória para uma aeronave
+ * Otimizado para reduzir chamadas a rand() e operações de módulo
+ * @param comprimento: Tamanho da rota (número de setores)
+ * @param total_setores: Número total de setores disponíveis no espaço aéreo
+ * @return Ponteiro para array de inteiros contendo a rota
+ */
+int* gerar_rota_aleatoria(int comprimento, int total_setores) {
+    if (comprimento <= 0 || total_setores <= 0) {
+        return NULL;
+    }
+    
+    int *rota = malloc(sizeof(int) * comprimento);
+    if (!rota) {
+        perror("malloc rota");
+        return NULL;
+    }
+    
+    // Gera uma rota começando de um setor aleatório
+    int setor_atual = rand() % total_setores;
+    rota[0] = setor_atual;
+    
+    // Gera o resto da rota de forma sequencial ou com pequenos saltos
+    for (int i = 1; i < comprimento; i++) {
+        // Otimização: uma única chamada rand() por iteração
+        int aleatorio = rand();
+        int tipo_movimento = aleatorio % 100;
+        
+        if (tipo_movimento < 70) {
+            // 70% de chance: Move para setor adjacente (mais eficiente)
+            setor_atual = (setor_atual + 1) % total_setores;
+        } else if (tipo_movimento < 90) {
+            // 20% de chance: Move para setor adjacente anterior
+            setor_atual = (setor_atual + total_setores - 1) % total_setores;
+        } else {
+            // 10% de chance: Faz um salto aleatório pequeno
+            int salto = ((aleatorio >> 8) % 3) + 1;  // Reutiliza bits do rand()
+            int direcao = (aleatorio & 1) ? 1 : -1;
+            setor_atual = (setor_atual + (salto * direcao) + total_setores) % total_setores;
+        }
+        rota[i] = setor_atual;
+    }
+    
+    return rota;
+}
+
+/**
+ * Gera um comprimento de rota aleatório baseado no total de setores
+ * @param total_setores: Número total de setores no espaço aéreo
+ * @return Comprimento da rota gerado aleatoriamente
+ */
+int gerar_comprimento_rota(int total_setores) {
+    if (total_setores <= 0) {
+        return 3; // Valor padrão mínimo
+    }
+    
+    // Gera rota entre 50% e 150% do total de setores
+    int minimo = (total_setores / 2) > 3 ? (total_setores / 2) : 3;
+    int maximo = (total_setores * 3 / 2) > minimo ? (total_setores * 3 / 2) : minimo + 5;
+    
+    return minimo + (rand() % (maximo - minimo + 1));
+}
+
+/**
+ * Calcula o tempo médio de espera de todas as aeronaves
+ * Otimizado para evitar divisão desnecessária
+ * @param aeronaves: Array de ponteiros para aeronaves
+ * @param total_aeronaves: Número total de aeronaves
+ * @return Tempo médio de espera em segundos
+ */
+double calcular_tempo_medio(aeronave_t **aeronaves, int total_aeronaves) {
+    if (!aeronaves || total_aeronaves <= 0) {
+        return 0.0;
+    }
+    
+    double tempo_total = 0.0;
+    int aeronaves_validas = 0;
+    
+    // Percorre apenas uma vez o array
+    for (int i = 0; i < total_aeronaves; i++) {
+        if (aeronaves[i]) {
+            double media_aeronave = aeronave_calcular_media_espera(aeronaves[i]);
+            tempo_total += media_aeronave;
+            aeronaves_validas++;
+        }
+    }
+    
+    // Evita divisão se não houver aeronaves válidas
+    return (aeronaves_validas > 0) ? (tempo_total / aeronaves_validas) : 0.0;
+}
@@ -0,0 +1,272 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "../include/verificador.h"
+#include "../include/relogio.h"
+#include "../include/utils.h"
+
+// Estado do verificador. Tudo que os ganchos tocam é atômico, então conferir
+// não depende de mutex_ctrl e o vigia lê sem travar ninguém
+typedef struct {
+    int total_setores;
+    int total_aeronaves;
+    _Atomic int *dono;                  // Por setor: id de quem o controlador concedeu, -1 se livre
+    _Atomic int *aguardando;            // Por aeronave: setor pelo qual está parada, -1 se nenhum
+    _Atomic unsigned long *estacionada; // Por aeronave: quantas vezes parou (época da espera atual)
+    _Atomic long long *parada_desde_ns; // Por aeronave: início da espera atual
+    _Alignas(LINHA_CACHE) _Atomic long concessoes;
+    _Atomic long violacoes_ocupacao;
+    _Atomic long liberacoes_invalidas;
+    _Atomic long setores_perdidos;
+    _Atomic long estacionamentos;
+    _Atomic bool registrou_violacao;
+    char primeira_violacao[160];
+    // Só o vigia escreve daqui para baixo
+    unsigned long *suspeita_epoca;      // Época da espera em que a suspeita começou (0 = nenhuma)
+    long long *suspeita_desde_ns;
+    long long parada_max_ns;
+    pthread_t thread_vigia;
+    _Atomic bool vigia_ativo;
+    bool vigia_iniciado;
+} verificador_t;
+
+static verificador_t verificador;
+static _Atomic bool ligado = false;
+
+/**
+ * Guarda a descrição da primeira violação (as seguintes só contam)
+ */
+static void verificador_registrar(const char *formato, int a, int b, int c) {
+    if (atomic_exchange(&verificador.registrou_violacao, true)) return;
+    snprintf(verificador.primeira_violacao, sizeof(verificador.primeira_violacao), formato, a, b, c);
+}
+
+/**
+ * Procura aeronaves paradas cujo motivo de esperar já acabou: o setor que
+ * aguardam está livre ou já é delas. Uma passada só levanta suspeita; a
+ * violação exige a mesma espera nessa situação por VERIFICADOR_LIMITE_PERDA_MS,
+ * o que descarta a janela normal entre a concessão e o sem_post
+ * @return Id da aeronave que perdeu o despertar, -1 se nenhuma
+ */
+static int verificador_passada_vigia() {
+    long long agora = relogio_agora_ns();
+    long long limite_ns = (long long)VERIFICADOR_LIMITE_PERDA_MS * 1000000LL;
+
+    for (int id = 0; id < verificador.total_aeronaves; id++) {
+        int setor = atomic_load_explicit(&verificador.aguardando[id], memory_order_acquire);
+        if (setor < 0) {
+            verificador.suspeita_epoca[id] = 0;
+            continue;
+        }
+        long long parada = agora - atomic_load_explicit(&verificador.parada_desde_ns[id], memory_order_relaxed);
+        if (parada > verificador.parada_max_ns) verificador.parada_max_ns = parada;
+
+        int dono = atomic_load_explicit(&verificador.dono[setor], memory_order_relaxed);
+        if (dono != -1 && dono != id) {
+            verificador.suspeita_epoca[id] = 0;
+            continue;
+        }
+        unsigned long epoca = atomic_load_explicit(&verificador.estacionada[id], memory_order_relaxed);
+        if (verificador.suspeita_epoca[id] != epoca) {
+            verificador.suspeita_epoca[id] = epoca;
+            verificador.suspeita_desde_ns[id] = agora;
+        } else if (agora - verificador.suspeita_desde_ns[id] >= limite_ns) {
+            return id;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Thread do vigia de despertares. Um despertar perdido deixa a execução parada
+ * para sempre (frota_aguardar nunca volta), então o vigia relata e encerra o
+ * processo com falha em vez de deixar o teste pendurado
+ * @param arg: Não utilizado
+ * @return NULL ao ser desligado
+ */
+static void *verificador_vigia_executar(void *arg) {
+    (void)arg;
+    struct timespec pausa = {
+        .tv_sec = VERIFICADOR_PERIODO_MS / 1000,
+        .tv_nsec = (long)(VERIFICADOR_PERIODO_MS % 1000) * 1000000L
+    };
+    while (atomic_load(&verificador.vigia_ativo)) {
+        nanosleep(&pausa, NULL);
+        int id = verificador_passada_vigia();
+        if (id < 0) continue;
+
+        int setor = atomic_load(&verificador.aguardando[id]);
+        int dono = atomic_load(&verificador.dono[setor]);
+        fflush(stdout);
+        fprintf(stderr, "[VERIFICADOR] Despertar perdido: A%d parada há mais de %d ms por S%d, que está %s\n",
+                id, VERIFICADOR_LIMITE_PERDA_MS, setor, dono == id ? "concedido a ela" : "livre");
+        _exit(2);
+    }
+    return NULL;
+}
+
+/**
+ * Liga o verificador para a próxima execução (depois de atc_init, antes das
+ * threads das aeronaves) e inicia o vigia
+ * @param setores: Número de setores
+ * @param aeronaves: Número de aeronaves (ids de 0 a aeronaves-1)
+ * @return true em caso de sucesso
+ */
+bool verificador_inicializar(int setores, int aeronaves) {
+    memset(&verificador, 0, sizeof(verificador));
+    verificador.total_setores = setores;
+    verificador.total_aeronaves = aeronaves;
+    verificador.dono = malloc(sizeof(*verificador.dono) * setores);
+    verificador.aguardando = malloc(sizeof(*verificador.aguardando) * aeronaves);
+    verificador.estacionada = malloc(sizeof(*verificador.estacionada) * aeronaves);
+    verificador.parada_desde_ns = malloc(sizeof(*verificador.parada_desde_ns) * aeronaves);
+    verificador.suspeita_epoca = calloc(aeronaves, sizeof(*verificador.suspeita_epoca));
+    verificador.suspeita_desde_ns = calloc(aeronaves, sizeof(*verificador.suspeita_desde_ns));
+    if (!verificador.dono || !verificador.aguardando || !verificador.estacionada ||
+        !verificador.parada_desde_ns || !verificador.suspeita_epoca || !verificador.suspeita_desde_ns) {
+        perror("malloc verificador");
+        verificador_finalizar();
+        return false;
+    }
+
+    for (int s = 0; s < setores; s++) {
+        atomic_init(&verificador.dono[s], -1);
+    }
+    for (int i = 0; i < aeronaves; i++) {
+        atomic_init(&verificador.aguardando[i], -1);
+        atomic_init(&verificador.estacionada[i], 0);
+        atomic_init(&verificador.parada_desde_ns[i], 0);
+    }
+
+    atomic_store(&verificador.vigia_ativo, true);
+    if (pthread_create(&verificador.thread_vigia, NULL, verificador_vigia_executar, NULL) != 0) {
+        perror("Erro ao criar thread do vigia de despertares");
+        verificador_finalizar();
+        return false;
+    }
+    verificador.vigia_iniciado = true;
+    atomic_store(&ligado, true);
+    return true;
+}
+
+/**
+ * Para o vigia e libera o verificador (depois de atc_finalizar: o controlador
+ * central ainda pode liberar setores até lá)
+ */
+void verificador_finalizar() {
+    atomic_store(&ligado, false);
+    if (verificador.vigia_iniciado) {
+        atomic_store(&verificador.vigia_ativo, false);
+        pthread_join(verificador.thread_vigia, NULL);
+        verificador.vigia_iniciado = false;
+    }
+    free(verificador.dono);
+    free(verificador.aguardando);
+    free(verificador.estacionada);
+    free(verificador.parada_desde_ns);
+    free(verificador.suspeita_epoca);
+    free(verificador.suspeita_desde_ns);
+    verificador.dono = NULL;
+    verificador.aguardando = NULL;
+    verificador.estacionada = NULL;
+    verificador.parada_desde_ns = NULL;
+    verificador.suspeita_epoca = NULL;
+    verificador.suspeita_desde_ns = NULL;
+}
+
+/**
+ * @return true se o verificador está ligado nesta execução
+ */
+bool verificador_ativo() {
+    return atomic_load_explicit(&ligado, memory_order_relaxed);
+}
+
+/**
+ * Confere uma concessão: o setor precisa estar livre (ou já ser da aeronave)
+ * @param setor: Setor concedido
+ * @param id: Aeronave que passa a ocupá-lo
+ */
+void verificador_ocupar(int setor, int id) {
+    if (!verificador_ativo()) return;
+    atomic_fetch_add_explicit(&verificador.concessoes, 1, memory_order_relaxed);
+    int esperado = -1;
+    if (!atomic_compare_exchange_strong(&verificador.dono[setor], &esperado, id) && esperado != id) {
+        atomic_fetch_add(&verificador.violacoes_ocupacao, 1);
+        verificador_registrar("S%d concedido a A%d com A%d dentro", setor, id, esperado);
+        atomic_store(&verificador.dono[setor], id);
+    }
+}
+
+/**
+ * Confere uma liberação: só o dono devolve o setor
+ * @param setor: Setor liberado
+ * @param id: Aeronave em nome de quem o setor é liberado
+ */
+void verificador_desocupar(int setor, int id) {
+    if (!verificador_ativo()) return;
+    int esperado = id;
+    if (!atomic_compare_exchange_strong(&verificador.dono[setor], &esperado, -1)) {
+        atomic_fetch_add(&verificador.liberacoes_invalidas, 1);
+        verificador_registrar("S%d liberado por A%d, mas o dono era A%d", setor, id, esperado);
+        atomic_store(&verificador.dono[setor], -1);
+    }
+}
+
+/**
+ * Chamada pela própria aeronave em voo: o setor em que ela está continua dela
+ * @param setor: Setor que a aeronave acredita ocupar
+ * @param id: Aeronave
+ */
+void verificador_confirmar(int setor, int id) {
+    if (!verificador_ativo()) return;
+    int dono = atomic_load(&verificador.dono[setor]);
+    if (dono != id) {
+        atomic_fetch_add(&verificador.setores_perdidos, 1);
+        verificador_registrar("A%d voando em S%d, mas o dono é A%d", id, setor, dono);
+    }
+}
+
+/**
+ * Marca que a aeronave vai dormir no semáforo à espera de um setor
+ * @param id: Aeronave
+ * @param setor: Setor pedido
+ */
+void verificador_estacionar(int id, int setor) {
+    if (!verificador_ativo()) return;
+    atomic_fetch_add_explicit(&verificador.estacionamentos, 1, memory_order_relaxed);
+    atomic_store_explicit(&verificador.parada_desde_ns[id], relogio_agora_ns(), memory_order_relaxed);
+    atomic_fetch_add_explicit(&verificador.estacionada[id], 1, memory_order_relaxed);
+    atomic_store_explicit(&verificador.aguardando[id], setor, memory_order_release);
+}
+
+/**
+ * Marca que a aeronave acordou
+ * @param id: Aeronave
+ */
+void verificador_despertar(int id) {
+    if (!verificador_ativo()) return;
+    atomic_store_explicit(&verificador.aguardando[id], -1, memory_order_release);
+}
+
+/**
+ * Copia os contadores do verificador (depois de verificador_finalizar, com o vigia parado)
+ * @param estatisticas: Estrutura que recebe os contadores
+ */
+void verificador_obter_estatisticas(verificador_estatisticas_t *estatisticas) {
+    if (estatisticas == NULL) return;
+    memset(estatisticas, 0, sizeof(*estatisticas));
+    estatisticas->concessoes = atomic_load(&verificador.concessoes);
+    estatisticas->violacoes_ocupacao = atomic_load(&verificador.violacoes_ocupacao);
+    estatisticas->liberacoes_invalidas = atomic_load(&verificador.liberacoes_invalidas);
+    estatisticas->setores_perdidos = atomic_load(&verificador.setores_perdidos);
+    estatisticas->estacionamentos = atomic_load(&verificador.estacionamentos);
+    estatisticas->parada_max_ns = verificador.parada_max_ns;
+    if (atomic_load(&verificador.registrou_violacao)) {
+        snprintf(estatisticas->primeira_violacao, sizeof(estatisticas->primeira_violacao), "%s",
+                 verificador.primeira_violacao);
+    }
+}
@@ -0,0 +1,85 @@
+#include <stdio.h>
+#include <string.h>
+#include "../include/vitima.h"
+#include "../include/utils.h"
+
+#define ESPERA_REFERENCIA_S 3.0 // Espera longa (mesmo limiar do boost do controlador)
+#define RECUOS_REFERENCIA 2     // Recuos seguidos que já rendem boost
+
+// Original: recua a de menor prioridade efetiva
+const politica_vitima_t vitima_prioridade = { "prioridade", 1.0, 0.0, 0.0, 0.0 };
+// Recua a que menos andou: quem está perto do fim libera o espaço aéreo logo
+const politica_vitima_t vitima_progresso = { "progresso", 0.0, 1.0, 0.0, 0.0 };
+// Tudo junto: prioridade, progresso, espera acumulada e recuos anteriores
+const politica_vitima_t vitima_custo = { "custo", 1.0, 1.0, 1.0, 1.0 };
+
+const politica_vitima_t *const vitimas_disponiveis[] = {
+    &vitima_prioridade,
+    &vitima_progresso,
+    &vitima_custo,
+};
+const int total_vitimas = sizeof(vitimas_disponiveis) / sizeof(vitimas_disponiveis[0]);
+
+static politica_vitima_t vitima_pesos = { "pesos", 0.0, 0.0, 0.0, 0.0 };
+static const politica_vitima_t *vitima_atual = &vitima_prioridade;
+
+/**
+ * Seleciona a função de custo da escolha de vítimas (antes de atc_init)
+ * @param nome: Nome de uma política pronta (prioridade, progresso, custo) ou
+ *              "pesos:P,R,E,C" com os pesos de prioridade, progresso, espera e recuos
+ * @return true se o nome for conhecido e os pesos forem válidos
+ */
+bool vitima_definir(const char *nome) {
+    if (nome == NULL) return false;
+    for (int i = 0; i < total_vitimas; i++) {
+        if (strcmp(vitimas_disponiveis[i]->nome, nome) == 0) {
+            vitima_atual = vitimas_disponiveis[i];
+            return true;
+        }
+    }
+
+    double p, r, e, c;
+    if (strncmp(nome, "pesos:", 6) != 0 ||
+        sscanf(nome + 6, "%lf,%lf,%lf,%lf", &p, &r, &e, &c) != 4 ||
+        p < 0 || r < 0 || e < 0 || c < 0) {
+        return false;
+    }
+    vitima_pesos.peso_prioridade = p;
+    vitima_pesos.peso_progresso = r;
+    vitima_pesos.peso_espera = e;
+    vitima_pesos.peso_recuos = c;
+    vitima_atual = &vitima_pesos;
+    return true;
+}
+
+/**
+ * @return Nome da política de vítimas em uso
+ */
+const char *vitima_nome() {
+    return vitima_atual->nome;
+}
+
+/**
+ * Calcula quanto se perde fazendo uma aeronave recuar (a de menor custo recua)
+ * Deve ser chamada com mutex_ctrl, com a aeronave parada na fila ou pedindo o setor
+ * @param aeronave: Candidata a vítima
+ * @param prioridade: Prioridade efetiva (da tabela do controlador)
+ * @param agora_ns: Instante atual (relogio_agora_ns), comum a todo o ciclo
+ * @return Custo do recuo (quanto maior, mais se perde)
+ */
+double vitima_calcular_custo(const aeronave_t *aeronave, unsigned int prioridade, long long agora_ns) {
+    const politica_vitima_t *v = vitima_atual;
+    double custo = v->peso_prioridade * prioridade / PRIORIDADE_MAX;
+
+    if (v->peso_progresso > 0 && aeronave->comprimento_rota > 0) {
+        custo += v->peso_progresso * aeronave->posicao_rota / aeronave->comprimento_rota;
+    }
+    if (v->peso_espera > 0 && aeronave->instante_solicitacao_ns > 0) {
+        double espera_simulada = (agora_ns - aeronave->instante_solicitacao_ns) / 1e9 * escala_tempo;
+        custo += v->peso_espera * espera_simulada / ESPERA_REFERENCIA_S;
+    }
+    if (v->peso_recuos > 0) {
+        custo += v->peso_recuos * aeronave->contador_recuos / RECUOS_REFERENCIA;
+    }
+    return custo;
+}